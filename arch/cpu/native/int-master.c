@@ -33,10 +33,55 @@
 #include "sys/int-master.h"
 
 #include <stdbool.h>
+#if RTIMER_WITH_QUEUE
+#include <signal.h>
+#endif /* RTIMER_WITH_QUEUE */
 /*---------------------------------------------------------------------------*/
 #define DISABLED 0
 #define ENABLED  1
 /*---------------------------------------------------------------------------*/
+#if RTIMER_WITH_QUEUE
+/*
+ * The only interrupt on native is the SIGALRM that drives the rtimer.
+ * The rtimer queue is updated in critical sections, so interrupts are
+ * masked by blocking that signal. Each call is then a system call, and
+ * interrupts start out enabled.
+ */
+static int_master_status_t
+alarm_mask(int how, bool change)
+{
+  sigset_t set, old;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGALRM);
+  sigprocmask(how, change ? &set : NULL, &old);
+  return sigismember(&old, SIGALRM) ? DISABLED : ENABLED;
+}
+/*---------------------------------------------------------------------------*/
+void
+int_master_enable(void)
+{
+  alarm_mask(SIG_UNBLOCK, true);
+}
+/*---------------------------------------------------------------------------*/
+int_master_status_t
+int_master_read_and_disable(void)
+{
+  return alarm_mask(SIG_BLOCK, true);
+}
+/*---------------------------------------------------------------------------*/
+void
+int_master_status_set(int_master_status_t status)
+{
+  alarm_mask(status == DISABLED ? SIG_BLOCK : SIG_UNBLOCK, true);
+}
+/*---------------------------------------------------------------------------*/
+bool
+int_master_is_enabled(void)
+{
+  return alarm_mask(SIG_BLOCK, false) == ENABLED;
+}
+#else /* RTIMER_WITH_QUEUE */
 static int_master_status_t stat = DISABLED;
 /*---------------------------------------------------------------------------*/
 void
@@ -64,4 +109,5 @@ int_master_is_enabled(void)
 {
   return stat == DISABLED ? false : true;
 }
+#endif /* RTIMER_WITH_QUEUE */
 /*---------------------------------------------------------------------------*/
@@ -65,6 +65,11 @@
 #include <err.h>
 #include "net/netstack.h"
 #include "net/packetbuf.h"
+#include "tun6-net.h"
+
+#if TUN6_NET_WITH_BATCHING
+#include "lib/ringbufindex.h"
+#endif /* TUN6_NET_WITH_BATCHING */
 
 static const char *config_ipaddr = "fd00::1/64";
 /* Allocate some bytes in RAM and copy the string */
@@ -72,6 +77,20 @@ static char config_tundev[IFNAMSIZ + 1] = "tun0";
 
 static int tunfd = -1;
 
+static struct tun6_net_stats stats;
+
+#if TUN6_NET_WITH_BATCHING
+struct rx_packet {
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+};
+
+static struct rx_packet rx_ring[TUN6_NET_RING_SIZE];
+static struct ringbufindex rx_ringbuf;
+
+PROCESS(tun6_net_process, "Tun6 input");
+#endif /* TUN6_NET_WITH_BATCHING */
+
 static int set_fd(fd_set *rset, fd_set *wset);
 static void handle_fd(fd_set *rset, fd_set *wset);
 static const struct select_callback tun_select_callback = {
@@ -222,6 +241,13 @@ tun_init()
 
   LOG_INFO("Tun open:%d\n", tunfd);
 
+#if TUN6_NET_WITH_BATCHING
+  /* Packets are read until the device has no more of them. */
+  fcntl(tunfd, F_SETFL, fcntl(tunfd, F_GETFL) | O_NONBLOCK);
+  ringbufindex_init(&rx_ringbuf, TUN6_NET_RING_SIZE);
+  process_start(&tun6_net_process, NULL);
+#endif /* TUN6_NET_WITH_BATCHING */
+
   select_set_callback(tunfd, &tun_select_callback);
 
   fprintf(stderr, "opened %s device ``/dev/%s''\n",
@@ -237,8 +263,12 @@ tun_init()
 static int
 tun_output(uint8_t *data, int len)
 {
-  if(tunfd != -1 && write(tunfd, data, len) != len) {
-    err(1, "serial_to_tun: write");
+  if(tunfd != -1) {
+    if(write(tunfd, data, len) != len) {
+      err(1, "serial_to_tun: write");
+    }
+    stats.tx_packets++;
+    stats.tx_bytes += len;
   }
   return 0;
 }
@@ -254,8 +284,17 @@ tun_input(unsigned char *data, int maxlen)
   }
 
   if((size = read(tunfd, data, maxlen)) == -1) {
+#if TUN6_NET_WITH_BATCHING
+    if(errno == EAGAIN || errno == EWOULDBLOCK) {
+      return 0;
+    }
+#endif /* TUN6_NET_WITH_BATCHING */
     err(1, "tun_input: read");
   }
+  if(size > 0) {
+    stats.rx_packets++;
+    stats.rx_bytes += size;
+  }
   return size;
 }
 /*---------------------------------------------------------------------------*/
@@ -279,6 +318,13 @@ set_fd(fd_set *rset, fd_set *wset)
     return 0;
   }
 
+#if TUN6_NET_WITH_BATCHING
+  /* Leave the packets in the device until uIP has caught up. */
+  if(ringbufindex_full(&rx_ringbuf)) {
+    return 0;
+  }
+#endif /* TUN6_NET_WITH_BATCHING */
+
   FD_SET(tunfd, rset);
   return 1;
 }
@@ -297,12 +343,72 @@ handle_fd(fd_set *rset, fd_set *wset)
   LOG_INFO("Tun6-handle FD\n");
 
   if(FD_ISSET(tunfd, rset)) {
+#if TUN6_NET_WITH_BATCHING
+    unsigned long batch = 0;
+    int i;
+
+    while((i = ringbufindex_peek_put(&rx_ringbuf)) >= 0) {
+      size = tun_input(rx_ring[i].data, sizeof(rx_ring[i].data));
+      if(size <= 0) {
+        break;
+      }
+      rx_ring[i].len = size;
+      ringbufindex_put(&rx_ringbuf);
+      batch++;
+    }
+    LOG_DBG("TUN data incoming batch:%lu\n", batch);
+
+    if(batch > 0) {
+      stats.rx_batches++;
+      if(batch > stats.rx_max_batch) {
+        stats.rx_max_batch = batch;
+      }
+      process_poll(&tun6_net_process);
+    }
+    if(i < 0) {
+      stats.rx_ring_full++;
+    }
+#else /* TUN6_NET_WITH_BATCHING */
     size = tun_input(uip_buf, sizeof(uip_buf));
     LOG_DBG("TUN data incoming read:%d\n", size);
+    if(size > 0) {
+      stats.rx_batches++;
+      stats.rx_max_batch = 1;
+    }
     uip_len = size;
     tcpip_input();
+#endif /* TUN6_NET_WITH_BATCHING */
   }
 }
+/*---------------------------------------------------------------------------*/
+#if TUN6_NET_WITH_BATCHING
+/* Pass all packets in the receive ring to uIP. */
+PROCESS_THREAD(tun6_net_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    while((i = ringbufindex_peek_get(&rx_ringbuf)) >= 0) {
+      memcpy(uip_buf, rx_ring[i].data, rx_ring[i].len);
+      uip_len = rx_ring[i].len;
+      ringbufindex_get(&rx_ringbuf);
+      tcpip_input();
+    }
+  }
+
+  PROCESS_END();
+}
+#endif /* TUN6_NET_WITH_BATCHING */
+/*---------------------------------------------------------------------------*/
+const struct tun6_net_stats *
+tun6_net_get_stats(void)
+{
+  return &stats;
+}
 
 static void input(void)
 {
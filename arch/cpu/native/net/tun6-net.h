@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Interface of the native tun network driver.
+ */
+
+#ifndef TUN6_NET_H_
+#define TUN6_NET_H_
+
+#include "contiki.h"
+
+/*
+ * Read all packets that are queued in the tun device when it becomes
+ * readable, instead of one packet per main loop iteration. The packets
+ * are kept in a ring buffer until the tun6 process passes them to uIP.
+ */
+#ifdef TUN6_NET_CONF_WITH_BATCHING
+#define TUN6_NET_WITH_BATCHING TUN6_NET_CONF_WITH_BATCHING
+#else
+#define TUN6_NET_WITH_BATCHING 0
+#endif
+
+/* The number of slots in the receive ring, which must be a power of
+   two. One slot is always kept empty. */
+#ifdef TUN6_NET_CONF_RING_SIZE
+#define TUN6_NET_RING_SIZE TUN6_NET_CONF_RING_SIZE
+#else
+#define TUN6_NET_RING_SIZE 32
+#endif
+
+struct tun6_net_stats {
+  /* Packets and bytes read from the tun device. */
+  unsigned long rx_packets;
+  unsigned long rx_bytes;
+  /* Readiness events that yielded at least one packet, and the largest
+     number of packets read in one of them. */
+  unsigned long rx_batches;
+  unsigned long rx_max_batch;
+  /* Readiness events that stopped because the receive ring was full. */
+  unsigned long rx_ring_full;
+  /* Packets and bytes written to the tun device. */
+  unsigned long tx_packets;
+  unsigned long tx_bytes;
+};
+
+/**
+ * \brief  Get the traffic counters of the tun driver.
+ * \return A pointer to the counters, which are updated in place.
+ */
+const struct tun6_net_stats *tun6_net_get_stats(void);
+
+#endif /* TUN6_NET_H_ */
@@ -73,9 +73,15 @@ rtimer_arch_schedule(rtimer_clock_t t)
   rtimer_clock_t c;
 
   c = t - clock_time();
-  
-  val.it_value.tv_sec = c / CLOCK_SECOND;
-  val.it_value.tv_usec = (c % CLOCK_SECOND) * CLOCK_SECOND;
+
+  if(RTIMER_CLOCK_DIFF(c, 0) <= 0) {
+    /* Already due: a zero timer value would disarm the timer instead */
+    val.it_value.tv_sec = 0;
+    val.it_value.tv_usec = 1;
+  } else {
+    val.it_value.tv_sec = c / CLOCK_SECOND;
+    val.it_value.tv_usec = (c % CLOCK_SECOND) * (1000000 / CLOCK_SECOND);
+  }
 
   PRINTF("rtimer_arch_schedule time %"PRIu32 " %"PRIu32 " in %ld.%ld seconds\n",
          t, c, (long)val.it_value.tv_sec, (long)val.it_value.tv_usec);
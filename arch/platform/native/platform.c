@@ -47,6 +47,7 @@
 #include <unistd.h>
 #include <sys/select.h>
 #include <errno.h>
+#include <stdbool.h>
 
 #include "contiki.h"
 #include "net/netstack.h"
@@ -113,11 +114,55 @@
 #else
 #define SELECT_STDIN 1
 #endif
+
+/*
+ * Wait for file descriptors and timers with epoll instead of select().
+ * Any file descriptor below FD_SETSIZE can then be monitored, and the
+ * main loop wakes up when the next event timer expires rather than
+ * after a fixed timeout. Only available on Linux.
+ */
+#ifdef SELECT_CONF_WITH_EPOLL
+#define SELECT_WITH_EPOLL SELECT_CONF_WITH_EPOLL
+#else
+#define SELECT_WITH_EPOLL 0
+#endif
+
+#if SELECT_WITH_EPOLL && !defined(__linux__)
+#error "SELECT_CONF_WITH_EPOLL requires Linux"
+#endif
 /** @} */
 /*---------------------------------------------------------------------------*/
 
+#if SELECT_WITH_EPOLL
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+/* The maximum number of events handled per main loop iteration. */
+#define EPOLL_MAX_EVENTS 64
+
+struct select_entry {
+  const struct select_callback *callback;
+  /* The events that the descriptor is registered for with epoll. */
+  uint32_t events;
+  /* Regular files cannot be added to epoll, and are always ready as
+     with select(). */
+  bool always_ready;
+};
+
+/* The callbacks are indexed by file descriptor, and the descriptors
+   with a callback are also kept in a dense array for iteration. */
+static struct select_entry select_entries[FD_SETSIZE];
+static int select_fds[FD_SETSIZE];
+static int select_nfds;
+
+static int epoll_fd = -1;
+static int timer_fd = -1;
+static bool timer_armed;
+static clock_time_t timer_expiration;
+#else /* SELECT_WITH_EPOLL */
 static const struct select_callback *select_callback[SELECT_MAX];
 static int select_max = 0;
+#endif /* SELECT_WITH_EPOLL */
 
 #ifdef PLATFORM_CONF_MAC_ADDR
 static uint8_t mac_addr[] = PLATFORM_CONF_MAC_ADDR;
@@ -126,6 +171,161 @@ static uint8_t mac_addr[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
 #endif /* PLATFORM_CONF_MAC_ADDR */
 
 /*---------------------------------------------------------------------------*/
+#if SELECT_WITH_EPOLL
+static bool
+epoll_setup(void)
+{
+  struct epoll_event ev;
+
+  if(epoll_fd >= 0) {
+    return true;
+  }
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if(epoll_fd < 0) {
+    perror("epoll_create1");
+    return false;
+  }
+
+  /* A timer descriptor wakes up the main loop when the next event timer
+     expires. */
+  timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if(timer_fd < 0) {
+    perror("timerfd_create");
+  } else {
+    ev.events = EPOLLIN;
+    ev.data.fd = timer_fd;
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) < 0) {
+      perror("epoll_ctl");
+    }
+  }
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+int
+select_set_callback(int fd, const struct select_callback *callback)
+{
+  struct select_entry *entry;
+  int i;
+
+  /* The callbacks use fd_set, which limits the descriptor values. */
+  if(fd < 0 || fd >= FD_SETSIZE || !epoll_setup()) {
+    return 0;
+  }
+
+  /* Check that the callback functions are set */
+  if(callback != NULL &&
+     (callback->set_fd == NULL || callback->handle_fd == NULL)) {
+    callback = NULL;
+  }
+
+  entry = &select_entries[fd];
+  if(callback != NULL && entry->callback == NULL) {
+    select_fds[select_nfds++] = fd;
+  } else if(callback == NULL && entry->callback != NULL) {
+    for(i = 0; select_fds[i] != fd; i++);
+    select_fds[i] = select_fds[--select_nfds];
+    if(entry->events != 0 && !entry->always_ready) {
+      /* The descriptor may already have been closed. */
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    }
+    entry->events = 0;
+    entry->always_ready = false;
+  }
+  entry->callback = callback;
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Register the events that the callback asked for in fdr and fdw with
+   epoll, if they have changed since the previous iteration. */
+static void
+update_events(int fd, struct select_entry *entry, fd_set *fdr, fd_set *fdw)
+{
+  struct epoll_event ev;
+  uint32_t events;
+  int op;
+
+  events = (FD_ISSET(fd, fdr) ? EPOLLIN : 0) | (FD_ISSET(fd, fdw) ? EPOLLOUT : 0);
+  if(events == entry->events) {
+    return;
+  }
+  if(entry->always_ready) {
+    entry->events = events;
+    return;
+  }
+
+  ev.events = events;
+  ev.data.fd = fd;
+  if(entry->events == 0) {
+    op = EPOLL_CTL_ADD;
+  } else if(events == 0) {
+    op = EPOLL_CTL_DEL;
+  } else {
+    op = EPOLL_CTL_MOD;
+  }
+
+  if(epoll_ctl(epoll_fd, op, fd, &ev) < 0 && op != EPOLL_CTL_DEL) {
+    if(op == EPOLL_CTL_ADD && errno == EPERM) {
+      entry->always_ready = true;
+      entry->events = events;
+      return;
+    }
+    /* A descriptor that was closed and reopened under the same number
+       has been dropped from the epoll set, and must be added again. */
+    if(op != EPOLL_CTL_MOD || errno != ENOENT ||
+       epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      perror("epoll_ctl");
+      return;
+    }
+  }
+  entry->events = events;
+}
+/*---------------------------------------------------------------------------*/
+/* Arm the timer descriptor for the next event timer expiration. */
+static void
+update_timer(void)
+{
+  struct itimerspec its;
+  clock_time_t next;
+  clock_time_t now;
+
+  if(timer_fd < 0) {
+    return;
+  }
+
+  memset(&its, 0, sizeof(its));
+  if(!etimer_pending()) {
+    if(timer_armed) {
+      timerfd_settime(timer_fd, 0, &its, NULL);
+      timer_armed = false;
+    }
+    return;
+  }
+
+  next = etimer_next_expiration_time();
+  if(timer_armed && next == timer_expiration) {
+    return;
+  }
+
+  now = clock_time();
+  if(CLOCK_LT(now, next)) {
+    its.it_value.tv_sec = (next - now) / CLOCK_SECOND;
+    its.it_value.tv_nsec = ((next - now) % CLOCK_SECOND) *
+      (1000000000 / CLOCK_SECOND);
+  } else {
+    /* Already expired. A zero value would disarm the timer. */
+    its.it_value.tv_nsec = 1;
+  }
+  if(timerfd_settime(timer_fd, 0, &its, NULL) < 0) {
+    perror("timerfd_settime");
+    return;
+  }
+  timer_armed = true;
+  timer_expiration = next;
+}
+/*---------------------------------------------------------------------------*/
+#else /* SELECT_WITH_EPOLL */
 int
 select_set_callback(int fd, const struct select_callback *callback)
 {
@@ -157,6 +357,7 @@ select_set_callback(int fd, const struct select_callback *callback)
   }
   return 0;
 }
+#endif /* SELECT_WITH_EPOLL */
 /*---------------------------------------------------------------------------*/
 #if SELECT_STDIN
 static int
@@ -282,6 +483,111 @@ platform_init_stage_three()
   setvbuf(stdout, (char *)NULL, _IONBF, 0);
 }
 /*---------------------------------------------------------------------------*/
+#if SELECT_WITH_EPOLL
+void
+platform_main_loop()
+{
+#if SELECT_STDIN
+  select_set_callback(STDIN_FILENO, &stdin_fd);
+#endif /* SELECT_STDIN */
+  /* Only the bits of the registered descriptors are used, and they are
+     cleared one by one instead of resetting the whole sets. */
+  static fd_set fdr;
+  static fd_set fdw;
+
+  epoll_setup();
+
+  while(1) {
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    struct select_entry *entry;
+    uint64_t expirations;
+    bool ready;
+    int timeout;
+    int retval;
+    int fd;
+    int i;
+
+    retval = process_run();
+
+    /* Ask the callbacks which events they are interested in. Epoll is
+       only updated when the interest of a descriptor changes. */
+    for(i = 0; i < select_nfds; i++) {
+      fd = select_fds[i];
+      FD_CLR(fd, &fdr);
+      FD_CLR(fd, &fdw);
+    }
+    for(i = 0; i < select_nfds; i++) {
+      select_entries[select_fds[i]].callback->set_fd(&fdr, &fdw);
+    }
+    ready = false;
+    for(i = 0; i < select_nfds; i++) {
+      fd = select_fds[i];
+      update_events(fd, &select_entries[fd], &fdr, &fdw);
+      if(select_entries[fd].always_ready && select_entries[fd].events != 0) {
+        ready = true;
+      }
+    }
+
+    if(retval || ready) {
+      timeout = 0;
+    } else {
+      update_timer();
+      timeout = SELECT_TIMEOUT;
+    }
+
+    retval = epoll_wait(epoll_fd, events, EPOLL_MAX_EVENTS, timeout);
+    if(retval < 0) {
+      if(errno != EINTR) {
+        perror("epoll_wait");
+      }
+      retval = 0;
+    }
+
+    /* Report the ready descriptors to the callbacks as select() would.
+       Descriptors that are always ready keep the bits from set_fd(). */
+    for(i = 0; i < select_nfds; i++) {
+      fd = select_fds[i];
+      if(!select_entries[fd].always_ready) {
+        FD_CLR(fd, &fdr);
+        FD_CLR(fd, &fdw);
+      }
+    }
+    for(i = 0; i < retval; i++) {
+      fd = events[i].data.fd;
+      if(fd == timer_fd) {
+        if(read(timer_fd, &expirations, sizeof(expirations)) > 0) {
+          timer_armed = false;
+        }
+        continue;
+      }
+      entry = &select_entries[fd];
+      if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR) &&
+         entry->events & EPOLLIN) {
+        FD_SET(fd, &fdr);
+      }
+      if(events[i].events & (EPOLLOUT | EPOLLERR) &&
+         entry->events & EPOLLOUT) {
+        FD_SET(fd, &fdw);
+      }
+    }
+    for(i = 0; i < retval; i++) {
+      fd = events[i].data.fd;
+      /* A callback may have removed another descriptor. */
+      if(fd != timer_fd && select_entries[fd].callback != NULL) {
+        select_entries[fd].callback->handle_fd(&fdr, &fdw);
+      }
+    }
+    for(i = 0; ready && i < select_nfds; i++) {
+      entry = &select_entries[select_fds[i]];
+      if(entry->always_ready && entry->events != 0) {
+        entry->callback->handle_fd(&fdr, &fdw);
+      }
+    }
+
+    etimer_request_poll();
+  }
+}
+#else /* SELECT_WITH_EPOLL */
 void
 platform_main_loop()
 {
@@ -327,6 +633,7 @@ platform_main_loop()
     etimer_request_poll();
   }
 }
+#endif /* SELECT_WITH_EPOLL */
 /*---------------------------------------------------------------------------*/
 void
 log_message(char *m1, char *m2)
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *	Measures the rate at which selections process the tuples of a
+ *	relation. Build with DEFINES=DB_FEATURE_COMPILED_LVM=1 to compare
+ *	compiled conditions with interpreted ones.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "contiki.h"
+
+#include "antelope.h"
+
+#define TUPLE_COUNT 10000
+
+/* The number of times each selection is run. */
+#define ROUNDS      10
+
+/* The queries to measure, and the numbers of tuples they return. */
+static const struct {
+  const char *query;
+  tuple_id_t expected;
+} selections[] = {
+  { "SELECT id, value FROM samples WHERE value > 899;", 1000 },
+  { "SELECT id, value FROM samples WHERE value >= 100 AND value < 110;", 100 },
+  { "SELECT id, value FROM samples WHERE id * 2 = value + 20;", 1 },
+  { "SELECT id, value FROM samples WHERE value = 7 OR id < 3;", 13 },
+};
+
+PROCESS(antelope_benchmark, "Antelope benchmark");
+AUTOSTART_PROCESSES(&antelope_benchmark);
+
+static db_result_t
+execute(const char *format, ...)
+{
+  static db_handle_t handle;
+  db_result_t result;
+  va_list ap;
+  char buf[64];
+
+  va_start(ap, format);
+  vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+
+  result = db_query(&handle, "%s", buf);
+  if(DB_ERROR(result)) {
+    printf("Query \"%s\" failed: %s\n", buf, db_get_result_message(result));
+  }
+  db_free(&handle);
+  return result;
+}
+
+static int
+create_relation(void)
+{
+  long i;
+
+  db_init();
+  if(DB_ERROR(execute("REMOVE RELATION samples;"))) {
+    /* The relation did not exist. */
+  }
+  if(DB_ERROR(execute("CREATE RELATION samples;")) ||
+     DB_ERROR(execute("CREATE ATTRIBUTE id DOMAIN LONG IN samples;")) ||
+     DB_ERROR(execute("CREATE ATTRIBUTE value DOMAIN INT IN samples;"))) {
+    return 0;
+  }
+
+  for(i = 0; i < TUPLE_COUNT; i++) {
+    if(DB_ERROR(execute("INSERT (%ld, %ld) INTO samples;", i, i % 1000))) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static void
+run_selection(const char *query, tuple_id_t expected)
+{
+  static db_handle_t handle;
+  db_result_t result;
+  tuple_id_t matching;
+  clock_time_t start;
+  clock_time_t elapsed;
+  unsigned round;
+
+  start = clock_time();
+  for(round = 0; round < ROUNDS; round++) {
+    result = db_query(&handle, "%s", query);
+    if(DB_ERROR(result)) {
+      printf("Query \"%s\" failed: %s\n", query,
+             db_get_result_message(result));
+      db_free(&handle);
+      return;
+    }
+
+    matching = 0;
+    while(db_processing(&handle)) {
+      result = db_process(&handle);
+      if(result == DB_GOT_ROW) {
+        matching++;
+      } else if(result != DB_OK) {
+        if(DB_ERROR(result)) {
+          printf("Processing error: %s\n", db_get_result_message(result));
+        }
+        break;
+      }
+    }
+    db_free(&handle);
+  }
+  elapsed = clock_time() - start;
+
+  printf("%s\n  %lu tuples returned, %lu rows/s%s\n", query,
+         (unsigned long)matching,
+         (unsigned long)((unsigned long long)TUPLE_COUNT * ROUNDS *
+                         CLOCK_SECOND / (elapsed ? elapsed : 1)),
+         matching == expected ? "" : " (wrong result)");
+}
+
+PROCESS_THREAD(antelope_benchmark, ev, data)
+{
+  static unsigned i;
+
+  PROCESS_BEGIN();
+
+  printf("Creating a relation with %u tuples\n", TUPLE_COUNT);
+  if(!create_relation()) {
+    PROCESS_EXIT();
+  }
+
+  printf("Compiled conditions: %s\n", DB_FEATURE_COMPILED_LVM ? "yes" : "no");
+  for(i = 0; i < sizeof(selections) / sizeof(selections[0]); i++) {
+    run_selection(selections[i].query, selections[i].expected);
+    PROCESS_PAUSE();
+  }
+
+  PROCESS_END();
+}
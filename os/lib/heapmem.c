@@ -180,6 +180,31 @@ static size_t max_heap_usage;
 
 static chunk_t *free_list;
 
+#if HEAPMEM_WITH_SIZE_CLASSES
+/*
+ * Free chunks of small sizes are kept in segregated lists instead of
+ * the general free list. A chunk of size s belongs to class
+ * s / HEAPMEM_ALIGNMENT - 1, so every chunk in a class can hold an
+ * aligned allocation of the class size.
+ */
+#define SIZE_CLASS(size) ((size) / HEAPMEM_ALIGNMENT - 1)
+#define IS_SMALL(size) ((size) >= HEAPMEM_ALIGNMENT && \
+                        SIZE_CLASS(size) < HEAPMEM_SIZE_CLASSES)
+
+static chunk_t *class_free_list[HEAPMEM_SIZE_CLASSES];
+static size_t class_hits[HEAPMEM_SIZE_CLASSES];
+static size_t class_misses[HEAPMEM_SIZE_CLASSES];
+
+/* free_list_for: Get the free list of chunks of a certain size. */
+static chunk_t **
+free_list_for(size_t size)
+{
+  return IS_SMALL(size) ? &class_free_list[SIZE_CLASS(size)] : &free_list;
+}
+#else
+#define free_list_for(size) (&free_list)
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
+
 #define IN_HEAP(ptr) ((ptr) != NULL && \
                      (char *)(ptr) >= (char *)heap_base) && \
                      ((char *)(ptr) < (char *)heap_base + heap_usage)
@@ -202,6 +227,21 @@ extend_space(size_t size)
   return old_usage;
 }
 
+/* add_chunk_to_free_list: Put a free chunk on the free list that
+   matches its size. */
+static void
+add_chunk_to_free_list(chunk_t * const chunk)
+{
+  chunk_t **list = free_list_for(chunk->size);
+
+  chunk->prev = NULL;
+  chunk->next = *list;
+  if(*list != NULL) {
+    (*list)->prev = chunk;
+  }
+  *list = chunk;
+}
+
 /* free_chunk: Mark a chunk as being free, and put it on the free list. */
 static void
 free_chunk(chunk_t * const chunk)
@@ -212,13 +252,7 @@ free_chunk(chunk_t * const chunk)
     /* Release the chunk back into the wilderness. */
     heap_usage -= sizeof(chunk_t) + chunk->size;
   } else {
-    /* Put the chunk on the free list. */
-    chunk->prev = NULL;
-    chunk->next = free_list;
-    if(free_list != NULL) {
-      free_list->prev = chunk;
-    }
-    free_list = chunk;
+    add_chunk_to_free_list(chunk);
   }
 }
 
@@ -227,10 +261,12 @@ free_chunk(chunk_t * const chunk)
 static void
 remove_chunk_from_free_list(chunk_t * const chunk)
 {
-  if(chunk == free_list) {
-    free_list = chunk->next;
-    if(free_list != NULL) {
-      free_list->prev = NULL;
+  chunk_t **list = free_list_for(chunk->size);
+
+  if(chunk == *list) {
+    *list = chunk->next;
+    if(*list != NULL) {
+      (*list)->prev = NULL;
     }
   } else {
     chunk->prev->next = chunk->next;
@@ -291,14 +327,11 @@ defrag_chunks(void)
   }
 }
 
-/* get_free_chunk: Search the free list for the most suitable chunk,
-   as determined by its size, to satisfy an allocation request. */
+/* find_best_chunk: Search the free list for the smallest chunk that
+   can hold the requested size. */
 static chunk_t *
-get_free_chunk(const size_t size)
+find_best_chunk(const size_t size)
 {
-  /* Defragment chunks only right before they are needed for allocation. */
-  defrag_chunks();
-
   chunk_t *best = NULL;
   /* Limit the time we spend on searching the free list. */
   int i = CHUNK_SEARCH_MAX;
@@ -320,6 +353,32 @@ get_free_chunk(const size_t size)
     }
   }
 
+  return best;
+}
+
+/* get_free_chunk: Search the free list for the most suitable chunk,
+   as determined by its size, to satisfy an allocation request. */
+static chunk_t *
+get_free_chunk(const size_t size)
+{
+#if HEAPMEM_WITH_SIZE_CLASSES
+  if(IS_SMALL(size)) {
+    /* Any chunk in the class of the requested size fits, and it is too
+       small to be split. */
+    chunk_t *chunk = class_free_list[SIZE_CLASS(size)];
+    if(chunk != NULL) {
+      class_hits[SIZE_CLASS(size)]++;
+      remove_chunk_from_free_list(chunk);
+      return chunk;
+    }
+    class_misses[SIZE_CLASS(size)]++;
+  }
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
+
+  /* Defragment chunks only right before they are needed for allocation. */
+  defrag_chunks();
+
+  chunk_t *best = find_best_chunk(size);
   if(best != NULL) {
     /* We found a chunk that can hold an object of the requested
        allocation size. Split it if possible. */
@@ -330,6 +389,36 @@ get_free_chunk(const size_t size)
   return best;
 }
 
+#if HEAPMEM_WITH_SIZE_CLASSES
+/* get_coalesced_chunk: Walk through the whole heap and coalesce every
+   free chunk with its free neighbors, regardless of their free lists,
+   and then search the free list again. Freed small chunks stay in
+   their size classes, where defrag_chunks() never reaches them, so
+   this is the last resort when the heap cannot be extended. */
+static chunk_t *
+get_coalesced_chunk(const size_t size)
+{
+  for(chunk_t *chunk = (chunk_t *)heap_base;
+      (char *)chunk < &heap_base[heap_usage];
+      chunk = NEXT_CHUNK(chunk)) {
+    if(CHUNK_FREE(chunk)) {
+      /* The coalesced chunk may belong to another free list. */
+      remove_chunk_from_free_list(chunk);
+      coalesce_chunks(chunk);
+      add_chunk_to_free_list(chunk);
+    }
+  }
+
+  chunk_t *best = find_best_chunk(size);
+  if(best != NULL) {
+    remove_chunk_from_free_list(best);
+    split_chunk(best, size);
+  }
+
+  return best;
+}
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
+
 /*
  * heapmem_zone_register: Register a new zone, which is essentially a
  * subdivision of the heap with a reserved allocation space. This
@@ -380,7 +469,9 @@ heapmem_zone_register(const char *name, size_t zone_size)
  * free list will be examined.
  *
  * As a last resort, heapmem_alloc() will try to extend the heap
- * space, and thereby create a new chunk available for use.
+ * space, and thereby create a new chunk available for use. With size
+ * classes, all free chunks are coalesced and searched once more if
+ * the heap cannot be extended.
  */
 void *
 #if HEAPMEM_DEBUG
@@ -410,10 +501,16 @@ heapmem_zone_alloc(heapmem_zone_t zone, size_t size)
   chunk_t *chunk = get_free_chunk(size);
   if(chunk == NULL) {
     chunk = extend_space(sizeof(chunk_t) + size);
-    if(chunk == NULL) {
-      return NULL;
+    if(chunk != NULL) {
+      chunk->size = size;
+    } else {
+#if HEAPMEM_WITH_SIZE_CLASSES
+      chunk = get_coalesced_chunk(size);
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
+      if(chunk == NULL) {
+        return NULL;
+      }
     }
-    chunk->size = size;
   }
 
   chunk->flags = CHUNK_FLAG_ALLOCATED;
@@ -627,14 +724,40 @@ heapmem_stats(heapmem_stats_t *stats)
       stats->allocated += chunk->size;
       stats->overhead += sizeof(chunk_t);
     } else {
+#if HEAPMEM_WITH_SIZE_CLASSES
+      /* The coalesced chunk may belong to another free list. */
+      remove_chunk_from_free_list(chunk);
+      coalesce_chunks(chunk);
+      add_chunk_to_free_list(chunk);
+#else
       coalesce_chunks(chunk);
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
       stats->available += chunk->size;
+      stats->free_chunks++;
+      if(chunk->size > stats->largest_free) {
+        stats->largest_free = chunk->size;
+      }
     }
   }
   stats->available += HEAPMEM_ARENA_SIZE - heap_usage;
   stats->footprint = heap_usage;
   stats->max_footprint = max_heap_usage;
   stats->chunks = stats->overhead / sizeof(chunk_t);
+
+  if(HEAPMEM_ARENA_SIZE - heap_usage > sizeof(chunk_t) &&
+     HEAPMEM_ARENA_SIZE - heap_usage - sizeof(chunk_t) > stats->largest_free) {
+    stats->largest_free = HEAPMEM_ARENA_SIZE - heap_usage - sizeof(chunk_t);
+  }
+  if(stats->available > 0) {
+    stats->fragmentation = 100 -
+      (unsigned)((100 * (uint64_t)stats->largest_free + stats->available / 2) /
+                 stats->available);
+  }
+
+#if HEAPMEM_WITH_SIZE_CLASSES
+  memcpy(stats->class_hits, class_hits, sizeof(class_hits));
+  memcpy(stats->class_misses, class_misses, sizeof(class_misses));
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
 }
 
 /* heapmem_print_stats: Print all the statistics collected through the
@@ -653,6 +776,18 @@ heapmem_print_debug_info(bool print_chunks)
   HEAPMEM_PRINTF("* Allocated chunks: %zu\n", stats.chunks);
   HEAPMEM_PRINTF("* Chunk size: %zu\n", sizeof(chunk_t));
   HEAPMEM_PRINTF("* Total chunk overhead: %zu\n", stats.overhead);
+  HEAPMEM_PRINTF("* Free chunks: %zu\n", stats.free_chunks);
+  HEAPMEM_PRINTF("* Largest free block: %zu\n", stats.largest_free);
+  HEAPMEM_PRINTF("* Fragmentation: %u%%\n", stats.fragmentation);
+#if HEAPMEM_WITH_SIZE_CLASSES
+  for(int i = 0; i < HEAPMEM_SIZE_CLASSES; i++) {
+    if(stats.class_hits[i] > 0 || stats.class_misses[i] > 0) {
+      HEAPMEM_PRINTF("* Size class %zu: %zu hits, %zu misses\n",
+                     (i + 1) * (size_t)HEAPMEM_ALIGNMENT,
+                     stats.class_hits[i], stats.class_misses[i]);
+    }
+  }
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
 
   if(print_chunks) {
     HEAPMEM_PRINTF("* Allocated chunks:\n");
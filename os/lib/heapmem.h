@@ -83,6 +83,29 @@
 #ifndef HEAPMEM_DEBUG
 #define HEAPMEM_DEBUG 0
 #endif
+
+/*
+ * The HEAPMEM_CONF_WITH_SIZE_CLASSES parameter enables segregated free
+ * lists for small chunks. Each size class holds free chunks of one
+ * aligned size, so that small allocations of a previously freed size
+ * take constant time. Larger allocations, and small ones that miss
+ * their class, use the regular best-fit search. If that search fails
+ * for a large allocation, all free chunks in the heap are coalesced,
+ * including those in the size classes, before the heap is extended.
+ */
+#ifdef HEAPMEM_CONF_WITH_SIZE_CLASSES
+#define HEAPMEM_WITH_SIZE_CLASSES HEAPMEM_CONF_WITH_SIZE_CLASSES
+#else
+#define HEAPMEM_WITH_SIZE_CLASSES 0
+#endif
+
+/* The number of size classes. Class i holds chunks of (i + 1) times
+   the heapmem alignment. */
+#ifdef HEAPMEM_CONF_SIZE_CLASSES
+#define HEAPMEM_SIZE_CLASSES HEAPMEM_CONF_SIZE_CLASSES
+#else
+#define HEAPMEM_SIZE_CLASSES 16
+#endif
 /*****************************************************************************/
 typedef struct heapmem_stats {
   size_t allocated;
@@ -91,6 +114,19 @@ typedef struct heapmem_stats {
   size_t footprint;
   size_t max_footprint;
   size_t chunks;
+  /* The number of free chunks within the footprint. */
+  size_t free_chunks;
+  /* The largest allocation that can be served, from a free chunk or
+     from the unused space after the footprint. */
+  size_t largest_free;
+  /* The share of the available memory, in percent, that is not part
+     of the largest free block. */
+  unsigned fragmentation;
+#if HEAPMEM_WITH_SIZE_CLASSES
+  /* Small allocations served from, and missing, each size class. */
+  size_t class_hits[HEAPMEM_SIZE_CLASSES];
+  size_t class_misses[HEAPMEM_SIZE_CLASSES];
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
 } heapmem_stats_t;
 /*****************************************************************************/
 typedef uint8_t heapmem_zone_t;
@@ -216,6 +252,10 @@ bool heapmem_free(void *ptr);
  * the amount of memory allocated, overhead used for memory management,
  * and the number of chunks allocated. By using this information, developers
  * can tune their software to use the heapmem allocator more efficiently.
+ *
+ * The fragmentation metrics are computed after coalescing adjacent
+ * free chunks. With HEAPMEM_CONF_WITH_SIZE_CLASSES, the statistics
+ * also include the number of allocations served from each size class.
  */
 void heapmem_stats(heapmem_stats_t *stats);
 
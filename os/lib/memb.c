@@ -53,8 +53,61 @@ memb_init(struct memb *m)
 {
   memset(m->used, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+#if MEMB_WITH_FREE_LIST
+  m->free_top = 0;
+  m->next_unused = 0;
+#endif /* MEMB_WITH_FREE_LIST */
 }
 /*---------------------------------------------------------------------------*/
+#if MEMB_WITH_FREE_LIST
+void *
+memb_alloc(struct memb *m)
+{
+  unsigned short i;
+
+  if(m->free_top > 0) {
+    /* Reuse the most recently freed block. */
+    i = m->free_list[--m->free_top];
+  } else if(m->next_unused < m->num) {
+    /* Take a block that has never been handed out. */
+    i = m->next_unused++;
+  } else {
+    /* No free block, so we return NULL to indicate failure to
+       allocate block. */
+    return NULL;
+  }
+
+  m->used[i] = true;
+  return (void *)((char *)m->mem + (i * m->size));
+}
+/*---------------------------------------------------------------------------*/
+int
+memb_free(struct memb *m, void *ptr)
+{
+  size_t offset;
+  unsigned short i;
+
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+
+  /* Compute the block index directly and reject pointers that do not
+     point to the beginning of a block. */
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  i = offset / m->size;
+
+  /* Check the allocation status to detect the double-free error. */
+  if(m->used[i] == false) {
+    return -1;
+  }
+  m->used[i] = false;
+  m->free_list[m->free_top++] = i;
+  return 0;
+}
+#else /* MEMB_WITH_FREE_LIST */
 void *
 memb_alloc(struct memb *m)
 {
@@ -96,6 +149,7 @@ memb_free(struct memb *m, void *ptr)
   }
   return -1;
 }
+#endif /* MEMB_WITH_FREE_LIST */
 /*---------------------------------------------------------------------------*/
 int
 memb_inmemb(struct memb *m, void *ptr)
@@ -107,6 +161,9 @@ memb_inmemb(struct memb *m, void *ptr)
 size_t
 memb_numfree(struct memb *m)
 {
+#if MEMB_WITH_FREE_LIST
+  return m->free_top + (m->num - m->next_unused);
+#else /* MEMB_WITH_FREE_LIST */
   int i;
   size_t num_free = 0;
 
@@ -117,5 +174,6 @@ memb_numfree(struct memb *m)
   }
 
   return num_free;
+#endif /* MEMB_WITH_FREE_LIST */
 }
 /** @} */
@@ -67,6 +67,21 @@
 #include <stdlib.h>
 #include "sys/cc.h"
 
+/**
+ * \brief Use O(1) free-list allocation for MEMB() pools.
+ *
+ * By default, memb_alloc() and memb_free() search the pool linearly.
+ * When this option is enabled, each pool keeps a stack of free block
+ * indices alongside its usage flags, so that allocation, deallocation
+ * and memb_numfree() run in constant time. The cost is one unsigned
+ * short per block plus two counters per pool.
+ */
+#ifdef MEMB_CONF_WITH_FREE_LIST
+#define MEMB_WITH_FREE_LIST MEMB_CONF_WITH_FREE_LIST
+#else
+#define MEMB_WITH_FREE_LIST 0
+#endif
+
 /**
  * Declare a memory block.
  *
@@ -88,18 +103,38 @@ MEMB(connections, struct connection, 16);
  * \param num The total number of memory chunks in the block.
  *
  */
+#if MEMB_WITH_FREE_LIST
+#define MEMB(name, structure, num) \
+        static bool CC_CONCAT(name,_memb_used)[num]; \
+        static unsigned short CC_CONCAT(name,_memb_free)[num]; \
+        static structure CC_CONCAT(name,_memb_mem)[num]; \
+        static struct memb name = {sizeof(structure), num, \
+                                          CC_CONCAT(name,_memb_used), \
+                                          (void *)CC_CONCAT(name,_memb_mem), \
+                                          CC_CONCAT(name,_memb_free), 0, 0}
+#else /* MEMB_WITH_FREE_LIST */
 #define MEMB(name, structure, num) \
         static bool CC_CONCAT(name,_memb_used)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_used), \
                                           (void *)CC_CONCAT(name,_memb_mem)}
+#endif /* MEMB_WITH_FREE_LIST */
 
 struct memb {
   unsigned short size;
   unsigned short num;
   bool *used;
   void *mem;
+#if MEMB_WITH_FREE_LIST
+  /* Stack of indices of blocks that have been freed. */
+  unsigned short *free_list;
+  /* Number of indices on the free_list stack. */
+  unsigned short free_top;
+  /* Blocks at this index and above have never been allocated. This
+     keeps a zero-initialized pool usable before memb_init(). */
+  unsigned short next_unused;
+#endif /* MEMB_WITH_FREE_LIST */
 };
 
 /**
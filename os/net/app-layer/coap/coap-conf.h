@@ -105,6 +105,15 @@
 #define COAP_OBSERVE_REFRESH_INTERVAL  20
 #endif /* COAP_OBSERVE_REFRESH_INTERVAL */
 
+/* Render a notification once for all observers of a resource and
+   patch only the per-observer header fields, instead of calling the
+   resource handler and allocating a transaction for each observer */
+#ifdef COAP_CONF_WITH_OBSERVE_FANOUT
+#define COAP_WITH_OBSERVE_FANOUT COAP_CONF_WITH_OBSERVE_FANOUT
+#else
+#define COAP_WITH_OBSERVE_FANOUT 0
+#endif
+
 /* Maximal length of observable URL */
 #ifdef COAP_CONF_OBSERVER_URL_LEN
 #define COAP_OBSERVER_URL_LEN COAP_CONF_OBSERVER_URL_LEN
@@ -112,6 +121,21 @@
 #define COAP_OBSERVER_URL_LEN 20
 #endif
 
+/* Look up resources in a hash table of URI paths instead of scanning
+   the resource list, and keep the resource list sorted by URI path */
+#ifdef COAP_CONF_WITH_RESOURCE_HASH
+#define COAP_WITH_RESOURCE_HASH COAP_CONF_WITH_RESOURCE_HASH
+#else
+#define COAP_WITH_RESOURCE_HASH 0
+#endif
+
+/* Number of buckets in the resource hash table */
+#ifdef COAP_CONF_RESOURCE_HASH_SIZE
+#define COAP_RESOURCE_HASH_SIZE COAP_CONF_RESOURCE_HASH_SIZE
+#else
+#define COAP_RESOURCE_HASH_SIZE 16
+#endif
+
 /* Enable the well-known resource (well-known/core) by default */
 #ifndef COAP_WELL_KNOWN_RESOURCE_ENABLED
 #define COAP_WELL_KNOWN_RESOURCE_ENABLED  1
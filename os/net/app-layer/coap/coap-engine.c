@@ -72,6 +72,16 @@ LIST(coap_handlers);
 LIST(coap_resource_services);
 static uint8_t is_initialized = 0;
 
+#if COAP_WITH_RESOURCE_HASH
+/* Resources hashed by URI path, chained through hash_next */
+static coap_resource_t *resource_hash[COAP_RESOURCE_HASH_SIZE];
+
+/* FNV-1a, so that the hash of each parent path of a URI path is
+   available while hashing the full path */
+#define URL_HASH_INIT 2166136261UL
+#define URL_HASH_STEP(h, c) (((h) ^ (uint8_t)(c)) * 16777619UL)
+#endif /* COAP_WITH_RESOURCE_HASH */
+
 /*---------------------------------------------------------------------------*/
 /*- CoAP service handlers---------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -390,6 +400,62 @@ coap_engine_init(void)
   coap_init_connection();
 }
 /*---------------------------------------------------------------------------*/
+#if COAP_WITH_RESOURCE_HASH
+static uint32_t
+url_hash(const char *url, int url_len)
+{
+  uint32_t hash = URL_HASH_INIT;
+  int i;
+
+  for(i = 0; i < url_len; i++) {
+    hash = URL_HASH_STEP(hash, url[i]);
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_add(coap_resource_t *resource)
+{
+  coap_resource_t **bucket;
+
+  bucket = &resource_hash[url_hash(resource->url, strlen(resource->url))
+                          % COAP_RESOURCE_HASH_SIZE];
+  resource->hash_next = *bucket;
+  *bucket = resource;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(coap_resource_t *resource)
+{
+  coap_resource_t **r;
+
+  for(r = &resource_hash[url_hash(resource->url, strlen(resource->url))
+                         % COAP_RESOURCE_HASH_SIZE];
+      *r != NULL; r = &(*r)->hash_next) {
+    if(*r == resource) {
+      *r = resource->hash_next;
+      resource->hash_next = NULL;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static coap_resource_t *
+hash_lookup(const char *url, int url_len, uint32_t hash)
+{
+  coap_resource_t *resource;
+
+  for(resource = resource_hash[hash % COAP_RESOURCE_HASH_SIZE];
+      resource != NULL; resource = resource->hash_next) {
+    if(strncmp(resource->url, url, url_len) == 0
+       && resource->url[url_len] == '\0') {
+      return resource;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* COAP_WITH_RESOURCE_HASH */
 /**
  * \brief Makes a resource available under the given URI path
  *
@@ -401,8 +467,29 @@ void
 coap_activate_resource(coap_resource_t *resource, const char *path)
 {
   coap_periodic_resource_t *periodic;
+#if COAP_WITH_RESOURCE_HASH
+  coap_resource_t *prev;
+  coap_resource_t *r;
+
+  if(list_contains(coap_resource_services, resource)) {
+    hash_remove(resource);
+    list_remove(coap_resource_services, resource);
+  }
+  resource->url = path;
+
+  /* Keep the list sorted, so that .well-known/core lists resources
+     in order of URI path */
+  prev = NULL;
+  for(r = list_head(coap_resource_services);
+      r != NULL && strcmp(r->url, path) < 0; r = r->next) {
+    prev = r;
+  }
+  list_insert(coap_resource_services, prev, resource);
+  hash_add(resource);
+#else /* COAP_WITH_RESOURCE_HASH */
   resource->url = path;
   list_add(coap_resource_services, resource);
+#endif /* COAP_WITH_RESOURCE_HASH */
 
   LOG_INFO("Activating: %s\n", resource->url);
 
@@ -434,19 +521,31 @@ coap_get_next_resource(coap_resource_t *resource)
   return list_item_next(resource);
 }
 /*---------------------------------------------------------------------------*/
-static int
-invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
-                             uint8_t *buffer, uint16_t buffer_size,
-                             int32_t *offset)
+coap_resource_t *
+coap_find_resource(const char *url, int url_len)
 {
-  uint8_t found = 0;
-  uint8_t allowed = 1;
-
-  coap_resource_t *resource = NULL;
-  const char *url = NULL;
-  int url_len, res_url_len;
+  coap_resource_t *resource;
+#if COAP_WITH_RESOURCE_HASH
+  coap_resource_t *parent = NULL;
+  uint32_t hash = URL_HASH_INIT;
+  int i;
+
+  /* Hash the URI path once, and look up each parent path on the way
+     for a resource with sub-resources */
+  for(i = 0; i < url_len; i++) {
+    if(url[i] == '/') {
+      resource = hash_lookup(url, i, hash);
+      if(resource != NULL && (resource->flags & HAS_SUB_RESOURCES)) {
+        parent = resource;
+      }
+    }
+    hash = URL_HASH_STEP(hash, url[i]);
+  }
+  resource = hash_lookup(url, url_len, hash);
+  return resource != NULL ? resource : parent;
+#else /* COAP_WITH_RESOURCE_HASH */
+  int res_url_len;
 
-  url_len = coap_get_header_uri_path(request, &url);
   for(resource = list_head(coap_resource_services);
       resource; resource = resource->next) {
 
@@ -457,31 +556,51 @@ invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
             && (resource->flags & HAS_SUB_RESOURCES)
             && url[res_url_len] == '/'))
        && strncmp(resource->url, url, res_url_len) == 0) {
-      coap_resource_flags_t method = coap_get_method_type(request);
-      found = 1;
-
-      LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
-               (uint16_t)method, resource->flags);
-
-      if((method & METHOD_GET) && resource->get_handler != NULL) {
-        /* call handler function */
-        resource->get_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_POST) && resource->post_handler != NULL) {
-        /* call handler function */
-        resource->post_handler(request, response, buffer, buffer_size,
+      return resource;
+    }
+  }
+  return NULL;
+#endif /* COAP_WITH_RESOURCE_HASH */
+}
+/*---------------------------------------------------------------------------*/
+static int
+invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
+                             uint8_t *buffer, uint16_t buffer_size,
+                             int32_t *offset)
+{
+  uint8_t found = 0;
+  uint8_t allowed = 1;
+
+  coap_resource_t *resource = NULL;
+  const char *url = NULL;
+  int url_len;
+
+  url_len = coap_get_header_uri_path(request, &url);
+  resource = coap_find_resource(url, url_len);
+  if(resource != NULL) {
+    coap_resource_flags_t method = coap_get_method_type(request);
+    found = 1;
+
+    LOG_INFO("/%s, method %u, resource->flags %u\n", resource->url,
+             (uint16_t)method, resource->flags);
+
+    if((method & METHOD_GET) && resource->get_handler != NULL) {
+      /* call handler function */
+      resource->get_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_POST) && resource->post_handler != NULL) {
+      /* call handler function */
+      resource->post_handler(request, response, buffer, buffer_size,
+                             offset);
+    } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
+      /* call handler function */
+      resource->put_handler(request, response, buffer, buffer_size, offset);
+    } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
+      /* call handler function */
+      resource->delete_handler(request, response, buffer, buffer_size,
                                offset);
-      } else if((method & METHOD_PUT) && resource->put_handler != NULL) {
-        /* call handler function */
-        resource->put_handler(request, response, buffer, buffer_size, offset);
-      } else if((method & METHOD_DELETE) && resource->delete_handler != NULL) {
-        /* call handler function */
-        resource->delete_handler(request, response, buffer, buffer_size,
-                                 offset);
-      } else {
-        allowed = 0;
-        coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
-      }
-      break;
+    } else {
+      allowed = 0;
+      coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
     }
   }
   if(!found) {
@@ -111,6 +111,12 @@ struct coap_resource_s {
     coap_resource_trigger_handler_t trigger;
     coap_resource_trigger_handler_t resume;
   };
+#if COAP_WITH_RESOURCE_HASH
+  coap_resource_t *hash_next;             /* next in the hash bucket */
+#endif /* COAP_WITH_RESOURCE_HASH */
+#if COAP_WITH_OBSERVE_FANOUT
+  struct coap_observer *observers;        /* observers of the resource */
+#endif /* COAP_WITH_OBSERVE_FANOUT */
 };
 
 struct coap_periodic_resource_s {
@@ -167,6 +173,20 @@ coap_resource_t *coap_get_first_resource(void);
  */
 coap_resource_t *coap_get_next_resource(coap_resource_t *resource);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief      Finds the resource that serves a URI path.
+ * \param url  The URI path, without leading slash.
+ * \param url_len The length of the URI path.
+ * \return     The resource with the URI path, else a resource with
+ *             sub-resources whose URI path is a parent path of it,
+ *             or NULL if no resource serves the URI path.
+ *
+ *             With COAP_WITH_RESOURCE_HASH, the resource with the
+ *             longest parent path is returned, and the lookup takes
+ *             time proportional to the length of the URI path.
+ */
+coap_resource_t *coap_find_resource(const char *url, int url_len);
+/*---------------------------------------------------------------------------*/
 
 #include "coap-transactions.h"
 #include "coap-observe.h"
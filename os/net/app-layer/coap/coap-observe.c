@@ -56,11 +56,23 @@
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
+
+#if COAP_WITH_OBSERVE_FANOUT
+/* The representation of the resource, rendered once per notification */
+static uint8_t notification_payload[COAP_MAX_CHUNK_SIZE];
+/* The serialized notification, patched for each observer */
+static uint8_t notification_buffer[COAP_MAX_PACKET_SIZE + 1];
+static uint16_t notification_len;
+/* Offset and length of the value of the Observe option, if any */
+static int observe_offset;
+static uint8_t observe_len;
+#endif /* COAP_WITH_OBSERVE_FANOUT */
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 static coap_observer_t *
-add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
+add_observer(const coap_resource_t *resource,
+             const coap_endpoint_t *endpoint, const uint8_t *token,
              size_t token_len, const char *uri, int uri_len)
 {
   /* Remove existing observe relationship, if any. */
@@ -75,6 +87,10 @@ add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
     }
     memcpy(o->url, uri, max);
     o->url[max] = 0;
+#if COAP_WITH_OBSERVE_FANOUT
+    /* Only the handler API makes the resource const */
+    o->resource = (coap_resource_t *)resource;
+#endif /* COAP_WITH_OBSERVE_FANOUT */
     coap_endpoint_copy(&o->endpoint, endpoint);
     o->token_len = token_len;
     memcpy(o->token, token, token_len);
@@ -84,6 +100,17 @@ add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
              list_length(observers_list) + 1, COAP_MAX_OBSERVERS,
              o->url, o->token[0], o->token[1]);
     list_add(observers_list, o);
+#if COAP_WITH_OBSERVE_FANOUT
+    /* Keep the observers of the resource in the order of the list */
+    o->resource_next = NULL;
+    if(o->resource != NULL) {
+      coap_observer_t **tail = &o->resource->observers;
+      while(*tail != NULL) {
+        tail = &(*tail)->resource_next;
+      }
+      *tail = o;
+    }
+#endif /* COAP_WITH_OBSERVE_FANOUT */
   }
 
   return o;
@@ -97,6 +124,18 @@ coap_remove_observer(coap_observer_t *o)
   LOG_INFO("Removing observer for /%s [0x%02X%02X]\n", o->url, o->token[0],
            o->token[1]);
 
+#if COAP_WITH_OBSERVE_FANOUT
+  if(o->resource != NULL) {
+    for(coap_observer_t **p = &o->resource->observers; *p != NULL;
+        p = &(*p)->resource_next) {
+      if(*p == o) {
+        *p = o->resource_next;
+        break;
+      }
+    }
+  }
+#endif /* COAP_WITH_OBSERVE_FANOUT */
+
   memb_free(&observers_memb, o);
   list_remove(observers_list, o);
 }
@@ -180,6 +219,229 @@ coap_remove_observer_by_mid(const coap_endpoint_t *endpoint, uint16_t mid)
 /*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+static int
+observer_matches_url(const coap_observer_t *obs, const char *url,
+                     int url_len, uint8_t sub_ok)
+{
+  int obs_url_len = strlen(obs->url);
+
+  /* Do a match based on the parent/sub-resource match so that it is
+     possible to do parent-node observe */
+  return (obs_url_len == url_len
+          || (obs_url_len > url_len
+              && sub_ok
+              && obs->url[url_len] == '/'))
+    && strncmp(url, obs->url, url_len) == 0;
+}
+/*---------------------------------------------------------------------------*/
+#if COAP_WITH_OBSERVE_FANOUT
+static uint8_t
+int_option_len(uint32_t value)
+{
+  return value > 0xFFFFFF ? 4 : value > 0xFFFF ? 3 : value > 0xFF ? 2 :
+    value > 0 ? 1 : 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the offset of the value of the Observe option in a serialized
+   message, or -1 if the message has no Observe option */
+static int
+find_observe_value(const uint8_t *message, uint16_t len)
+{
+  const uint8_t *p = message + COAP_HEADER_LEN
+    + (message[0] & COAP_HEADER_TOKEN_LEN_MASK);
+  const uint8_t *end = message + len;
+  unsigned number = 0;
+  unsigned delta, length;
+
+  while(p < end && *p != 0xFF) {
+    delta = *p >> 4;
+    length = *p & 0x0F;
+    p++;
+    if(delta == 13) {
+      delta = 13 + *p++;
+    } else if(delta == 14) {
+      delta = 269 + ((p[0] << 8) | p[1]);
+      p += 2;
+    }
+    if(length == 13) {
+      length = 13 + *p++;
+    } else if(length == 14) {
+      length = 269 + ((p[0] << 8) | p[1]);
+      p += 2;
+    }
+    number += delta;
+    if(number == COAP_OPTION_OBSERVE) {
+      return p - message;
+    } else if(number > COAP_OPTION_OBSERVE) {
+      break;
+    }
+    p += length;
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+serialize_notification(coap_message_t *notification)
+{
+  notification_len = coap_serialize_message(notification,
+                                            notification_buffer);
+  observe_offset = -1;
+  if(notification_len > 0
+     && coap_is_option(notification, COAP_OPTION_OBSERVE)) {
+    observe_offset = find_observe_value(notification_buffer,
+                                        notification_len);
+    observe_len = int_option_len(notification->observe);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Turns the serialized notification into the one for an observer. As
+   long as the token and the Observe value have the same lengths as in
+   the serialized notification, only their bytes and the header are
+   patched. */
+static void
+prepare_notification(coap_message_t *notification, coap_observer_t *obs,
+                     coap_message_type_t type, uint16_t mid)
+{
+  uint32_t observe = obs->obs_counter;
+  int i;
+
+  if(notification->code < BAD_REQUEST_4_00) {
+    coap_set_header_observe(notification, observe);
+  }
+  coap_set_token(notification, obs->token, obs->token_len);
+  notification->type = type;
+  notification->mid = mid;
+
+  if(notification_len == 0
+     || (notification_buffer[0] & COAP_HEADER_TOKEN_LEN_MASK)
+     != obs->token_len
+     || (observe_offset >= 0 && int_option_len(observe) != observe_len)) {
+    serialize_notification(notification);
+    return;
+  }
+
+  notification_buffer[0] &= ~COAP_HEADER_TYPE_MASK;
+  notification_buffer[0] |= COAP_HEADER_TYPE_MASK
+    & (type << COAP_HEADER_TYPE_POSITION);
+  notification_buffer[2] = (uint8_t)(mid >> 8);
+  notification_buffer[3] = (uint8_t)mid;
+  memcpy(&notification_buffer[COAP_HEADER_LEN], obs->token, obs->token_len);
+  if(observe_offset >= 0) {
+    for(i = observe_len - 1; i >= 0; i--) {
+      notification_buffer[observe_offset + i] = (uint8_t)observe;
+      observe >>= 8;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+render_notification(coap_resource_t *resource, const char *url,
+                    coap_message_t *notification)
+{
+  coap_message_t request[1]; /* this way the message can be treated as pointer as usual */
+  int32_t new_offset = 0;
+
+  coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+  /* create a "fake" request for the URI */
+  coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+  coap_set_header_uri_path(request, url);
+
+  /* Either old style get_handler or the full handler */
+  if(coap_call_handlers(request, notification, notification_payload,
+                        COAP_MAX_CHUNK_SIZE, &new_offset) > 0) {
+    LOG_DBG("Notification on new handlers\n");
+  } else if(resource != NULL) {
+    resource->get_handler(request, notification, notification_payload,
+                          COAP_MAX_CHUNK_SIZE, &new_offset);
+  } else {
+    notification->code = BAD_REQUEST_4_00;
+  }
+
+  if(new_offset != 0) {
+    coap_set_header_block2(notification, 0, new_offset != -1,
+                           COAP_MAX_BLOCK_SIZE);
+    coap_set_payload(notification, notification->payload,
+                     MIN(notification->payload_len, COAP_MAX_BLOCK_SIZE));
+  }
+
+  /* Serialize for the first observer */
+  notification_len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+notify_observers_once(coap_resource_t *resource, const char *subpath,
+                      const char *url)
+{
+  coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
+  coap_observer_t *obs = NULL;
+  coap_transaction_t *transaction;
+  coap_message_type_t type;
+  uint8_t rendered = 0;
+  uint8_t by_resource;
+  uint8_t sub_ok;
+  uint16_t mid;
+  int url_len;
+
+  url_len = strlen(url);
+  sub_ok = (resource == NULL) || (resource->flags & HAS_SUB_RESOURCES);
+  /* The observers of a resource are kept by the resource itself, and
+     only a notification for a sub-resource needs to match the URLs */
+  by_resource = resource != NULL && subpath == NULL;
+  for(obs = by_resource ? resource->observers :
+        (coap_observer_t *)list_head(observers_list); obs;
+      obs = by_resource ? obs->resource_next : obs->next) {
+    if(!by_resource && !observer_matches_url(obs, url, url_len, sub_ok)) {
+      continue;
+    }
+
+    if(!rendered) {
+      render_notification(resource, url, notification);
+      rendered = 1;
+    }
+
+    /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
+    type = COAP_TYPE_NON;
+    if(COAP_OBSERVE_REFRESH_INTERVAL != 0
+       && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
+      LOG_DBG("           Force Confirmable for\n");
+      type = COAP_TYPE_CON;
+    }
+
+    /* Only a CON notification needs a transaction for retransmissions */
+    mid = coap_get_mid();
+    transaction = NULL;
+    if(type == COAP_TYPE_CON
+       && (transaction = coap_new_transaction(mid, &obs->endpoint)) == NULL) {
+      continue;
+    }
+
+    LOG_DBG("           Observer ");
+    LOG_DBG_COAP_EP(&obs->endpoint);
+    LOG_DBG_("\n");
+
+    /* update last MID for RST matching */
+    obs->last_mid = mid;
+
+    prepare_notification(notification, obs, type, mid);
+    if(notification->code < BAD_REQUEST_4_00) {
+      (obs->obs_counter)++;
+      /* mask out to keep the CoAP observe option length <= 3 bytes */
+      obs->obs_counter &= 0xffffff;
+    }
+
+    if(notification_len == 0) {
+      coap_clear_transaction(transaction);
+    } else if(transaction != NULL) {
+      memcpy(transaction->message, notification_buffer, notification_len);
+      transaction->message_len = notification_len;
+      coap_send_transaction(transaction);
+    } else {
+      coap_sendto(&obs->endpoint, notification_buffer, notification_len);
+    }
+  }
+}
+#endif /* COAP_WITH_OBSERVE_FANOUT */
+/*---------------------------------------------------------------------------*/
 void
 coap_notify_observers(coap_resource_t *resource)
 {
@@ -190,13 +452,15 @@ coap_notify_observers(coap_resource_t *resource)
 void
 coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
 {
+#if !COAP_WITH_OBSERVE_FANOUT
   /* build notification */
   coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
   coap_message_t request[1]; /* this way the message can be treated as pointer as usual */
   coap_observer_t *obs = NULL;
-  int url_len, obs_url_len;
-  char url[COAP_OBSERVER_URL_LEN];
   uint8_t sub_ok = 0;
+#endif /* !COAP_WITH_OBSERVE_FANOUT */
+  int url_len;
+  char url[COAP_OBSERVER_URL_LEN];
 
   if(resource != NULL) {
     url_len = strlen(resource->url);
@@ -216,6 +480,10 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   /* url now contains the notify URL that needs to match the observer */
   LOG_INFO("Notification from %s\n", url);
 
+#if COAP_WITH_OBSERVE_FANOUT
+  notify_observers_once(resource, subpath, url);
+#else /* COAP_WITH_OBSERVE_FANOUT */
+
   coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
   /* create a "fake" request for the URI */
   coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
@@ -227,18 +495,9 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   sub_ok = (resource == NULL) || (resource->flags & HAS_SUB_RESOURCES);
   for(obs = (coap_observer_t *)list_head(observers_list); obs;
       obs = obs->next) {
-    obs_url_len = strlen(obs->url);
-
-    /* Do a match based on the parent/sub-resource match so that it is
-       possible to do parent-node observe */
-
     /***** TODO fix here so that we handle the notofication correctly ******/
     /* All the new-style ... is assuming that the URL might be within */
-    if((obs_url_len == url_len
-        || (obs_url_len > url_len
-            && sub_ok
-            && obs->url[url_len] == '/'))
-       && strncmp(url, obs->url, url_len) == 0) {
+    if(observer_matches_url(obs, url, url_len, sub_ok)) {
       coap_transaction_t *transaction = NULL;
 
       /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
@@ -304,6 +563,7 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
       }
     }
   }
+#endif /* COAP_WITH_OBSERVE_FANOUT */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -321,7 +581,7 @@ coap_observe_handler(const coap_resource_t *resource, coap_message_t *coap_req,
       if(src_ep == NULL) {
         /* No source endpoint, can not add */
       } else if(coap_req->observe == 0) {
-        obs = add_observer(src_ep,
+        obs = add_observer(resource, src_ep,
                            coap_req->token, coap_req->token_len,
                            coap_req->uri_path, coap_req->uri_path_len);
         if(obs) {
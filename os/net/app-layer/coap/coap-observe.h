@@ -52,6 +52,10 @@ typedef struct coap_observer {
   struct coap_observer *next;   /* for LIST */
 
   char url[COAP_OBSERVER_URL_LEN];
+#if COAP_WITH_OBSERVE_FANOUT
+  coap_resource_t *resource; /* the resource that serves the URL */
+  struct coap_observer *resource_next; /* next observer of the resource */
+#endif /* COAP_WITH_OBSERVE_FANOUT */
   coap_endpoint_t endpoint;
   uint8_t token_len;
   uint8_t token[COAP_TOKEN_LEN];
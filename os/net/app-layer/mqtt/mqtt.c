@@ -166,6 +166,12 @@ typedef enum {
 #define RESPONSE_WAIT_TIMEOUT (CLOCK_SECOND * 10)
 /*---------------------------------------------------------------------------*/
 #define INCREMENT_MID(conn)   (conn)->mid_counter += 2
+#if MQTT_WITH_STREAMING
+/* Packets are written after the data that the socket has not sent yet */
+#define OUT_BUFFER_START(conn) (&(conn)->out_buffer[(conn)->socket.output_data_len])
+#else
+#define OUT_BUFFER_START(conn) ((conn)->out_buffer)
+#endif
 #define MQTT_STRING_LENGTH(s) (((s)->length) == 0 ? 0 : (MQTT_STRING_LEN_SIZE + (s)->length))
 /*---------------------------------------------------------------------------*/
 /* Protothread send macros */
@@ -304,8 +310,10 @@ disconnect_tcp(struct mqtt_connection *conn)
 static void
 send_out_buffer(struct mqtt_connection *conn)
 {
-  if(conn->out_buffer_ptr - conn->out_buffer == 0) {
-    conn->out_buffer_sent = 1;
+  uint8_t *start = OUT_BUFFER_START(conn);
+
+  if(conn->out_buffer_ptr - start == 0) {
+    conn->out_buffer_sent = tcp_socket_queuelen(&conn->socket) == 0;
     return;
   }
   conn->out_buffer_sent = 0;
@@ -313,8 +321,7 @@ send_out_buffer(struct mqtt_connection *conn)
   DBG("MQTT - (send_out_buffer) Space used in buffer: %i\n",
       conn->out_buffer_ptr - conn->out_buffer);
 
-  tcp_socket_send(&conn->socket, conn->out_buffer,
-                  conn->out_buffer_ptr - conn->out_buffer);
+  tcp_socket_send(&conn->socket, start, conn->out_buffer_ptr - start);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -832,6 +839,11 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
 {
   PT_BEGIN(pt);
 
+#if MQTT_WITH_STREAMING
+  /* Queue the publish behind the packets that are not sent yet */
+  conn->out_buffer_ptr = OUT_BUFFER_START(conn);
+#endif /* MQTT_WITH_STREAMING */
+
   DBG("MQTT - Sending publish message! topic %s topic_length %i\n",
       conn->out_packet.topic,
       conn->out_packet.topic_length);
@@ -891,11 +903,23 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
 #endif
 
   /* Write Payload */
-  PT_MQTT_WRITE_BYTES(conn,
-                      conn->out_packet.payload,
-                      conn->out_packet.payload_size);
+#if MQTT_WITH_STREAMING
+  if(conn->out_packet.frags != NULL) {
+    /* The socket sends the payload straight from the fragments */
+    send_out_buffer(conn);
+    tcp_socket_send_frags(&conn->socket, conn->out_packet.frags,
+                          conn->out_packet.frag_count);
+    /* The fragments belong to the app again once they have been sent */
+    PT_WAIT_UNTIL(pt, conn->out_buffer_sent);
+  } else
+#endif /* MQTT_WITH_STREAMING */
+  {
+    PT_MQTT_WRITE_BYTES(conn,
+                        conn->out_packet.payload,
+                        conn->out_packet.payload_size);
 
-  send_out_buffer(conn);
+    send_out_buffer(conn);
+  }
   timer_set(&conn->t, RESPONSE_WAIT_TIMEOUT);
 
   /*
@@ -1605,7 +1629,7 @@ tcp_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
   case TCP_SOCKET_DATA_SENT: {
     DBG("MQTT - Got TCP_DATA_SENT\n");
 
-    if(conn->socket.output_data_len == 0) {
+    if(tcp_socket_queuelen(&conn->socket) == 0) {
       conn->out_buffer_sent = 1;
       conn->out_buffer_ptr = conn->out_buffer;
     }
@@ -1717,7 +1741,8 @@ PROCESS_THREAD(mqtt_process, ev, data)
       conn = data;
       DBG("MQTT - Got mqtt_do_publish_mqtt_event!\n");
 
-      if(conn->out_buffer_sent == 1 &&
+      /* With streaming, publishes need not wait for earlier packets */
+      if((MQTT_WITH_STREAMING || conn->out_buffer_sent == 1) &&
          conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
         PT_INIT(&conn->out_proto_thread);
         while(conn->state == MQTT_CONN_STATE_CONNECTED_TO_BROKER &&
@@ -2022,6 +2047,10 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
 #endif
   conn->out_packet.payload = payload;
   conn->out_packet.payload_size = payload_size;
+#if MQTT_WITH_STREAMING
+  conn->out_packet.frags = NULL;
+  conn->out_packet.frag_count = 0;
+#endif /* MQTT_WITH_STREAMING */
   conn->out_packet.qos = qos_level;
   conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
 
@@ -2037,6 +2066,45 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
   return MQTT_STATUS_OK;
 }
 /*----------------------------------------------------------------------------*/
+#if MQTT_WITH_STREAMING
+mqtt_status_t
+mqtt_publish_frags(struct mqtt_connection *conn, uint16_t *mid, char *topic,
+                   const struct tcp_socket_frag *frags, int frag_count,
+                   mqtt_qos_level_t qos_level,
+#if MQTT_5
+                   mqtt_retain_t retain,
+                   uint8_t topic_alias, mqtt_topic_alias_en_t topic_alias_en,
+                   struct mqtt_prop_list *prop_list)
+#else
+                   mqtt_retain_t retain)
+#endif
+{
+  mqtt_status_t status;
+  uint32_t payload_size = 0;
+  int i;
+
+  if(frags == NULL || frag_count <= 0 || frag_count > UINT8_MAX) {
+    return MQTT_STATUS_INVALID_ARGS_ERROR;
+  }
+  for(i = 0; i < frag_count; i++) {
+    payload_size += frags[i].len;
+  }
+
+  /* The publish is not processed before the fragments are set */
+  status = mqtt_publish(conn, mid, topic, NULL, payload_size, qos_level,
+#if MQTT_5
+                        retain, topic_alias, topic_alias_en, prop_list);
+#else
+                        retain);
+#endif
+  if(status == MQTT_STATUS_OK && payload_size > 0) {
+    conn->out_packet.frags = frags;
+    conn->out_packet.frag_count = frag_count;
+  }
+  return status;
+}
+#endif /* MQTT_WITH_STREAMING */
+/*----------------------------------------------------------------------------*/
 void
 mqtt_set_username_password(struct mqtt_connection *conn, char *username,
                            char *password)
@@ -126,6 +126,21 @@
 #define MQTT_TCP_OUTPUT_BUFF_SIZE 512
 
 #define MQTT_INPUT_BUFF_SIZE 512
+
+/*
+ * Let QoS 0 publishes be queued back-to-back behind data that the TCP
+ * socket has not sent yet, and enable mqtt_publish_frags(), which
+ * sends the payload of a publish from application memory
+ */
+#ifdef MQTT_CONF_WITH_STREAMING
+#define MQTT_WITH_STREAMING MQTT_CONF_WITH_STREAMING
+#else
+#define MQTT_WITH_STREAMING 0
+#endif
+
+#if MQTT_WITH_STREAMING && !TCP_SOCKET_WITH_GATHER
+#error "MQTT_CONF_WITH_STREAMING requires TCP_SOCKET_CONF_WITH_GATHER"
+#endif
 #define MQTT_MAX_TOPIC_LENGTH 64
 #define MQTT_MAX_TOPICS_PER_SUBSCRIBE 1
 
@@ -475,6 +490,10 @@ struct mqtt_out_packet {
   uint16_t topic_length;
   uint8_t *payload;
   uint32_t payload_size;
+#if MQTT_WITH_STREAMING
+  const struct tcp_socket_frag *frags;
+  uint8_t frag_count;
+#endif /* MQTT_WITH_STREAMING */
   mqtt_qos_level_t qos;
   mqtt_qos_state_t qos_state;
   mqtt_retain_t retain;
@@ -713,6 +732,44 @@ mqtt_status_t mqtt_publish(struct mqtt_connection *conn,
 #else
                            mqtt_retain_t retain);
 #endif
+#if MQTT_WITH_STREAMING
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Publish to a MQTT topic from a list of payload fragments.
+ * \param conn A pointer to the MQTT connection.
+ * \param mid A pointer to message ID.
+ * \param topic A pointer to the topic to publish to.
+ * \param frags The payload fragments, in payload order.
+ * \param frag_count The number of payload fragments.
+ * \param qos_level Quality Of Service level to use. Currently supports 0, 1.
+ * \param retain The RETAIN flag, as for mqtt_publish().
+ * \param topic_alias Topic alias to send (MQTTv5-only).
+ * \param topic_alias_en Control whether or not to discard topic and only send
+ *        topic alias s(MQTTv5-only).
+ * \param prop_list Output properties (MQTTv5-only).
+ * \return MQTT_STATUS_OK or some error status
+ *
+ * Like mqtt_publish(), but the payload is not copied into the output
+ * buffer of the connection: it is sent by the TCP socket directly from
+ * the fragments, so it may be larger than the output buffer. The
+ * fragment list and the memory it points to must stay untouched until
+ * mqtt_ready() returns true again.
+ */
+mqtt_status_t mqtt_publish_frags(struct mqtt_connection *conn,
+                                 uint16_t *mid,
+                                 char *topic,
+                                 const struct tcp_socket_frag *frags,
+                                 int frag_count,
+                                 mqtt_qos_level_t qos_level,
+#if MQTT_5
+                                 mqtt_retain_t retain,
+                                 uint8_t topic_alias,
+                                 mqtt_topic_alias_en_t topic_alias_en,
+                                 struct mqtt_prop_list *prop_list);
+#else
+                                 mqtt_retain_t retain);
+#endif
+#endif /* MQTT_WITH_STREAMING */
 /*---------------------------------------------------------------------------*/
 /**
  * \brief Set the user name and password for a MQTT client.
@@ -68,6 +68,7 @@
 #include "net/ipv6/tcpip.h"
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-chksum.h"
 #include "net/ipv6/uipbuf.h"
 #include "net/ipv6/sicslowpan.h"
 #include "net/netstack.h"
@@ -94,6 +95,10 @@
 #define PACKETBUF_FRAG_DISPATCH_SIZE 0   /* 16 bit */
 #define PACKETBUF_FRAG_TAG           2   /* 16 bit */
 #define PACKETBUF_FRAG_OFFSET        4   /* 8 bit */
+#define PACKETBUF_RFRAG_TAG          1   /* 8 bit */
+#define PACKETBUF_RFRAG_SEQ_SIZE     2   /* 16 bit */
+#define PACKETBUF_RFRAG_OFFSET       4   /* 16 bit */
+#define PACKETBUF_RFRAG_ACK_BITMAP   2   /* 32 bit */
 
 /* define the buffer as a byte array */
 #define PACKETBUF_IPHC_BUF              ((uint8_t *)(packetbuf_ptr + packetbuf_hdr_len))
@@ -199,9 +204,48 @@ static int last_tx_status;
 /* Support for reassembling multiple packets                         */
 /* ----------------------------------------------------------------- */
 
+/* Forward the fragments of datagrams for other nodes as they arrive,
+ * through a virtual reassembly buffer (RFC 8930), instead of reassembling
+ * the datagrams first. Only the first fragment goes through the IPv6
+ * stack, which picks the next hop. The next fragments are switched to the
+ * same next hop, with a new tag. Datagrams that the stack does not route
+ * to a single next hop, such as datagrams for this node, multicast
+ * datagrams and datagrams routed with a source routing header, are
+ * reassembled. */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARDING
+#define SICSLOWPAN_FRAG_FORWARDING SICSLOWPAN_CONF_FRAG_FORWARDING
+#else
+#define SICSLOWPAN_FRAG_FORWARDING 0
+#endif
+
+#if SICSLOWPAN_FRAG_FORWARDING && !SICSLOWPAN_CONF_FRAG
+#error SICSLOWPAN_CONF_FRAG_FORWARDING requires SICSLOWPAN_CONF_FRAG
+#endif
+
+/* Selective fragment recovery (RFC 8931). Datagrams are sent with
+ * recoverable fragment (RFRAG) headers, and the receiver acknowledges
+ * the fragments that it has with a bitmap, so that only the missing
+ * fragments are sent again. The recovery is done on each link: every
+ * hop reassembles the datagram. */
+#ifdef SICSLOWPAN_CONF_FRAG_RECOVERY
+#define SICSLOWPAN_FRAG_RECOVERY SICSLOWPAN_CONF_FRAG_RECOVERY
+#else
+#define SICSLOWPAN_FRAG_RECOVERY 0
+#endif
+
+#if SICSLOWPAN_FRAG_RECOVERY && !SICSLOWPAN_CONF_FRAG
+#error SICSLOWPAN_CONF_FRAG_RECOVERY requires SICSLOWPAN_CONF_FRAG
+#endif
+
+#if SICSLOWPAN_FRAG_RECOVERY && SICSLOWPAN_FRAG_FORWARDING
+#error SICSLOWPAN_CONF_FRAG_RECOVERY and SICSLOWPAN_CONF_FRAG_FORWARDING cannot be combined
+#endif
+
 #if SICSLOWPAN_CONF_FRAG
 static uint16_t my_tag;
 
+static struct sicslowpan_frag_stats frag_stats;
+
 /** The total length of the IPv6 packet in the sicslowpan_buf. */
 
 /* This needs to be defined in NBR / Nodes depending on available RAM   */
@@ -251,6 +295,10 @@ struct sicslowpan_frag_info {
   uint16_t reassembled_len;
   /** Reassembly %process %timer. */
   struct timer reass_timer;
+#if SICSLOWPAN_FRAG_RECOVERY
+  /** The recoverable fragments received, by sequence number */
+  uint32_t received;
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
 
   /** Fragment size of first fragment */
   uint16_t first_frag_len;
@@ -273,6 +321,134 @@ struct sicslowpan_frag_buf {
 
 static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
 
+/* The number of fragment buffers in use */
+static uint16_t frag_bufs_used;
+
+#if SICSLOWPAN_FRAG_FORWARDING
+/* The number of datagrams that can be forwarded at the same time */
+#ifdef SICSLOWPAN_CONF_VRB_ENTRIES
+#define SICSLOWPAN_VRB_ENTRIES SICSLOWPAN_CONF_VRB_ENTRIES
+#else
+#define SICSLOWPAN_VRB_ENTRIES 4
+#endif
+
+/* A virtual reassembly buffer entry: the state of a datagram that is
+   forwarded fragment by fragment */
+struct sicslowpan_vrb {
+  /** The source address of the incoming fragments */
+  linkaddr_t sender;
+  /** The tag of the incoming fragments */
+  uint16_t tag;
+  /** Total length of the datagram (if zero this entry is not in use) */
+  uint16_t len;
+  /** Length of the datagram forwarded so far */
+  uint16_t forwarded_len;
+  /** The offsets of the forwarded fragments, one bit per 8 octets */
+  uint8_t forwarded_offsets[(UIP_BUFSIZE / 8 + 7) / 8];
+  /** The next hop of the outgoing fragments */
+  linkaddr_t next_hop;
+  /** The tag of the outgoing fragments */
+  uint16_t out_tag;
+#if LLSEC802154_USES_AUX_HEADER
+  uint8_t security_level;
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  uint8_t key_index;
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+  /** Lifetime of the entry */
+  struct timer timer;
+};
+
+static struct sicslowpan_vrb vrb[SICSLOWPAN_VRB_ENTRIES];
+
+/* The reassembly context of the first fragment that is passed to the IPv6
+   stack, or -1 */
+static int8_t vrb_context = -1;
+/* The entry created when the stack sent the first fragment */
+static struct sicslowpan_vrb *vrb_created;
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
+#if SICSLOWPAN_FRAG_RECOVERY
+/* The number of datagrams that can wait for an acknowledgment at the
+   same time */
+#ifdef SICSLOWPAN_CONF_RFRAG_CONTEXTS
+#define SICSLOWPAN_RFRAG_CONTEXTS SICSLOWPAN_CONF_RFRAG_CONTEXTS
+#else
+#define SICSLOWPAN_RFRAG_CONTEXTS 1
+#endif
+
+/* The time to wait for an acknowledgment */
+#ifdef SICSLOWPAN_CONF_RFRAG_ACK_TIMEOUT
+#define SICSLOWPAN_RFRAG_ACK_TIMEOUT SICSLOWPAN_CONF_RFRAG_ACK_TIMEOUT
+#else
+#define SICSLOWPAN_RFRAG_ACK_TIMEOUT (CLOCK_SECOND / 2)
+#endif
+
+/* The number of times that fragments are sent again, or an
+   acknowledgment is asked for again, before a datagram is given up */
+#ifdef SICSLOWPAN_CONF_RFRAG_MAX_RETRIES
+#define SICSLOWPAN_RFRAG_MAX_RETRIES SICSLOWPAN_CONF_RFRAG_MAX_RETRIES
+#else
+#define SICSLOWPAN_RFRAG_MAX_RETRIES 3
+#endif
+
+/* The sequence number of a fragment has 5 bits */
+#define SICSLOWPAN_RFRAG_MAX_FRAGMENTS 32
+#define SICSLOWPAN_RFRAG_BIT(seq)      (0x80000000UL >> (seq))
+#define SICSLOWPAN_RFRAG_BITMAP_FULL   0xffffffffUL
+#define SICSLOWPAN_RFRAG_BITMAP_NULL   0
+#define SICSLOWPAN_RFRAG_ACK_REQUEST   0x8000
+/* The room for the compressed headers of the first fragment */
+#define SICSLOWPAN_RFRAG_MAX_HDR_LEN   64
+/* The length of a datagram whose first fragment was not received */
+#define SICSLOWPAN_RFRAG_LEN_UNKNOWN   0xffff
+
+/* A datagram that waits for an acknowledgment */
+struct sicslowpan_rfrag_sender {
+  /** Length of the datagram (if zero this context is not in use) */
+  uint16_t len;
+  /** The uncompressed datagram */
+  uint8_t buf[UIP_BUFSIZE];
+  /** The compressed headers of the first fragment */
+  uint8_t hdr[SICSLOWPAN_RFRAG_MAX_HDR_LEN];
+  uint8_t hdr_len;
+  /** Length of the headers before the compression */
+  uint8_t uncomp_hdr_len;
+  /** Payload of the first fragment, and of the next fragments */
+  uint16_t frag0_payload;
+  uint16_t fragn_payload;
+  /** The number of fragments */
+  uint8_t count;
+  uint8_t tag;
+  /** The number of times that fragments were sent again */
+  uint8_t retries;
+  uint8_t max_transmissions;
+#if LLSEC802154_USES_AUX_HEADER
+  uint8_t security_level;
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  uint8_t key_index;
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+  linkaddr_t dest;
+  /** Acknowledgment timer */
+  struct ctimer timer;
+};
+
+static struct sicslowpan_rfrag_sender rfrag_senders[SICSLOWPAN_RFRAG_CONTEXTS];
+static uint8_t rfrag_next_sender;
+
+/* A datagram reassembled recently, which is acknowledged again if its
+   fragments are sent again after a lost acknowledgment */
+struct sicslowpan_rfrag_done {
+  linkaddr_t sender;
+  uint8_t tag;
+  struct timer timer;
+};
+
+static struct sicslowpan_rfrag_done rfrag_done[SICSLOWPAN_REASS_CONTEXTS];
+static uint8_t rfrag_next_done;
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
+
 /*---------------------------------------------------------------------------*/
 static int
 clear_fragments(uint8_t frag_info_index)
@@ -287,6 +463,7 @@ clear_fragments(uint8_t frag_info_index)
       clear_count++;
     }
   }
+  frag_bufs_used -= clear_count;
   return clear_count;
 }
 /*---------------------------------------------------------------------------*/
@@ -326,6 +503,9 @@ store_fragment(uint8_t index, uint8_t offset)
       frag_buf[i].len = len;
       frag_buf[i].index = index;
       memcpy(frag_buf[i].data, packetbuf_ptr + packetbuf_hdr_len, len);
+      if(++frag_bufs_used > frag_stats.max_buffers) {
+        frag_stats.max_buffers = frag_bufs_used;
+      }
       /* return the length of the stored fragment */
       return len;
     }
@@ -334,57 +514,79 @@ store_fragment(uint8_t index, uint8_t offset)
   return -1;
 }
 /*---------------------------------------------------------------------------*/
-/* add a new fragment to the buffer */
+/* allocate the context of a new fragmented packet */
 static int8_t
-add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
+new_context(uint16_t tag, uint16_t frag_size)
 {
   int i;
-  int len;
   int8_t found = -1;
 
-  if(offset == 0) {
-    /* This is a first fragment - check if we can add this */
-    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-      /* clear all fragment info with expired timer to free all fragment buffers */
-      if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
-        clear_fragments(i);
-      }
-
-      /* We use len as indication on used or not used */
-      if(found < 0 && frag_info[i].len == 0) {
-        /* We remember the first free fragment info but must continue
-           the loop to free any other expired fragment buffers. */
-        found = i;
-      }
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    /* clear all fragment info with expired timer to free all fragment buffers */
+    if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
+      clear_fragments(i);
     }
 
-    if(found < 0) {
-      LOG_WARN("reassembly: failed to store new fragment session - tag: %d\n", tag);
-      return -1;
+    /* We use len as indication on used or not used */
+    if(found < 0 && frag_info[i].len == 0) {
+      /* We remember the first free fragment info but must continue
+         the loop to free any other expired fragment buffers. */
+      found = i;
     }
+  }
 
-    /* Found a free fragment info to store data in */
-    frag_info[found].len = frag_size;
-    frag_info[found].tag = tag;
-    linkaddr_copy(&frag_info[found].sender,
-                  packetbuf_addr(PACKETBUF_ADDR_SENDER));
-    timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
-    /* first fragment can not be stored immediately but is moved into
-       the buffer while uncompressing */
-    return found;
+  if(found < 0) {
+    LOG_WARN("reassembly: failed to store new fragment session - tag: %d\n", tag);
+    return -1;
   }
 
-  /* This is a N-fragment - should find the info */
+  /* Found a free fragment info to store data in */
+  frag_info[found].len = frag_size;
+  frag_info[found].tag = tag;
+  frag_info[found].reassembled_len = 0;
+#if SICSLOWPAN_FRAG_RECOVERY
+  frag_info[found].received = 0;
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
+  linkaddr_copy(&frag_info[found].sender,
+                packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+/* find the context of a fragment from its tag and sender */
+static int8_t
+find_context(uint16_t tag)
+{
+  int i;
+
   for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
     if(frag_info[i].tag == tag && frag_info[i].len > 0 &&
        linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
       /* Tag and Sender match - this must be the correct info to store in */
-      found = i;
-      break;
+      return i;
     }
   }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* add a new fragment to the buffer */
+static int8_t
+add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
+{
+  int i;
+  int len;
 
-  if(found < 0) {
+  if(offset == 0) {
+    /* This is a first fragment - check if we can add this. It can not
+       be stored immediately but is moved into the buffer while
+       uncompressing */
+    return new_context(tag, frag_size);
+  }
+
+  /* This is a N-fragment - should find the info */
+  i = find_context(tag);
+
+  if(i < 0) {
     /* no entry found for storing the new fragment */
     LOG_WARN("reassembly: failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
     return -1;
@@ -405,6 +607,76 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
     return -1;
   }
 }
+#if SICSLOWPAN_FRAG_RECOVERY
+/*---------------------------------------------------------------------------*/
+/* Add a recoverable fragment to the buffer. The context of the packet is
+   allocated by whichever fragment comes first, since fragments that are
+   sent again come out of order. */
+static int8_t
+rfrag_add_fragment(uint8_t tag, uint8_t seq, uint16_t frag_size, uint8_t offset)
+{
+  int8_t context;
+  int len;
+
+  context = find_context(tag);
+  if(context < 0) {
+    context = new_context(tag, seq == 0 ? frag_size : SICSLOWPAN_RFRAG_LEN_UNKNOWN);
+    if(context < 0) {
+      return -1;
+    }
+  } else {
+    /* Keep the context while the sender recovers the missing fragments */
+    timer_restart(&frag_info[context].reass_timer);
+  }
+
+  if(seq == 0) {
+    /* The first fragment gives the total length, and is moved into the
+       buffer while uncompressing */
+    frag_info[context].len = frag_size;
+    return context;
+  }
+
+  len = store_fragment(context, offset);
+  if(len < 0 && timeout_fragments(context) > 0) {
+    len = store_fragment(context, offset);
+  }
+  if(len < 0) {
+    LOG_WARN("reassembly: failed to store recoverable fragment - tag: %d seq: %d\n",
+             tag, seq);
+    return -1;
+  }
+  frag_info[context].reassembled_len += len;
+  frag_info[context].received |= SICSLOWPAN_RFRAG_BIT(seq);
+  return context;
+}
+/*---------------------------------------------------------------------------*/
+static bool
+rfrag_is_done(uint8_t tag, const linkaddr_t *sender)
+{
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(!timer_expired(&rfrag_done[i].timer) && rfrag_done[i].tag == tag &&
+       linkaddr_cmp(&rfrag_done[i].sender, sender)) {
+      return true;
+    }
+  }
+  return false;
+}
+/*---------------------------------------------------------------------------*/
+static void
+rfrag_set_done(uint8_t tag, const linkaddr_t *sender)
+{
+  struct sicslowpan_rfrag_done *d = &rfrag_done[rfrag_next_done];
+
+  rfrag_next_done = (rfrag_next_done + 1) % SICSLOWPAN_REASS_CONTEXTS;
+  d->tag = tag;
+  linkaddr_copy(&d->sender, sender);
+  /* Until the sender gives up */
+  timer_set(&d->timer,
+            SICSLOWPAN_RFRAG_ACK_TIMEOUT * (SICSLOWPAN_RFRAG_MAX_RETRIES + 1));
+}
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
 /*---------------------------------------------------------------------------*/
 /* Copy all the fragments that are associated with a specific context
    into uip */
@@ -443,9 +715,16 @@ copy_frags2uip(int context)
   }
   /* deallocate all the fragments for this context */
   clear_fragments(context);
+  frag_stats.reassembled++;
 
   return true;
 }
+/*---------------------------------------------------------------------------*/
+const struct sicslowpan_frag_stats *
+sicslowpan_get_frag_stats(void)
+{
+  return &frag_stats;
+}
 #endif /* SICSLOWPAN_CONF_FRAG */
 
 /* -------------------------------------------------------------------------- */
@@ -1574,19 +1853,19 @@ send_packet(void)
 /*--------------------------------------------------------------------*/
 /**
  * \brief This function is called by the 6lowpan code to copy a fragment's
- * payload from uIP and send it down the stack.
- * \param uip_offset the offset in the uIP buffer where to copy the payload from
- * \param dest the link layer destination address of the packet
+ * payload from the IP packet and send it down the stack.
+ * \param buf the IP packet, usually in the uIP buffer
+ * \param uip_offset the offset in the IP packet where to copy the payload from
  * \return 1 if success, 0 otherwise
  */
 static int
-fragment_copy_payload_and_send(uint16_t uip_offset)
+fragment_copy_payload_and_send(const uint8_t *buf, uint16_t uip_offset)
 {
   struct queuebuf *q;
 
-  /* Now copy fragment payload from uip_buf */
-  memcpy(packetbuf_ptr + packetbuf_hdr_len,
-         (uint8_t *)UIP_IP_BUF + uip_offset, packetbuf_payload_len);
+  /* Now copy fragment payload from the IP packet */
+  memcpy(packetbuf_ptr + packetbuf_hdr_len, buf + uip_offset,
+         packetbuf_payload_len);
   packetbuf_set_datalen(packetbuf_payload_len + packetbuf_hdr_len);
 
   /* Backup packetbuf to queuebuf. Enables preserving attributes for all framgnets */
@@ -1613,6 +1892,488 @@ fragment_copy_payload_and_send(uint16_t uip_offset)
 }
 #endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
+/* Copy the link-layer security attributes of the received packet to
+   uipbuf, for them to be used when the packet is forwarded */
+static void
+set_uipbuf_llsec_attrs(void)
+{
+#if LLSEC802154_USES_AUX_HEADER
+  uipbuf_set_attr(UIPBUF_ATTR_LLSEC_LEVEL,
+    packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL));
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  uipbuf_set_attr(UIPBUF_ATTR_LLSEC_KEY_ID,
+    packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX));
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /*  LLSEC802154_USES_AUX_HEADER */
+}
+#if SICSLOWPAN_FRAG_FORWARDING
+/*--------------------------------------------------------------------*/
+/* Find the entry of a datagram from the source and tag of its fragments */
+static struct sicslowpan_vrb *
+vrb_lookup(const linkaddr_t *sender, uint16_t tag)
+{
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb[i].len > 0 && vrb[i].tag == tag &&
+       !timer_expired(&vrb[i].timer) &&
+       linkaddr_cmp(&vrb[i].sender, sender)) {
+      return &vrb[i];
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+static struct sicslowpan_vrb *
+vrb_alloc(void)
+{
+  struct sicslowpan_vrb *found = NULL;
+  int i;
+  int used = 1;
+
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb[i].len > 0 && timer_expired(&vrb[i].timer)) {
+      /* Some fragments of this datagram were lost */
+      vrb[i].len = 0;
+    }
+    if(vrb[i].len > 0) {
+      used++;
+    } else if(found == NULL) {
+      found = &vrb[i];
+    }
+  }
+  if(found != NULL && used > frag_stats.max_forwarding) {
+    frag_stats.max_forwarding = used;
+  }
+  return found;
+}
+/*--------------------------------------------------------------------*/
+/* Is the packet in uip_buf the datagram of the first fragment passed to
+   the stack? The stack may also send other packets, such as ICMPv6 errors */
+static bool
+vrb_is_forwarded_datagram(void)
+{
+  struct uip_ip_hdr *hdr = SICSLOWPAN_IP_BUF(frag_info[vrb_context].first_frag);
+
+  return uip_len == frag_info[vrb_context].len &&
+    UIP_IP_BUF->proto == hdr->proto &&
+    uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &hdr->srcipaddr) &&
+    uip_ipaddr_cmp(&UIP_IP_BUF->destipaddr, &hdr->destipaddr);
+}
+/*--------------------------------------------------------------------*/
+/* Send the first fragment of a forwarded datagram, after output() has
+   compressed the headers. Only the headers and the payload of the first
+   fragment are valid in uip_buf. */
+static uint8_t
+vrb_send_first_fragment(const linkaddr_t *localdest)
+{
+  struct sicslowpan_frag_info *info = &frag_info[vrb_context];
+  struct sicslowpan_vrb *v;
+  uint16_t out_tag;
+
+  /* The first fragment must carry the same part of the datagram as the
+     incoming one, as the offsets of the next fragments are kept */
+  if(localdest == NULL || info->first_frag_len < uncomp_hdr_len ||
+     packetbuf_hdr_len + SICSLOWPAN_FRAG1_HDR_LEN +
+     info->first_frag_len - uncomp_hdr_len > mac_max_payload) {
+    LOG_INFO("forwarding: first fragment does not fit, reassembling\n");
+    return 0;
+  }
+
+  v = vrb_alloc();
+  if(v == NULL) {
+    LOG_WARN("forwarding: no free entry, reassembling\n");
+    return 0;
+  }
+
+  last_tx_status = MAC_TX_OK;
+  out_tag = my_tag++;
+
+  /* Move IPHC/IPv6 header to make room for FRAG1 header */
+  memmove(packetbuf_ptr + SICSLOWPAN_FRAG1_HDR_LEN, packetbuf_ptr, packetbuf_hdr_len);
+  packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | uip_len));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, out_tag);
+  packetbuf_payload_len = info->first_frag_len - uncomp_hdr_len;
+
+  LOG_INFO("forwarding: first fragment (tag %d -> %d, payload %d)\n",
+           info->tag, out_tag, packetbuf_payload_len);
+  if(fragment_copy_payload_and_send((uint8_t *)UIP_IP_BUF, uncomp_hdr_len) == 0) {
+    return 0;
+  }
+
+  linkaddr_copy(&v->sender, &info->sender);
+  v->tag = info->tag;
+  v->len = uip_len;
+  v->forwarded_len = info->first_frag_len;
+  memset(v->forwarded_offsets, 0, sizeof(v->forwarded_offsets));
+  linkaddr_copy(&v->next_hop, localdest);
+  v->out_tag = out_tag;
+#if LLSEC802154_USES_AUX_HEADER
+  v->security_level = packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  v->key_index = packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+  timer_set(&v->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  vrb_created = v;
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/* Pass the first fragment of a datagram for another node to the IPv6
+   stack, for it to route the datagram. Returns true if the first fragment
+   was sent, false if the datagram must be reassembled. */
+static bool
+vrb_forward_first_fragment(int8_t context)
+{
+  struct sicslowpan_frag_info *info = &frag_info[context];
+  struct uip_ip_hdr *hdr = SICSLOWPAN_IP_BUF(info->first_frag);
+
+  if(uip_is_addr_mcast(&hdr->destipaddr) ||
+     uip_is_addr_linklocal(&hdr->destipaddr) ||
+     uip_ds6_is_my_addr(&hdr->destipaddr) ||
+     info->len > sizeof(uip_buf) || info->first_frag_len > info->len) {
+    return false;
+  }
+
+  if(info->reassembled_len != info->first_frag_len) {
+    /* Fragments that arrived before the first one are already stored */
+    return false;
+  }
+
+  /* The stack sees the length of the whole datagram but only reads the
+     headers, which are all in the first fragment. Anything else that it
+     sends meanwhile is dropped by output() */
+  memcpy((uint8_t *)UIP_IP_BUF, info->first_frag, info->first_frag_len);
+  uip_len = info->len;
+  set_uipbuf_llsec_attrs();
+
+  vrb_context = context;
+  vrb_created = NULL;
+  tcpip_input();
+  vrb_context = -1;
+
+  if(vrb_created == NULL) {
+    /* The stack dropped or changed the datagram, and nothing was sent */
+    return false;
+  }
+
+  /* The next fragments are forwarded, not stored */
+  clear_fragments(context);
+  frag_stats.forwarded++;
+  return true;
+}
+/*--------------------------------------------------------------------*/
+/* Forward a subsequent fragment of a datagram whose first fragment was
+   forwarded. Returns false if the datagram is not forwarded. */
+static bool
+vrb_forward_fragment(uint16_t tag)
+{
+  struct sicslowpan_vrb *v;
+  uint8_t *frame;
+  uint16_t len;
+  uint8_t offset;
+
+  len = packetbuf_datalen();
+  if(len <= SICSLOWPAN_FRAGN_HDR_LEN) {
+    return false;
+  }
+
+  v = vrb_lookup(packetbuf_addr(PACKETBUF_ADDR_SENDER), tag);
+  if(v == NULL) {
+    return false;
+  }
+
+  offset = PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET];
+  if((offset << 3) >= v->len) {
+    return false;
+  }
+  if(v->forwarded_offsets[offset / 8] & (1 << (offset % 8))) {
+    /* The previous hop sent the fragment again, and it must not be
+       counted twice */
+    LOG_INFO("forwarding: duplicate fragment (tag %d, offset %d)\n",
+             tag, offset << 3);
+    return true;
+  }
+
+  /* Turn the received frame into an outgoing one, with the new tag */
+  frame = packetbuf_dataptr();
+  packetbuf_clear();
+  memmove(packetbuf_dataptr(), frame, len);
+  packetbuf_set_datalen(len);
+  packetbuf_ptr = packetbuf_dataptr();
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, v->out_tag);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &v->next_hop);
+#if LLSEC802154_USES_AUX_HEADER
+  packetbuf_set_attr(PACKETBUF_ATTR_SECURITY_LEVEL, v->security_level);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  packetbuf_set_attr(PACKETBUF_ATTR_KEY_INDEX, v->key_index);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+
+  LOG_INFO("forwarding: fragment (tag %d -> %d, offset %d)\n",
+           tag, v->out_tag, offset << 3);
+  send_packet();
+
+  v->forwarded_offsets[offset / 8] |= 1 << (offset % 8);
+  v->forwarded_len += len - SICSLOWPAN_FRAGN_HDR_LEN;
+  if(v->forwarded_len >= v->len) {
+    /* This was the last fragment */
+    v->len = 0;
+  }
+  return true;
+}
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+#if SICSLOWPAN_FRAG_RECOVERY
+/*--------------------------------------------------------------------*/
+/* Send a recoverable fragment of a datagram */
+static int
+rfrag_send_fragment(struct sicslowpan_rfrag_sender *s, uint8_t seq,
+                    bool ack_request)
+{
+  uint16_t offset;
+
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &s->dest);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, s->max_transmissions);
+#if LLSEC802154_USES_AUX_HEADER
+  packetbuf_set_attr(PACKETBUF_ATTR_SECURITY_LEVEL, s->security_level);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  packetbuf_set_attr(PACKETBUF_ATTR_KEY_INDEX, s->key_index);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+
+  if(seq == 0) {
+    /* The first fragment has the compressed headers */
+    memcpy(packetbuf_ptr + SICSLOWPAN_RFRAG_HDR_LEN, s->hdr, s->hdr_len);
+    packetbuf_hdr_len = SICSLOWPAN_RFRAG_HDR_LEN + s->hdr_len;
+    offset = s->uncomp_hdr_len;
+    packetbuf_payload_len = s->frag0_payload;
+  } else {
+    packetbuf_hdr_len = SICSLOWPAN_RFRAG_HDR_LEN;
+    offset = s->uncomp_hdr_len + s->frag0_payload + (seq - 1) * s->fragn_payload;
+    packetbuf_payload_len = MIN(s->fragn_payload, s->len - offset);
+  }
+
+  /* Set RFRAG header. The offset field of the first fragment is the
+     length of the datagram */
+  PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_DISPATCH_SIZE] = SICSLOWPAN_DISPATCH_RFRAG;
+  PACKETBUF_FRAG_PTR[PACKETBUF_RFRAG_TAG] = s->tag;
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_SEQ_SIZE,
+        (ack_request ? SICSLOWPAN_RFRAG_ACK_REQUEST : 0) | (seq << 10) |
+        (packetbuf_hdr_len - SICSLOWPAN_RFRAG_HDR_LEN + packetbuf_payload_len));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_OFFSET, seq == 0 ? s->len : offset);
+
+  LOG_INFO("output: recoverable fragment %d/%d (tag %d, payload %d, offset %d%s)\n",
+           seq + 1, s->count, s->tag, packetbuf_payload_len, offset,
+           ack_request ? ", ack request" : "");
+  return fragment_copy_payload_and_send(s->buf, offset);
+}
+/*--------------------------------------------------------------------*/
+static void
+rfrag_timeout(void *ptr)
+{
+  struct sicslowpan_rfrag_sender *s = ptr;
+
+  if(++s->retries > SICSLOWPAN_RFRAG_MAX_RETRIES) {
+    LOG_WARN("output: no acknowledgment of tag %d, dropping packet\n", s->tag);
+    s->len = 0;
+    return;
+  }
+
+  /* Ask for an acknowledgment again with the last fragment */
+  last_tx_status = MAC_TX_OK;
+  rfrag_send_fragment(s, s->count - 1, true);
+  frag_stats.retransmitted++;
+  ctimer_set(&s->timer, SICSLOWPAN_RFRAG_ACK_TIMEOUT, rfrag_timeout, s);
+}
+/*--------------------------------------------------------------------*/
+/* Process an acknowledgment, and send the missing fragments again */
+static void
+rfrag_input_ack(void)
+{
+  struct sicslowpan_rfrag_sender *s;
+  uint32_t bitmap;
+  uint8_t tag;
+  int seq, last;
+
+  if(packetbuf_datalen() < SICSLOWPAN_RFRAG_ACK_HDR_LEN) {
+    LOG_WARN("input: truncated fragment acknowledgment\n");
+    return;
+  }
+
+  tag = PACKETBUF_FRAG_PTR[PACKETBUF_RFRAG_TAG];
+  bitmap = ((uint32_t)GET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_ACK_BITMAP) << 16) |
+    GET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_ACK_BITMAP + 2);
+
+  for(s = rfrag_senders; s < &rfrag_senders[SICSLOWPAN_RFRAG_CONTEXTS]; s++) {
+    if(s->len > 0 && s->tag == tag &&
+       linkaddr_cmp(&s->dest, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+      break;
+    }
+  }
+  if(s == &rfrag_senders[SICSLOWPAN_RFRAG_CONTEXTS]) {
+    LOG_DBG("input: fragment acknowledgment of unknown tag %d\n", tag);
+    return;
+  }
+
+  /* Find the last missing fragment, which asks for an acknowledgment */
+  last = -1;
+  if(bitmap != SICSLOWPAN_RFRAG_BITMAP_FULL) {
+    for(seq = 0; seq < s->count; seq++) {
+      if(!(bitmap & SICSLOWPAN_RFRAG_BIT(seq))) {
+        last = seq;
+      }
+    }
+  }
+
+  if(last < 0 || bitmap == SICSLOWPAN_RFRAG_BITMAP_NULL) {
+    /* The datagram was received, or the receiver gave it up */
+    LOG_INFO("input: fragments of tag %d %s\n", tag,
+             last < 0 ? "acknowledged" : "aborted");
+    ctimer_stop(&s->timer);
+    s->len = 0;
+    return;
+  }
+
+  if(++s->retries > SICSLOWPAN_RFRAG_MAX_RETRIES) {
+    LOG_WARN("output: fragments of tag %d still missing, dropping packet\n", tag);
+    ctimer_stop(&s->timer);
+    s->len = 0;
+    return;
+  }
+
+  last_tx_status = MAC_TX_OK;
+  for(seq = 0; seq <= last; seq++) {
+    if(!(bitmap & SICSLOWPAN_RFRAG_BIT(seq))) {
+      if(rfrag_send_fragment(s, seq, seq == last) == 0) {
+        break;
+      }
+      frag_stats.retransmitted++;
+    }
+  }
+  ctimer_set(&s->timer, SICSLOWPAN_RFRAG_ACK_TIMEOUT, rfrag_timeout, s);
+}
+/*--------------------------------------------------------------------*/
+/* Acknowledge the fragments received of a datagram */
+static void
+rfrag_send_ack(const linkaddr_t *dest, uint8_t tag, uint32_t bitmap)
+{
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+#if LLSEC802154_USES_AUX_HEADER
+  packetbuf_set_attr(PACKETBUF_ATTR_SECURITY_LEVEL,
+    uipbuf_get_attr(UIPBUF_ATTR_LLSEC_LEVEL));
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  packetbuf_set_attr(PACKETBUF_ATTR_KEY_INDEX,
+    uipbuf_get_attr(UIPBUF_ATTR_LLSEC_KEY_ID));
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+
+  PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_DISPATCH_SIZE] = SICSLOWPAN_DISPATCH_RFRAG_ACK;
+  PACKETBUF_FRAG_PTR[PACKETBUF_RFRAG_TAG] = tag;
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_ACK_BITMAP, bitmap >> 16);
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_ACK_BITMAP + 2, bitmap & 0xffff);
+  packetbuf_set_datalen(SICSLOWPAN_RFRAG_ACK_HDR_LEN);
+
+  LOG_INFO("output: fragment acknowledgment (tag %d, bitmap 0x%08lx)\n",
+           tag, (unsigned long)bitmap);
+  send_packet();
+}
+/*--------------------------------------------------------------------*/
+/* Fragment the packet in uip_buf with recoverable fragments, and keep it
+   until it is acknowledged */
+static uint8_t
+rfrag_output(const linkaddr_t *localdest)
+{
+  struct sicslowpan_rfrag_sender *s;
+  int frag0_payload;
+  int fragn_payload;
+  int count;
+  int seq;
+  bool unicast;
+
+  /* Payloads that are multiples of 8 bytes, like FRAG1 and FRAGN */
+  frag0_payload = (mac_max_payload - packetbuf_hdr_len - SICSLOWPAN_RFRAG_HDR_LEN) & 0xfffffff8;
+  fragn_payload = MIN(mac_max_payload - SICSLOWPAN_RFRAG_HDR_LEN,
+                      SICSLOWPAN_FRAGMENT_SIZE) & 0xfffffff8;
+  if(frag0_payload < 0 || fragn_payload <= 0 ||
+     packetbuf_hdr_len > SICSLOWPAN_RFRAG_MAX_HDR_LEN) {
+    LOG_WARN("output: compressed header does not fit first fragment\n");
+    return 0;
+  }
+
+  count = 1 + (uip_len - uncomp_hdr_len - frag0_payload + fragn_payload - 1) / fragn_payload;
+  if(count > SICSLOWPAN_RFRAG_MAX_FRAGMENTS) {
+    LOG_WARN("output: dropping packet, too many fragments (%d)\n", count);
+    return 0;
+  }
+
+  /* Keep one queuebuf in reserve, as for other fragmented packets */
+  if(queuebuf_numfree() < count + 1) {
+    LOG_WARN("output: dropping packet, not enough free bufs (needed: %d, free: %d)\n",
+             count + 1, (int)queuebuf_numfree());
+    return 0;
+  }
+
+  for(s = rfrag_senders; s < &rfrag_senders[SICSLOWPAN_RFRAG_CONTEXTS]; s++) {
+    if(s->len == 0) {
+      break;
+    }
+  }
+  if(s == &rfrag_senders[SICSLOWPAN_RFRAG_CONTEXTS]) {
+    /* Give up the recovery of a datagram that waits for an acknowledgment */
+    s = &rfrag_senders[rfrag_next_sender];
+    rfrag_next_sender = (rfrag_next_sender + 1) % SICSLOWPAN_RFRAG_CONTEXTS;
+    LOG_WARN("output: no free recovery context, giving up tag %d\n", s->tag);
+    ctimer_stop(&s->timer);
+  }
+
+  unicast = localdest != NULL && !linkaddr_cmp(localdest, &linkaddr_null);
+  s->len = uip_len;
+  memcpy(s->buf, UIP_IP_BUF, uip_len);
+  memcpy(s->hdr, packetbuf_ptr, packetbuf_hdr_len);
+  s->hdr_len = packetbuf_hdr_len;
+  s->uncomp_hdr_len = uncomp_hdr_len;
+  s->frag0_payload = frag0_payload;
+  s->fragn_payload = fragn_payload;
+  s->count = count;
+  s->tag = my_tag++;
+  s->retries = 0;
+  s->max_transmissions = packetbuf_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
+#if LLSEC802154_USES_AUX_HEADER
+  s->security_level = packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  s->key_index = packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+  linkaddr_copy(&s->dest, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+
+  LOG_INFO("output: recoverable fragmentation needed. fragments: %d\n", count);
+
+  /* Reset last tx status -- MAC layers most often call packet_sent asynchrously */
+  last_tx_status = MAC_TX_OK;
+  /* The last fragment asks for an acknowledgment. If a fragment cannot be
+     sent, the acknowledgment timer recovers the rest. */
+  for(seq = 0; seq < count; seq++) {
+    if(rfrag_send_fragment(s, seq, unicast && seq == count - 1) == 0) {
+      break;
+    }
+  }
+
+  if(!unicast) {
+    /* Broadcast fragments are not acknowledged */
+    s->len = 0;
+    return seq == count;
+  }
+  ctimer_set(&s->timer, SICSLOWPAN_RFRAG_ACK_TIMEOUT, rfrag_timeout, s);
+  return 1;
+}
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
+/*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
  *  network using 6lowpan.
  *  \param localdest The MAC address of the destination
@@ -1643,6 +2404,18 @@ output(const linkaddr_t *localdest)
 
   LOG_INFO("output: sending IPv6 packet with len %d\n", uip_len);
 
+#if SICSLOWPAN_FRAG_FORWARDING
+  if(vrb_context >= 0 && !vrb_is_forwarded_datagram()) {
+    /* Only the first fragment of the datagram is in uip_buf. The stack
+       either changed its headers, e.g., when the RPL root inserts a
+       source routing header, or sends another packet, such as an
+       ICMPv6 error that quotes it. Drop the packet: the datagram is
+       reassembled and passed to the stack again. */
+    LOG_INFO("forwarding: datagram changed by the stack, reassembling\n");
+    return 0;
+  }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
   /* copy over the retransmission count from uipbuf attributes */
   packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
                      uipbuf_get_attr(UIPBUF_ATTR_MAX_MAC_TRANSMISSIONS));
@@ -1699,6 +2472,18 @@ output(const linkaddr_t *localdest)
             uip_len, uip_len - uncomp_hdr_len + packetbuf_hdr_len,
             mac_max_payload, frag_needed);
 
+#if SICSLOWPAN_FRAG_FORWARDING
+  if(vrb_context >= 0) {
+    return vrb_send_first_fragment(localdest);
+  }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
+#if SICSLOWPAN_FRAG_RECOVERY
+  if(frag_needed) {
+    return rfrag_output(localdest);
+  }
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
+
   if(frag_needed) {
 #if SICSLOWPAN_CONF_FRAG
     /* Number of bytes processed. */
@@ -1773,7 +2558,7 @@ output(const linkaddr_t *localdest)
     LOG_INFO("output: fragment %d/%d (tag %d, payload %d)\n",
              curr_frag + 1, fragment_count,
              frag_tag, packetbuf_payload_len);
-    if(fragment_copy_payload_and_send(uncomp_hdr_len) == 0) {
+    if(fragment_copy_payload_and_send((uint8_t *)UIP_IP_BUF, uncomp_hdr_len) == 0) {
       return 0;
     }
 
@@ -1807,7 +2592,8 @@ output(const linkaddr_t *localdest)
       LOG_INFO("output: fragment %d/%d (tag %d, payload %d, offset %d)\n",
                curr_frag + 1, fragment_count,
                frag_tag, packetbuf_payload_len, processed_ip_out_len);
-      if(fragment_copy_payload_and_send(processed_ip_out_len) == 0) {
+      if(fragment_copy_payload_and_send((uint8_t *)UIP_IP_BUF,
+                                        processed_ip_out_len) == 0) {
         return 0;
       }
 
@@ -1867,6 +2653,13 @@ input(void)
   uint16_t frag_tag = 0;
   uint8_t first_fragment = 0, last_fragment = 0;
 #endif /*SICSLOWPAN_CONF_FRAG*/
+#if SICSLOWPAN_FRAG_RECOVERY
+  /* recoverable fragment: sequence number and sender */
+  uint8_t rfrag_seq = 0;
+  bool is_rfrag = false, rfrag_ack_request = false;
+  linkaddr_t rfrag_sender;
+  uint16_t rfrag_offset;
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
 
   /* Update link statistics */
   link_stats_input_callback(packetbuf_addr(PACKETBUF_ADDR_SENDER));
@@ -1935,6 +2728,12 @@ input(void)
       frag_size = GET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE) & 0x07ff;
       packetbuf_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
 
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(vrb_forward_fragment(frag_tag)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
       /* Add the fragment to the fragmentation context (this will also
          copy the payload) */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
@@ -1953,6 +2752,88 @@ input(void)
       }
       is_fragment = 1;
       break;
+#if SICSLOWPAN_FRAG_RECOVERY
+    case SICSLOWPAN_DISPATCH_RFRAG:
+      if((PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_DISPATCH_SIZE] & SICSLOWPAN_DISPATCH_RFRAG_MASK) ==
+         SICSLOWPAN_DISPATCH_RFRAG_ACK) {
+        rfrag_input_ack();
+        return;
+      }
+      if(packetbuf_datalen() < SICSLOWPAN_RFRAG_HDR_LEN) {
+        LOG_WARN("input: truncated recoverable fragment\n");
+        return;
+      }
+
+      /*
+       * set tag and sequence number. The offset is in bytes, or is the
+       * size for the first fragment
+       */
+      frag_tag = PACKETBUF_FRAG_PTR[PACKETBUF_RFRAG_TAG];
+      rfrag_seq = (GET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_SEQ_SIZE) >> 10) & 0x1f;
+      rfrag_ack_request = (GET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_SEQ_SIZE) &
+                           SICSLOWPAN_RFRAG_ACK_REQUEST) != 0;
+      rfrag_offset = GET16(PACKETBUF_FRAG_PTR, PACKETBUF_RFRAG_OFFSET);
+      linkaddr_copy(&rfrag_sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+      packetbuf_hdr_len += SICSLOWPAN_RFRAG_HDR_LEN;
+      is_rfrag = true;
+      is_fragment = 1;
+
+      LOG_INFO("input: received recoverable fragment (tag %d, seq %d)\n",
+               frag_tag, rfrag_seq);
+
+      if(rfrag_is_done(frag_tag, &rfrag_sender)) {
+        /* The acknowledgment of this packet was lost */
+        if(rfrag_ack_request) {
+          rfrag_send_ack(&rfrag_sender, frag_tag, SICSLOWPAN_RFRAG_BITMAP_FULL);
+        }
+        return;
+      }
+
+      frag_context = find_context(frag_tag);
+      if(frag_context >= 0 &&
+         (frag_info[frag_context].received & SICSLOWPAN_RFRAG_BIT(rfrag_seq))) {
+        /* A fragment sent again although it was received */
+        if(rfrag_ack_request) {
+          rfrag_send_ack(&rfrag_sender, frag_tag, frag_info[frag_context].received);
+        }
+        return;
+      }
+
+      if(rfrag_seq == 0) {
+        frag_size = rfrag_offset;
+        first_fragment = 1;
+      } else if((rfrag_offset & 7) != 0 || (rfrag_offset >> 3) > 0xff) {
+        /* Offsets are stored in units of 8 bytes */
+        LOG_WARN("input: unsupported recoverable fragment offset %d\n", rfrag_offset);
+        return;
+      } else {
+        frag_offset = rfrag_offset >> 3;
+      }
+      if(first_fragment && frag_size == 0) {
+        LOG_WARN("input: invalid recoverable fragment size\n");
+        return;
+      }
+
+      frag_context = rfrag_add_fragment(frag_tag, rfrag_seq, frag_size, frag_offset);
+      if(frag_context == -1) {
+        LOG_ERR("input: failed to store recoverable fragment (tag %d)\n", frag_tag);
+        return;
+      }
+
+      if(first_fragment) {
+        buffer = frag_info[frag_context].first_frag;
+        buffer_size = SICSLOWPAN_FIRST_FRAGMENT_SIZE;
+      } else {
+        /* rfrag_add_fragment stored the fragment */
+        buffer = NULL;
+        frag_size = frag_info[frag_context].len;
+        if(frag_size != SICSLOWPAN_RFRAG_LEN_UNKNOWN &&
+           frag_info[frag_context].reassembled_len >= frag_size) {
+          last_fragment = 1;
+        }
+      }
+      break;
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
     default:
       break;
   }
@@ -2047,7 +2928,20 @@ input(void)
       LOG_ERR("input: cannot copy the payload into the buffer\n");
       return;
     }
-    memcpy((uint8_t *)buffer + uncomp_hdr_len, packetbuf_ptr + packetbuf_hdr_len, packetbuf_payload_len);
+    if(buffer == (uint8_t *)UIP_IP_BUF && packetbuf_payload_len > 0 &&
+       (uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) ||
+        uip_is_addr_mcast(&UIP_IP_BUF->destipaddr))) {
+      /* The packet is for us, so sum the payload while copying it, and
+         uIP does not have to read it again to check its checksum */
+      uipbuf_set_attr(UIPBUF_ATTR_PAYLOAD_CHKSUM,
+                      uip_chksum_copy(0, (uint8_t *)buffer + uncomp_hdr_len,
+                                      packetbuf_ptr + packetbuf_hdr_len,
+                                      packetbuf_payload_len));
+      uipbuf_set_attr(UIPBUF_ATTR_PAYLOAD_OFFSET, uncomp_hdr_len);
+      uipbuf_set_attr(UIPBUF_ATTR_PAYLOAD_LEN, packetbuf_payload_len);
+    } else {
+      memcpy((uint8_t *)buffer + uncomp_hdr_len, packetbuf_ptr + packetbuf_hdr_len, packetbuf_payload_len);
+    }
   }
 
   /* update processed_ip_in_len if fragment, sicslowpan_len otherwise */
@@ -2056,8 +2950,20 @@ input(void)
   if(frag_size > 0) {
     /* Add the size of the header only for the first fragment. */
     if(first_fragment != 0) {
-      frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
+      frag_info[frag_context].reassembled_len += uncomp_hdr_len + packetbuf_payload_len;
       frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+#if SICSLOWPAN_FRAG_RECOVERY
+      frag_info[frag_context].received |= SICSLOWPAN_RFRAG_BIT(0);
+      if(is_rfrag && frag_info[frag_context].reassembled_len >= frag_size) {
+        /* The first fragment was sent again, after the others */
+        last_fragment = 1;
+      }
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(vrb_forward_first_fragment(frag_context)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
     }
     /* For the last fragment, we are OK if there is extrenous bytes at
        the end of the packet. */
@@ -2067,6 +2973,11 @@ input(void)
       if(!copy_frags2uip(frag_context)) {
         return;
       }
+#if SICSLOWPAN_FRAG_RECOVERY
+      if(is_rfrag) {
+        rfrag_set_done(frag_tag, &rfrag_sender);
+      }
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
     }
   }
 
@@ -2103,23 +3014,24 @@ input(void)
       callback->input_callback();
     }
 
-#if LLSEC802154_USES_AUX_HEADER
     /*
      * Assuming that the last packet in packetbuf is containing
      *  the LLSEC state so that it can be copied to uipbuf.
      */
-    uipbuf_set_attr(UIPBUF_ATTR_LLSEC_LEVEL,
-      packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL));
-#if LLSEC802154_USES_EXPLICIT_KEYS
-    uipbuf_set_attr(UIPBUF_ATTR_LLSEC_KEY_ID,
-      packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX));
-#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
-#endif /*  LLSEC802154_USES_AUX_HEADER */
+    set_uipbuf_llsec_attrs();
 
     tcpip_input();
 #if SICSLOWPAN_CONF_FRAG
   }
 #endif /* SICSLOWPAN_CONF_FRAG */
+
+#if SICSLOWPAN_FRAG_RECOVERY
+  if(rfrag_ack_request) {
+    rfrag_send_ack(&rfrag_sender, frag_tag,
+                   last_fragment ? SICSLOWPAN_RFRAG_BITMAP_FULL :
+                   frag_info[frag_context].received);
+  }
+#endif /* SICSLOWPAN_FRAG_RECOVERY */
 }
 /** @} */
 
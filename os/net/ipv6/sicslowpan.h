@@ -88,6 +88,9 @@
 #define SICSLOWPAN_DISPATCH_FRAG1                   0xc0 /* 11000xxx */
 #define SICSLOWPAN_DISPATCH_FRAGN                   0xe0 /* 11100xxx */
 #define SICSLOWPAN_DISPATCH_FRAG_MASK               0xf8
+#define SICSLOWPAN_DISPATCH_RFRAG                   0xe8 /* 1110100x */
+#define SICSLOWPAN_DISPATCH_RFRAG_ACK               0xea /* 1110101x */
+#define SICSLOWPAN_DISPATCH_RFRAG_MASK              0xfe
 #define SICSLOWPAN_DISPATCH_PAGING                  0xf0 /* 1111xxxx */
 #define SICSLOWPAN_DISPATCH_PAGING_MASK             0xf0
 /** @} */
@@ -188,6 +191,8 @@
 #define SICSLOWPAN_HC1_HC_UDP_HDR_LEN               7
 #define SICSLOWPAN_FRAG1_HDR_LEN                    4
 #define SICSLOWPAN_FRAGN_HDR_LEN                    5
+#define SICSLOWPAN_RFRAG_HDR_LEN                    6
+#define SICSLOWPAN_RFRAG_ACK_HDR_LEN                6
 /** @} */
 
 /**
@@ -296,5 +301,27 @@ struct sicslowpan_nh_compressor {
 
 extern const struct network_driver sicslowpan_driver;
 
+#if SICSLOWPAN_CONF_FRAG
+/** \brief Fragmentation statistics */
+struct sicslowpan_frag_stats {
+  /** Datagrams reassembled */
+  uint32_t reassembled;
+  /** Datagrams forwarded fragment by fragment */
+  uint32_t forwarded;
+  /** Peak number of fragment buffers in use */
+  uint16_t max_buffers;
+  /** Peak number of datagrams forwarded at the same time */
+  uint16_t max_forwarding;
+  /** Fragments sent again after a recoverable fragment acknowledgment */
+  uint32_t retransmitted;
+};
+
+/**
+ * \brief Get the fragmentation statistics
+ * \return A pointer to the statistics
+ */
+const struct sicslowpan_frag_stats *sicslowpan_get_frag_stats(void);
+#endif /* SICSLOWPAN_CONF_FRAG */
+
 #endif /* SICSLOWPAN_H_ */
 /** @} */
@@ -45,6 +45,9 @@
 #include <string.h>
 
 static void relisten(struct tcp_socket *s);
+#if UIP_TCP_SEND_WINDOW > 1
+static void acked(struct tcp_socket *s);
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 
 LIST(socketlist);
 /*---------------------------------------------------------------------------*/
@@ -58,21 +61,102 @@ call_event(struct tcp_socket *s, tcp_socket_event_t event)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if TCP_SOCKET_WITH_GATHER
+/* Sends a segment that continues from the output buffer into the
+   fragments, by gathering it in the outgoing packet */
+static void
+senddata_frags(struct tcp_socket *s, int len)
+{
+  uint8_t *buf = uip_appdata;
+  const struct tcp_socket_frag *frag = s->output_frags;
+  uint16_t offset = s->output_frag_offset;
+  int copylen, pos;
+
+  /* All of the output buffer goes first */
+  s->output_senddata_len = s->output_data_len;
+  len = MIN(len, s->output_senddata_len + s->output_frags_len);
+  pos = s->output_senddata_len;
+  memcpy(buf, s->output_data_ptr, pos);
+  while(pos < len) {
+    copylen = MIN(frag->len - offset, len - pos);
+    memcpy(&buf[pos], &frag->data[offset], copylen);
+    pos += copylen;
+    frag++;
+    offset = 0;
+  }
+  s->output_data_send_nxt = len;
+  uip_send(buf, len);
+}
+/*---------------------------------------------------------------------------*/
+/* Drops acknowledged bytes from the fragments */
+static void
+acked_frags(struct tcp_socket *s, uint32_t len)
+{
+  uint16_t left;
+
+  s->output_frags_len -= len;
+  while(len > 0) {
+    left = s->output_frags->len - s->output_frag_offset;
+    if(len < left) {
+      s->output_frag_offset += len;
+      break;
+    }
+    len -= left;
+    s->output_frags++;
+    s->output_frags_count--;
+    s->output_frag_offset = 0;
+  }
+  if(s->output_frags_len == 0) {
+    s->output_frags = NULL;
+    s->output_frags_count = 0;
+    s->output_frag_offset = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TCP_SOCKET_WITH_GATHER */
 static void
 senddata(struct tcp_socket *s)
 {
   int len = MIN(s->output_data_max_seg, uip_mss());
 
+#if TCP_SOCKET_WITH_GATHER
+  /* A retransmission must repeat the segment that was sent before */
+  if(s->output_frags_len > 0 && s->output_data_len < len
+     && (s->output_data_send_nxt == 0
+         || s->output_data_send_nxt > s->output_senddata_len)) {
+    senddata_frags(s, len);
+  } else
+#endif /* TCP_SOCKET_WITH_GATHER */
   if(s->output_senddata_len > 0) {
     len = MIN(s->output_senddata_len, len);
     s->output_data_send_nxt = len;
     uip_send(s->output_data_ptr, len);
   }
+
+#if UIP_TCP_SEND_WINDOW > 1
+  /* uIP retransmits the data from its own buffer, so the data is done
+     with as soon as it has been sent */
+  if(s->output_data_send_nxt > 0) {
+    acked(s);
+  }
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 }
 /*---------------------------------------------------------------------------*/
 static void
 acked(struct tcp_socket *s)
 {
+#if TCP_SOCKET_WITH_GATHER
+  if(s->output_data_send_nxt > s->output_senddata_len) {
+    /* The segment continued into the fragments */
+    acked_frags(s, s->output_data_send_nxt - s->output_senddata_len);
+    s->output_data_send_nxt = s->output_senddata_len;
+    if(s->output_senddata_len == 0) {
+      call_event(s, TCP_SOCKET_DATA_SENT);
+      return;
+    }
+  }
+#endif /* TCP_SOCKET_WITH_GATHER */
+
   if(s->output_senddata_len > 0) {
     /* Copy the data in the outputbuf down and update outputbufptr and
        outputbuf_lastsent */
@@ -166,6 +250,7 @@ appcall(void *state)
 	  s->flags &= ~TCP_SOCKET_FLAGS_LISTENING;
           s->output_data_max_seg = uip_mss();
 	  tcp_markconn(uip_conn, s);
+	  s->c = uip_conn;
 	  call_event(s, TCP_SOCKET_CONNECTED);
 	  break;
 	}
@@ -203,9 +288,11 @@ appcall(void *state)
     return;
   }
 
+#if UIP_TCP_SEND_WINDOW == 1
   if(uip_acked()) {
     acked(s);
   }
+#endif /* UIP_TCP_SEND_WINDOW == 1 */
   if(uip_newdata()) {
     newdata(s);
   }
@@ -278,6 +365,12 @@ tcp_socket_register(struct tcp_socket *s, void *ptr,
   s->output_data_len = 0;
   s->output_data_ptr = output_databuf;
   s->output_data_maxlen = output_databuf_len;
+#if TCP_SOCKET_WITH_GATHER
+  s->output_frags = NULL;
+  s->output_frags_len = 0;
+  s->output_frag_offset = 0;
+  s->output_frags_count = 0;
+#endif /* TCP_SOCKET_WITH_GATHER */
   s->input_callback = input_callback;
   s->event_callback = event_callback;
   list_add(socketlist, s);
@@ -349,6 +442,13 @@ tcp_socket_send(struct tcp_socket *s,
     return -1;
   }
 
+#if TCP_SOCKET_WITH_GATHER
+  if(s->output_frags_len > 0) {
+    /* The data would go out before the fragments */
+    return 0;
+  }
+#endif /* TCP_SOCKET_WITH_GATHER */
+
   len = MIN(datalen, s->output_data_maxlen - s->output_data_len);
 
   memmove(&s->output_data_ptr[s->output_data_len], data, len);
@@ -363,6 +463,36 @@ tcp_socket_send(struct tcp_socket *s,
   return len;
 }
 /*---------------------------------------------------------------------------*/
+#if TCP_SOCKET_WITH_GATHER
+int
+tcp_socket_send_frags(struct tcp_socket *s,
+                      const struct tcp_socket_frag *frags, int count)
+{
+  uint32_t len = 0;
+  int i;
+
+  if(s == NULL || s->output_frags_len > 0 || count > UINT8_MAX) {
+    return -1;
+  }
+
+  for(i = 0; i < count; i++) {
+    len += frags[i].len;
+  }
+  if(len == 0) {
+    return 0;
+  }
+
+  s->output_frags = frags;
+  s->output_frags_count = count;
+  s->output_frag_offset = 0;
+  s->output_frags_len = len;
+
+  tcpip_poll_tcp(s->c);
+
+  return len;
+}
+#endif /* TCP_SOCKET_WITH_GATHER */
+/*---------------------------------------------------------------------------*/
 int
 tcp_socket_send_str(struct tcp_socket *s,
              const char *str)
@@ -405,7 +535,11 @@ tcp_socket_max_sendlen(struct tcp_socket *s)
 int
 tcp_socket_queuelen(struct tcp_socket *s)
 {
+#if TCP_SOCKET_WITH_GATHER
+  return s->output_data_len + s->output_frags_len;
+#else /* TCP_SOCKET_WITH_GATHER */
   return s->output_data_len;
+#endif /* TCP_SOCKET_WITH_GATHER */
 }
 /*---------------------------------------------------------------------------*/
 #endif /* UIP_TCP */
@@ -34,8 +34,30 @@
 
 #include "uip.h"
 
+/**
+ * Let a socket send data from a list of fragments in application
+ * memory after the data in its output buffer, with
+ * tcp_socket_send_frags(). The fragments are copied straight into the
+ * outgoing segments instead of into the output buffer first.
+ */
+#ifdef TCP_SOCKET_CONF_WITH_GATHER
+#define TCP_SOCKET_WITH_GATHER TCP_SOCKET_CONF_WITH_GATHER
+#else
+#define TCP_SOCKET_WITH_GATHER 0
+#endif
+
 struct tcp_socket;
 
+#if TCP_SOCKET_WITH_GATHER
+/**
+ * A fragment of data to send, in application memory.
+ */
+struct tcp_socket_frag {
+  const uint8_t *data;
+  uint16_t len;
+};
+#endif /* TCP_SOCKET_WITH_GATHER */
+
 typedef enum {
   TCP_SOCKET_CONNECTED,
   TCP_SOCKET_CLOSED,
@@ -99,6 +121,14 @@ struct tcp_socket {
   uint16_t output_data_send_nxt;
   uint16_t output_senddata_len;
   uint16_t output_data_max_seg;
+#if TCP_SOCKET_WITH_GATHER
+  /* Fragments to send after the output buffer. The first fragment has
+     been acknowledged up to output_frag_offset. */
+  const struct tcp_socket_frag *output_frags;
+  uint32_t output_frags_len;
+  uint16_t output_frag_offset;
+  uint8_t output_frags_count;
+#endif /* TCP_SOCKET_WITH_GATHER */
 
   uint8_t flags;
   uint16_t listen_port;
@@ -224,11 +254,38 @@ int tcp_socket_unlisten(struct tcp_socket *s);
  *             data has been acknowledged by the remote host, the
  *             socket's event callback is called with the event
  *             argument set to TCP_SOCKET_DATA_SENT.
+ *
+ *             If UIP_TCP_SEND_WINDOW is more than one, uIP keeps the
+ *             sent data until it is acknowledged, and the event is
+ *             issued as soon as the data has been sent.
  */
 int tcp_socket_send(struct tcp_socket *s,
                     const uint8_t *dataptr,
                     int datalen);
 
+#if TCP_SOCKET_WITH_GATHER
+/**
+ * \brief      Send data from fragments in application memory
+ * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
+ * \param frags An array of fragments of data to be sent
+ * \param count The number of fragments
+ * \retval -1  If an error occurs
+ * \return     The number of bytes that will be sent
+ *
+ *             This function sends the fragments, in order, after the
+ *             data currently in the output buffer. The data of the
+ *             fragments is copied directly into outgoing segments,
+ *             and possibly again into retransmissions, so the array
+ *             and the data must not be changed until
+ *             tcp_socket_queuelen() returns zero. Until then,
+ *             tcp_socket_send() does not accept more data, and no
+ *             more fragments can be sent.
+ */
+int tcp_socket_send_frags(struct tcp_socket *s,
+                          const struct tcp_socket_frag *frags,
+                          int count);
+#endif /* TCP_SOCKET_WITH_GATHER */
+
 /**
  * \brief      Send a string on a connected TCP socket
  * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
@@ -291,7 +348,9 @@ int tcp_socket_max_sendlen(struct tcp_socket *s);
  *
  *             This function queries the TCP socket and returns the
  *             number of bytes that are currently not yet known to
- *             have been successfully received by the receiver.
+ *             have been successfully received by the receiver,
+ *             including the bytes of fragments sent with
+ *             tcp_socket_send_frags().
  *
  */
 int tcp_socket_queuelen(struct tcp_socket *s);
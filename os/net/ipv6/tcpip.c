@@ -347,7 +347,7 @@ eventhandler(process_event_t ev, process_data_t data)
       for(struct uip_udp_conn *cptr = &uip_udp_conns[0];
           cptr < &uip_udp_conns[UIP_UDP_CONNS]; ++cptr) {
         if(cptr->appstate.p == p) {
-          cptr->lport = 0;
+          uip_udp_remove(cptr);
         }
       }
 #endif /* UIP_UDP */
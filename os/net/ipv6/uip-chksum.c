@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ *
+ * \file
+ *         Internet checksum (RFC 1071) computation, with incremental
+ *         updates (RFC 1624) and a combined copy-and-checksum routine.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-chksum.h"
+
+#include <string.h>
+
+/*
+ * The data is summed a word at a time, in the byte order of the CPU,
+ * into an accumulator that is wide enough for the carries of all words
+ * of a packet. Since one's complement addition is commutative and
+ * byte-order independent (RFC 1071, section 2), folding the accumulator
+ * to 16 bits and swapping it to host byte order gives the same sum as
+ * adding big-endian 16-bit words one by one. Words are loaded four at
+ * a time with memcpy(), as the data need not be aligned.
+ */
+#if UIP_CHKSUM_WORD_SIZE == 4
+typedef uint32_t chksum_word_t;
+typedef uint64_t chksum_acc_t;
+#elif UIP_CHKSUM_WORD_SIZE == 2
+typedef uint16_t chksum_word_t;
+typedef uint32_t chksum_acc_t;
+#else
+#error "UIP_CHKSUM_WORD_SIZE must be 2 or 4"
+#endif
+
+/* The number of bytes that uip_chksum_copy() copies before summing them.
+   It is a multiple of the words that are summed at a time, so that all
+   but the last chunk are summed without a tail. */
+#define UIP_CHKSUM_COPY_CHUNK 256
+/*---------------------------------------------------------------------------*/
+static uint16_t
+fold(chksum_acc_t acc)
+{
+  while(acc >> 16) {
+    acc = (acc & 0xffff) + (acc >> 16);
+  }
+  return (uint16_t)acc;
+}
+/*---------------------------------------------------------------------------*/
+/* Sums the bytes that remain after the last whole word. */
+static chksum_acc_t
+add_tail(chksum_acc_t acc, const uint8_t *data, uint16_t len)
+{
+  uint16_t w;
+  uint8_t last[2];
+
+  while(len >= 2) {
+    memcpy(&w, data, 2);
+    acc += w;
+    data += 2;
+    len -= 2;
+  }
+  if(len > 0) {
+    /* The last byte is the most significant byte of a word that is
+       padded with zero. */
+    last[0] = *data;
+    last[1] = 0;
+    memcpy(&w, last, 2);
+    acc += w;
+  }
+  return acc;
+}
+/*---------------------------------------------------------------------------*/
+/* Sums the data into the accumulator, in the byte order of the CPU. */
+static chksum_acc_t
+add_words(chksum_acc_t acc, const uint8_t *data, uint16_t len)
+{
+  chksum_word_t w[4];
+
+  while(len >= sizeof(w)) {
+    memcpy(w, data, sizeof(w));
+    acc += (chksum_acc_t)w[0] + w[1] + w[2] + w[3];
+    data += sizeof(w);
+    len -= sizeof(w);
+  }
+  while(len >= sizeof(w[0])) {
+    memcpy(w, data, sizeof(w[0]));
+    acc += w[0];
+    data += sizeof(w[0]);
+    len -= sizeof(w[0]);
+  }
+  return add_tail(acc, data, len);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_add(uint16_t sum, const void *data, uint16_t len)
+{
+  return UIP_HTONS(fold(add_words(UIP_HTONS(sum), data, len)));
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_copy(uint16_t sum, void *dst, const void *src, uint16_t len)
+{
+  const uint8_t *s = src;
+  uint8_t *d = dst;
+  chksum_acc_t acc;
+  uint16_t n;
+
+  acc = UIP_HTONS(sum);
+
+  /* The data is copied and summed in chunks that stay in the cache
+     between the copy and the sum, so that it is only read from memory
+     once, while both memcpy() and the sum run at full speed. */
+  while(len > 0) {
+    n = len < UIP_CHKSUM_COPY_CHUNK ? len : UIP_CHKSUM_COPY_CHUNK;
+    memcpy(d, s, n);
+    acc = add_words(acc, s, n);
+    s += n;
+    d += n;
+    len -= n;
+  }
+
+  return UIP_HTONS(fold(acc));
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+uip_chksum_update(uint16_t chksum, uint16_t old_sum, uint16_t new_sum)
+{
+  uint32_t acc;
+
+  /* HC' = ~(~HC + ~m + m') */
+  acc = (uint16_t)~uip_ntohs(chksum);
+  acc += (uint16_t)~old_sum;
+  acc += new_sum;
+
+  return uip_htons((uint16_t)~fold(acc));
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \addtogroup uip
+ * @{
+ *
+ * \file
+ *         Internet checksum (RFC 1071) computation, with incremental
+ *         updates (RFC 1624) and a combined copy-and-checksum routine.
+ *
+ *         All partial sums are 16-bit one's complement sums of the data
+ *         taken as big-endian 16-bit words, in host byte order, as used
+ *         by uIP. A partial sum of data that starts at an even offset
+ *         can be continued with data that also starts at an even offset.
+ */
+
+#ifndef UIP_CHKSUM_H_
+#define UIP_CHKSUM_H_
+
+#include "contiki.h"
+
+#include <stdint.h>
+
+/********** Configuration  **********/
+
+/* The number of bytes that are loaded and summed at a time, 2 or 4.
+ * Four-byte words are summed into a 64-bit accumulator, which suits
+ * 32-bit CPUs and larger. */
+#ifdef UIP_CHKSUM_CONF_WORD_SIZE
+#define UIP_CHKSUM_WORD_SIZE UIP_CHKSUM_CONF_WORD_SIZE
+#elif UINTPTR_MAX > 0xffff
+#define UIP_CHKSUM_WORD_SIZE 4
+#else
+#define UIP_CHKSUM_WORD_SIZE 2
+#endif
+
+/********** Public functions **********/
+
+/**
+ * \brief Adds data to a partial Internet checksum
+ * \param sum The partial sum of the data before this data, or zero
+ * \param data The data, at an even offset from the start of the summed data
+ * \param len The length of the data
+ * \return The partial sum including the data, in host byte order
+ */
+uint16_t uip_chksum_add(uint16_t sum, const void *data, uint16_t len);
+
+/**
+ * \brief Copies data and adds it to a partial Internet checksum
+ * \param sum The partial sum of the data before this data, or zero
+ * \param dst The destination, which must not overlap the source
+ * \param src The data, at an even offset from the start of the summed data
+ * \param len The length of the data
+ * \return The partial sum including the data, in host byte order
+ *
+ * This reads the data once, where a memcpy() followed by
+ * uip_chksum_add() reads it twice.
+ */
+uint16_t uip_chksum_copy(uint16_t sum, void *dst, const void *src,
+                         uint16_t len);
+
+/**
+ * \brief Updates a checksum field after a change of the checksummed data
+ * \param chksum The checksum field, as stored in the packet
+ * \param old_sum The partial sum of the fields that were changed,
+ * before the change
+ * \param new_sum The partial sum of the same fields after the change
+ * \return The updated checksum field, to be stored in the packet
+ *
+ * This computes the new checksum field from the old one as in RFC
+ * 1624, eqn. 3, instead of summing all of the data again. Both partial
+ * sums must be computed over the fields as they are aligned in the
+ * checksummed data. A UDP checksum field that is updated to zero should
+ * be stored as 0xffff.
+ */
+uint16_t uip_chksum_update(uint16_t chksum, uint16_t old_sum,
+                           uint16_t new_sum);
+
+#endif /* UIP_CHKSUM_H_ */
+/** @} */
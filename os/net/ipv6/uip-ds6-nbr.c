@@ -46,6 +46,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include "lib/list.h"
 #include "net/link-stats.h"
 #include "net/linkaddr.h"
@@ -114,11 +115,111 @@ MEMB(uip_ds6_nbr_memb, uip_ds6_nbr_t, UIP_DS6_NBR_MAX_NEIGHBOR_CACHES);
 NBR_TABLE(uip_ds6_nbr_t, ds6_neighbors);
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+#if UIP_DS6_NBR_MULTI_IPV6_ADDRS
+#if UIP_DS6_NBR_IPADDR_INDEX_SIZE <= UIP_DS6_NBR_MAX_NEIGHBOR_CACHES
+#error "UIP_DS6_NBR_IPADDR_INDEX_SIZE must be larger than UIP_DS6_NBR_MAX_NEIGHBOR_CACHES"
+#endif
+#elif UIP_DS6_NBR_IPADDR_INDEX_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error "UIP_DS6_NBR_IPADDR_INDEX_SIZE must be larger than NBR_TABLE_MAX_NEIGHBORS"
+#endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+/* Open-addressing hash index over the neighbor cache entries, keyed by
+ * IPv6 address, using linear probing. NULL marks an empty slot. */
+static uip_ds6_nbr_t *ipaddr_index[UIP_DS6_NBR_IPADDR_INDEX_SIZE];
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
+
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+/*---------------------------------------------------------------------------*/
+/* FNV-1a hash of an IPv6 address, reduced to a slot number. Only the
+ * interface identifier of a link-local address is hashed, as all
+ * link-local addresses have the same prefix. */
+static unsigned
+ipaddr_index_hash(const uip_ipaddr_t *ipaddr)
+{
+  uint32_t hash = 2166136261UL;
+  int i;
+
+  for(i = uip_is_addr_linklocal(ipaddr) ? 8 : 0; i < 16; i++) {
+    hash ^= ipaddr->u8[i];
+    hash *= 16777619UL;
+  }
+  return hash % UIP_DS6_NBR_IPADDR_INDEX_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+ipaddr_index_next(unsigned slot)
+{
+  return slot + 1 < UIP_DS6_NBR_IPADDR_INDEX_SIZE ? slot + 1 : 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Find the slot of an IPv6 address, or -1 if it is not indexed */
+static int
+ipaddr_index_find(const uip_ipaddr_t *ipaddr)
+{
+  unsigned slot = ipaddr_index_hash(ipaddr);
+
+  /* The index is never full, so the probe ends at an empty slot */
+  while(ipaddr_index[slot] != NULL) {
+    if(uip_ipaddr_cmp(ipaddr, &ipaddr_index[slot]->ipaddr)) {
+      return slot;
+    }
+    slot = ipaddr_index_next(slot);
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+ipaddr_index_add(uip_ds6_nbr_t *nbr)
+{
+  unsigned slot = ipaddr_index_hash(&nbr->ipaddr);
+
+  while(ipaddr_index[slot] != NULL) {
+    slot = ipaddr_index_next(slot);
+  }
+  ipaddr_index[slot] = nbr;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove an entry, which must still have the IPv6 address that it was
+ * indexed with. The entry itself is searched for, since two entries
+ * may have the same IPv6 address with different link-layer addresses. */
+static void
+ipaddr_index_remove(const uip_ds6_nbr_t *nbr)
+{
+  unsigned hole;
+  unsigned slot;
+
+  hole = ipaddr_index_hash(&nbr->ipaddr);
+  while(ipaddr_index[hole] != nbr) {
+    if(ipaddr_index[hole] == NULL) {
+      return;
+    }
+    hole = ipaddr_index_next(hole);
+  }
+
+  /* Backward-shift deletion: move later entries of the probe sequence
+   * into the hole, so that lookups never need tombstones. An entry can
+   * fill the hole unless its home slot lies cyclically in (hole, slot]. */
+  for(slot = ipaddr_index_next(hole); ipaddr_index[slot] != NULL;
+      slot = ipaddr_index_next(slot)) {
+    unsigned home = ipaddr_index_hash(&ipaddr_index[slot]->ipaddr);
+    bool in_range = hole <= slot ? (hole < home && home <= slot)
+                                 : (hole < home || home <= slot);
+    if(!in_range) {
+      ipaddr_index[hole] = ipaddr_index[slot];
+      hole = slot;
+    }
+  }
+  ipaddr_index[hole] = NULL;
+}
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_neighbors_init(void)
 {
   link_stats_init();
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+  memset(ipaddr_index, 0, sizeof(ipaddr_index));
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
   memb_init(&uip_ds6_nbr_memb);
   nbr_table_register(uip_ds6_nbr_entries,
@@ -187,7 +288,22 @@ uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
     add_uip_ds6_nbr_to_nbr_entry(nbr, nbr_entry);
   }
 #else
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+  uip_ds6_nbr_t *replaced;
+
+  /* The entry of a neighbor with the same link-layer address is
+     cleared and reused for the new IPv6 address */
+  replaced = nbr_table_get_from_lladdr(ds6_neighbors, (linkaddr_t*)lladdr);
+  if(replaced != NULL) {
+    ipaddr_index_remove(replaced);
+  }
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
   nbr = nbr_table_add_lladdr(ds6_neighbors, (linkaddr_t*)lladdr, reason, data);
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+  if(nbr == NULL && replaced != NULL) {
+    ipaddr_index_add(replaced);
+  }
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
 #endif /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
   if(nbr) {
@@ -195,6 +311,9 @@ uip_ds6_nbr_add(const uip_ipaddr_t *ipaddr, const uip_lladdr_t *lladdr,
     NETSTACK_CONF_DS6_NEIGHBOR_UPDATED_CALLBACK((const linkaddr_t *)lladdr, 1);
 #endif /* NETSTACK_CONF_DS6_NEIGHBOR_ADDED_CALLBACK */
     uip_ipaddr_copy(&nbr->ipaddr, ipaddr);
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+    ipaddr_index_add(nbr);
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
 #if UIP_ND6_SEND_RA || !UIP_CONF_ROUTER
     nbr->isrouter = isrouter;
 #endif /* UIP_ND6_SEND_RA || !UIP_CONF_ROUTER */
@@ -269,6 +388,9 @@ free_uip_ds6_nbr(uip_ds6_nbr_t *nbr)
   if(nbr == NULL) {
     return;
   }
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+  ipaddr_index_remove(nbr);
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
 #if UIP_CONF_IPV6_QUEUE_PKT
   uip_packetqueue_free(&nbr->packethandle);
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
@@ -327,6 +449,10 @@ uip_ds6_nbr_rm(uip_ds6_nbr_t *nbr)
 
 #else /* UIP_DS6_NBR_MULTI_IPV6_ADDRS */
 
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+  ipaddr_index_remove(nbr);
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
+
 #if UIP_CONF_IPV6_QUEUE_PKT
   uip_packetqueue_free(&nbr->packethandle);
 #endif /* UIP_CONF_IPV6_QUEUE_PKT */
@@ -496,6 +622,14 @@ uip_ds6_nbr_next(uip_ds6_nbr_t *nbr)
 uip_ds6_nbr_t *
 uip_ds6_nbr_lookup(const uip_ipaddr_t *ipaddr)
 {
+#if UIP_DS6_NBR_WITH_IPADDR_INDEX
+  int slot;
+  if(ipaddr == NULL) {
+    return NULL;
+  }
+  slot = ipaddr_index_find(ipaddr);
+  return slot != -1 ? ipaddr_index[slot] : NULL;
+#else /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
   uip_ds6_nbr_t *nbr;
   if(ipaddr == NULL) {
     return NULL;
@@ -506,6 +640,7 @@ uip_ds6_nbr_lookup(const uip_ipaddr_t *ipaddr)
     }
   }
   return NULL;
+#endif /* UIP_DS6_NBR_WITH_IPADDR_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 uip_ds6_nbr_t *
@@ -91,6 +91,26 @@
   (NBR_TABLE_MAX_NEIGHBORS * UIP_DS6_NBR_MAX_6ADDRS_PER_NBR)
 #endif /* UIP_DS6_NBR_CONF_MAX_NEIGHBOR_CACHES */
 
+/** \brief Set non-zero (1) to keep a hash index from IPv6 address to
+ * neighbor cache entry, so that uip_ds6_nbr_lookup() does not need to
+ * walk all entries */
+#ifdef UIP_DS6_NBR_CONF_WITH_IPADDR_INDEX
+#define UIP_DS6_NBR_WITH_IPADDR_INDEX UIP_DS6_NBR_CONF_WITH_IPADDR_INDEX
+#else
+#define UIP_DS6_NBR_WITH_IPADDR_INDEX 0
+#endif /* UIP_DS6_NBR_CONF_WITH_IPADDR_INDEX */
+
+/** \brief Set the number of slots in the IPv6 address index. It must be
+ * larger than the number of neighbor cache entries; twice as large
+ * keeps probe sequences short */
+#ifdef UIP_DS6_NBR_CONF_IPADDR_INDEX_SIZE
+#define UIP_DS6_NBR_IPADDR_INDEX_SIZE UIP_DS6_NBR_CONF_IPADDR_INDEX_SIZE
+#elif UIP_DS6_NBR_MULTI_IPV6_ADDRS
+#define UIP_DS6_NBR_IPADDR_INDEX_SIZE (2 * UIP_DS6_NBR_MAX_NEIGHBOR_CACHES)
+#else
+#define UIP_DS6_NBR_IPADDR_INDEX_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS)
+#endif /* UIP_DS6_NBR_CONF_IPADDR_INDEX_SIZE */
+
 #if UIP_DS6_NBR_MULTI_IPV6_ADDRS
 /** \brief nbr_table entry when UIP_DS6_NBR_MULTI_IPV6_ADDRS is
  * enabled. uip_ds6_nbrs is a list of uip_ds6_nbr_t objects */
@@ -85,6 +85,22 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_WITH_TRIE
+/* A node of the route trie. Each node covers the first "length" bits of
+   its prefix. Nodes without a route only exist to branch between their
+   two children. */
+struct route_trie_node {
+  struct route_trie_node *child[2];
+  uip_ds6_route_t *route;
+  uip_ipaddr_t prefix;
+  uint8_t length;
+};
+
+/* Every route adds at most one route node and one branching node. */
+MEMB(routetriememb, struct route_trie_node, 2 * UIP_DS6_ROUTE_NB);
+static struct route_trie_node *route_trie;
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
+
 #endif /* (UIP_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -161,6 +177,183 @@ uip_ds6_notification_rm(struct uip_ds6_notification *n)
   list_remove(notificationlist, n);
 }
 #endif
+#if (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_TRIE
+/*---------------------------------------------------------------------------*/
+static int
+trie_bit(const uip_ipaddr_t *addr, uint8_t index)
+{
+  return (addr->u8[index >> 3] >> (7 - (index & 7))) & 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Number of leading bits, up to max, that two addresses have in common */
+static uint8_t
+trie_common_length(const uip_ipaddr_t *a, const uip_ipaddr_t *b, uint8_t max)
+{
+  uint8_t length = 0;
+  int i;
+
+  for(i = 0; i < sizeof(uip_ipaddr_t) && length < max; i++) {
+    uint8_t diff = a->u8[i] ^ b->u8[i];
+    if(diff != 0) {
+      while((diff & 0x80) == 0) {
+        diff <<= 1;
+        length++;
+      }
+      break;
+    }
+    length += 8;
+  }
+  return MIN(length, max);
+}
+/*---------------------------------------------------------------------------*/
+static int
+trie_prefix_matches(const uip_ipaddr_t *addr, const struct route_trie_node *n)
+{
+  uint8_t bytes = n->length >> 3;
+  uint8_t bits = n->length & 7;
+
+  if(memcmp(addr, &n->prefix, bytes) != 0) {
+    return 0;
+  }
+  return bits == 0 ||
+    ((addr->u8[bytes] ^ n->prefix.u8[bytes]) & (0xff << (8 - bits))) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static struct route_trie_node *
+trie_node_new(const uip_ipaddr_t *prefix, uint8_t length,
+              uip_ds6_route_t *route)
+{
+  struct route_trie_node *n = memb_alloc(&routetriememb);
+
+  if(n != NULL) {
+    n->child[0] = n->child[1] = NULL;
+    n->route = route;
+    uip_ipaddr_copy(&n->prefix, prefix);
+    n->length = length;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+trie_lookup(const uip_ipaddr_t *addr)
+{
+  struct route_trie_node *n;
+  uip_ds6_route_t *found_route = NULL;
+
+  /* Every node below a matching node is longer, so the last matching
+     node with a route holds the longest match. */
+  for(n = route_trie; n != NULL && trie_prefix_matches(addr, n);
+      n = n->length < 128 ? n->child[trie_bit(addr, n->length)] : NULL) {
+    if(n->route != NULL) {
+      found_route = n->route;
+    }
+  }
+  return found_route;
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+trie_find(const uip_ipaddr_t *prefix, uint8_t length)
+{
+  struct route_trie_node *n;
+
+  for(n = route_trie; n != NULL && n->length < length &&
+        trie_prefix_matches(prefix, n);
+      n = n->child[trie_bit(prefix, n->length)]);
+
+  if(n != NULL && n->length == length && trie_prefix_matches(prefix, n)) {
+    return n->route;
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static int
+trie_insert(uip_ds6_route_t *r)
+{
+  struct route_trie_node **link = &route_trie;
+  struct route_trie_node *n;
+  struct route_trie_node *branch;
+  struct route_trie_node *leaf;
+  uint8_t common;
+
+  while((n = *link) != NULL) {
+    common = trie_common_length(&r->ipaddr, &n->prefix,
+                                MIN(r->length, n->length));
+    if(common == n->length) {
+      if(n->length == r->length) {
+        /* Same prefix as an existing node */
+        n->route = r;
+        return 1;
+      }
+      /* The node covers our prefix, continue below it */
+      link = &n->child[trie_bit(&r->ipaddr, n->length)];
+    } else if(common == r->length) {
+      /* Our prefix covers the node: insert above it */
+      leaf = trie_node_new(&r->ipaddr, r->length, r);
+      if(leaf == NULL) {
+        return 0;
+      }
+      leaf->child[trie_bit(&n->prefix, r->length)] = n;
+      *link = leaf;
+      return 1;
+    } else {
+      /* The prefixes diverge: add a branching node at the first
+         differing bit */
+      branch = trie_node_new(&r->ipaddr, common, NULL);
+      leaf = trie_node_new(&r->ipaddr, r->length, r);
+      if(branch == NULL || leaf == NULL) {
+        memb_free(&routetriememb, branch);
+        memb_free(&routetriememb, leaf);
+        return 0;
+      }
+      branch->child[trie_bit(&r->ipaddr, common)] = leaf;
+      branch->child[trie_bit(&n->prefix, common)] = n;
+      *link = branch;
+      return 1;
+    }
+  }
+
+  *link = trie_node_new(&r->ipaddr, r->length, r);
+  return *link != NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+trie_remove(const uip_ds6_route_t *r)
+{
+  struct route_trie_node **link = &route_trie;
+  struct route_trie_node **parent_link = NULL;
+  struct route_trie_node *n;
+  struct route_trie_node *parent;
+
+  for(n = *link; n != NULL && n->route != r; n = *link) {
+    if(n->length >= r->length || !trie_prefix_matches(&r->ipaddr, n)) {
+      return;
+    }
+    parent_link = link;
+    link = &n->child[trie_bit(&r->ipaddr, n->length)];
+  }
+  if(n == NULL) {
+    return;
+  }
+
+  n->route = NULL;
+  if(n->child[0] != NULL && n->child[1] != NULL) {
+    /* Keep the node to branch between its children */
+    return;
+  }
+  *link = n->child[0] != NULL ? n->child[0] : n->child[1];
+  memb_free(&routetriememb, n);
+
+  /* The parent may now be a branching node with a single child */
+  if(parent_link != NULL) {
+    parent = *parent_link;
+    if(parent->route == NULL &&
+       (parent->child[0] == NULL || parent->child[1] == NULL)) {
+      *parent_link = parent->child[0] != NULL ? parent->child[0] : parent->child[1];
+      memb_free(&routetriememb, parent);
+    }
+  }
+}
+#endif /* (UIP_MAX_ROUTES != 0) && UIP_DS6_ROUTE_WITH_TRIE */
 /*---------------------------------------------------------------------------*/
 void
 uip_ds6_route_init(void)
@@ -168,6 +361,10 @@ uip_ds6_route_init(void)
 #if (UIP_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_WITH_TRIE
+  memb_init(&routetriememb);
+  route_trie = NULL;
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_MAX_ROUTES != 0) */
@@ -275,9 +472,11 @@ uip_ds6_route_t *
 uip_ds6_route_lookup(const uip_ipaddr_t *addr)
 {
 #if (UIP_MAX_ROUTES != 0)
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_WITH_TRIE
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif /* !UIP_DS6_ROUTE_WITH_TRIE */
 
   LOG_INFO("Looking up route for ");
   LOG_INFO_6ADDR(addr);
@@ -287,6 +486,9 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     return NULL;
   }
 
+#if UIP_DS6_ROUTE_WITH_TRIE
+  found_route = trie_lookup(addr);
+#else /* UIP_DS6_ROUTE_WITH_TRIE */
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -302,6 +504,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
 
   if(found_route != NULL) {
     LOG_INFO("Found route: ");
@@ -313,6 +516,9 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     LOG_INFO("No route found\n");
   }
 
+#if !UIP_DS6_ROUTE_WITH_TRIE || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+  /* The trie does not need the list order for fast lookups, but the
+     eviction of the least recently used route does. */
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -322,6 +528,7 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* !UIP_DS6_ROUTE_WITH_TRIE || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
 
   return found_route;
 #else /* (UIP_MAX_ROUTES != 0) */
@@ -371,6 +578,15 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
 
     uip_ds6_route_rm(r);
   }
+#if UIP_DS6_ROUTE_WITH_TRIE
+  /* The trie holds a single route per prefix, so also drop any route
+     to the exact same prefix that the longest match above did not
+     return. */
+  r = trie_find(ipaddr, length);
+  if(r != NULL) {
+    uip_ds6_route_rm(r);
+  }
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
   {
     struct uip_ds6_route_neighbor_routes *routes;
     /* If there is no routing entry, create one. We first need to
@@ -465,6 +681,16 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
 
+#if UIP_DS6_ROUTE_WITH_TRIE
+  if(!trie_insert(r)) {
+    /* This should not happen, as the trie has room for two nodes
+       per route. */
+    LOG_ERR("Add: could not allocate route trie node\n");
+    uip_ds6_route_rm(r);
+    return NULL;
+  }
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
+
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
 #endif
@@ -509,6 +735,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_WITH_TRIE
+    trie_remove(route);
+#endif /* UIP_DS6_ROUTE_WITH_TRIE */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -111,6 +111,16 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_MAX_ROUTES */
 
+/** \brief Index the routing table with a path-compressed binary trie
+ *  (Patricia trie) over the route prefixes, so that uip_ds6_route_lookup()
+ *  runs in time proportional to the prefix length instead of the number
+ *  of routes. Costs up to two trie nodes per route. */
+#ifdef UIP_DS6_ROUTE_CONF_WITH_TRIE
+#define UIP_DS6_ROUTE_WITH_TRIE UIP_DS6_ROUTE_CONF_WITH_TRIE
+#else /* UIP_DS6_ROUTE_CONF_WITH_TRIE */
+#define UIP_DS6_ROUTE_WITH_TRIE 0
+#endif /* UIP_DS6_ROUTE_CONF_WITH_TRIE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
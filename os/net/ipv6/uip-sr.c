@@ -58,6 +58,16 @@ static int num_nodes;
 LIST(nodelist);
 MEMB(nodememb, uip_sr_node_t, UIP_SR_LINK_NUM);
 
+#if UIP_SR_WITH_NODE_INDEX
+/* Hash buckets of nodes, keyed on graph and link identifier */
+static uip_sr_node_t *node_index[UIP_SR_NODE_INDEX_SIZE];
+/* Incremented whenever a parent link changes or a node is removed. This
+ * invalidates the cached reachability of all nodes at once. */
+static uint16_t topology_version;
+/* The root node that the cached reachability refers to */
+static const uip_sr_node_t *cached_root;
+#endif /* UIP_SR_WITH_NODE_INDEX */
+
 /*---------------------------------------------------------------------------*/
 int
 uip_sr_num_nodes(void)
@@ -77,24 +87,137 @@ node_matches_address(const void *graph, const uip_sr_node_t *node,
     return uip_ipaddr_cmp(&node_ipaddr, addr);
   }
 }
+#if UIP_SR_WITH_NODE_INDEX
+/*---------------------------------------------------------------------------*/
+static unsigned
+node_index_hash(const void *graph, const unsigned char *link_identifier)
+{
+  uint32_t hash = 2166136261UL ^ (uint32_t)(uintptr_t)graph;
+  int i;
+
+  for(i = 0; i < 8; i++) {
+    hash ^= link_identifier[i];
+    hash *= 16777619UL;
+  }
+  return hash % UIP_SR_NODE_INDEX_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+node_index_add(uip_sr_node_t *node)
+{
+  unsigned bucket = node_index_hash(node->graph, node->link_identifier);
+
+  node->hash_next = node_index[bucket];
+  node_index[bucket] = node;
+}
+/*---------------------------------------------------------------------------*/
+static void
+node_index_remove(uip_sr_node_t *node)
+{
+  uip_sr_node_t **l;
+
+  l = &node_index[node_index_hash(node->graph, node->link_identifier)];
+  for(; *l != NULL; l = &(*l)->hash_next) {
+    if(*l == node) {
+      *l = node->hash_next;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+topology_changed(void)
+{
+  if(++topology_version == 0) {
+    /* The version wrapped around: clear all caches so that no stale entry
+     * can match a future version. */
+    uip_sr_node_t *l;
+    for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+      l->cache_version = 0;
+    }
+    topology_version = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+node_is_reachable(uip_sr_node_t *node, const uip_sr_node_t *root_node)
+{
+  uip_sr_node_t *l;
+  int steps;
+  uint8_t reachable;
+
+  if(root_node != cached_root) {
+    cached_root = root_node;
+    topology_changed();
+  }
+
+  /* Walk towards the root until we find it, or a node whose cached
+   * reachability is still valid. */
+  for(l = node, steps = 0;
+      l != NULL && l != root_node && l->cache_version != topology_version
+        && steps < UIP_SR_LINK_NUM;
+      l = l->parent, steps++);
+
+  if(l == NULL || steps >= UIP_SR_LINK_NUM) {
+    /* Dead end or loop */
+    reachable = 0;
+  } else if(l == root_node) {
+    reachable = 1;
+  } else {
+    reachable = l->cache_reachable;
+  }
+
+  /* Cache the result for every node we walked through */
+  for(l = node; steps > 0; l = l->parent, steps--) {
+    l->cache_version = topology_version;
+    l->cache_reachable = reachable;
+  }
+
+  return reachable;
+}
+#endif /* UIP_SR_WITH_NODE_INDEX */
+/*---------------------------------------------------------------------------*/
+static void
+set_parent(uip_sr_node_t *node, uip_sr_node_t *parent)
+{
+#if UIP_SR_WITH_NODE_INDEX
+  if(node->parent != parent) {
+    topology_changed();
+  }
+#endif /* UIP_SR_WITH_NODE_INDEX */
+  node->parent = parent;
+}
 /*---------------------------------------------------------------------------*/
 uip_sr_node_t *
 uip_sr_get_node(const void *graph, const uip_ipaddr_t *addr)
 {
   uip_sr_node_t *l;
+#if UIP_SR_WITH_NODE_INDEX
+  if(addr == NULL) {
+    return NULL;
+  }
+  l = node_index[node_index_hash(graph, &addr->u8[8])];
+  for(; l != NULL; l = l->hash_next) {
+    /* Compare node identifier first, then prefix */
+    if(memcmp(l->link_identifier, &addr->u8[8], 8) == 0
+       && node_matches_address(graph, l, addr)) {
+      return l;
+    }
+  }
+#else /* UIP_SR_WITH_NODE_INDEX */
   for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
     /* Compare prefix and node identifier */
     if(node_matches_address(graph, l, addr)) {
       return l;
     }
   }
+#endif /* UIP_SR_WITH_NODE_INDEX */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
 int
 uip_sr_is_addr_reachable(const void *graph, const uip_ipaddr_t *addr)
 {
-  int max_depth = UIP_SR_LINK_NUM;
   uip_ipaddr_t root_ipaddr;
   uip_sr_node_t *node;
   uip_sr_node_t *root_node;
@@ -103,11 +226,17 @@ uip_sr_is_addr_reachable(const void *graph, const uip_ipaddr_t *addr)
   node = uip_sr_get_node(graph, addr);
   root_node = uip_sr_get_node(graph, &root_ipaddr);
 
+#if UIP_SR_WITH_NODE_INDEX
+  return node != NULL && node_is_reachable(node, root_node);
+#else /* UIP_SR_WITH_NODE_INDEX */
+  int max_depth = UIP_SR_LINK_NUM;
+
   while(node != NULL && node != root_node && max_depth > 0) {
     node = node->parent;
     max_depth--;
   }
   return node != NULL && node == root_node;
+#endif /* UIP_SR_WITH_NODE_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -153,29 +282,33 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child,
       return NULL;
     }
     child_node->parent = NULL;
+    child_node->graph = graph;
+    memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
     list_add(nodelist, child_node);
     num_nodes++;
+#if UIP_SR_WITH_NODE_INDEX
+    child_node->cache_version = 0;
+    node_index_add(child_node);
+#endif /* UIP_SR_WITH_NODE_INDEX */
   }
 
   /* Initialize node */
-  child_node->graph = graph;
   child_node->lifetime = lifetime;
-  memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
 
   /* Is the node reachable before the update? */
   if(uip_sr_is_addr_reachable(graph, child)) {
     old_parent_node = child_node->parent;
     /* Update node */
-    child_node->parent = parent_node;
+    set_parent(child_node, parent_node);
     /* Has the node become unreachable? May happen if we create a loop. */
     if(!uip_sr_is_addr_reachable(graph, child)) {
       /* The new parent makes the node unreachable, restore old parent.
        * We will take the update next time, with chances we know more of
        * the topology and the loop is gone. */
-      child_node->parent = old_parent_node;
+      set_parent(child_node, old_parent_node);
     }
   } else {
-    child_node->parent = parent_node;
+    set_parent(child_node, parent_node);
   }
 
   LOG_INFO("NS: updating link, child ");
@@ -193,6 +326,11 @@ uip_sr_init(void)
   num_nodes = 0;
   memb_init(&nodememb);
   list_init(nodelist);
+#if UIP_SR_WITH_NODE_INDEX
+  memset(node_index, 0, sizeof(node_index));
+  topology_version = 1;
+  cached_root = NULL;
+#endif /* UIP_SR_WITH_NODE_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 uip_sr_node_t *
@@ -235,6 +373,10 @@ uip_sr_periodic(unsigned seconds)
           LOG_INFO_("\n");
         }
         list_remove(nodelist, l);
+#if UIP_SR_WITH_NODE_INDEX
+        node_index_remove(l);
+        topology_changed();
+#endif /* UIP_SR_WITH_NODE_INDEX */
         memb_free(&nodememb, l);
         num_nodes--;
       }
@@ -255,6 +397,10 @@ uip_sr_free_all(void)
     memb_free(&nodememb, l);
     num_nodes--;
   }
+#if UIP_SR_WITH_NODE_INDEX
+  memset(node_index, 0, sizeof(node_index));
+  topology_changed();
+#endif /* UIP_SR_WITH_NODE_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -85,6 +85,23 @@
 
 #define UIP_SR_INFINITE_LIFETIME           0xFFFFFFFF
 
+/* Keep a hash index of nodes keyed on graph and link identifier, and cache
+ * the reachability of each node until the topology changes. This makes
+ * node lookups and reachability checks at large non-storing roots run in
+ * constant time instead of scanning every node. */
+#ifdef UIP_SR_CONF_WITH_NODE_INDEX
+#define UIP_SR_WITH_NODE_INDEX        UIP_SR_CONF_WITH_NODE_INDEX
+#else /* UIP_SR_CONF_WITH_NODE_INDEX */
+#define UIP_SR_WITH_NODE_INDEX        0
+#endif /* UIP_SR_CONF_WITH_NODE_INDEX */
+
+/* The number of hash buckets of the node index */
+#ifdef UIP_SR_CONF_NODE_INDEX_SIZE
+#define UIP_SR_NODE_INDEX_SIZE        UIP_SR_CONF_NODE_INDEX_SIZE
+#else /* UIP_SR_CONF_NODE_INDEX_SIZE */
+#define UIP_SR_NODE_INDEX_SIZE        (UIP_SR_LINK_NUM / 2 + 1)
+#endif /* UIP_SR_CONF_NODE_INDEX_SIZE */
+
 /********** Data Structures  **********/
 
 /** \brief A node in a source routing graph, stored at the root and representing
@@ -98,6 +115,13 @@ typedef struct uip_sr_node {
   us with the prefix */
   unsigned char link_identifier[8];
   struct uip_sr_node *parent;
+#if UIP_SR_WITH_NODE_INDEX
+  /* Next node in the same hash bucket */
+  struct uip_sr_node *hash_next;
+  /* Topology version for which the cached values below are valid */
+  uint16_t cache_version;
+  uint8_t cache_reachable;
+#endif /* UIP_SR_WITH_NODE_INDEX */
 } uip_sr_node_t;
 
 /********** Public functions **********/
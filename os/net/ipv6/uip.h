@@ -773,7 +773,9 @@ void uip_send(const void *data, int len);
  * The current maximum segment size that can be sent on the
  * connection is computed from the receiver's window and the MSS of
  * the connection (which also is available by calling
- * uip_initialmss()).
+ * uip_initialmss()). If UIP_TCP_SEND_WINDOW is more than one, it is
+ * also limited by the free space in the retransmission buffer of the
+ * connection, and it is zero when the buffer is full.
  *
  * \hideinitializer
  */
@@ -815,7 +817,11 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \hideinitializer
  */
+#if UIP_UDP_WITH_PORT_HASH
+void uip_udp_remove(struct uip_udp_conn *conn);
+#else /* UIP_UDP_WITH_PORT_HASH */
 #define uip_udp_remove(conn) (conn)->lport = 0
+#endif /* UIP_UDP_WITH_PORT_HASH */
 
 /**
  * Bind a UDP connection to a local port.
@@ -825,9 +831,16 @@ struct uip_udp_conn *uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport);
  *
  * \param port The local port number, in network byte order.
  *
+ * With UIP_UDP_WITH_PORT_HASH, binding a connection to port zero
+ * removes it, as without the hash table.
+ *
  * \hideinitializer
  */
+#if UIP_UDP_WITH_PORT_HASH
+void uip_udp_bind(struct uip_udp_conn *conn, uint16_t port);
+#else /* UIP_UDP_WITH_PORT_HASH */
 #define uip_udp_bind(conn, port) (conn)->lport = port
+#endif /* UIP_UDP_WITH_PORT_HASH */
 
 /**
  * Send a UDP datagram of length len on the current connection.
@@ -1275,6 +1288,18 @@ struct uip_conn {
   uint8_t timer;         /**< The retransmission timer. */
   uint8_t nrtx;          /**< The number of retransmissions for the last
                               segment sent. */
+#if UIP_TCP_SEND_WINDOW > 1
+  uint16_t snd_wnd;      /**< The window advertised by the remote host. */
+  uint16_t sent;         /**< Length of the buffered data that has been sent. */
+  uint16_t txhead;       /**< Offset of the first buffered byte in txbuf. */
+  uint8_t cwnd;          /**< Congestion window, in segments. */
+  uint8_t ssthresh;      /**< Slow start threshold, in segments. */
+  uint8_t cwnd_acked;    /**< Segments acknowledged since cwnd grew. */
+  uint8_t dupacks;       /**< Number of duplicate ACKs in a row. */
+  uint8_t fin_pending;   /**< Send a FIN when all data is acknowledged. */
+  uint8_t txbuf[UIP_TCP_SEND_WINDOW * UIP_TCP_MSS]; /**< Data that has not
+                                                          been acknowledged. */
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
   uip_tcp_appstate_t appstate; /** The application state. */
 };
 
@@ -1311,6 +1336,11 @@ struct uip_udp_conn {
   uint16_t lport;        /**< The local port number in network byte order. */
   uint16_t rport;        /**< The remote port number in network byte order. */
   uint8_t  ttl;          /**< Default time-to-live. */
+#if UIP_UDP_WITH_PORT_HASH
+  /** The next connection in the same port hash bucket, or in the list
+      of unused connections. */
+  struct uip_udp_conn *hash_next;
+#endif /* UIP_UDP_WITH_PORT_HASH */
   /** The application state. */
   uip_udp_appstate_t appstate;
 };
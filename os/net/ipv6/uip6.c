@@ -74,6 +74,7 @@
 #include "sys/cc.h"
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-arch.h"
+#include "net/ipv6/uip-chksum.h"
 #include "net/ipv6/uipopt.h"
 #include "net/ipv6/uip-icmp6.h"
 #include "net/ipv6/uip-nd6.h"
@@ -229,6 +230,15 @@ uint8_t uip_acc32[4];
 #if UIP_UDP
 struct uip_udp_conn *uip_udp_conn;
 struct uip_udp_conn uip_udp_conns[UIP_UDP_CONNS];
+#if UIP_UDP_WITH_PORT_HASH
+/* The connections in use, chained by the hash of their local port.
+   Each chain is in the order of uip_udp_conns[]. */
+static struct uip_udp_conn *udp_port_hash[UIP_UDP_PORT_HASH_SIZE];
+/* The connections that are not in use, chained through hash_next. */
+static struct uip_udp_conn *udp_free_conns;
+#define UDP_PORT_HASH(port) \
+  (((port) ^ ((port) >> 8)) & (UIP_UDP_PORT_HASH_SIZE - 1))
+#endif /* UIP_UDP_WITH_PORT_HASH */
 #endif /* UIP_UDP */
 /** @} */
 
@@ -278,41 +288,10 @@ uip_add32(uint8_t *op32, uint16_t op16)
 
 #if ! UIP_ARCH_CHKSUM
 /*---------------------------------------------------------------------------*/
-static uint16_t
-chksum(uint16_t sum, const uint8_t *data, uint16_t len)
-{
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-
-  while(dataptr < last_byte) {   /* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
-    dataptr += 2;
-  }
-
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;      /* carry */
-    }
-  }
-
-  /* Return sum in host byte order. */
-  return sum;
-}
-/*---------------------------------------------------------------------------*/
 uint16_t
 uip_chksum(uint16_t *data, uint16_t len)
 {
-  return uip_htons(chksum(0, (uint8_t *)data, len));
+  return uip_htons(uip_chksum_add(0, data, len));
 }
 /*---------------------------------------------------------------------------*/
 #ifndef UIP_ARCH_IPCHKSUM
@@ -321,14 +300,14 @@ uip_ipchksum(void)
 {
   uint16_t sum;
 
-  sum = chksum(0, uip_buf, UIP_IPH_LEN);
+  sum = uip_chksum_add(0, uip_buf, UIP_IPH_LEN);
   LOG_DBG("uip_ipchksum: sum 0x%04x\n", sum);
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
 #endif
 /*---------------------------------------------------------------------------*/
 static uint16_t
-upper_layer_chksum(uint8_t proto)
+upper_layer_chksum(uint8_t proto, bool input)
 {
 /* gcc 4.4.0 - 4.6.1 (maybe 4.3...) with -Os on 8 bit CPUS incorrectly compiles:
  * int bar (int);
@@ -340,7 +319,7 @@ upper_layer_chksum(uint8_t proto)
  * See https://sourceforge.net/apps/mantisbt/contiki/view.php?id=3
  */
   volatile uint16_t upper_layer_len;
-  uint16_t sum;
+  uint16_t sum, start, offset, len, payload_sum;
 
   upper_layer_len = uipbuf_get_len_field(UIP_IP_BUF) - uip_ext_len;
 
@@ -351,10 +330,31 @@ upper_layer_chksum(uint8_t proto)
   /* IP protocol and length fields. This addition cannot carry. */
   sum = upper_layer_len + proto;
   /* Sum IP source and destination addresses. */
-  sum = chksum(sum, (uint8_t *)&UIP_IP_BUF->srcipaddr, 2 * sizeof(uip_ipaddr_t));
-
-  /* Sum upper-layer header and data. */
-  sum = chksum(sum, UIP_IP_PAYLOAD(uip_ext_len), upper_layer_len);
+  sum = uip_chksum_add(sum, &UIP_IP_BUF->srcipaddr, 2 * sizeof(uip_ipaddr_t));
+
+  /* Sum upper-layer header and data. When checking a received packet,
+     the link layer may already have summed the data at the end of it
+     while copying it into uip_buf. */
+  len = upper_layer_len;
+  if(input && uipbuf_get_attr(UIPBUF_ATTR_PAYLOAD_LEN) > 0) {
+    start = UIP_IP_PAYLOAD(uip_ext_len) - uip_buf;
+    offset = uipbuf_get_attr(UIPBUF_ATTR_PAYLOAD_OFFSET);
+    if(offset >= start && offset - start <= upper_layer_len &&
+       uipbuf_get_attr(UIPBUF_ATTR_PAYLOAD_LEN) ==
+       upper_layer_len - (offset - start)) {
+      len = offset - start;
+      payload_sum = uipbuf_get_attr(UIPBUF_ATTR_PAYLOAD_CHKSUM);
+      if(len & 1) {
+        /* The data was summed from an even offset. */
+        payload_sum = (payload_sum << 8) | (payload_sum >> 8);
+      }
+      sum += payload_sum;
+      if(sum < payload_sum) {
+        sum++;      /* carry */
+      }
+    }
+  }
+  sum = uip_chksum_add(sum, UIP_IP_PAYLOAD(uip_ext_len), len);
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -362,7 +362,7 @@ upper_layer_chksum(uint8_t proto)
 uint16_t
 uip_icmp6chksum(void)
 {
-  return upper_layer_chksum(UIP_PROTO_ICMP6);
+  return upper_layer_chksum(UIP_PROTO_ICMP6, false);
 
 }
 /*---------------------------------------------------------------------------*/
@@ -370,7 +370,7 @@ uip_icmp6chksum(void)
 uint16_t
 uip_tcpchksum(void)
 {
-  return upper_layer_chksum(UIP_PROTO_TCP);
+  return upper_layer_chksum(UIP_PROTO_TCP, false);
 }
 #endif /* UIP_TCP */
 /*---------------------------------------------------------------------------*/
@@ -378,9 +378,14 @@ uip_tcpchksum(void)
 uint16_t
 uip_udpchksum(void)
 {
-  return upper_layer_chksum(UIP_PROTO_UDP);
+  return upper_layer_chksum(UIP_PROTO_UDP, false);
 }
 #endif /* UIP_UDP && UIP_UDP_CHECKSUMS */
+/* Checks received packets, using the checksum of the payload that
+   the link layer may have computed. */
+#define upper_layer_input_chksum(proto, f) upper_layer_chksum(proto, true)
+#else /* UIP_ARCH_CHKSUM */
+#define upper_layer_input_chksum(proto, f) f()
 #endif /* UIP_ARCH_CHKSUM */
 /*---------------------------------------------------------------------------*/
 void
@@ -408,6 +413,14 @@ uip_init(void)
   for(int c = 0; c < UIP_UDP_CONNS; ++c) {
     uip_udp_conns[c].lport = 0;
   }
+#if UIP_UDP_WITH_PORT_HASH
+  memset(udp_port_hash, 0, sizeof(udp_port_hash));
+  udp_free_conns = NULL;
+  for(int c = UIP_UDP_CONNS - 1; c >= 0; --c) {
+    uip_udp_conns[c].hash_next = udp_free_conns;
+    udp_free_conns = &uip_udp_conns[c];
+  }
+#endif /* UIP_UDP_WITH_PORT_HASH */
 #endif /* UIP_UDP */
 
 #if UIP_IPV6_MULTICAST
@@ -516,12 +529,146 @@ uip_remove_ext_hdr(void)
 }
 /*---------------------------------------------------------------------------*/
 #if UIP_UDP
+#if UIP_UDP_WITH_PORT_HASH
+static void
+udp_hash_add(struct uip_udp_conn *conn)
+{
+  struct uip_udp_conn **p;
+
+  /* Keep the chain in the order of uip_udp_conns[], so that a datagram
+     that matches several connections equally well goes to the same
+     connection as with a scan of uip_udp_conns[] */
+  p = &udp_port_hash[UDP_PORT_HASH(conn->lport)];
+  while(*p != NULL && *p < conn) {
+    p = &(*p)->hash_next;
+  }
+  conn->hash_next = *p;
+  *p = conn;
+}
+/*---------------------------------------------------------------------------*/
+static void
+udp_list_remove(struct uip_udp_conn **p, struct uip_udp_conn *conn)
+{
+  while(*p != NULL) {
+    if(*p == conn) {
+      *p = conn->hash_next;
+      return;
+    }
+    p = &(*p)->hash_next;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct uip_udp_conn *
+udp_port_lookup(uint16_t lport)
+{
+  struct uip_udp_conn *conn;
+
+  for(conn = udp_port_hash[UDP_PORT_HASH(lport)];
+      conn != NULL;
+      conn = conn->hash_next) {
+    if(conn->lport == lport) {
+      return conn;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Finds the connection for a received datagram. A connection that is
+   bound to the remote port and address of the datagram takes
+   precedence over one that accepts any remote port or address. */
+static struct uip_udp_conn *
+udp_demux(void)
+{
+  struct uip_udp_conn *conn, *best;
+  uint8_t bound, best_bound;
+
+  best = NULL;
+  best_bound = 0;
+  for(conn = udp_port_hash[UDP_PORT_HASH(UIP_UDP_BUF->destport)];
+      conn != NULL;
+      conn = conn->hash_next) {
+    if(UIP_UDP_BUF->destport != conn->lport) {
+      continue;
+    }
+    bound = 0;
+    if(conn->rport != 0) {
+      if(UIP_UDP_BUF->srcport != conn->rport) {
+        continue;
+      }
+      bound++;
+    }
+    if(!uip_is_addr_unspecified(&conn->ripaddr)) {
+      if(!uip_ipaddr_cmp(&UIP_IP_BUF->srcipaddr, &conn->ripaddr)) {
+        continue;
+      }
+      bound++;
+    }
+    if(bound == 2) {
+      return conn;
+    }
+    if(best == NULL || bound > best_bound) {
+      best = conn;
+      best_bound = bound;
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_remove(struct uip_udp_conn *conn)
+{
+  if(conn->lport == 0) {
+    return;
+  }
+  udp_list_remove(&udp_port_hash[UDP_PORT_HASH(conn->lport)], conn);
+  conn->lport = 0;
+  conn->hash_next = udp_free_conns;
+  udp_free_conns = conn;
+}
+/*---------------------------------------------------------------------------*/
+void
+uip_udp_bind(struct uip_udp_conn *conn, uint16_t port)
+{
+  if(port == 0) {
+    uip_udp_remove(conn);
+    return;
+  }
+  if(conn->lport == 0) {
+    /* A removed connection that is bound again is in use again */
+    udp_list_remove(&udp_free_conns, conn);
+  } else {
+    udp_list_remove(&udp_port_hash[UDP_PORT_HASH(conn->lport)], conn);
+  }
+  conn->lport = port;
+  udp_hash_add(conn);
+}
+#endif /* UIP_UDP_WITH_PORT_HASH */
+/*---------------------------------------------------------------------------*/
 struct uip_udp_conn *
 uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
 {
-  int c;
   register struct uip_udp_conn *conn;
 
+#if UIP_UDP_WITH_PORT_HASH
+  conn = udp_free_conns;
+  if(conn == NULL) {
+    return 0;
+  }
+
+  /* Find an unused local port. */
+  do {
+    ++lastport;
+    if(lastport >= 32000) {
+      lastport = 4096;
+    }
+  } while(udp_port_lookup(UIP_HTONS(lastport)) != NULL);
+
+  udp_free_conns = conn->hash_next;
+  conn->lport = UIP_HTONS(lastport);
+  udp_hash_add(conn);
+#else /* UIP_UDP_WITH_PORT_HASH */
+  int c;
+
   /* Find an unused local port. */
   again:
   ++lastport;
@@ -549,6 +696,7 @@ uip_udp_new(const uip_ipaddr_t *ripaddr, uint16_t rport)
   }
 
   conn->lport = UIP_HTONS(lastport);
+#endif /* UIP_UDP_WITH_PORT_HASH */
   conn->rport = rport;
   if(ripaddr == NULL) {
     memset(&conn->ripaddr, 0, sizeof(uip_ipaddr_t));
@@ -970,6 +1118,176 @@ process_tcp_options(struct uip_conn *conn)
     }
   }
 }
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP_SEND_WINDOW > 1
+/* Once the application has closed a connection, it is no longer called
+   while the FIN waits for the buffered data to be acknowledged. */
+#define TCP_APPCALL(conn) do {                  \
+    if(!(conn)->fin_pending) {                  \
+      UIP_APPCALL();                            \
+    }                                           \
+  } while(0)
+#else /* UIP_TCP_SEND_WINDOW > 1 */
+#define TCP_APPCALL(conn) UIP_APPCALL()
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
+/*---------------------------------------------------------------------------*/
+static void
+update_rto(struct uip_conn *conn)
+{
+  signed char m;
+  m = conn->rto - conn->timer;
+  /* This is taken directly from VJs original code in his paper */
+  m = m - (conn->sa >> 3);
+  conn->sa += m;
+  if(m < 0) {
+    m = -m;
+  }
+  m = m - (conn->sv >> 2);
+  conn->sv += m;
+  conn->rto = (conn->sa >> 3) + conn->sv;
+}
+/*---------------------------------------------------------------------------*/
+#if UIP_TCP_SEND_WINDOW > 1
+#define TCP_TXBUF_SIZE (UIP_TCP_SEND_WINDOW * UIP_TCP_MSS)
+
+/* Limits the data that the application can send to the free space of
+   the retransmission buffer. */
+static void
+tcp_update_mss(struct uip_conn *conn)
+{
+  conn->mss = MIN(conn->initialmss, TCP_TXBUF_SIZE - conn->len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+tcp_update_snd_wnd(struct uip_conn *conn)
+{
+  conn->snd_wnd = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + UIP_TCP_BUF->wnd[1];
+  if(conn->snd_wnd == 0) {
+    /* Probe a zero window with a segment, which is retransmitted until
+       the window opens, as with the stop-and-wait window. */
+    conn->snd_wnd = conn->initialmss;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+tcp_window_init(struct uip_conn *conn)
+{
+  conn->len = 0;
+  conn->sent = 0;
+  conn->txhead = 0;
+  conn->cwnd = 1;
+  conn->ssthresh = UIP_TCP_SEND_WINDOW;
+  conn->cwnd_acked = 0;
+  conn->dupacks = 0;
+  conn->fin_pending = 0;
+  tcp_update_snd_wnd(conn);
+  tcp_update_mss(conn);
+}
+/*---------------------------------------------------------------------------*/
+/* Appends data that the application has sent to the retransmission
+   buffer. */
+static void
+tcp_buffer_data(struct uip_conn *conn, const uint8_t *data, uint16_t len)
+{
+  uint16_t pos, n;
+
+  pos = (conn->txhead + conn->len) % TCP_TXBUF_SIZE;
+  n = MIN(len, TCP_TXBUF_SIZE - pos);
+  memmove(&conn->txbuf[pos], data, n);
+  memmove(conn->txbuf, data + n, len - n);
+  conn->len += len;
+  tcp_update_mss(conn);
+}
+/*---------------------------------------------------------------------------*/
+/* Copies buffered data, starting at an offset from the first
+   unacknowledged byte, into the outgoing segment. */
+static void
+tcp_copy_segment(struct uip_conn *conn, uint16_t offset, uint16_t len)
+{
+  uint16_t pos, n;
+
+  pos = (conn->txhead + offset) % TCP_TXBUF_SIZE;
+  n = MIN(len, TCP_TXBUF_SIZE - pos);
+  memmove(uip_sappdata, &conn->txbuf[pos], n);
+  memmove((uint8_t *)uip_sappdata + n, conn->txbuf, len - n);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+seqno32(const uint8_t *seqno)
+{
+  return (uint32_t)seqno[0] << 24 | (uint32_t)seqno[1] << 16 |
+    (uint32_t)seqno[2] << 8 | seqno[3];
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the length of the next segment of buffered data that the
+   congestion window and the window of the remote host allow us to send. */
+static uint16_t
+tcp_sendable(struct uip_conn *conn)
+{
+  uint32_t wnd;
+
+  wnd = MIN((uint32_t)conn->cwnd * conn->initialmss, conn->snd_wnd);
+  if(conn->sent >= wnd || conn->sent >= conn->len) {
+    return 0;
+  }
+  return MIN(MIN(wnd - conn->sent, conn->len - conn->sent), conn->initialmss);
+}
+/*---------------------------------------------------------------------------*/
+/* Processes an ACK in the ESTABLISHED state, where it may acknowledge
+   any part of the buffered data. Returns non-zero if the ACK is the
+   third duplicate ACK in a row, in which case the first unacknowledged
+   segment should be retransmitted right away. */
+static int
+tcp_window_ack(struct uip_conn *conn)
+{
+  uint32_t acked;
+
+  acked = seqno32(UIP_TCP_BUF->ackno) - seqno32(conn->snd_nxt);
+  if(acked == 0) {
+    if(uip_len == 0 && conn->sent > 0 && ++conn->dupacks == 3) {
+      conn->ssthresh = MAX(conn->cwnd / 2, 2);
+      conn->cwnd = conn->ssthresh;
+      conn->cwnd_acked = 0;
+      return 1;
+    }
+    return 0;
+  }
+  if(acked > conn->len) {
+    /* The ACK is old, or acknowledges data that we have not sent. */
+    return 0;
+  }
+
+  uip_add32(conn->snd_nxt, acked);
+  memcpy(conn->snd_nxt, uip_acc32, sizeof(conn->snd_nxt));
+
+  /* Do RTT estimation, unless we have done retransmissions. */
+  if(conn->nrtx == 0) {
+    update_rto(conn);
+  }
+  conn->nrtx = 0;
+  conn->timer = conn->rto;
+
+  conn->txhead = (conn->txhead + acked) % TCP_TXBUF_SIZE;
+  conn->len -= acked;
+  conn->sent = acked < conn->sent ? conn->sent - acked : 0;
+  conn->dupacks = 0;
+
+  /* Slow start, followed by congestion avoidance. */
+  if(conn->cwnd < conn->ssthresh) {
+    conn->cwnd++;
+  } else if(++conn->cwnd_acked >= conn->cwnd) {
+    conn->cwnd++;
+    conn->cwnd_acked = 0;
+  }
+  if(conn->cwnd > UIP_TCP_SEND_WINDOW) {
+    conn->cwnd = UIP_TCP_SEND_WINDOW;
+  }
+
+  tcp_update_mss(conn);
+  uip_flags = UIP_ACKDATA;
+  return 0;
+}
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 #endif /* UIP_TCP */
 /*---------------------------------------------------------------------------*/
 static bool
@@ -1007,6 +1325,10 @@ uip_process(uint8_t flag)
 #if UIP_TCP
   int c;
   register struct uip_conn *uip_connr = uip_conn;
+#if UIP_TCP_SEND_WINDOW > 1
+  uint16_t snd_offset = 0;
+  int fast_rexmit = 0;
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 #endif /* UIP_TCP */
 #if UIP_UDP
   if(flag == UIP_UDP_SEND_CONN) {
@@ -1020,9 +1342,10 @@ uip_process(uint8_t flag)
   if(flag == UIP_POLL_REQUEST) {
 #if UIP_TCP
     if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED &&
-       !uip_outstanding(uip_connr)) {
+       (UIP_TCP_SEND_WINDOW > 1 || !uip_outstanding(uip_connr))) {
       uip_flags = UIP_POLL;
-      UIP_APPCALL();
+      uip_slen = 0;
+      TCP_APPCALL(uip_connr);
       goto appsend;
 #if UIP_ACTIVE_OPEN
     } else if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_SYN_SENT) {
@@ -1116,6 +1439,19 @@ uip_process(uint8_t flag)
 #endif /* UIP_ACTIVE_OPEN */
 
           case UIP_ESTABLISHED:
+#if UIP_TCP_SEND_WINDOW > 1
+            /*
+             * Go back to the first unacknowledged segment and send the
+             * buffered data again, starting with a congestion window
+             * of one segment.
+             */
+            uip_connr->ssthresh = MAX(uip_connr->cwnd / 2, 2);
+            uip_connr->cwnd = 1;
+            uip_connr->cwnd_acked = 0;
+            uip_connr->dupacks = 0;
+            uip_connr->sent = 0;
+            uip_flags = 0;
+#else /* UIP_TCP_SEND_WINDOW > 1 */
             /*
              * In the ESTABLISHED state, we call upon the application
              * to do the actual retransmit after which we jump into
@@ -1124,6 +1460,7 @@ uip_process(uint8_t flag)
              */
             uip_flags = UIP_REXMIT;
             UIP_APPCALL();
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
             goto apprexmit;
 
           case UIP_FIN_WAIT_1:
@@ -1133,13 +1470,18 @@ uip_process(uint8_t flag)
             goto tcp_send_finack;
           }
         }
+#if UIP_TCP_SEND_WINDOW > 1
+      }
+      if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+#else /* UIP_TCP_SEND_WINDOW > 1 */
       } else if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
         /*
          * If there was no need for a retransmission, we poll the
          * application for new data.
          */
         uip_flags = UIP_POLL;
-        UIP_APPCALL();
+        TCP_APPCALL(uip_connr);
         goto appsend;
       }
     }
@@ -1502,7 +1844,7 @@ uip_process(uint8_t flag)
 
 #if UIP_CONF_IPV6_CHECKS
   /* Compute and check the ICMP header checksum */
-  if(uip_icmp6chksum() != 0xffff) {
+  if(upper_layer_input_chksum(UIP_PROTO_ICMP6, uip_icmp6chksum) != 0xffff) {
     UIP_STAT(++uip_stat.icmp.drop);
     UIP_STAT(++uip_stat.icmp.chkerr);
     LOG_ERR("icmpv6 bad checksum\n");
@@ -1562,7 +1904,8 @@ uip_process(uint8_t flag)
      0. This is to be able to debug code that for one reason or
      another miscomputes UDP checksums. The reception of zero UDP
      checksums should be turned into a configration option. */
-  if(UIP_UDP_BUF->udpchksum != 0 && uip_udpchksum() != 0xffff) {
+  if(UIP_UDP_BUF->udpchksum != 0 &&
+     upper_layer_input_chksum(UIP_PROTO_UDP, uip_udpchksum) != 0xffff) {
     UIP_STAT(++uip_stat.udp.drop);
     UIP_STAT(++uip_stat.udp.chkerr);
     LOG_ERR("udp: bad checksum 0x%04x 0x%04x\n", UIP_UDP_BUF->udpchksum,
@@ -1578,6 +1921,12 @@ uip_process(uint8_t flag)
   }
 
   /* Demultiplex this UDP packet between the UDP "connections". */
+#if UIP_UDP_WITH_PORT_HASH
+  uip_udp_conn = udp_demux();
+  if(uip_udp_conn != NULL) {
+    goto udp_found;
+  }
+#else /* UIP_UDP_WITH_PORT_HASH */
   for(uip_udp_conn = &uip_udp_conns[0];
       uip_udp_conn < &uip_udp_conns[UIP_UDP_CONNS];
       ++uip_udp_conn) {
@@ -1597,6 +1946,7 @@ uip_process(uint8_t flag)
       goto udp_found;
     }
   }
+#endif /* UIP_UDP_WITH_PORT_HASH */
   LOG_ERR("udp: no matching connection found\n");
   UIP_STAT(++uip_stat.udp.drop);
 
@@ -1665,8 +2015,8 @@ uip_process(uint8_t flag)
   LOG_INFO("Receiving TCP packet\n");
   /* Start of TCP input header processing code. */
 
-  if(uip_tcpchksum() != 0xffff) {   /* Compute and check the TCP
-                                       checksum. */
+  /* Compute and check the TCP checksum. */
+  if(upper_layer_input_chksum(UIP_PROTO_TCP, uip_tcpchksum) != 0xffff) {
     UIP_STAT(++uip_stat.tcp.drop);
     UIP_STAT(++uip_stat.tcp.chkerr);
     LOG_ERR("tcp: bad checksum 0x%04x 0x%04x\n", UIP_TCP_BUF->tcpchksum,
@@ -1910,6 +2260,13 @@ uip_process(uint8_t flag)
      data. If so, we update the sequence number, reset the length of
      the outstanding data, calculate RTT estimations, and reset the
      retransmission timer. */
+#if UIP_TCP_SEND_WINDOW > 1
+  if((uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+    if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
+      fast_rexmit = tcp_window_ack(uip_connr);
+    }
+  } else
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
   if((UIP_TCP_BUF->flags & TCP_ACK) && uip_outstanding(uip_connr)) {
     uip_add32(uip_connr->snd_nxt, uip_connr->len);
 
@@ -1925,18 +2282,7 @@ uip_process(uint8_t flag)
 
       /* Do RTT estimation, unless we have done retransmissions. */
       if(uip_connr->nrtx == 0) {
-        signed char m;
-        m = uip_connr->rto - uip_connr->timer;
-        /* This is taken directly from VJs original code in his paper */
-        m = m - (uip_connr->sa >> 3);
-        uip_connr->sa += m;
-        if(m < 0) {
-          m = -m;
-        }
-        m = m - (uip_connr->sv >> 2);
-        uip_connr->sv += m;
-        uip_connr->rto = (uip_connr->sa >> 3) + uip_connr->sv;
-
+        update_rto(uip_connr);
       }
       /* Set the acknowledged flag. */
       uip_flags = UIP_ACKDATA;
@@ -1964,6 +2310,9 @@ uip_process(uint8_t flag)
       uip_connr->tcpstateflags = UIP_ESTABLISHED;
       uip_flags = UIP_CONNECTED;
       uip_connr->len = 0;
+#if UIP_TCP_SEND_WINDOW > 1
+      tcp_window_init(uip_connr);
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
       if(uip_len > 0) {
         uip_flags |= UIP_NEWDATA;
         uip_add_rcv_nxt(uip_len);
@@ -1996,6 +2345,9 @@ uip_process(uint8_t flag)
       uip_add_rcv_nxt(1);
       uip_flags = UIP_CONNECTED | UIP_NEWDATA;
       uip_connr->len = 0;
+#if UIP_TCP_SEND_WINDOW > 1
+      tcp_window_init(uip_connr);
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
       uipbuf_clear();
       uip_slen = 0;
       UIP_APPCALL();
@@ -2086,12 +2438,27 @@ uip_process(uint8_t flag)
          and the application will retransmit it. This is called the
          "persistent timer" and uses the retransmission mechanim.
      */
+#if UIP_TCP_SEND_WINDOW > 1
+    /* With a send window, the window limits the buffered data that we
+       send instead of the segments of the application. */
+    tcp_update_snd_wnd(uip_connr);
+
+    if(fast_rexmit) {
+      UIP_STAT(++uip_stat.tcp.rexmit);
+      tmp16 = MIN(uip_connr->len, uip_connr->initialmss);
+      tcp_copy_segment(uip_connr, 0, tmp16);
+      uip_len = tmp16 + UIP_IPTCPH_LEN;
+      UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+      goto tcp_send_noopts;
+    }
+#else /* UIP_TCP_SEND_WINDOW > 1 */
     tmp16 = ((uint16_t)UIP_TCP_BUF->wnd[0] << 8) + (uint16_t)UIP_TCP_BUF->wnd[1];
     if(tmp16 > uip_connr->initialmss ||
         tmp16 == 0) {
       tmp16 = uip_connr->initialmss;
     }
     uip_connr->mss = tmp16;
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 
     /* If this packet constitutes an ACK for outstanding data (flagged
          by the UIP_ACKDATA flag, we should call the application since it
@@ -2111,7 +2478,7 @@ uip_process(uint8_t flag)
          send, uip_len must be set to 0. */
     if(uip_flags & (UIP_NEWDATA | UIP_ACKDATA)) {
       uip_slen = 0;
-      UIP_APPCALL();
+      TCP_APPCALL(uip_connr);
 
       appsend:
 
@@ -2124,6 +2491,14 @@ uip_process(uint8_t flag)
 
       if(uip_flags & UIP_CLOSE) {
         uip_slen = 0;
+#if UIP_TCP_SEND_WINDOW > 1
+        if(uip_outstanding(uip_connr)) {
+          /* The FIN follows the buffered data. */
+          uip_connr->fin_pending = 1;
+          goto apprexmit;
+        }
+        tcp_send_fin:
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
         uip_connr->len = 1;
         uip_connr->tcpstateflags = UIP_FIN_WAIT_1;
         uip_connr->nrtx = 0;
@@ -2131,6 +2506,35 @@ uip_process(uint8_t flag)
         goto tcp_send_nodata;
       }
 
+#if UIP_TCP_SEND_WINDOW > 1
+      if(uip_slen > 0) {
+        /* The application cannot send more than what fits in the
+           retransmission buffer. */
+        tcp_buffer_data(uip_connr, uip_sappdata,
+                        MIN(uip_slen, uip_connr->mss));
+      }
+      apprexmit:
+      uip_appdata = uip_sappdata;
+
+      if(uip_connr->fin_pending && !uip_outstanding(uip_connr)) {
+        goto tcp_send_fin;
+      }
+
+      /* Send the next segment of buffered data that the window
+         allows, and poll the connection to send the one after it. */
+      tmp16 = tcp_sendable(uip_connr);
+      if(tmp16 > 0) {
+        snd_offset = uip_connr->sent;
+        tcp_copy_segment(uip_connr, snd_offset, tmp16);
+        uip_connr->sent += tmp16;
+        if(tcp_sendable(uip_connr) > 0) {
+          tcpip_poll_tcp(uip_connr);
+        }
+        uip_len = tmp16 + UIP_IPTCPH_LEN;
+        UIP_TCP_BUF->flags = TCP_ACK | TCP_PSH;
+        goto tcp_send_noopts;
+      }
+#else /* UIP_TCP_SEND_WINDOW > 1 */
       /* If uip_slen > 0, the application has data to be sent. */
       if(uip_slen > 0) {
 
@@ -2177,6 +2581,7 @@ uip_process(uint8_t flag)
         /* Send the packet. */
         goto tcp_send_noopts;
       }
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
       /* If there is no data to send, just send out a pure ACK if
            there is newdata. */
       if(uip_flags & UIP_NEWDATA) {
@@ -2276,10 +2681,22 @@ uip_process(uint8_t flag)
   UIP_TCP_BUF->ackno[2] = uip_connr->rcv_nxt[2];
   UIP_TCP_BUF->ackno[3] = uip_connr->rcv_nxt[3];
 
+#if UIP_TCP_SEND_WINDOW > 1
+  /* A segment of buffered data may start after the first
+     unacknowledged byte. A segment without data, such as a pure ACK,
+     takes the sequence number that follows the data sent so far. */
+  if(uip_len == UIP_IPTCPH_LEN &&
+     (uip_connr->tcpstateflags & UIP_TS_MASK) == UIP_ESTABLISHED) {
+    snd_offset = uip_connr->sent;
+  }
+  uip_add32(uip_connr->snd_nxt, snd_offset);
+  memcpy(UIP_TCP_BUF->seqno, uip_acc32, sizeof(UIP_TCP_BUF->seqno));
+#else /* UIP_TCP_SEND_WINDOW > 1 */
   UIP_TCP_BUF->seqno[0] = uip_connr->snd_nxt[0];
   UIP_TCP_BUF->seqno[1] = uip_connr->snd_nxt[1];
   UIP_TCP_BUF->seqno[2] = uip_connr->snd_nxt[2];
   UIP_TCP_BUF->seqno[3] = uip_connr->snd_nxt[3];
+#endif /* UIP_TCP_SEND_WINDOW > 1 */
 
   UIP_TCP_BUF->srcport  = uip_connr->lport;
   UIP_TCP_BUF->destport = uip_connr->rport;
@@ -210,6 +210,9 @@ enum {
   UIPBUF_ATTR_FLAGS,   /**< Flags that can control lower layers.  see above. */
   UIPBUF_ATTR_RSSI, /**< Last packet's RSSI */
   UIPBUF_ATTR_LINK_QUALITY, /**< Last packet's LQI */
+  UIPBUF_ATTR_PAYLOAD_OFFSET, /**< Offset of received data with a known checksum */
+  UIPBUF_ATTR_PAYLOAD_LEN, /**< Length of received data with a known checksum */
+  UIPBUF_ATTR_PAYLOAD_CHKSUM, /**< Partial checksum of that data */
   UIPBUF_ATTR_MAX
 };
 
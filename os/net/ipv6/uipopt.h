@@ -231,6 +231,31 @@ void uip_log(char *msg);
 #define UIP_UDP_CONNS    10
 #endif /* UIP_CONF_UDP_CONNS */
 
+/**
+ * Toggles whether received UDP datagrams are demultiplexed through a
+ * hash table of the local ports of the UDP connections, instead of
+ * by scanning all connections. The table also makes the allocation
+ * of connections and ephemeral ports independent of UIP_UDP_CONNS.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_UDP_WITH_PORT_HASH
+#define UIP_UDP_WITH_PORT_HASH (UIP_CONF_UDP_WITH_PORT_HASH)
+#else /* UIP_CONF_UDP_WITH_PORT_HASH */
+#define UIP_UDP_WITH_PORT_HASH 0
+#endif /* UIP_CONF_UDP_WITH_PORT_HASH */
+
+/**
+ * The number of buckets in the UDP port hash table, a power of two.
+ *
+ * \hideinitializer
+ */
+#ifdef UIP_CONF_UDP_PORT_HASH_SIZE
+#define UIP_UDP_PORT_HASH_SIZE (UIP_CONF_UDP_PORT_HASH_SIZE)
+#else /* UIP_CONF_UDP_PORT_HASH_SIZE */
+#define UIP_UDP_PORT_HASH_SIZE 16
+#endif /* UIP_CONF_UDP_PORT_HASH_SIZE */
+
 /**
  * The name of the function that should be called when UDP datagrams arrive.
  *
@@ -366,6 +391,25 @@ void uip_log(char *msg);
 #define UIP_RECEIVE_WINDOW (UIP_CONF_RECEIVE_WINDOW)
 #endif
 
+/**
+ * The maximum number of TCP segments that a connection can have in
+ * flight, which limits the congestion window of the connection.
+ *
+ * With the default of one segment, uIP waits for each segment to be
+ * acknowledged and the application regenerates the data of a
+ * retransmission. With more segments, each connection keeps the data
+ * sent by the application in a retransmission buffer of this many
+ * times UIP_TCP_MSS bytes until it is acknowledged, and the
+ * application can send whenever uip_mss() is non-zero.
+ *
+ * \hideinitializer
+ */
+#ifndef UIP_CONF_TCP_SEND_WINDOW
+#define UIP_TCP_SEND_WINDOW 1
+#else
+#define UIP_TCP_SEND_WINDOW (UIP_CONF_TCP_SEND_WINDOW)
+#endif
+
 /**
  * How long a connection should stay in the TIME_WAIT state.
  *
@@ -314,6 +314,16 @@
 #define TSCH_QUEUE_MAX_NEIGHBOR_QUEUES ((NBR_TABLE_CONF_MAX_NEIGHBORS) + 2)
 #endif
 
+/* Keep a bitmap over the neighbor table of the unicast neighbors that have
+ * a queued packet, an expired backoff and no tx link, so that a shared slot
+ * picks a neighbor without walking the table. The neighbors are served
+ * round-robin. */
+#ifdef TSCH_QUEUE_CONF_WITH_READY_SET
+#define TSCH_QUEUE_WITH_READY_SET TSCH_QUEUE_CONF_WITH_READY_SET
+#else
+#define TSCH_QUEUE_WITH_READY_SET 0
+#endif
+
 /******** Configuration: scheduling  *******/
 
 /* Initializes TSCH with a 6TiSCH minimal schedule */
@@ -353,6 +363,33 @@
 #define TSCH_SCHEDULE_MAX_LINKS 32
 #endif
 
+/* Keep the links of every slotframe sorted by timeslot, so that the next
+ * active link is found with a binary search per slotframe instead of a
+ * scan of all links. This costs one pointer per link. */
+#ifdef TSCH_SCHEDULE_CONF_WITH_SORTED_LINKS
+#define TSCH_SCHEDULE_WITH_SORTED_LINKS TSCH_SCHEDULE_CONF_WITH_SORTED_LINKS
+#else
+#define TSCH_SCHEDULE_WITH_SORTED_LINKS 0
+#endif
+
+/* Index the links of every slotframe by timeslot in a hash table, so that
+ * links are found by timeslot and channel offset without a scan of the
+ * slotframe. This costs one pointer per link and
+ * TSCH_SCHEDULE_LINK_HASH_SIZE pointers per slotframe. Lookups take
+ * constant time when the table is at least as large as the slotframes. */
+#ifdef TSCH_SCHEDULE_CONF_WITH_LINK_HASH
+#define TSCH_SCHEDULE_WITH_LINK_HASH TSCH_SCHEDULE_CONF_WITH_LINK_HASH
+#else
+#define TSCH_SCHEDULE_WITH_LINK_HASH 0
+#endif
+
+/* Number of hash buckets per slotframe */
+#ifdef TSCH_SCHEDULE_CONF_LINK_HASH_SIZE
+#define TSCH_SCHEDULE_LINK_HASH_SIZE TSCH_SCHEDULE_CONF_LINK_HASH_SIZE
+#else
+#define TSCH_SCHEDULE_LINK_HASH_SIZE 16
+#endif
+
 /* To include Sixtop Implementation */
 #ifdef TSCH_CONF_WITH_SIXTOP
 #define TSCH_WITH_SIXTOP TSCH_CONF_WITH_SIXTOP
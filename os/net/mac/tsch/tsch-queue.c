@@ -55,6 +55,7 @@
 #include "net/queuebuf.h"
 #include "net/mac/tsch/tsch.h"
 #include "net/nbr-table.h"
+#include "sys/critical.h"
 #include <string.h>
 
 /* Log configuration */
@@ -75,6 +76,18 @@ NBR_TABLE(struct tsch_neighbor, tsch_neighbors);
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+#if TSCH_QUEUE_WITH_READY_SET
+#define READY_SET_WORDS ((NBR_TABLE_MAX_NEIGHBORS + 31) / 32)
+/* Bit i is set when neighbor i of the table is a unicast neighbor without tx
+ * links, with a queued packet and an expired backoff. These are the
+ * neighbors that may send over a shared link to the broadcast address. The
+ * set is updated from both interrupt and process context, always within a
+ * critical section. */
+static uint32_t ready_set[READY_SET_WORDS];
+/* Where the next search starts, one past the last neighbor served */
+static uint16_t ready_next;
+#endif /* TSCH_QUEUE_WITH_READY_SET */
+
 /*---------------------------------------------------------------------------*/
 /* Add a TSCH neighbor */
 struct tsch_neighbor *
@@ -252,6 +265,9 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
           /* Enqueue packet */
           p->qb = queuebuf_new_from_packetbuf();
           if(p->qb != NULL) {
+            /* The slot operation modifies the frame from interrupt
+               context, where no memory can be allocated */
+            queuebuf_unshare(p->qb);
             p->sent = sent;
             p->ptr = ptr;
             p->ret = MAC_TX_DEFERRED;
@@ -260,6 +276,7 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
             /* Add to ringbuf (actual add committed through atomic operation) */
             n->tx_array[put_index] = p;
             ringbufindex_put(&n->tx_ringbuf);
+            tsch_queue_update_ready(n);
             LOG_DBG("packet is added put_index %u, packet %p\n",
                    put_index, p);
             return p;
@@ -300,6 +317,7 @@ tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
       /* Get and remove packet from ringbuf (remove committed through an atomic operation */
       int16_t get_index = ringbufindex_get(&n->tx_ringbuf);
       if(get_index != -1) {
+        tsch_queue_update_ready(n);
         return n->tx_array[get_index];
       } else {
         return NULL;
@@ -458,12 +476,93 @@ tsch_queue_get_packet_for_dest_addr(const linkaddr_t *addr, struct tsch_link *li
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_QUEUE_WITH_READY_SET
+/* Update the ready set bit of a neighbor from its current state */
+void
+tsch_queue_update_ready(const struct tsch_neighbor *n)
+{
+  int index = n - _tsch_neighbors_mem;
+  uint32_t mask = (uint32_t)1 << (index % 32);
+  int_master_status_t status;
+
+  status = critical_enter();
+  if(!n->is_broadcast && n->tx_links_count == 0 && n->backoff_window == 0
+     && !ringbufindex_empty(&n->tx_ringbuf)) {
+    ready_set[index / 32] |= mask;
+  } else {
+    ready_set[index / 32] &= ~mask;
+  }
+  critical_exit(status);
+}
+/*---------------------------------------------------------------------------*/
+/* Find the first neighbor of the ready set in [index;end), or -1 */
+static int
+ready_set_find(int index, int end)
+{
+  while(index < end) {
+    uint32_t word = ready_set[index / 32] >> (index % 32);
+    if(word == 0) {
+      /* Skip to the next word */
+      index += 32 - index % 32;
+    } else {
+      while((word & 1) == 0) {
+        word >>= 1;
+        index++;
+      }
+      return index < end ? index : -1;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the head packet of the next ready neighbor after the last one
+ * served, writes pointer to the neighbor in *n */
+static struct tsch_packet *
+ready_set_get_packet(struct tsch_neighbor **n, struct tsch_link *link)
+{
+  int start = ready_next;
+  int end = NBR_TABLE_MAX_NEIGHBORS;
+  int index = start;
+
+  while(1) {
+    index = ready_set_find(index, end);
+    if(index == -1) {
+      if(end == start) {
+        return NULL;
+      }
+      /* Wrap around */
+      index = 0;
+      end = start;
+    } else {
+      struct tsch_neighbor *curr_nbr = &_tsch_neighbors_mem[index];
+      /* The link selector may still reject the packet */
+      struct tsch_packet *p = tsch_queue_get_packet_for_nbr(curr_nbr, link);
+      if(p != NULL) {
+        ready_next = (index + 1) % NBR_TABLE_MAX_NEIGHBORS;
+        if(n != NULL) {
+          *n = curr_nbr;
+        }
+        return p;
+      }
+      index++;
+    }
+  }
+}
+#endif /* TSCH_QUEUE_WITH_READY_SET */
+/*---------------------------------------------------------------------------*/
 /* Returns the head packet of any neighbor queue with zero backoff counter.
  * Writes pointer to the neighbor in *n */
 struct tsch_packet *
 tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
+#if TSCH_QUEUE_WITH_READY_SET
+    /* The ready set only holds neighbors with an expired backoff, which
+     * is what a shared link requires */
+    if(link != NULL && link->link_options & LINK_OPTION_SHARED) {
+      return ready_set_get_packet(n, link);
+    }
+#endif /* TSCH_QUEUE_WITH_READY_SET */
     struct tsch_neighbor *curr_nbr = (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
     struct tsch_packet *p = NULL;
     while(curr_nbr != NULL) {
@@ -496,6 +595,7 @@ tsch_queue_backoff_reset(struct tsch_neighbor *n)
 {
   n->backoff_window = 0;
   n->backoff_exponent = TSCH_MAC_MIN_BE;
+  tsch_queue_update_ready(n);
 }
 /*---------------------------------------------------------------------------*/
 /* Increment backoff exponent, pick a new window */
@@ -513,6 +613,7 @@ tsch_queue_backoff_inc(struct tsch_neighbor *n)
   if(n->backoff_window < UINT16_MAX) {
     n->backoff_window++;
   }
+  tsch_queue_update_ready(n);
 }
 /*---------------------------------------------------------------------------*/
 /* Decrement backoff window for all queues directed at dest_addr */
@@ -527,6 +628,9 @@ tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr)
          && ((n->tx_links_count == 0 && is_broadcast)
              || (n->tx_links_count > 0 && linkaddr_cmp(dest_addr, tsch_queue_get_nbr_address(n))))) {
         n->backoff_window--;
+        if(n->backoff_window == 0) {
+          tsch_queue_update_ready(n);
+        }
       }
       n = (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, n);
     }
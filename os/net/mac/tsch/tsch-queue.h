@@ -46,6 +46,7 @@
 #include "lib/ringbufindex.h"
 #include "net/linkaddr.h"
 #include "net/mac/mac.h"
+#include "net/mac/tsch/tsch-conf.h"
 
 /***** External Variables *****/
 
@@ -184,6 +185,16 @@ void tsch_queue_backoff_inc(struct tsch_neighbor *n);
  * \param dest_addr The target address, &tsch_broadcast_address for broadcast
  */
 void tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr);
+#if TSCH_QUEUE_WITH_READY_SET
+/**
+ * \brief Update the ready set after a change of the queue, backoff window
+ * or tx link count of a neighbor
+ * \param n The neighbor queue
+ */
+void tsch_queue_update_ready(const struct tsch_neighbor *n);
+#else /* TSCH_QUEUE_WITH_READY_SET */
+#define tsch_queue_update_ready(n)
+#endif /* TSCH_QUEUE_WITH_READY_SET */
 /**
  * \brief Initialize TSCH queue module
  */
@@ -68,6 +68,101 @@ MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
 
+#if TSCH_SCHEDULE_WITH_SORTED_LINKS
+/* The links of all slotframes, grouped by slotframe in the order of
+ * slotframe_list and sorted by timeslot within each slotframe. Links
+ * with the same timeslot are kept in the order of the links list. */
+static struct tsch_link *sorted_links[TSCH_SCHEDULE_MAX_LINKS];
+static uint16_t sorted_links_count;
+/*---------------------------------------------------------------------------*/
+/* Returns the position of the first link of a slotframe with a timeslot
+ * after a given one */
+static uint16_t
+sorted_links_upper_bound(const struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  uint16_t low = sf->sorted_first;
+  uint16_t high = sf->sorted_first + sf->sorted_count;
+
+  while(low < high) {
+    uint16_t mid = low + (high - low) / 2;
+    if(sorted_links[mid]->timeslot <= timeslot) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+/*---------------------------------------------------------------------------*/
+/* Moves the links of the slotframes that follow a given one */
+static void
+sorted_links_shift(struct tsch_slotframe *sf, int delta)
+{
+  for(sf = list_item_next(sf); sf != NULL; sf = list_item_next(sf)) {
+    sf->sorted_first += delta;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Adds a new link, which is the last one in the links list of sf */
+static void
+sorted_links_add(struct tsch_slotframe *sf, struct tsch_link *l)
+{
+  uint16_t i = sorted_links_upper_bound(sf, l->timeslot);
+
+  memmove(&sorted_links[i + 1], &sorted_links[i],
+          (sorted_links_count - i) * sizeof(sorted_links[0]));
+  sorted_links[i] = l;
+  sorted_links_count++;
+  sf->sorted_count++;
+  sorted_links_shift(sf, 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sorted_links_remove(struct tsch_slotframe *sf, struct tsch_link *l)
+{
+  uint16_t i = sorted_links_upper_bound(sf, l->timeslot);
+
+  /* The link is among the ones with the same timeslot before i */
+  do {
+    i--;
+  } while(sorted_links[i] != l);
+  memmove(&sorted_links[i], &sorted_links[i + 1],
+          (sorted_links_count - i - 1) * sizeof(sorted_links[0]));
+  sorted_links_count--;
+  sf->sorted_count--;
+  sorted_links_shift(sf, -1);
+}
+#endif /* TSCH_SCHEDULE_WITH_SORTED_LINKS */
+
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+#define LINK_HASH(timeslot) ((timeslot) % TSCH_SCHEDULE_LINK_HASH_SIZE)
+/*---------------------------------------------------------------------------*/
+/* Adds a link at the end of its hash chain, so that the links with the
+ * same timeslot are kept in the order of the links list */
+static void
+link_hash_add(struct tsch_slotframe *sf, struct tsch_link *l)
+{
+  struct tsch_link **p = &sf->link_hash[LINK_HASH(l->timeslot)];
+
+  while(*p != NULL) {
+    p = &(*p)->hash_next;
+  }
+  l->hash_next = NULL;
+  *p = l;
+}
+/*---------------------------------------------------------------------------*/
+static void
+link_hash_remove(struct tsch_slotframe *sf, struct tsch_link *l)
+{
+  struct tsch_link **p = &sf->link_hash[LINK_HASH(l->timeslot)];
+
+  while(*p != l) {
+    p = &(*p)->hash_next;
+  }
+  *p = l->hash_next;
+}
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
+
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
 tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
@@ -88,6 +183,14 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
       sf->handle = handle;
       TSCH_ASN_DIVISOR_INIT(sf->size, size);
       LIST_STRUCT_INIT(sf, links_list);
+#if TSCH_SCHEDULE_WITH_SORTED_LINKS
+      /* The slotframe is added last, so its links go last */
+      sf->sorted_first = sorted_links_count;
+      sf->sorted_count = 0;
+#endif /* TSCH_SCHEDULE_WITH_SORTED_LINKS */
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+      memset(sf->link_hash, 0, sizeof(sf->link_hash));
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
       /* Add the slotframe to the global list */
       list_add(slotframe_list, sf);
     }
@@ -262,6 +365,12 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
           address = &linkaddr_null;
         }
         linkaddr_copy(&l->addr, address);
+#if TSCH_SCHEDULE_WITH_SORTED_LINKS
+        sorted_links_add(slotframe, l);
+#endif /* TSCH_SCHEDULE_WITH_SORTED_LINKS */
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+        link_hash_add(slotframe, l);
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
 
         LOG_INFO("add_link sf=%u opt=%s type=%s ts=%u ch=%u addr=",
                  slotframe->handle,
@@ -280,6 +389,7 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
             if(!(l->link_options & LINK_OPTION_SHARED)) {
               n->dedicated_tx_links_count++;
             }
+            tsch_queue_update_ready(n);
           }
         }
       }
@@ -314,6 +424,12 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
       LOG_INFO_LLADDR(&l->addr);
       LOG_INFO_("\n");
 
+#if TSCH_SCHEDULE_WITH_SORTED_LINKS
+      sorted_links_remove(slotframe, l);
+#endif /* TSCH_SCHEDULE_WITH_SORTED_LINKS */
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+      link_hash_remove(slotframe, l);
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
       list_remove(slotframe->links_list, l);
       memb_free(&link_memb, l);
 
@@ -328,6 +444,7 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
           if(!(link_options & LINK_OPTION_SHARED)) {
             n->dedicated_tx_links_count--;
           }
+          tsch_queue_update_ready(n);
         }
       }
 
@@ -348,10 +465,17 @@ tsch_schedule_remove_link_by_offsets(struct tsch_slotframe *slotframe,
   int ret = 0;
   if(!tsch_is_locked()) {
     if(slotframe != NULL) {
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+      struct tsch_link *l = slotframe->link_hash[LINK_HASH(timeslot)];
+      /* Loop over the items with the same hash and remove all matching links */
+      while(l != NULL) {
+        struct tsch_link *next = l->hash_next;
+#else /* TSCH_SCHEDULE_WITH_LINK_HASH */
       struct tsch_link *l = list_head(slotframe->links_list);
       /* Loop over all items and remove all matching links */
       while(l != NULL) {
         struct tsch_link *next = list_item_next(l);
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
         if(l->timeslot == timeslot && l->channel_offset == channel_offset) {
           if(tsch_schedule_remove_link(slotframe, l)) {
             ret = 1;
@@ -372,6 +496,16 @@ tsch_schedule_get_link_by_offsets(struct tsch_slotframe *slotframe,
 {
   if(!tsch_is_locked()) {
     if(slotframe != NULL) {
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+      struct tsch_link *l = slotframe->link_hash[LINK_HASH(timeslot)];
+      /* Loop over the items with the same hash */
+      while(l != NULL) {
+        if(l->timeslot == timeslot && l->channel_offset == channel_offset) {
+          return l;
+        }
+        l = l->hash_next;
+      }
+#else /* TSCH_SCHEDULE_WITH_LINK_HASH */
       struct tsch_link *l = list_head(slotframe->links_list);
       /* Loop over all items. Assume there is max one link per timeslot
          and channel_offset */
@@ -381,6 +515,7 @@ tsch_schedule_get_link_by_offsets(struct tsch_slotframe *slotframe,
         }
         l = list_item_next(l);
       }
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
       return l;
     }
   }
@@ -394,6 +529,16 @@ tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe,
 {
   if(!tsch_is_locked()) {
     if(slotframe != NULL) {
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+      struct tsch_link *l = slotframe->link_hash[LINK_HASH(timeslot)];
+      /* Loop over the items with the same hash */
+      while(l != NULL) {
+        if(l->timeslot == timeslot) {
+          return l;
+        }
+        l = l->hash_next;
+      }
+#else /* TSCH_SCHEDULE_WITH_LINK_HASH */
       struct tsch_link *l = list_head(slotframe->links_list);
       /* Loop over all items. Assume there is max one link per timeslot */
       while(l != NULL) {
@@ -402,6 +547,7 @@ tsch_schedule_get_link_by_timeslot(struct tsch_slotframe *slotframe,
         }
         l = list_item_next(l);
       }
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
       return l;
     }
   }
@@ -430,6 +576,59 @@ default_tsch_link_comparator(struct tsch_link *a, struct tsch_link *b)
   return a;
 }
 
+/*---------------------------------------------------------------------------*/
+/* Considers link l, occurring time_to_timeslot slots from now, as the next
+ * active link or its backup */
+static void
+select_link(struct tsch_link *l, uint16_t time_to_timeslot,
+            struct tsch_link **curr_best, uint16_t *time_to_curr_best,
+            struct tsch_link **curr_backup)
+{
+  if(*curr_best == NULL || time_to_timeslot < *time_to_curr_best) {
+    *time_to_curr_best = time_to_timeslot;
+    *curr_best = l;
+    *curr_backup = NULL;
+  } else if(time_to_timeslot == *time_to_curr_best) {
+    struct tsch_link *new_best = NULL;
+    /* Two links are overlapping, we need to select one of them.
+     * By standard: prioritize Tx links first, second by lowest handle */
+    if(((*curr_best)->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
+      /* Both or neither links have Tx, select the one with lowest handle */
+      if(l->slotframe_handle != (*curr_best)->slotframe_handle) {
+        if(l->slotframe_handle < (*curr_best)->slotframe_handle) {
+          new_best = l;
+        }
+      } else {
+        /* compare the link against the current best link and return the newly selected one */
+        new_best = TSCH_LINK_COMPARATOR(*curr_best, l);
+      }
+    } else {
+      /* Select the link that has the Tx option */
+      if(l->link_options & LINK_OPTION_TX) {
+        new_best = l;
+      }
+    }
+
+    /* Maintain backup_link */
+    /* Check if 'l' best can be used as backup */
+    if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
+      if(*curr_backup == NULL || l->slotframe_handle < (*curr_backup)->slotframe_handle) {
+        *curr_backup = l;
+      }
+    }
+    /* Check if curr_best can be used as backup */
+    if(new_best != *curr_best && ((*curr_best)->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
+      if(*curr_backup == NULL || (*curr_best)->slotframe_handle < (*curr_backup)->slotframe_handle) {
+        *curr_backup = *curr_best;
+      }
+    }
+
+    /* Maintain curr_best */
+    if(new_best != NULL) {
+      *curr_best = new_best;
+    }
+  }
+}
 /*---------------------------------------------------------------------------*/
 /* Returns the next active link after a given ASN, and a backup link (for the same ASN, with Rx flag) */
 struct tsch_link *
@@ -448,59 +647,41 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
     while(sf != NULL) {
       /* Get timeslot from ASN, given the slotframe length */
       uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+#if TSCH_SCHEDULE_WITH_SORTED_LINKS
+      if(sf->sorted_count > 0) {
+        /* Only the links at the first timeslot after the current one, in
+         * this or in the next slotframe iteration, can be the earliest */
+        uint16_t end = sf->sorted_first + sf->sorted_count;
+        uint16_t i = sorted_links_upper_bound(sf, timeslot);
+        uint16_t next_timeslot;
+        uint16_t time_to_timeslot;
+
+        if(i == end) {
+          i = sf->sorted_first;
+        }
+        next_timeslot = sorted_links[i]->timeslot;
+        time_to_timeslot =
+          next_timeslot > timeslot ?
+          next_timeslot - timeslot :
+          sf->size.val + next_timeslot - timeslot;
+        do {
+          select_link(sorted_links[i], time_to_timeslot,
+                      &curr_best, &time_to_curr_best, &curr_backup);
+          i++;
+        } while(i < end && sorted_links[i]->timeslot == next_timeslot);
+      }
+#else /* TSCH_SCHEDULE_WITH_SORTED_LINKS */
       struct tsch_link *l = list_head(sf->links_list);
       while(l != NULL) {
         uint16_t time_to_timeslot =
           l->timeslot > timeslot ?
           l->timeslot - timeslot :
           sf->size.val + l->timeslot - timeslot;
-        if(curr_best == NULL || time_to_timeslot < time_to_curr_best) {
-          time_to_curr_best = time_to_timeslot;
-          curr_best = l;
-          curr_backup = NULL;
-        } else if(time_to_timeslot == time_to_curr_best) {
-          struct tsch_link *new_best = NULL;
-          /* Two links are overlapping, we need to select one of them.
-           * By standard: prioritize Tx links first, second by lowest handle */
-          if((curr_best->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
-            /* Both or neither links have Tx, select the one with lowest handle */
-            if(l->slotframe_handle != curr_best->slotframe_handle) {
-              if(l->slotframe_handle < curr_best->slotframe_handle) {
-                new_best = l;
-              }
-            } else {
-              /* compare the link against the current best link and return the newly selected one */
-              new_best = TSCH_LINK_COMPARATOR(curr_best, l);
-            }
-          } else {
-            /* Select the link that has the Tx option */
-            if(l->link_options & LINK_OPTION_TX) {
-              new_best = l;
-            }
-          }
-
-          /* Maintain backup_link */
-          /* Check if 'l' best can be used as backup */
-          if(new_best != l && (l->link_options & LINK_OPTION_RX)) { /* Does 'l' have Rx flag? */
-            if(curr_backup == NULL || l->slotframe_handle < curr_backup->slotframe_handle) {
-              curr_backup = l;
-            }
-          }
-          /* Check if curr_best can be used as backup */
-          if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) { /* Does curr_best have Rx flag? */
-            if(curr_backup == NULL || curr_best->slotframe_handle < curr_backup->slotframe_handle) {
-              curr_backup = curr_best;
-            }
-          }
-
-          /* Maintain curr_best */
-          if(new_best != NULL) {
-            curr_best = new_best;
-          }
-        }
-
+        select_link(l, time_to_timeslot,
+                    &curr_best, &time_to_curr_best, &curr_backup);
         l = list_item_next(l);
       }
+#endif /* TSCH_SCHEDULE_WITH_SORTED_LINKS */
       sf = list_item_next(sf);
     }
     if(time_offset != NULL) {
@@ -521,6 +702,9 @@ tsch_schedule_init(void)
     memb_init(&link_memb);
     memb_init(&slotframe_memb);
     list_init(slotframe_list);
+#if TSCH_SCHEDULE_WITH_SORTED_LINKS
+    sorted_links_count = 0;
+#endif /* TSCH_SCHEDULE_WITH_SORTED_LINKS */
     tsch_release_lock();
     return 1;
   } else {
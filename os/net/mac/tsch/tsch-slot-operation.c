@@ -313,7 +313,9 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
                         str, (int)(now-ref_time), (int)offset);
     );
   } else {
-    r = rtimer_set(tm, ref_time + offset, 1, (void (*)(struct rtimer *, void *))tsch_slot_operation, NULL);
+    /* Slot operation takes precedence over other rtimer users */
+    r = rtimer_set_with_priority(tm, ref_time + offset, RTIMER_PRIORITY_HIGH,
+                                 (void (*)(struct rtimer *, void *))tsch_slot_operation, NULL);
     if(r == RTIMER_OK) {
       return 1;
     }
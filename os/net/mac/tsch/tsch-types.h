@@ -44,6 +44,7 @@
 
 /********** Includes **********/
 
+#include "net/mac/tsch/tsch-conf.h"
 #include "net/mac/tsch/tsch-asn.h"
 #include "lib/list.h"
 #include "lib/ringbufindex.h"
@@ -78,6 +79,10 @@ struct tsch_link {
   enum link_type link_type;
   /* Any other data for upper layers */
   void *data;
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+  /* Next link in the same hash bucket of the slotframe */
+  struct tsch_link *hash_next;
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
 };
 
 /** \brief 802.15.4e slotframe (contains links) */
@@ -91,6 +96,16 @@ struct tsch_slotframe {
   struct tsch_asn_divisor_t size;
   /* List of links belonging to this slotframe */
   LIST_STRUCT(links_list);
+#if TSCH_SCHEDULE_WITH_SORTED_LINKS
+  /* Position and number of the links of this slotframe in the
+   * timeslot-sorted link array of the schedule */
+  uint16_t sorted_first;
+  uint16_t sorted_count;
+#endif /* TSCH_SCHEDULE_WITH_SORTED_LINKS */
+#if TSCH_SCHEDULE_WITH_LINK_HASH
+  /* The links of this slotframe, hashed by timeslot */
+  struct tsch_link *link_hash[TSCH_SCHEDULE_LINK_HASH_SIZE];
+#endif /* TSCH_SCHEDULE_WITH_LINK_HASH */
 };
 
 /** \brief TSCH packet information */
@@ -70,6 +70,15 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_LLADDR_INDEX
+#if NBR_TABLE_LLADDR_INDEX_SIZE <= NBR_TABLE_MAX_NEIGHBORS
+#error "NBR_TABLE_LLADDR_INDEX_SIZE must be larger than NBR_TABLE_MAX_NEIGHBORS"
+#endif
+/* Open-addressing hash index over the neighbor keys, using linear probing.
+ * Each slot holds a neighbor index plus one; zero marks an empty slot. */
+static uint16_t lladdr_index[NBR_TABLE_LLADDR_INDEX_SIZE];
+#endif /* NBR_TABLE_WITH_LLADDR_INDEX */
+
 /*---------------------------------------------------------------------------*/
 static void remove_key(nbr_table_key_t *key, bool do_free);
 /*---------------------------------------------------------------------------*/
@@ -115,16 +124,97 @@ key_from_item(const nbr_table_t *table, const nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+#if NBR_TABLE_WITH_LLADDR_INDEX
+/* FNV-1a hash of a link-layer address, reduced to a slot number */
+static unsigned
+lladdr_index_hash(const linkaddr_t *lladdr)
+{
+  uint32_t hash = 2166136261UL;
+  int i;
+
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash ^= lladdr->u8[i];
+    hash *= 16777619UL;
+  }
+  return hash % NBR_TABLE_LLADDR_INDEX_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+lladdr_index_next(unsigned slot)
+{
+  return slot + 1 < NBR_TABLE_LLADDR_INDEX_SIZE ? slot + 1 : 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Find the slot of a link-layer address, or -1 if it is not indexed */
+static int
+lladdr_index_find(const linkaddr_t *lladdr)
+{
+  unsigned slot = lladdr_index_hash(lladdr);
+
+  /* The index is never full, so the probe ends at an empty slot */
+  while(lladdr_index[slot] != 0) {
+    if(linkaddr_cmp(lladdr, &key_from_index(lladdr_index[slot] - 1)->lladdr)) {
+      return slot;
+    }
+    slot = lladdr_index_next(slot);
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+lladdr_index_add(const nbr_table_key_t *key)
+{
+  unsigned slot = lladdr_index_hash(&key->lladdr);
+
+  while(lladdr_index[slot] != 0) {
+    slot = lladdr_index_next(slot);
+  }
+  lladdr_index[slot] = index_from_key(key) + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+lladdr_index_remove(const nbr_table_key_t *key)
+{
+  int found = lladdr_index_find(&key->lladdr);
+  unsigned hole;
+  unsigned slot;
+
+  if(found == -1) {
+    return;
+  }
+
+  /* Backward-shift deletion: move later entries of the probe sequence
+   * into the hole, so that lookups never need tombstones. An entry can
+   * fill the hole unless its home slot lies cyclically in (hole, slot]. */
+  hole = found;
+  for(slot = lladdr_index_next(hole); lladdr_index[slot] != 0;
+      slot = lladdr_index_next(slot)) {
+    unsigned home = lladdr_index_hash(&key_from_index(lladdr_index[slot] - 1)->lladdr);
+    bool in_range = hole <= slot ? (hole < home && home <= slot)
+                                 : (hole < home || home <= slot);
+    if(!in_range) {
+      lladdr_index[hole] = lladdr_index[slot];
+      hole = slot;
+    }
+  }
+  lladdr_index[hole] = 0;
+}
+#endif /* NBR_TABLE_WITH_LLADDR_INDEX */
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
-  nbr_table_key_t *key;
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_LLADDR_INDEX
+  int slot = lladdr_index_find(lladdr);
+  return slot != -1 ? lladdr_index[slot] - 1 : -1;
+#else /* NBR_TABLE_WITH_LLADDR_INDEX */
+  nbr_table_key_t *key;
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -133,6 +223,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     key = list_item_next(key);
   }
   return -1;
+#endif /* NBR_TABLE_WITH_LLADDR_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 /* Get bit from "used" or "locked" bitmap */
@@ -183,6 +274,9 @@ remove_key(nbr_table_key_t *key, bool do_free)
   locked_map[index_from_key(key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, key);
+#if NBR_TABLE_WITH_LLADDR_INDEX
+  lladdr_index_remove(key);
+#endif /* NBR_TABLE_WITH_LLADDR_INDEX */
   if(do_free) {
     /* Release the memory */
     memb_free(&neighbor_addr_mem, key);
@@ -430,6 +524,9 @@ nbr_table_add_lladdr(const nbr_table_t *table, const linkaddr_t *lladdr,
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_LLADDR_INDEX
+    lladdr_index_add(key);
+#endif /* NBR_TABLE_WITH_LLADDR_INDEX */
   }
 
   /* Get item in the current table */
@@ -55,6 +55,22 @@ typedef enum {
 
 #define NBR_TABLE_MAX_NEIGHBORS NBR_TABLE_CONF_MAX_NEIGHBORS
 
+/* Keep a hash index from link-layer address to neighbor index, so that
+ * nbr_table_get_from_lladdr() does not need to walk the neighbor list. */
+#ifdef NBR_TABLE_CONF_WITH_LLADDR_INDEX
+#define NBR_TABLE_WITH_LLADDR_INDEX NBR_TABLE_CONF_WITH_LLADDR_INDEX
+#else /* NBR_TABLE_CONF_WITH_LLADDR_INDEX */
+#define NBR_TABLE_WITH_LLADDR_INDEX 0
+#endif /* NBR_TABLE_CONF_WITH_LLADDR_INDEX */
+
+/* Number of slots in the link-layer address index. Must be larger than
+ * NBR_TABLE_MAX_NEIGHBORS; twice as large keeps probe sequences short. */
+#ifdef NBR_TABLE_CONF_LLADDR_INDEX_SIZE
+#define NBR_TABLE_LLADDR_INDEX_SIZE NBR_TABLE_CONF_LLADDR_INDEX_SIZE
+#else /* NBR_TABLE_CONF_LLADDR_INDEX_SIZE */
+#define NBR_TABLE_LLADDR_INDEX_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS)
+#endif /* NBR_TABLE_CONF_LLADDR_INDEX_SIZE */
+
 #ifdef NBR_TABLE_CONF_GC_GET_WORST
 #define NBR_TABLE_GC_GET_WORST NBR_TABLE_CONF_GC_GET_WORST
 #else /* NBR_TABLE_CONF_GC_GET_WORST */
@@ -46,6 +46,7 @@
 
 #include "contiki-net.h"
 #include "net/packetbuf.h"
+#include "net/queuebuf.h"
 #include "sys/cc.h"
 
 struct packetbuf_attr packetbuf_attrs[PACKETBUF_NUM_ATTRS];
@@ -62,6 +63,14 @@ static uint8_t hdrlen;
 static uint32_t packetbuf_aligned[(PACKETBUF_SIZE + 3) / 4];
 static uint8_t *packetbuf = (uint8_t *)packetbuf_aligned;
 
+#if QUEUEBUF_WITH_SHARED_DATA
+/* The queued packet that the packetbuf holds an unmodified copy of */
+static const void *origin;
+#define CLEAR_ORIGIN() (origin = NULL)
+#else /* QUEUEBUF_WITH_SHARED_DATA */
+#define CLEAR_ORIGIN()
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
+
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -76,6 +85,7 @@ packetbuf_clear(void)
 {
   buflen = bufptr = 0;
   hdrlen = 0;
+  CLEAR_ORIGIN();
 
   packetbuf_attr_clear();
 }
@@ -98,8 +108,8 @@ packetbuf_copyto(void *to)
   if(hdrlen + buflen > PACKETBUF_SIZE) {
     return 0;
   }
-  memcpy(to, packetbuf_hdrptr(), hdrlen);
-  memcpy((uint8_t *)to + hdrlen, packetbuf_dataptr(), buflen);
+  memcpy(to, packetbuf, hdrlen);
+  memcpy((uint8_t *)to + hdrlen, packetbuf + packetbuf_hdrlen(), buflen);
   return hdrlen + buflen;
 }
 /*---------------------------------------------------------------------------*/
@@ -112,6 +122,7 @@ packetbuf_hdralloc(int size)
     return 0;
   }
 
+  CLEAR_ORIGIN();
   /* shift data to the right */
   for(i = packetbuf_totlen() - 1; i >= 0; i--) {
     packetbuf[i + size] = packetbuf[i];
@@ -127,6 +138,7 @@ packetbuf_hdrreduce(int size)
     return 0;
   }
 
+  CLEAR_ORIGIN();
   bufptr += size;
   buflen -= size;
   return 1;
@@ -136,18 +148,21 @@ void
 packetbuf_set_datalen(uint16_t len)
 {
   PRINTF("packetbuf_set_len: len %d\n", len);
+  CLEAR_ORIGIN();
   buflen = len;
 }
 /*---------------------------------------------------------------------------*/
 void *
 packetbuf_dataptr(void)
 {
+  CLEAR_ORIGIN();
   return packetbuf + packetbuf_hdrlen();
 }
 /*---------------------------------------------------------------------------*/
 void *
 packetbuf_hdrptr(void)
 {
+  CLEAR_ORIGIN();
   return packetbuf;
 }
 /*---------------------------------------------------------------------------*/
@@ -175,6 +190,31 @@ packetbuf_remaininglen(void)
   return PACKETBUF_SIZE - packetbuf_totlen();
 }
 /*---------------------------------------------------------------------------*/
+#if QUEUEBUF_WITH_SHARED_DATA
+void
+packetbuf_set_origin(const void *o)
+{
+  origin = bufptr == 0 ? o : NULL;
+}
+/*---------------------------------------------------------------------------*/
+const void *
+packetbuf_origin(void)
+{
+  return origin;
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_restore(const void *o)
+{
+  if(o == NULL || o != origin) {
+    return 0;
+  }
+  buflen += hdrlen;
+  hdrlen = 0;
+  return 1;
+}
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
+/*---------------------------------------------------------------------------*/
 void
 packetbuf_attr_clear(void)
 {
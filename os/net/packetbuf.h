@@ -192,6 +192,41 @@ int packetbuf_hdralloc(int size);
  */
 int packetbuf_hdrreduce(int size);
 
+/**
+ * \brief        Record that the packetbuf holds a copy of a queued packet
+ * \param origin The storage of the queued packet, or NULL
+ *
+ *               This is used by the queuebuf module to avoid copying a
+ *               packet between the packetbuf and a queuebuf when both
+ *               already hold the same data. The record is dropped as
+ *               soon as the packetbuf may change: when it is cleared,
+ *               when its header or data length is changed, and when a
+ *               pointer to its header or data is handed out. Nothing is
+ *               recorded if header and data are not contiguous.
+ *
+ *               Only available with QUEUEBUF_CONF_WITH_SHARED_DATA.
+ */
+void packetbuf_set_origin(const void *origin);
+
+/**
+ * \brief      Get the queued packet that the packetbuf holds a copy of
+ * \return     The storage of the queued packet, or NULL
+ */
+const void *packetbuf_origin(void);
+
+/**
+ * \brief        Turn the packetbuf back into the packet it was copied from
+ * \param origin The storage of the queued packet
+ * \retval       Non-zero if the packetbuf holds a copy of the packet,
+ *               zero otherwise
+ *
+ *               If the packetbuf holds a copy of the packet, its
+ *               header is made part of the data, as if the packet had
+ *               been copied in with packetbuf_copyfrom(). The
+ *               attributes are left unchanged.
+ */
+int packetbuf_restore(const void *origin);
+
 /* Packet attributes stuff below: */
 
 typedef uint16_t packetbuf_attr_t;
@@ -69,16 +69,35 @@ struct queuebuf {
     int swap_id;
   };
 #endif
+#if QUEUEBUF_WITH_SHARED_DATA
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
 };
 
 /* The actual queuebuf data */
 struct queuebuf_data {
   uint8_t data[PACKETBUF_SIZE];
   uint16_t len;
+#if QUEUEBUF_WITH_SHARED_DATA
+  /* The number of queuebufs that refer to the data */
+  uint16_t refs;
+#else /* QUEUEBUF_WITH_SHARED_DATA */
   struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
   struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
 };
 
+/* The attributes of a queuebuf are kept with its data, unless the data
+   may be shared with other queuebufs */
+#if QUEUEBUF_WITH_SHARED_DATA
+#define ATTRS(b, ptr) ((void)(ptr), (b)->attrs)
+#define ADDRS(b, ptr) ((void)(ptr), (b)->addrs)
+#else /* QUEUEBUF_WITH_SHARED_DATA */
+#define ATTRS(b, ptr) ((ptr)->attrs)
+#define ADDRS(b, ptr) ((ptr)->addrs)
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
+
 MEMB(bufmem, struct queuebuf, QUEUEBUF_NUM);
 MEMB(buframmem, struct queuebuf_data, QUEUEBUFRAM_NUM);
 
@@ -276,6 +295,59 @@ queuebuf_load_to_ram(struct queuebuf *b)
   return b->ram_ptr;
 }
 #endif /* WITH_SWAP */
+#if QUEUEBUF_WITH_SHARED_DATA
+/*---------------------------------------------------------------------------*/
+/* Drop a reference to queuebuf data */
+static void
+release_data(struct queuebuf_data *d)
+{
+  if(--d->refs == 0) {
+    if(packetbuf_origin() == d) {
+      packetbuf_set_origin(NULL);
+    }
+    memb_free(&buframmem, d);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Make sure that a queuebuf is the only one that refers to its data,
+   optionally keeping the contents, and that the packetbuf does not
+   count as a copy of it. Since every queuebuf could have data of its
+   own, a block is always available when the data is shared. */
+static struct queuebuf_data *
+detach_data(struct queuebuf *b, int keep)
+{
+  struct queuebuf_data *d = b->ram_ptr;
+
+  if(d->refs > 1) {
+    d = memb_alloc(&buframmem);
+    if(d == NULL) {
+      PRINTF("detach_data: could not allocate queuebuf data\n");
+      return NULL;
+    }
+    if(keep) {
+      memcpy(d->data, b->ram_ptr->data, b->ram_ptr->len);
+      d->len = b->ram_ptr->len;
+    }
+    d->refs = 1;
+    b->ram_ptr->refs--;
+    b->ram_ptr = d;
+  }
+  if(packetbuf_origin() == d) {
+    packetbuf_set_origin(NULL);
+  }
+  return d;
+}
+/*---------------------------------------------------------------------------*/
+/* Copy the packetbuf to queuebuf data, unless it is a copy of it */
+static void
+data_from_packetbuf(struct queuebuf_data *d)
+{
+  d->len = packetbuf_copyto(d->data);
+  if(d->len == packetbuf_totlen()) {
+    packetbuf_set_origin(d);
+  }
+}
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
 /*---------------------------------------------------------------------------*/
 void
 queuebuf_init(void)
@@ -319,6 +391,25 @@ queuebuf_new_from_packetbuf(void)
     buf->line = line;
     buf->time = clock_time();
 #endif /* QUEUEBUF_DEBUG */
+#if QUEUEBUF_WITH_SHARED_DATA
+    /* Refer to the data of the queuebuf that the packetbuf is an
+       unmodified copy of, if any */
+    buframptr = (struct queuebuf_data *)packetbuf_origin();
+    if(buframptr != NULL) {
+      buframptr->refs++;
+    } else {
+      buframptr = memb_alloc(&buframmem);
+      if(buframptr == NULL) {
+        PRINTF("queuebuf_new_from_packetbuf: could not queuebuf data\n");
+        memb_free(&bufmem, buf);
+        return NULL;
+      }
+      buframptr->refs = 1;
+      data_from_packetbuf(buframptr);
+    }
+    buf->ram_ptr = buframptr;
+    packetbuf_attr_copyto(buf->attrs, buf->addrs);
+#else /* QUEUEBUF_WITH_SHARED_DATA */
     buf->ram_ptr = memb_alloc(&buframmem);
 #if WITH_SWAP
     /* If the allocation failed, store the qbuf in swap files */
@@ -352,6 +443,7 @@ queuebuf_new_from_packetbuf(void)
       }
     }
 #endif
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
 
 #if QUEUEBUF_STATS
     ++queuebuf_len;
@@ -371,7 +463,7 @@ void
 queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
-  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+  packetbuf_attr_copyto(ATTRS(buf, buframptr), ADDRS(buf, buframptr));
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
@@ -382,9 +474,21 @@ queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 void
 queuebuf_update_from_packetbuf(struct queuebuf *buf)
 {
+#if QUEUEBUF_WITH_SHARED_DATA
+  struct queuebuf_data *buframptr;
+
+  packetbuf_attr_copyto(buf->attrs, buf->addrs);
+  if(packetbuf_origin() != buf->ram_ptr) {
+    buframptr = detach_data(buf, 0);
+    if(buframptr != NULL) {
+      data_from_packetbuf(buframptr);
+    }
+  }
+#else /* QUEUEBUF_WITH_SHARED_DATA */
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
   packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
   buframptr->len = packetbuf_copyto(buframptr->data);
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
@@ -396,7 +500,9 @@ void
 queuebuf_free(struct queuebuf *buf)
 {
   if(memb_inmemb(&bufmem, buf)) {
-#if WITH_SWAP
+#if QUEUEBUF_WITH_SHARED_DATA
+    release_data(buf->ram_ptr);
+#elif WITH_SWAP
     if(buf->location == IN_RAM) {
       memb_free(&buframmem, buf->ram_ptr);
     } else {
@@ -421,17 +527,40 @@ queuebuf_to_packetbuf(struct queuebuf *b)
 {
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+#if QUEUEBUF_WITH_SHARED_DATA
+    if(!packetbuf_restore(buframptr)) {
+      packetbuf_copyfrom(buframptr->data, buframptr->len);
+      packetbuf_set_origin(buframptr);
+    }
+#else /* QUEUEBUF_WITH_SHARED_DATA */
     packetbuf_copyfrom(buframptr->data, buframptr->len);
-    packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
+    packetbuf_attr_copyfrom(ATTRS(b, buframptr), ADDRS(b, buframptr));
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if QUEUEBUF_WITH_SHARED_DATA
+void
+queuebuf_unshare(struct queuebuf *b)
+{
+  if(memb_inmemb(&bufmem, b)) {
+    detach_data(b, 1);
   }
 }
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
 /*---------------------------------------------------------------------------*/
 void *
 queuebuf_dataptr(struct queuebuf *b)
 {
   if(memb_inmemb(&bufmem, b)) {
+#if QUEUEBUF_WITH_SHARED_DATA
+    /* The caller may modify the data */
+    struct queuebuf_data *buframptr = detach_data(b, 1);
+    return buframptr != NULL ? buframptr->data : NULL;
+#else /* QUEUEBUF_WITH_SHARED_DATA */
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
     return buframptr->data;
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
   }
   return NULL;
 }
@@ -447,14 +576,14 @@ linkaddr_t *
 queuebuf_addr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
-  return &buframptr->addrs[type - PACKETBUF_ADDR_FIRST].addr;
+  return &ADDRS(b, buframptr)[type - PACKETBUF_ADDR_FIRST].addr;
 }
 /*---------------------------------------------------------------------------*/
 packetbuf_attr_t
 queuebuf_attr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
-  return buframptr->attrs[type].val;
+  return ATTRS(b, buframptr)[type].val;
 }
 /*---------------------------------------------------------------------------*/
 void
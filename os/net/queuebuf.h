@@ -86,6 +86,22 @@
   #define WITH_SWAP 0
 #endif /* QUEUEBUFRAM_CONF_NUM */
 
+/* QUEUEBUF_WITH_SHARED_DATA lets queuebufs that hold the same packet
+   share its data, with a reference count, while each keeps its own
+   attributes. A packet that is queued again without having been
+   modified in the packetbuf, and a queued packet that is loaded back
+   into the packetbuf it was taken from, are then not copied. This
+   cannot be combined with swapping. */
+#ifdef QUEUEBUF_CONF_WITH_SHARED_DATA
+#define QUEUEBUF_WITH_SHARED_DATA QUEUEBUF_CONF_WITH_SHARED_DATA
+#else /* QUEUEBUF_CONF_WITH_SHARED_DATA */
+#define QUEUEBUF_WITH_SHARED_DATA 0
+#endif /* QUEUEBUF_CONF_WITH_SHARED_DATA */
+
+#if QUEUEBUF_WITH_SHARED_DATA && WITH_SWAP
+#error "QUEUEBUF_CONF_WITH_SHARED_DATA cannot be used with swapping"
+#endif
+
 #ifdef QUEUEBUF_CONF_DEBUG
 #define QUEUEBUF_DEBUG QUEUEBUF_CONF_DEBUG
 #else /* QUEUEBUF_CONF_DEBUG */
@@ -108,6 +124,16 @@ void queuebuf_update_from_packetbuf(struct queuebuf *b);
 void queuebuf_to_packetbuf(struct queuebuf *b);
 void queuebuf_free(struct queuebuf *b);
 
+#if QUEUEBUF_WITH_SHARED_DATA
+/* Give a queuebuf its own copy of its data, so that the data can later
+   be modified through queuebuf_dataptr() without allocating memory,
+   e.g. from interrupt context. The data is not shared again unless the
+   queuebuf is loaded into the packetbuf. */
+void queuebuf_unshare(struct queuebuf *b);
+#else /* QUEUEBUF_WITH_SHARED_DATA */
+#define queuebuf_unshare(b)
+#endif /* QUEUEBUF_WITH_SHARED_DATA */
+
 void *queuebuf_dataptr(struct queuebuf *b);
 int queuebuf_datalen(struct queuebuf *b);
 
@@ -61,6 +61,7 @@
 #include "ip64/ip64-slip-interface.h"
 #include "ip64/ip64-dns64.h"
 #include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-chksum.h"
 #include "ip64/ip64-ipv4-dhcp.h"
 #include "contiki-net.h"
 
@@ -265,91 +266,59 @@ ip64_set_ipv6_address(const uip_ip6addr_t *addr)
 }
 /*---------------------------------------------------------------------------*/
 static uint16_t
-chksum(uint16_t sum, const uint8_t *data, uint16_t len)
-{
-  uint16_t t;
-  const uint8_t *dataptr;
-  const uint8_t *last_byte;
-
-  dataptr = data;
-  last_byte = data + len - 1;
-
-  while(dataptr < last_byte) {	/* At least two more bytes */
-    t = (dataptr[0] << 8) + dataptr[1];
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-    dataptr += 2;
-  }
-
-  if(dataptr == last_byte) {
-    t = (dataptr[0] << 8) + 0;
-    sum += t;
-    if(sum < t) {
-      sum++;		/* carry */
-    }
-  }
-
-  /* Return sum in host byte order. */
-  return sum;
-}
-/*---------------------------------------------------------------------------*/
-static uint16_t
 ipv4_checksum(struct ipv4_hdr *hdr)
 {
   uint16_t sum;
 
-  sum = chksum(0, (uint8_t *)hdr, IPV4_HDRLEN);
+  sum = uip_chksum_add(0, hdr, IPV4_HDRLEN);
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
 /*---------------------------------------------------------------------------*/
+/* Computes the checksum of a transport layer segment from the partial
+   sum of its header and data. */
 static uint16_t
-ipv4_transport_checksum(const uint8_t *packet, uint16_t len, uint8_t proto)
+ipv4_transport_checksum(const uint8_t *packet, uint16_t len, uint8_t proto,
+                        uint16_t sum)
 {
-  uint16_t transport_layer_len;
-  uint16_t sum;
+  uint8_t lenproto[4];
   struct ipv4_hdr *v4hdr = (struct ipv4_hdr *)packet;
 
-  transport_layer_len = len - IPV4_HDRLEN;
-
-  /* First sum pseudoheader. */
+  /* Sum pseudoheader. */
 
   if(proto != IP_PROTO_ICMPV4) {
-    /* IP protocol and length fields. This addition cannot carry. */
-    sum = transport_layer_len + proto;
+    /* IP protocol and length fields. */
+    lenproto[0] = (len - IPV4_HDRLEN) >> 8;
+    lenproto[1] = (len - IPV4_HDRLEN) & 0xff;
+    lenproto[2] = 0;
+    lenproto[3] = proto;
+    sum = uip_chksum_add(sum, lenproto, sizeof(lenproto));
     /* Sum IP source and destination addresses. */
-    sum = chksum(sum, (uint8_t *)&v4hdr->srcipaddr, 2 * sizeof(uip_ip4addr_t));
-  } else {
-    /* ping replies' checksums are calculated over the icmp-part only */
-    sum = 0;
+    sum = uip_chksum_add(sum, &v4hdr->srcipaddr, 2 * sizeof(uip_ip4addr_t));
   }
-
-  /* Sum transport layer header and data. */
-  sum = chksum(sum, &packet[IPV4_HDRLEN], transport_layer_len);
+  /* ping replies' checksums are calculated over the icmp-part only */
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
 /*---------------------------------------------------------------------------*/
+/* Computes the checksum of a transport layer segment from the partial
+   sum of its header and data. */
 static uint16_t
-ipv6_transport_checksum(const uint8_t *packet, uint16_t len, uint8_t proto)
+ipv6_transport_checksum(const uint8_t *packet, uint16_t len, uint8_t proto,
+                        uint16_t sum)
 {
-  uint16_t transport_layer_len;
-  uint16_t sum;
+  uint8_t lenproto[4];
   struct ipv6_hdr *v6hdr = (struct ipv6_hdr *)packet;
 
-  transport_layer_len = len - IPV6_HDRLEN;
-
-  /* First sum pseudoheader. */
+  /* Sum pseudoheader. */
 
-  /* IP protocol and length fields. This addition cannot carry. */
-  sum = transport_layer_len + proto;
+  /* IP protocol and length fields. */
+  lenproto[0] = (len - IPV6_HDRLEN) >> 8;
+  lenproto[1] = (len - IPV6_HDRLEN) & 0xff;
+  lenproto[2] = 0;
+  lenproto[3] = proto;
+  sum = uip_chksum_add(sum, lenproto, sizeof(lenproto));
   /* Sum IP source and destination addresses. */
-  sum = chksum(sum, (uint8_t *)&v6hdr->srcipaddr, sizeof(uip_ip6addr_t));
-  sum = chksum(sum, (uint8_t *)&v6hdr->destipaddr, sizeof(uip_ip6addr_t));
-
-  /* Sum transport layer header and data. */
-  sum = chksum(sum, &packet[IPV6_HDRLEN], transport_layer_len);
+  sum = uip_chksum_add(sum, &v6hdr->srcipaddr, 2 * sizeof(uip_ip6addr_t));
 
   return (sum == 0) ? 0xffff : uip_htons(sum);
 }
@@ -365,6 +334,8 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
   struct icmpv4_hdr *icmpv4hdr;
   struct icmpv6_hdr *icmpv6hdr;
   uint16_t ipv6len, ipv4len;
+  uint16_t sum, old_sum, new_sum;
+  const uint16_t *srcport;
   struct ip64_addrmap_entry *m;
 
   v6hdr = (struct ipv6_hdr *)ipv6packet;
@@ -379,10 +350,12 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
   }
 
   /* We copy the data from the IPv6 packet into the IPv4 packet. We do
-     not modify the data in any way. */
-  memcpy(&resultpacket[IPV4_HDRLEN],
-	 &ipv6packet[IPV6_HDRLEN],
-	 ipv6len - IPV6_HDRLEN);
+     not modify the data in any way, but sum it while copying it so
+     that we can check its checksum without reading it again. */
+  sum = uip_chksum_copy(0, &resultpacket[IPV4_HDRLEN],
+                        &ipv6packet[IPV6_HDRLEN],
+                        ipv6len - IPV6_HDRLEN);
+  srcport = (const uint16_t *)&ipv6packet[IPV6_HDRLEN];
 
   udphdr = (struct udp_hdr *)&resultpacket[IPV4_HDRLEN];
   tcphdr = (struct tcp_hdr *)&resultpacket[IPV4_HDRLEN];
@@ -423,10 +396,10 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
     v4hdr->proto = IP_PROTO_TCP;
 
     /* Compute and check the TCP checksum - since we're going to
-       recompute it ourselves, we must ensure that it was correct in
+       update it ourselves, we must ensure that it was correct in
        the first place. */
     if(ipv6_transport_checksum(ipv6packet, ipv6len,
-                               IP_PROTO_TCP) != 0xffff) {
+                               IP_PROTO_TCP, sum) != 0xffff) {
       LOG_WARN("Bad TCP checksum, dropping\n");
     }
 
@@ -445,10 +418,10 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
                       BUFSIZE - IPV4_HDRLEN - sizeof(struct udp_hdr));
     }
     /* Compute and check the UDP checksum - since we're going to
-       recompute it ourselves, we must ensure that it was correct in
+       update it ourselves, we must ensure that it was correct in
        the first place. */
     if(ipv6_transport_checksum(ipv6packet, ipv6len,
-                               IP_PROTO_UDP) != 0xffff) {
+                               IP_PROTO_UDP, sum) != 0xffff) {
       LOG_WARN("Bad UDP checksum, dropping\n");
     }
     break;
@@ -607,27 +580,45 @@ ip64_6to4(const uint8_t *ipv6packet, const uint16_t ipv6packet_len,
 
 
 
+  /* The TCP and UDP checksums are updated incrementally (RFC 1624)
+     for the changes of the pseudoheader addresses and the source
+     port, which are the only changes to the checksummed data. */
+  old_sum = uip_chksum_add(0, &v6hdr->srcipaddr, 2 * sizeof(uip_ip6addr_t));
+  old_sum = uip_chksum_add(old_sum, srcport, sizeof(*srcport));
+  new_sum = uip_chksum_add(0, &v4hdr->srcipaddr, 2 * sizeof(uip_ip4addr_t));
+  new_sum = uip_chksum_add(new_sum, &udphdr->srcport, sizeof(udphdr->srcport));
+
   /* The checksum is in different places in the different protocol
      headers, so we need to be sure that we update the correct
      field. */
   switch(v4hdr->proto) {
   case IP_PROTO_TCP:
-    tcphdr->tcpchksum = 0;
-    tcphdr->tcpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
-						  IP_PROTO_TCP));
+    tcphdr->tcpchksum = uip_chksum_update(tcphdr->tcpchksum,
+                                          old_sum, new_sum);
     break;
   case IP_PROTO_UDP:
-    udphdr->udpchksum = 0;
-    udphdr->udpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
-						  IP_PROTO_UDP));
+    if(udphdr->destport == UIP_HTONS(DNS_PORT) || udphdr->udpchksum == 0) {
+      /* The DNS64 module has rewritten the data, or there was no
+         checksum to update. */
+      udphdr->udpchksum = 0;
+      sum = uip_chksum_add(0, &resultpacket[IPV4_HDRLEN],
+                           ipv4len - IPV4_HDRLEN);
+      udphdr->udpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
+						    IP_PROTO_UDP, sum));
+    } else {
+      udphdr->udpchksum = uip_chksum_update(udphdr->udpchksum,
+                                            old_sum, new_sum);
+    }
     if(udphdr->udpchksum == 0) {
       udphdr->udpchksum = 0xffff;
     }
     break;
   case IP_PROTO_ICMPV4:
     icmpv4hdr->icmpchksum = 0;
+    sum = uip_chksum_add(0, &resultpacket[IPV4_HDRLEN],
+                         ipv4len - IPV4_HDRLEN);
     icmpv4hdr->icmpchksum = ~(ipv4_transport_checksum(resultpacket, ipv4len,
-						      IP_PROTO_ICMPV4));
+						      IP_PROTO_ICMPV4, sum));
     break;
 
   default:
@@ -651,6 +642,8 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
   struct icmpv4_hdr *icmpv4hdr;
   struct icmpv6_hdr *icmpv6hdr;
   uint16_t ipv4len, ipv6len, ipv6_packet_len;
+  uint16_t sum, old_sum, new_sum;
+  const struct udp_hdr *v4udphdr;
   struct ip64_addrmap_entry *m;
 
   v6hdr = (struct ipv6_hdr *)resultpacket;
@@ -678,7 +671,8 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
   memcpy(&resultpacket[IPV6_HDRLEN],
 	 &ipv4packet[IPV4_HDRLEN],
 	 ipv4len - IPV4_HDRLEN);
-  
+  v4udphdr = (const struct udp_hdr *)&ipv4packet[IPV4_HDRLEN];
+
   udphdr = (struct udp_hdr *)&resultpacket[IPV6_HDRLEN];
   tcphdr = (struct tcp_hdr *)&resultpacket[IPV6_HDRLEN];
   icmpv4hdr = (struct icmpv4_hdr *)&ipv4packet[IPV4_HDRLEN];
@@ -842,23 +836,44 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
     }
   }
 
+  /* The TCP and UDP checksums are updated incrementally (RFC 1624)
+     for the changes of the pseudoheader addresses and the destination
+     port, which are the only changes to the checksummed data unless
+     the DNS64 module has rewritten it. */
+  old_sum = uip_chksum_add(0, &v4hdr->srcipaddr, 2 * sizeof(uip_ip4addr_t));
+  old_sum = uip_chksum_add(old_sum, &v4udphdr->destport,
+                           sizeof(v4udphdr->destport));
+  new_sum = uip_chksum_add(0, &v6hdr->srcipaddr, 2 * sizeof(uip_ip6addr_t));
+  new_sum = uip_chksum_add(new_sum, &udphdr->destport,
+                           sizeof(udphdr->destport));
+
   /* The checksum is in different places in the different protocol
      headers, so we need to be sure that we update the correct
      field. */
   switch(v6hdr->nxthdr) {
   case IP_PROTO_TCP:
-    tcphdr->tcpchksum = 0;
-    tcphdr->tcpchksum = ~(ipv6_transport_checksum(resultpacket,
-						  ipv6len,
-						  IP_PROTO_TCP));
+    tcphdr->tcpchksum = uip_chksum_update(tcphdr->tcpchksum,
+                                          old_sum, new_sum);
     break;
   case IP_PROTO_UDP:
-    udphdr->udpchksum = 0;
     /* As the udplen might have changed (DNS) we need to update it also */
     udphdr->udplen = uip_htons(ipv6_packet_len);
-    udphdr->udpchksum = ~(ipv6_transport_checksum(resultpacket,
-						  ipv6len,
-						  IP_PROTO_UDP));
+    if(udphdr->srcport == UIP_HTONS(DNS_PORT) || udphdr->udpchksum == 0) {
+      /* The DNS64 module has rewritten the data, or the IPv4 packet
+         had no checksum, which is mandatory in IPv6. */
+      udphdr->udpchksum = 0;
+      sum = uip_chksum_add(0, &resultpacket[IPV6_HDRLEN], ipv6_packet_len);
+      udphdr->udpchksum = ~(ipv6_transport_checksum(resultpacket,
+						    ipv6len,
+						    IP_PROTO_UDP, sum));
+    } else {
+      old_sum = uip_chksum_add(old_sum, &v4udphdr->udplen,
+                               sizeof(v4udphdr->udplen));
+      new_sum = uip_chksum_add(new_sum, &udphdr->udplen,
+                               sizeof(udphdr->udplen));
+      udphdr->udpchksum = uip_chksum_update(udphdr->udpchksum,
+                                            old_sum, new_sum);
+    }
     if(udphdr->udpchksum == 0) {
       udphdr->udpchksum = 0xffff;
     }
@@ -866,9 +881,10 @@ ip64_4to6(const uint8_t *ipv4packet, const uint16_t ipv4packet_len,
 
   case IP_PROTO_ICMPV6:
     icmpv6hdr->icmpchksum = 0;
+    sum = uip_chksum_add(0, &resultpacket[IPV6_HDRLEN], ipv6_packet_len);
     icmpv6hdr->icmpchksum = ~(ipv6_transport_checksum(resultpacket,
                                                 ipv6len,
-                                                IP_PROTO_ICMPV6));
+                                                IP_PROTO_ICMPV6, sum));
     break;
   default:
     LOG_WARN("4to6: Protocol type %d not supported\n", v4hdr->proto);
@@ -70,6 +70,13 @@
 #define DB_FEATURE_INTEGRITY		0
 #endif /* DB_FEATURE_INTEGRITY */
 
+/* Compile the condition of a selection once per query into a program
+   that reads attribute values directly from rows, and read rows from
+   storage in batches. */
+#ifndef DB_FEATURE_COMPILED_LVM
+#define DB_FEATURE_COMPILED_LVM		0
+#endif /* DB_FEATURE_COMPILED_LVM */
+
 /*----------------------------------------------------------------------------*/
 
 /* Configuration parameters that may be trimmed to save space. */
@@ -111,6 +118,12 @@
 #define DB_VM_BYTECODE_SIZE		256
 #endif /* DB_VM_BYTECODE_SIZE */
 
+/* The number of rows read at once by a selection that scans a
+   relation, if DB_FEATURE_COMPILED_LVM is enabled. */
+#ifndef DB_ROW_BATCH_SIZE
+#define DB_ROW_BATCH_SIZE		8
+#endif /* DB_ROW_BATCH_SIZE */
+
 /*----------------------------------------------------------------------------*/
 
 /* Language options. */
@@ -236,5 +249,11 @@
 #define LVM_USE_FLOATS			DB_FEATURE_FLOATS
 #endif /* LVM_USE_FLOATS */
 
+/* The maximum depth of the value stack of a compiled LVM program.
+   Deeper expressions are interpreted instead. */
+#ifndef LVM_STACK_DEPTH
+#define LVM_STACK_DEPTH			8
+#endif /* LVM_STACK_DEPTH */
+
 
 #endif /* !DB_OPTIONS_H */
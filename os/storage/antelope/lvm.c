@@ -66,10 +66,23 @@
 
 #define IS_CONNECTIVE(op) ((op) & LVM_CONNECTIVE)
 
+#if DB_FEATURE_COMPILED_LVM
+/* Instructions of compiled programs that push values. The other
+   instructions are operators. */
+#define INSN_CONST  (LVM_OPERAND | 1)
+#define INSN_LOAD16 (LVM_OPERAND | 2)
+#define INSN_LOAD32 (LVM_OPERAND | 4)
+#endif /* DB_FEATURE_COMPILED_LVM */
+
 struct variable {
   operand_type_t type;
   operand_value_t value;
   char name[LVM_MAX_NAME_LENGTH + 1];
+#if DB_FEATURE_COMPILED_LVM
+  /* The location of the value in the data of a compiled program. */
+  uint16_t offset;
+  uint8_t size;
+#endif /* DB_FEATURE_COMPILED_LVM */
 };
 typedef struct variable variable_t;
 
@@ -539,6 +552,224 @@ lvm_clone(lvm_instance_t *dst, lvm_instance_t *src)
   memcpy(dst, src, sizeof(*dst));
 }
 
+#if DB_FEATURE_COMPILED_LVM
+lvm_status_t
+lvm_bind_variable(char *name, unsigned offset, unsigned size)
+{
+  variable_id_t id;
+
+  id = lookup(name);
+  if(id == LVM_MAX_VARIABLE_ID || variables[id].name[0] == '\0') {
+    return LVM_INVALID_IDENTIFIER;
+  }
+  if(size != 2 && size != 4) {
+    return LVM_TYPE_ERROR;
+  }
+
+  variables[id].offset = offset;
+  variables[id].size = size;
+  return LVM_TRUE;
+}
+
+static lvm_status_t
+emit(lvm_program_t *program, uint8_t op, unsigned offset, long value)
+{
+  lvm_insn_t *insn;
+
+  if(program->length >= LVM_MAX_INSNS) {
+    return LVM_STACK_OVERFLOW;
+  }
+
+  insn = &program->insns[program->length++];
+  insn->op = op;
+  insn->offset = offset;
+  insn->value = value;
+  return LVM_TRUE;
+}
+
+static lvm_status_t
+compile_operand(lvm_instance_t *p, lvm_program_t *program, unsigned depth)
+{
+  operand_t operand;
+  variable_t *var;
+
+  if(depth >= LVM_STACK_DEPTH) {
+    return LVM_STACK_OVERFLOW;
+  }
+
+  get_operand(p, &operand);
+  switch(operand.type) {
+  case LVM_VARIABLE:
+    var = &variables[operand.value.id];
+    if(var->size == 0) {
+      /* The value is not in the data of the program. */
+      return LVM_INVALID_IDENTIFIER;
+    }
+    return emit(program, var->size == 2 ? INSN_LOAD16 : INSN_LOAD32,
+                var->offset, 0);
+  default:
+    return emit(program, INSN_CONST, 0, operand_to_long(&operand));
+  }
+}
+
+static lvm_status_t
+compile_expr(lvm_instance_t *p, lvm_program_t *program, operator_t op,
+             unsigned depth)
+{
+  int i;
+  lvm_status_t r;
+
+  for(i = 0; i < 2; i++) {
+    switch(get_type(p)) {
+    case LVM_ARITH_OP:
+      r = compile_expr(p, program, *get_operator(p), depth + i);
+      break;
+    case LVM_OPERAND:
+      r = compile_operand(p, program, depth + i);
+      break;
+    default:
+      r = LVM_SEMANTIC_ERROR;
+    }
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+  }
+
+  return emit(program, op, 0, 0);
+}
+
+static lvm_status_t
+compile_logic(lvm_instance_t *p, lvm_program_t *program, operator_t op,
+              unsigned depth)
+{
+  int i;
+  unsigned arguments;
+  lvm_status_t r;
+
+  if(IS_CONNECTIVE(op)) {
+    arguments = op == LVM_NOT ? 1 : 2;
+    for(i = 0; i < arguments; i++) {
+      if(get_type(p) != LVM_CMP_OP) {
+        return LVM_SEMANTIC_ERROR;
+      }
+      r = compile_logic(p, program, *get_operator(p), depth + i);
+      if(LVM_ERROR(r)) {
+        return r;
+      }
+    }
+    return emit(program, op, 0, 0);
+  }
+
+  return compile_expr(p, program, op, depth);
+}
+
+/*
+ * Compiles the bytecode into a program that reads the values of the
+ * variables from the data given at execution, at the locations bound
+ * with lvm_bind_variable(). The program is evaluated in postfix order,
+ * so it needs neither recursion nor variable lookups.
+ */
+lvm_status_t
+lvm_compile(lvm_instance_t *p, lvm_program_t *program)
+{
+  lvm_status_t status;
+
+  p->ip = 0;
+  program->length = 0;
+  if(get_type(p) != LVM_CMP_OP) {
+    return LVM_SEMANTIC_ERROR;
+  }
+
+  status = compile_logic(p, program, *get_operator(p), 0);
+  if(LVM_ERROR(status)) {
+    PRINTF("LVM: Compilation error: %d\n", (int)status);
+    return status;
+  }
+
+  return LVM_TRUE;
+}
+
+lvm_status_t
+lvm_execute_compiled(const lvm_program_t *program, const unsigned char *data)
+{
+  long stack[LVM_STACK_DEPTH];
+  const lvm_insn_t *insn;
+  const unsigned char *ptr;
+  long *top;
+
+  top = stack - 1;
+  for(insn = program->insns; insn < &program->insns[program->length]; insn++) {
+    switch(insn->op) {
+    case INSN_CONST:
+      *++top = insn->value;
+      continue;
+    case INSN_LOAD16:
+      ptr = data + insn->offset;
+      *++top = ptr[0] << 8 | ptr[1];
+      continue;
+    case INSN_LOAD32:
+      ptr = data + insn->offset;
+      *++top = (uint32_t)ptr[0] << 24 | (uint32_t)ptr[1] << 16 |
+               (uint32_t)ptr[2] << 8 | ptr[3];
+      continue;
+    case LVM_NOT:
+      *top = !*top;
+      continue;
+    default:
+      break;
+    }
+
+    /* Binary operators replace their two arguments with the result. */
+    top--;
+    switch(insn->op) {
+    case LVM_ADD:
+      top[0] += top[1];
+      break;
+    case LVM_SUB:
+      top[0] -= top[1];
+      break;
+    case LVM_MUL:
+      top[0] *= top[1];
+      break;
+    case LVM_DIV:
+      if(top[1] == 0) {
+        return LVM_MATH_ERROR;
+      }
+      top[0] /= top[1];
+      break;
+    case LVM_EQ:
+      top[0] = top[0] == top[1];
+      break;
+    case LVM_NEQ:
+      top[0] = top[0] != top[1];
+      break;
+    case LVM_GE:
+      top[0] = top[0] > top[1];
+      break;
+    case LVM_GEQ:
+      top[0] = top[0] >= top[1];
+      break;
+    case LVM_LE:
+      top[0] = top[0] < top[1];
+      break;
+    case LVM_LEQ:
+      top[0] = top[0] <= top[1];
+      break;
+    case LVM_AND:
+      top[0] = top[0] && top[1];
+      break;
+    case LVM_OR:
+      top[0] = top[0] || top[1];
+      break;
+    default:
+      return LVM_EXECUTION_ERROR;
+    }
+  }
+
+  return stack[0] ? LVM_TRUE : LVM_FALSE;
+}
+#endif /* DB_FEATURE_COMPILED_LVM */
+
 static void
 create_intersection(derivation_t *result, derivation_t *d1, derivation_t *d2)
 {
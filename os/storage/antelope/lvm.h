@@ -120,6 +120,27 @@ struct operand {
 };
 typedef struct operand operand_t;
 
+#if DB_FEATURE_COMPILED_LVM
+/* An instruction of a compiled program, which is executed in postfix
+   order on a stack of values. */
+struct lvm_insn {
+  uint8_t op;
+  uint16_t offset;
+  long value;
+};
+typedef struct lvm_insn lvm_insn_t;
+
+/* Every node of the bytecode has at least a type and an operator. */
+#define LVM_MAX_INSNS \
+  (DB_VM_BYTECODE_SIZE / (sizeof(node_type_t) + sizeof(operator_t)))
+
+struct lvm_program {
+  lvm_insn_t insns[LVM_MAX_INSNS];
+  uint16_t length;
+};
+typedef struct lvm_program lvm_program_t;
+#endif /* DB_FEATURE_COMPILED_LVM */
+
 void lvm_reset(lvm_instance_t *p, unsigned char *code, lvm_ip_t size);
 void lvm_clone(lvm_instance_t *dst, lvm_instance_t *src);
 lvm_status_t lvm_derive(lvm_instance_t *p);
@@ -140,5 +161,11 @@ lvm_status_t lvm_set_relation(lvm_instance_t *p, operator_t op);
 lvm_status_t lvm_set_operand(lvm_instance_t *p, operand_t *op);
 lvm_status_t lvm_set_long(lvm_instance_t *p, long l);
 lvm_status_t lvm_set_variable(lvm_instance_t *p, char *name);
+#if DB_FEATURE_COMPILED_LVM
+lvm_status_t lvm_bind_variable(char *name, unsigned offset, unsigned size);
+lvm_status_t lvm_compile(lvm_instance_t *p, lvm_program_t *program);
+lvm_status_t lvm_execute_compiled(const lvm_program_t *program,
+                                  const unsigned char *data);
+#endif /* DB_FEATURE_COMPILED_LVM */
 
 #endif /* LVM_H */
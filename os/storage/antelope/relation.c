@@ -88,6 +88,20 @@ static unsigned char * const left_row = row;
 static unsigned char * const right_row = extra_row;
 static unsigned char * const join_row = result_row;
 
+#if DB_FEATURE_COMPILED_LVM
+/* Rows read at once by a selection that scans a relation. */
+static unsigned char row_batch[DB_ROW_BATCH_SIZE * DB_MAX_ATTRIBUTES_PER_RELATION * DB_MAX_ELEMENT_SIZE];
+static tuple_id_t batch_start;
+static unsigned batch_count;
+
+/* The condition of the current selection, compiled to read attribute
+   values directly from the rows. */
+static lvm_program_t predicate;
+static int predicate_compiled;
+#else
+#define predicate_compiled 0
+#endif /* DB_FEATURE_COMPILED_LVM */
+
 LIST(relations);
 MEMB(relations_memb, relation_t, DB_RELATION_POOL_SIZE);
 MEMB(attributes_memb, attribute_t, DB_ATTRIBUTE_POOL_SIZE);
@@ -677,6 +691,9 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
   relation_t *result_rel;
   unsigned attribute_count;
   attribute_t *attr;
+#if DB_FEATURE_COMPILED_LVM
+  struct source_dest_map *map;
+#endif /* DB_FEATURE_COMPILED_LVM */
 
   result_rel = handle->result_rel;
 
@@ -703,6 +720,22 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
     }
   }
 
+#if DB_FEATURE_COMPILED_LVM
+  batch_count = 0;
+  predicate_compiled = 0;
+  if(adt->lvm_instance != NULL) {
+    for(map = attr_map; map < attr_map + attribute_count; map++) {
+      if(map->to_attr->domain == DOMAIN_INT) {
+        lvm_bind_variable(map->to_attr->name, map->from_offset, 2);
+      } else if(map->to_attr->domain == DOMAIN_LONG) {
+        lvm_bind_variable(map->to_attr->name, map->from_offset, 4);
+      }
+    }
+    /* If the condition cannot be compiled, it is interpreted instead. */
+    predicate_compiled = lvm_compile(adt->lvm_instance, &predicate) == LVM_TRUE;
+  }
+#endif /* DB_FEATURE_COMPILED_LVM */
+
   handle->flags |= DB_HANDLE_FLAG_PROCESSING;
 
   return DB_OK;
@@ -731,6 +764,48 @@ relation_process_remove(void *handle_ptr)
 }
 #endif
 
+#if DB_FEATURE_COMPILED_LVM
+/*
+ * Gets the next row of a relation scan from the current batch of rows,
+ * and reads the next batch when the current one has been used. If the
+ * condition is compiled, the rows that do not fulfill it are skipped
+ * until the end of the batch, in which case *row_ptr is set to NULL.
+ */
+static db_result_t
+get_batched_row(db_handle_t *handle, lvm_status_t wanted_result,
+                unsigned char **row_ptr)
+{
+  db_result_t result;
+  unsigned char *ptr;
+
+  if(handle->tuple_id < batch_start ||
+     handle->tuple_id >= batch_start + batch_count) {
+    batch_start = handle->tuple_id;
+    batch_count = DB_ROW_BATCH_SIZE;
+    result = storage_get_rows(handle->rel, &handle->tuple_id, row_batch,
+                              &batch_count);
+    if(result != DB_OK) {
+      batch_count = 0;
+      return result;
+    }
+  }
+
+  *row_ptr = NULL;
+  do {
+    ptr = row_batch +
+      (handle->tuple_id - batch_start) * handle->rel->row_length;
+    handle->tuple_id++;
+    if(!predicate_compiled ||
+       lvm_execute_compiled(&predicate, ptr) == wanted_result) {
+      *row_ptr = ptr;
+      break;
+    }
+  } while(handle->tuple_id < batch_start + batch_count);
+
+  return DB_OK;
+}
+#endif /* DB_FEATURE_COMPILED_LVM */
+
 db_result_t
 relation_process_select(void *handle_ptr)
 {
@@ -746,6 +821,7 @@ relation_process_select(void *handle_ptr)
   uint8_t intbuf[2];
   attribute_value_t value;
   lvm_status_t wanted_result;
+  unsigned char *row_ptr;
 
   handle = (db_handle_t *)handle_ptr;
   adt = (aql_adt_t *)handle->adt;
@@ -753,6 +829,11 @@ relation_process_select(void *handle_ptr)
   attribute_count = handle->result_rel->attribute_count;
   attr_map_end = attr_map + attribute_count;
 
+  wanted_result = LVM_TRUE;
+  if(AQL_GET_FLAGS(adt) & AQL_FLAG_INVERSE_LOGIC) {
+    wanted_result = LVM_FALSE;
+  }
+
   if(handle->flags & DB_HANDLE_FLAG_SEARCH_INDEX) {
     handle->tuple_id = index_get_next(&handle->index_iterator);
     if(handle->tuple_id == INVALID_TUPLE) {
@@ -771,8 +852,23 @@ relation_process_select(void *handle_ptr)
 
   /* Put the tuples fulfilling the given condition into a new relation.
      The tuples may be projected. */
+#if DB_FEATURE_COMPILED_LVM
+  if(handle->flags & DB_HANDLE_FLAG_SEARCH_INDEX) {
+    result = storage_get_row(handle->rel, &handle->tuple_id, row);
+    handle->tuple_id++;
+    row_ptr = row;
+    if(result == DB_OK && predicate_compiled &&
+       lvm_execute_compiled(&predicate, row) != wanted_result) {
+      return DB_OK;
+    }
+  } else {
+    result = get_batched_row(handle, wanted_result, &row_ptr);
+  }
+#else
   result = storage_get_row(handle->rel, &handle->tuple_id, row);
   handle->tuple_id++;
+  row_ptr = row;
+#endif /* DB_FEATURE_COMPILED_LVM */
   if(DB_ERROR(result)) {
     PRINTF("DB: Failed to get a row in relation %s!\n", handle->rel->name);
     return result;
@@ -783,21 +879,29 @@ relation_process_select(void *handle_ptr)
     return DB_FINISHED;
   }
 
+  if(row_ptr == NULL) {
+    /* No row in the batch fulfilled the given condition. */
+    return DB_OK;
+  }
+
   /* Process the attributes in the result relation. */
   for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
-    from_ptr = row + attr_map_ptr->from_offset;
+    from_ptr = row_ptr + attr_map_ptr->from_offset;
     result_attr = attr_map_ptr->to_attr;
 
-    /* Update the internal state of the PLE. */
-    if(result_attr->domain == DOMAIN_INT) {
-      operand_value.l = from_ptr[0] << 8 | from_ptr[1];
-      lvm_set_variable_value(result_attr->name, operand_value);
-    } else if(result_attr->domain == DOMAIN_LONG) {
-      operand_value.l = (uint32_t)from_ptr[0] << 24 |
-                        (uint32_t)from_ptr[1] << 16 |
-                        (uint32_t)from_ptr[2] << 8 |
-                        from_ptr[3];
-      lvm_set_variable_value(result_attr->name, operand_value);
+    /* Update the internal state of the PLE. A compiled condition
+       reads the values from the row instead. */
+    if(!predicate_compiled) {
+      if(result_attr->domain == DOMAIN_INT) {
+        operand_value.l = from_ptr[0] << 8 | from_ptr[1];
+        lvm_set_variable_value(result_attr->name, operand_value);
+      } else if(result_attr->domain == DOMAIN_LONG) {
+        operand_value.l = (uint32_t)from_ptr[0] << 24 |
+                          (uint32_t)from_ptr[1] << 16 |
+                          (uint32_t)from_ptr[2] << 8 |
+                          from_ptr[3];
+        lvm_set_variable_value(result_attr->name, operand_value);
+      }
     }
 
     if(result_attr->flags & ATTRIBUTE_FLAG_NO_STORE) {
@@ -813,17 +917,15 @@ relation_process_select(void *handle_ptr)
     }
   }
 
-  wanted_result = LVM_TRUE;
-  if(AQL_GET_FLAGS(adt) & AQL_FLAG_INVERSE_LOGIC) {
-    wanted_result = LVM_FALSE;
-  }
-
   /* Check whether the given predicate is true for this tuple. */
   if(adt->lvm_instance == NULL ||
+#if DB_FEATURE_COMPILED_LVM
+     predicate_compiled ||
+#endif /* DB_FEATURE_COMPILED_LVM */
      lvm_execute(adt->lvm_instance) == wanted_result) {
     if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
       for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
-        from_ptr = row + attr_map_ptr->from_offset;
+        from_ptr = row_ptr + attr_map_ptr->from_offset;
         result = db_phy_to_value(&value, attr_map_ptr->to_attr, from_ptr);
         if(DB_ERROR(result)) {
 	  return result;
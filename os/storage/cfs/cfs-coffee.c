@@ -58,6 +58,7 @@
 #include "cfs/cfs.h"
 #include "cfs-coffee-arch.h"
 #include "cfs/cfs-coffee.h"
+#include "lib/crc16.h"
 
 /* Micro logs enable modifications on storage types that do not support
    in-place updates. This applies primarily to flash memories. */
@@ -84,6 +85,16 @@
 #define COFFEE_EXTENDED_WEAR_LEVELLING  1
 #endif
 
+/*
+ * The number of files that a RAM directory cache can index by the
+ * hash of their names. The cache is built on the first lookup and
+ * spares the scan of the flash memory for files that are not open.
+ * Setting this to 0 disables the cache.
+ */
+#ifndef COFFEE_DIR_CACHE_SIZE
+#define COFFEE_DIR_CACHE_SIZE 0
+#endif
+
 #if COFFEE_START & (COFFEE_SECTOR_SIZE - 1)
 #error COFFEE_START must point to the first byte in a sector.
 #endif
@@ -190,6 +201,19 @@ struct file_header {
   char name[COFFEE_NAME_LENGTH];
 };
 
+#if COFFEE_DIR_CACHE_SIZE
+/* A directory cache entry maps the hash of a file name to the first
+   page of the file. The entries are sorted by hash. */
+struct dir_entry {
+  coffee_page_t page;
+  uint16_t hash;
+};
+
+#define DIR_CACHE_UNBUILT  0 /* The flash memory has not been scanned. */
+#define DIR_CACHE_COMPLETE 1 /* All active files are in the cache. */
+#define DIR_CACHE_PARTIAL  2 /* Some active files did not fit. */
+#endif /* COFFEE_DIR_CACHE_SIZE */
+
 /* This is needed because of a buggy compiler. */
 struct log_param {
   cfs_offset_t offset;
@@ -205,6 +229,11 @@ static struct file coffee_files[COFFEE_MAX_OPEN_FILES];
 static struct file_desc coffee_fd_set[COFFEE_FD_SET_SIZE];
 static coffee_page_t next_free;
 static char gc_wait;
+#if COFFEE_DIR_CACHE_SIZE
+static struct dir_entry dir_cache[COFFEE_DIR_CACHE_SIZE];
+static uint16_t dir_cache_count;
+static uint8_t dir_cache_state;
+#endif /* COFFEE_DIR_CACHE_SIZE */
 
 /*---------------------------------------------------------------------------*/
 static void
@@ -452,6 +481,130 @@ load_file(coffee_page_t start, struct file_header *hdr)
   return file;
 }
 /*---------------------------------------------------------------------------*/
+#if COFFEE_DIR_CACHE_SIZE
+static uint16_t
+name_hash(const char *name)
+{
+  return crc16_data((const unsigned char *)name, strlen(name), 0);
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the index of the first entry whose hash is not lower than
+   the given hash. */
+static uint16_t
+dir_cache_search(uint16_t hash)
+{
+  uint16_t low, high, mid;
+
+  low = 0;
+  high = dir_cache_count;
+  while(low < high) {
+    mid = low + (high - low) / 2;
+    if(dir_cache[mid].hash < hash) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dir_cache_add(const char *name, coffee_page_t page)
+{
+  uint16_t hash, i;
+
+  if(dir_cache_count == COFFEE_DIR_CACHE_SIZE) {
+    dir_cache_state = DIR_CACHE_PARTIAL;
+    return;
+  }
+  hash = name_hash(name);
+  i = dir_cache_search(hash);
+  memmove(&dir_cache[i + 1], &dir_cache[i],
+          (dir_cache_count - i) * sizeof(dir_cache[0]));
+  dir_cache[i].page = page;
+  dir_cache[i].hash = hash;
+  dir_cache_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dir_cache_remove(const char *name, coffee_page_t page)
+{
+  uint16_t hash, i;
+
+  hash = name_hash(name);
+  for(i = dir_cache_search(hash);
+      i < dir_cache_count && dir_cache[i].hash == hash; i++) {
+    if(dir_cache[i].page == page) {
+      dir_cache_count--;
+      memmove(&dir_cache[i], &dir_cache[i + 1],
+              (dir_cache_count - i) * sizeof(dir_cache[0]));
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct file *
+get_file(coffee_page_t page, struct file_header *hdr)
+{
+  int i;
+
+  for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
+    if(!FILE_FREE(&coffee_files[i]) && coffee_files[i].page == page) {
+      return &coffee_files[i];
+    }
+  }
+  return load_file(page, hdr);
+}
+/*---------------------------------------------------------------------------*/
+static struct file *
+find_file(const char *name)
+{
+  struct file_header hdr, found_hdr;
+  coffee_page_t page, found;
+  uint16_t i, hash;
+  int build;
+
+  /* Only the headers of files whose names have the same hash are read. */
+  hash = name_hash(name);
+  for(i = dir_cache_search(hash);
+      i < dir_cache_count && dir_cache[i].hash == hash; i++) {
+    read_header(&hdr, dir_cache[i].page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr) && strcmp(name, hdr.name) == 0) {
+      return get_file(dir_cache[i].page, &hdr);
+    }
+  }
+  /* A complete cache tells that the file does not exist. */
+  if(dir_cache_state == DIR_CACHE_COMPLETE) {
+    return NULL;
+  }
+
+  /* Scan the flash memory otherwise, and build the cache on the first
+     scan. */
+  build = dir_cache_state == DIR_CACHE_UNBUILT;
+  if(build) {
+    dir_cache_count = 0;
+    dir_cache_state = DIR_CACHE_COMPLETE;
+  }
+  found = INVALID_PAGE;
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr)) {
+      if(found == INVALID_PAGE && strcmp(name, hdr.name) == 0) {
+        found = page;
+        found_hdr = hdr;
+        if(!build) {
+          break;
+        }
+      }
+      if(build) {
+        dir_cache_add(hdr.name, page);
+      }
+    }
+  }
+
+  return found == INVALID_PAGE ? NULL : get_file(found, &found_hdr);
+}
+#else /* COFFEE_DIR_CACHE_SIZE */
 static struct file *
 find_file(const char *name)
 {
@@ -481,6 +634,7 @@ find_file(const char *name)
 
   return NULL;
 }
+#endif /* COFFEE_DIR_CACHE_SIZE */
 /*---------------------------------------------------------------------------*/
 static cfs_offset_t
 file_end(coffee_page_t start)
@@ -572,6 +726,11 @@ remove_by_page(coffee_page_t page, int remove_log,
 
   hdr.flags |= HDR_FLAG_OBSOLETE;
   write_header(&hdr, page);
+#if COFFEE_DIR_CACHE_SIZE
+  if(!HDR_LOG(hdr)) {
+    dir_cache_remove(hdr.name, page);
+  }
+#endif /* COFFEE_DIR_CACHE_SIZE */
 
   gc_wait = 0;
 
@@ -636,6 +795,11 @@ reserve(const char *name, coffee_page_t pages,
   hdr.max_pages = pages;
   hdr.flags = HDR_FLAG_ALLOCATED | flags;
   write_header(&hdr, page);
+#if COFFEE_DIR_CACHE_SIZE
+  if(!HDR_LOG(hdr)) {
+    dir_cache_add(hdr.name, page);
+  }
+#endif /* COFFEE_DIR_CACHE_SIZE */
 
   PRINTF("Coffee: Reserved %u pages starting from %u for file %s\n",
          (unsigned)pages, (unsigned)page, name);
@@ -1340,6 +1504,11 @@ cfs_coffee_format(void)
   memset(&coffee_fd_set, 0, sizeof(coffee_fd_set));
   next_free = 0;
   gc_wait = 1;
+#if COFFEE_DIR_CACHE_SIZE
+  /* There are no files after formatting. */
+  dir_cache_count = 0;
+  dir_cache_state = DIR_CACHE_COMPLETE;
+#endif /* COFFEE_DIR_CACHE_SIZE */
 
   PRINTF(" done!\n");
 
@@ -53,13 +53,105 @@
 LIST(ctimer_list);
 static bool initialized;
 
-/*---------------------------------------------------------------------------*/
 PROCESS(ctimer_process, "Ctimer process");
+/*---------------------------------------------------------------------------*/
+#if CTIMER_WITH_BATCHING
+/*
+ * Once the ctimer process has started, callback timers are queued in
+ * the event timer heap only, and ctimer_list stays empty. Expired
+ * timers are moved to the queue below, linked through their next
+ * pointers, until the ctimer process runs their callbacks.
+ */
+static struct ctimer *expired_head;
+static struct ctimer *expired_tail;
+/*---------------------------------------------------------------------------*/
+/* Take a timer whose callback has not run yet off the expired queue.
+   This only happens when the timer is stopped or re-armed by another
+   callback in the same batch, so the linear search is rare. */
+static void
+expired_remove(struct ctimer *c)
+{
+  struct ctimer *t;
+
+  /* Every queued timer but the tail has a next pointer, so this rules
+     out most timers at once. A timer that was never set may however
+     hold anything in next, so the queue is searched for it below. */
+  if(c->next == NULL && c != expired_tail) {
+    return;
+  }
+
+  if(c == expired_head) {
+    expired_head = c->next;
+    if(expired_head == NULL) {
+      expired_tail = NULL;
+    }
+  } else {
+    for(t = expired_head; t != NULL && t->next != c; t = t->next);
+    if(t == NULL) {
+      /* Not queued */
+      return;
+    }
+    t->next = c->next;
+    if(c == expired_tail) {
+      expired_tail = t;
+    }
+  }
+  c->next = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Called by the event timer process for each expired callback timer,
+   in order of expiration. */
+static void
+expired_add(struct etimer *et)
+{
+  struct ctimer *c;
+
+  c = (struct ctimer *)((char *)et - offsetof(struct ctimer, etimer));
+  c->next = NULL;
+  if(expired_tail == NULL) {
+    expired_head = c;
+  } else {
+    expired_tail->next = c;
+  }
+  expired_tail = c;
+
+  process_poll(&ctimer_process);
+}
+#endif /* CTIMER_WITH_BATCHING */
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(ctimer_process, ev, data)
 {
   struct ctimer *c;
   PROCESS_BEGIN();
 
+#if CTIMER_WITH_BATCHING
+  etimer_set_expiration_handler(&ctimer_process, expired_add);
+  while((c = list_pop(ctimer_list)) != NULL) {
+    c->next = NULL;
+    etimer_set(&c->etimer, c->etimer.timer.interval);
+  }
+  initialized = true;
+
+  while(1) {
+    PROCESS_YIELD_UNTIL(ev == PROCESS_EVENT_POLL);
+    /* Run the callbacks of all timers that have expired since the last
+       poll. Callbacks may stop or re-arm any timer in the queue. */
+    while(expired_head != NULL) {
+      c = expired_head;
+      expired_head = c->next;
+      if(expired_head == NULL) {
+        expired_tail = NULL;
+      }
+      c->next = NULL;
+      c->etimer.p = PROCESS_NONE;
+      PROCESS_CONTEXT_BEGIN(c->p);
+      if(c->f != NULL) {
+        c->f(c->ptr);
+      }
+      PROCESS_CONTEXT_END(c->p);
+    }
+  }
+#else /* CTIMER_WITH_BATCHING */
   for(c = list_head(ctimer_list); c != NULL; c = c->next) {
     etimer_set(&c->etimer, c->etimer.timer.interval);
   }
@@ -79,6 +171,7 @@ PROCESS_THREAD(ctimer_process, ev, data)
       }
     }
   }
+#endif /* CTIMER_WITH_BATCHING */
   PROCESS_END();
 }
 /*---------------------------------------------------------------------------*/
@@ -90,6 +183,18 @@ ctimer_init(void)
   process_start(&ctimer_process, NULL);
 }
 /*---------------------------------------------------------------------------*/
+static void
+add_to_list(struct ctimer *c)
+{
+#if CTIMER_WITH_BATCHING
+  /* The event timer heap keeps track of the timer once the ctimer
+     process has started. */
+  if(initialized) {
+    return;
+  }
+#endif /* CTIMER_WITH_BATCHING */
+  list_add(ctimer_list, c);
+}
 /*---------------------------------------------------------------------------*/
 void
 ctimer_set_with_process(struct ctimer *c, clock_time_t t,
@@ -100,6 +205,9 @@ ctimer_set_with_process(struct ctimer *c, clock_time_t t,
   c->f = f;
   c->ptr = ptr;
   if(initialized) {
+#if CTIMER_WITH_BATCHING
+    expired_remove(c);
+#endif /* CTIMER_WITH_BATCHING */
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_set(&c->etimer, t);
     PROCESS_CONTEXT_END(&ctimer_process);
@@ -107,43 +215,58 @@ ctimer_set_with_process(struct ctimer *c, clock_time_t t,
     c->etimer.timer.interval = t;
   }
 
-  list_add(ctimer_list, c);
+  add_to_list(c);
 }
 /*---------------------------------------------------------------------------*/
 void
 ctimer_reset(struct ctimer *c)
 {
   if(initialized) {
+#if CTIMER_WITH_BATCHING
+    expired_remove(c);
+#endif /* CTIMER_WITH_BATCHING */
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_reset(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
   }
 
-  list_add(ctimer_list, c);
+  add_to_list(c);
 }
 /*---------------------------------------------------------------------------*/
 void
 ctimer_restart(struct ctimer *c)
 {
   if(initialized) {
+#if CTIMER_WITH_BATCHING
+    expired_remove(c);
+#endif /* CTIMER_WITH_BATCHING */
     PROCESS_CONTEXT_BEGIN(&ctimer_process);
     etimer_restart(&c->etimer);
     PROCESS_CONTEXT_END(&ctimer_process);
   }
 
-  list_add(ctimer_list, c);
+  add_to_list(c);
 }
 /*---------------------------------------------------------------------------*/
 void
 ctimer_stop(struct ctimer *c)
 {
   if(initialized) {
+#if CTIMER_WITH_BATCHING
+    expired_remove(c);
+#endif /* CTIMER_WITH_BATCHING */
     etimer_stop(&c->etimer);
   } else {
     c->etimer.next = NULL;
     c->etimer.p = PROCESS_NONE;
   }
+#if CTIMER_WITH_BATCHING
+  if(!initialized) {
+    list_remove(ctimer_list, c);
+  }
+#else /* CTIMER_WITH_BATCHING */
   list_remove(ctimer_list, c);
+#endif /* CTIMER_WITH_BATCHING */
 }
 /*---------------------------------------------------------------------------*/
 bool
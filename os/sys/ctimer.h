@@ -60,6 +60,22 @@
 
 #include <stdbool.h>
 
+/**
+ * Queue callback timers directly in the event timer heap and run all
+ * callbacks that expire before the ctimer process is scheduled in a
+ * single pass, instead of posting one event per expired timer. This
+ * requires ETIMER_CONF_WITH_HEAP.
+ */
+#ifdef CTIMER_CONF_WITH_BATCHING
+#define CTIMER_WITH_BATCHING CTIMER_CONF_WITH_BATCHING
+#else
+#define CTIMER_WITH_BATCHING 0
+#endif
+
+#if CTIMER_WITH_BATCHING && !ETIMER_WITH_HEAP
+#error "CTIMER_CONF_WITH_BATCHING requires ETIMER_CONF_WITH_HEAP"
+#endif
+
 struct ctimer {
   struct ctimer *next;
   struct etimer etimer;
@@ -54,9 +54,160 @@ static clock_time_t next_expiration;
 
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
+#if ETIMER_WITH_HEAP
+static struct process *handler_process;
+static void (*handler)(struct etimer *);
+/*---------------------------------------------------------------------------*/
+/*
+ * The pending timers form a pairing heap rooted at timerlist. Each
+ * timer points to its first child, siblings are linked through the
+ * next pointer, and the prev pointer refers back to the parent or the
+ * previous sibling.
+ */
+static bool
+expires_before(struct etimer *a, struct etimer *b)
+{
+  return CLOCK_LT(etimer_expiration_time(a), etimer_expiration_time(b));
+}
+/*---------------------------------------------------------------------------*/
+static bool
+is_queued(struct etimer *et)
+{
+  if(et->self != et) {
+    return false;
+  }
+  /* A queued timer is the root, or is linked from its parent or
+     previous sibling. */
+  return et == timerlist ||
+    (et->prev != NULL && (et->prev->child == et || et->prev->next == et));
+}
+/*---------------------------------------------------------------------------*/
+/* Meld two detached heaps and return the root of the result. */
+static struct etimer *
+heap_meld(struct etimer *a, struct etimer *b)
+{
+  struct etimer *tmp;
+
+  if(a == NULL) {
+    return b;
+  }
+  if(b == NULL) {
+    return a;
+  }
+  if(expires_before(b, a)) {
+    tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  /* b becomes the first child of a. */
+  b->prev = a;
+  b->next = a->child;
+  if(a->child != NULL) {
+    a->child->prev = b;
+  }
+  a->child = b;
+  return a;
+}
+/*---------------------------------------------------------------------------*/
+/* Meld a list of sibling subtrees into one heap, using the two-pass
+   pairing strategy that gives the O(log n) amortized bound. */
+static struct etimer *
+heap_merge_pairs(struct etimer *first)
+{
+  struct etimer *a, *b, *pairs, *result;
+
+  /* First pass: meld the siblings pairwise from left to right. The
+     melded pairs are pushed on a stack linked through next. */
+  pairs = NULL;
+  while(first != NULL) {
+    a = first;
+    b = a->next;
+    first = b != NULL ? b->next : NULL;
+
+    a->next = a->prev = NULL;
+    if(b != NULL) {
+      b->next = b->prev = NULL;
+    }
+    a = heap_meld(a, b);
+    a->next = pairs;
+    pairs = a;
+  }
+
+  /* Second pass: meld the pairs from right to left. */
+  result = NULL;
+  while(pairs != NULL) {
+    a = pairs;
+    pairs = a->next;
+    a->next = NULL;
+    result = heap_meld(result, a);
+  }
+  return result;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_insert(struct etimer *et)
+{
+  et->child = et->next = et->prev = NULL;
+  et->self = et;
+  timerlist = heap_meld(timerlist, et);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_remove(struct etimer *et)
+{
+  if(et == timerlist) {
+    timerlist = heap_merge_pairs(et->child);
+  } else {
+    /* Unlink the subtree of et from its parent, and put its children
+       back into the heap. */
+    if(et->prev->child == et) {
+      et->prev->child = et->next;
+    } else {
+      et->prev->next = et->next;
+    }
+    if(et->next != NULL) {
+      et->next->prev = et->prev;
+    }
+    timerlist = heap_meld(timerlist, heap_merge_pairs(et->child));
+  }
+  et->child = et->next = et->prev = et->self = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Drop all timers belonging to process p. The heap is flattened into a
+   list of detached timers, and the remaining ones are melded back. */
+static void
+heap_remove_process(struct process *p)
+{
+  struct etimer *pending, *t, *c;
+
+  pending = timerlist;
+  timerlist = NULL;
+
+  while(pending != NULL) {
+    t = pending;
+    pending = t->next;
+    if(t->child != NULL) {
+      for(c = t->child; c->next != NULL; c = c->next);
+      c->next = pending;
+      pending = t->child;
+    }
+    t->child = t->next = t->prev = NULL;
+    if(t->p != p) {
+      timerlist = heap_meld(timerlist, t);
+    } else {
+      t->self = NULL;
+    }
+  }
+}
+#endif /* ETIMER_WITH_HEAP */
+/*---------------------------------------------------------------------------*/
 static void
 update_time(void)
 {
+#if ETIMER_WITH_HEAP
+  next_expiration = timerlist != NULL ? etimer_expiration_time(timerlist) : 0;
+#else /* ETIMER_WITH_HEAP */
   clock_time_t tdist;
   clock_time_t now;
   struct etimer *t;
@@ -75,10 +226,46 @@ update_time(void)
     }
     next_expiration = now + tdist;
   }
+#endif /* ETIMER_WITH_HEAP */
 }
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(etimer_process, ev, data)
 {
+#if ETIMER_WITH_HEAP
+  struct etimer *t;
+
+  PROCESS_BEGIN();
+
+  timerlist = NULL;
+
+  while(1) {
+    PROCESS_YIELD();
+
+    if(ev == PROCESS_EVENT_EXITED) {
+      heap_remove_process(data);
+      update_time();
+    } else if(ev == PROCESS_EVENT_POLL) {
+      /* Expired timers surface at the root of the heap in order. */
+      while(timerlist != NULL && timer_expired(&timerlist->timer)) {
+        t = timerlist;
+        if(t->p == handler_process && handler != NULL) {
+          heap_remove(t);
+          handler(t);
+          continue;
+        }
+        if(process_post(t->p, PROCESS_EVENT_TIMER, t) != PROCESS_ERR_OK) {
+          etimer_request_poll();
+          break;
+        }
+        t->p = PROCESS_NONE;
+        heap_remove(t);
+      }
+      update_time();
+    }
+  }
+
+  PROCESS_END();
+#else /* ETIMER_WITH_HEAP */
   struct etimer *t, *u;
 
   PROCESS_BEGIN();
@@ -105,6 +292,7 @@ PROCESS_THREAD(etimer_process, ev, data)
           }
         }
       }
+      update_time();
       continue;
     } else if(ev != PROCESS_EVENT_POLL) {
       continue;
@@ -139,8 +327,18 @@ again:
   }
 
   PROCESS_END();
+#endif /* ETIMER_WITH_HEAP */
 }
 /*---------------------------------------------------------------------------*/
+#if ETIMER_WITH_HEAP
+void
+etimer_set_expiration_handler(struct process *p, void (*f)(struct etimer *))
+{
+  handler_process = p;
+  handler = f;
+}
+#endif /* ETIMER_WITH_HEAP */
+/*---------------------------------------------------------------------------*/
 void
 etimer_request_poll(void)
 {
@@ -150,6 +348,18 @@ etimer_request_poll(void)
 static void
 add_timer(struct etimer *timer)
 {
+#if ETIMER_WITH_HEAP
+  etimer_request_poll();
+
+  /* The expiration time may have changed, so a queued timer is taken
+     out and inserted again at its new position. */
+  if(timer->p != PROCESS_NONE && is_queued(timer)) {
+    heap_remove(timer);
+  }
+  timer->p = PROCESS_CURRENT();
+  heap_insert(timer);
+  update_time();
+#else /* ETIMER_WITH_HEAP */
   struct etimer *t;
 
   etimer_request_poll();
@@ -171,6 +381,7 @@ add_timer(struct etimer *timer)
   timerlist = timer;
 
   update_time();
+#endif /* ETIMER_WITH_HEAP */
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -205,7 +416,17 @@ etimer_restart(struct etimer *et)
 void
 etimer_adjust(struct etimer *et, int timediff)
 {
+#if ETIMER_WITH_HEAP
+  if(et->p != PROCESS_NONE && is_queued(et)) {
+    heap_remove(et);
+    et->timer.start += timediff;
+    heap_insert(et);
+  } else {
+    et->timer.start += timediff;
+  }
+#else /* ETIMER_WITH_HEAP */
   et->timer.start += timediff;
+#endif /* ETIMER_WITH_HEAP */
   update_time();
 }
 /*---------------------------------------------------------------------------*/
@@ -236,6 +457,12 @@ etimer_next_expiration_time(void)
 void
 etimer_stop(struct etimer *et)
 {
+#if ETIMER_WITH_HEAP
+  if(et->p != PROCESS_NONE && is_queued(et)) {
+    heap_remove(et);
+    update_time();
+  }
+#else /* ETIMER_WITH_HEAP */
   struct etimer *t;
 
   /* First check if et is the first event timer on the list. */
@@ -260,6 +487,7 @@ etimer_stop(struct etimer *et)
 
   /* Remove the next pointer from the item to be removed. */
   et->next = NULL;
+#endif /* ETIMER_WITH_HEAP */
   /* Set the timer as expired */
   et->p = PROCESS_NONE;
 }
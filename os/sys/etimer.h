@@ -68,6 +68,18 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+/**
+ * Keep pending event timers in a pairing heap ordered by expiration
+ * time instead of in an unordered list. Setting, stopping, and
+ * expiring a timer then take O(log n) amortized time, and the next
+ * expiration time is found in O(1).
+ */
+#ifdef ETIMER_CONF_WITH_HEAP
+#define ETIMER_WITH_HEAP ETIMER_CONF_WITH_HEAP
+#else
+#define ETIMER_WITH_HEAP 0
+#endif
+
 /**
  * A timer.
  *
@@ -80,6 +92,17 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if ETIMER_WITH_HEAP
+  /* First child in the heap. The next pointer links the siblings. */
+  struct etimer *child;
+  /* Parent of a first child, otherwise the previous sibling. */
+  struct etimer *prev;
+  /* Points to the timer itself while it is queued. Unlike a flag or
+     the links above, memory that never held a queued timer at this
+     address does not look queued, so timers need not be zeroed before
+     they are first set or stopped. */
+  struct etimer *self;
+#endif /* ETIMER_WITH_HEAP */
 };
 
 /**
@@ -253,6 +276,24 @@ int etimer_pending(void);
  */
 clock_time_t etimer_next_expiration_time(void);
 
+#if ETIMER_WITH_HEAP
+/**
+ * \brief      Hand the expired timers of a process to a function
+ * \param p    The process that owns the timers
+ * \param f    The function to call with each expired timer
+ *
+ *             Instead of posting a PROCESS_EVENT_TIMER event for
+ *             each expired timer of process p, the event timer
+ *             process takes the timer off the queue and calls f. The
+ *             timer is not marked as expired: this is left to the
+ *             handler, by setting the process of the timer to
+ *             PROCESS_NONE. This lets a service such as ctimer handle
+ *             its timers in batches. Only one process at a time can
+ *             have an expiration handler.
+ */
+void etimer_set_expiration_handler(struct process *p,
+                                   void (*f)(struct etimer *));
+#endif /* ETIMER_WITH_HEAP */
 
 /** @} */
 
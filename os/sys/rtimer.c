@@ -50,13 +50,151 @@
 #define LOG_MODULE "RTimer"
 #define LOG_LEVEL LOG_LEVEL_NONE
 
+#if RTIMER_WITH_QUEUE
+
+#include "sys/critical.h"
+
+/* Pending tasks, sorted by deadline; tasks with equal deadlines are
+   kept in the order they were posted. */
+static struct rtimer *rtimer_queue;
+/*---------------------------------------------------------------------------*/
+/* Returns the first pending task after t with a higher priority that is
+   due less than RTIMER_PRIORITY_WINDOW ticks after t, if any. */
+static struct rtimer *
+preempting_task(const struct rtimer *t)
+{
+  struct rtimer *r;
+
+  for(r = t->next; r != NULL &&
+        RTIMER_CLOCK_DIFF(r->time, t->time) < RTIMER_PRIORITY_WINDOW;
+      r = r->next) {
+    if(r->priority > t->priority) {
+      return r;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the time at which the hardware compare should fire: that of
+   the head of the queue, or of the task it is held back for. */
+static rtimer_clock_t
+next_time(void)
+{
+  struct rtimer *r;
+
+  r = preempting_task(rtimer_queue);
+  return r != NULL ? r->time : rtimer_queue->time;
+}
+/*---------------------------------------------------------------------------*/
+/* Removes and returns the task to run at time now: the due task with the
+   highest priority that is not held back, or NULL if none may run yet. */
+static struct rtimer *
+take_next(rtimer_clock_t now)
+{
+  struct rtimer *r, *best, **prevp, **best_prevp;
+
+  best = NULL;
+  best_prevp = NULL;
+  for(prevp = &rtimer_queue, r = rtimer_queue;
+      r != NULL && !RTIMER_CLOCK_LT(now, r->time);
+      prevp = &r->next, r = r->next) {
+    if((best == NULL || r->priority > best->priority) &&
+       preempting_task(r) == NULL) {
+      best = r;
+      best_prevp = prevp;
+    }
+  }
+
+  if(best != NULL) {
+    *best_prevp = best->next;
+    best->next = NULL;
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+int
+rtimer_set_with_priority(struct rtimer *rtimer, rtimer_clock_t time,
+                         uint8_t priority, rtimer_callback_t func, void *ptr)
+{
+  struct rtimer *r, **prevp, **insertp;
+  int_master_status_t status;
+
+  LOG_DBG("rtimer_set time %lu priority %u\n",
+          (unsigned long)time, priority);
+
+  status = critical_enter();
+
+  insertp = NULL;
+  for(prevp = &rtimer_queue, r = rtimer_queue; r != NULL;
+      prevp = &r->next, r = r->next) {
+    if(r == rtimer) {
+      critical_exit(status);
+      return RTIMER_ERR_ALREADY_SCHEDULED;
+    }
+    if(insertp == NULL && RTIMER_CLOCK_LT(time, r->time)) {
+      insertp = prevp;
+    }
+  }
+  if(insertp == NULL) {
+    insertp = prevp;
+  }
+
+  rtimer->func = func;
+  rtimer->ptr = ptr;
+  rtimer->time = time;
+  rtimer->priority = priority;
+  rtimer->next = *insertp;
+  *insertp = rtimer;
+
+  /* The new task may be the earliest one, or hold back the earliest. */
+  if(insertp == &rtimer_queue || priority > rtimer_queue->priority) {
+    rtimer_arch_schedule(next_time());
+  }
+
+  critical_exit(status);
+  return RTIMER_OK;
+}
+/*---------------------------------------------------------------------------*/
+void
+rtimer_run_next(void)
+{
+  struct rtimer *t;
+  rtimer_clock_t now;
+  int_master_status_t status;
+
+  for(;;) {
+    status = critical_enter();
+    now = RTIMER_NOW();
+    t = take_next(now);
+    if(t == NULL) {
+      /* Nothing may run now. Tasks that are due but held back wait for
+         a task that is not due yet, so wake up for the first of those,
+         unless its time passed while we were looking. */
+      for(t = rtimer_queue; t != NULL && !RTIMER_CLOCK_LT(now, t->time);
+          t = t->next);
+      if(t != NULL && RTIMER_CLOCK_LT(RTIMER_NOW(), t->time)) {
+        rtimer_arch_schedule(t->time);
+      } else if(t != NULL) {
+        critical_exit(status);
+        continue;
+      }
+      critical_exit(status);
+      return;
+    }
+    critical_exit(status);
+
+    t->func(t, t->ptr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#else /* RTIMER_WITH_QUEUE */
+
 static struct rtimer *next_rtimer;
 
 /*---------------------------------------------------------------------------*/
 int
-rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
-	   rtimer_clock_t duration,
-	   rtimer_callback_t func, void *ptr)
+rtimer_set_with_priority(struct rtimer *rtimer, rtimer_clock_t time,
+                         uint8_t priority, rtimer_callback_t func, void *ptr)
 {
   LOG_DBG("rtimer_set time %lu\n", (unsigned long)time);
 
@@ -86,5 +224,16 @@ rtimer_run_next(void)
   t->func(t, t->ptr);
 }
 /*---------------------------------------------------------------------------*/
+#endif /* RTIMER_WITH_QUEUE */
+/*---------------------------------------------------------------------------*/
+int
+rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
+	   rtimer_clock_t duration,
+	   rtimer_callback_t func, void *ptr)
+{
+  return rtimer_set_with_priority(rtimer, time, RTIMER_PRIORITY_NORMAL,
+                                  func, ptr);
+}
+/*---------------------------------------------------------------------------*/
 
 /** @}*/
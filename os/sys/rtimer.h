@@ -104,6 +104,37 @@ typedef uint64_t rtimer_clock_t;
 #define RTIMER_GUARD_TIME (RTIMER_ARCH_SECOND >> 14)
 #endif /* RTIMER_CONF_GUARD_TIME */
 
+/*
+ * With RTIMER_WITH_QUEUE, rtimer_set() accepts any number of pending
+ * tasks. They are kept in a list sorted by deadline and the single
+ * hardware compare is always programmed for the earliest one. Without
+ * it, only one task can be pending at a time. On native, the queue
+ * also makes critical sections block SIGALRM with a system call, and
+ * interrupts then start out enabled.
+ */
+#ifdef RTIMER_CONF_WITH_QUEUE
+#define RTIMER_WITH_QUEUE RTIMER_CONF_WITH_QUEUE
+#else /* RTIMER_CONF_WITH_QUEUE */
+#define RTIMER_WITH_QUEUE 0
+#endif /* RTIMER_CONF_WITH_QUEUE */
+
+/*
+ * RTIMER_PRIORITY_WINDOW is the number of rtimer ticks a task is held
+ * back when a task with a higher priority is due that soon after it.
+ * This keeps a lower-priority callback from delaying, e.g., the TSCH
+ * slot operation. Only used with RTIMER_WITH_QUEUE.
+ */
+#ifdef RTIMER_CONF_PRIORITY_WINDOW
+#define RTIMER_PRIORITY_WINDOW RTIMER_CONF_PRIORITY_WINDOW
+#else /* RTIMER_CONF_PRIORITY_WINDOW */
+#define RTIMER_PRIORITY_WINDOW (RTIMER_ARCH_SECOND / 1000)
+#endif /* RTIMER_CONF_PRIORITY_WINDOW */
+
+/** \brief Priority of tasks scheduled with rtimer_set() */
+#define RTIMER_PRIORITY_NORMAL 0
+/** \brief Priority of tasks that must not be delayed by other tasks */
+#define RTIMER_PRIORITY_HIGH   1
+
 /*---------------------------------------------------------------------------*/
 
 /**
@@ -136,6 +167,10 @@ struct rtimer {
   rtimer_clock_t time;
   rtimer_callback_t func;
   void *ptr;
+#if RTIMER_WITH_QUEUE
+  struct rtimer *next;
+  uint8_t priority;
+#endif /* RTIMER_WITH_QUEUE */
 };
 
 /**
@@ -165,6 +200,26 @@ enum {
 int rtimer_set(struct rtimer *task, rtimer_clock_t time,
 	       rtimer_clock_t duration, rtimer_callback_t func, void *ptr);
 
+/**
+ * \brief      Post a real-time task with a priority.
+ * \param task A pointer to the task variable allocated somewhere.
+ * \param time The time when the task is to be executed.
+ * \param priority RTIMER_PRIORITY_NORMAL, RTIMER_PRIORITY_HIGH or above.
+ * \param func A function to be called when the task is executed.
+ * \param ptr An opaque pointer that will be supplied as an argument to the callback function.
+ * \return     RTIMER_OK if the task could be scheduled. Any other value indicates
+ *             the task could not be scheduled.
+ *
+ *             Works as rtimer_set(). When several tasks are due, the
+ *             one with the highest priority runs first, and a task is
+ *             held back while a higher-priority task is due within
+ *             RTIMER_PRIORITY_WINDOW after it. The priority is
+ *             ignored unless RTIMER_WITH_QUEUE is enabled.
+ */
+int rtimer_set_with_priority(struct rtimer *task, rtimer_clock_t time,
+                             uint8_t priority, rtimer_callback_t func,
+                             void *ptr);
+
 /**
  * \brief      Execute the next real-time task and schedule the next task, if any
  *
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      A multi-hop benchmark for the fragmentation of 6LoWPAN. The root
+ *      (node 1) repeatedly gets a 1 KB CoAP resource from the node at the
+ *      end of a line, and reports the latencies. Every node reports its
+ *      fragmentation statistics, so that the buffer usage with and
+ *      without SICSLOWPAN_CONF_FRAG_FORWARDING can be compared.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/routing/routing.h"
+#include "net/ipv6/sicslowpan.h"
+#include "sys/node-id.h"
+#include "coap-engine.h"
+#include "coap-blocking-api.h"
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "Frag"
+#define LOG_LEVEL LOG_LEVEL_INFO
+/*****************************************************************************/
+#define SERVER_EP "coap://[fd00::205:5:5:5]"
+#define PAYLOAD_LEN 1024
+#define REQUESTS 20
+#define REQUEST_INTERVAL (5 * CLOCK_SECOND)
+#define STATS_INTERVAL (60 * CLOCK_SECOND)
+
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARDING
+#define FRAG_FORWARDING SICSLOWPAN_CONF_FRAG_FORWARDING
+#else
+#define FRAG_FORWARDING 0
+#endif
+
+static clock_time_t request_time;
+static unsigned responses;
+static unsigned long total_latency;
+/*****************************************************************************/
+static void res_get_handler(coap_message_t *request, coap_message_t *response,
+                            uint8_t *buffer, uint16_t preferred_size,
+                            int32_t *offset);
+
+RESOURCE(res_data, "title=\"1 KB of data\"", res_get_handler, NULL, NULL, NULL);
+
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  for(int i = 0; i < PAYLOAD_LEN; i++) {
+    buffer[i] = 'a' + i % 26;
+  }
+  coap_set_header_content_format(response, TEXT_PLAIN);
+  coap_set_payload(response, buffer, PAYLOAD_LEN);
+}
+/*****************************************************************************/
+static void
+response_handler(coap_message_t *response)
+{
+  const uint8_t *payload;
+  unsigned long latency;
+
+  if(response == NULL) {
+    LOG_INFO("Request timed out\n");
+    return;
+  }
+
+  latency = (clock_time() - request_time) * 1000 / CLOCK_SECOND;
+  if(coap_get_payload(response, &payload) != PAYLOAD_LEN) {
+    LOG_INFO("Response of wrong length\n");
+    return;
+  }
+  responses++;
+  total_latency += latency;
+  LOG_INFO("Response %u latency %lu ms\n", responses, latency);
+}
+/*****************************************************************************/
+static void
+print_stats(void)
+{
+  const struct sicslowpan_frag_stats *stats = sicslowpan_get_frag_stats();
+
+  LOG_INFO("Fragmentation: reassembled %lu forwarded %lu max buffers %u max forwarding %u\n",
+           (unsigned long)stats->reassembled, (unsigned long)stats->forwarded,
+           stats->max_buffers, stats->max_forwarding);
+}
+/*****************************************************************************/
+PROCESS(frag_node_process, "6LoWPAN fragmentation benchmark");
+AUTOSTART_PROCESSES(&frag_node_process);
+/*****************************************************************************/
+PROCESS_THREAD(frag_node_process, ev, data)
+{
+  static struct etimer timer;
+  static struct etimer stats_timer;
+  static coap_endpoint_t server_ep;
+  static coap_message_t request[1];
+
+  PROCESS_BEGIN();
+
+  LOG_INFO("Fragment forwarding: %s\n",
+           FRAG_FORWARDING ? "yes" : "no");
+
+  if(node_id != 1) {
+    coap_activate_resource(&res_data, "data");
+    etimer_set(&stats_timer, STATS_INTERVAL);
+    while(1) {
+      PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&stats_timer));
+      print_stats();
+      etimer_reset(&stats_timer);
+    }
+  }
+
+  NETSTACK_ROUTING.root_start();
+  coap_endpoint_parse(SERVER_EP, strlen(SERVER_EP), &server_ep);
+
+  /* Wait for the routes to be set up */
+  etimer_set(&timer, 60 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+
+  while(responses < REQUESTS) {
+    coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+    coap_set_header_uri_path(request, "data");
+    request_time = clock_time();
+    COAP_BLOCKING_REQUEST(&server_ep, request, response_handler);
+
+    etimer_set(&timer, REQUEST_INTERVAL);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+  }
+
+  print_stats();
+  LOG_INFO("Average latency %lu ms\n", total_latency / responses);
+  LOG_INFO("Test OK\n");
+
+  PROCESS_END();
+}
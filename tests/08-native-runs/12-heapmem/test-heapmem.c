@@ -288,6 +288,118 @@ UNIT_TEST(stats_check)
   UNIT_TEST_ASSERT(stats.footprint == 0);
   UNIT_TEST_ASSERT(stats.max_footprint > stats.available / 2);
   UNIT_TEST_ASSERT(stats.chunks == 0);
+  UNIT_TEST_ASSERT(stats.free_chunks == 0);
+  UNIT_TEST_ASSERT(stats.fragmentation == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(small_allocations, "Small allocations");
+UNIT_TEST(small_allocations)
+{
+#define NUM_SMALL_ALLOCS 64
+
+  UNIT_TEST_BEGIN();
+
+  uint8_t *ptrs[NUM_SMALL_ALLOCS];
+  size_t alignment = heapmem_alignment();
+  heapmem_stats_t stats;
+
+  /* Allocate objects of interleaved small sizes, and then free every
+     other one to fragment the heap. */
+  for(int i = 0; i < NUM_SMALL_ALLOCS; i++) {
+    ptrs[i] = heapmem_alloc(1 + (i % 8) * alignment);
+    UNIT_TEST_ASSERT(ptrs[i] != NULL);
+    memset(ptrs[i], i, 1 + (i % 8) * alignment);
+  }
+  for(int i = 0; i < NUM_SMALL_ALLOCS; i += 2) {
+    UNIT_TEST_ASSERT(heapmem_free(ptrs[i]));
+  }
+
+  heapmem_stats(&stats);
+  printf("* free chunks %zu\n* largest free %zu\n* fragmentation %u%%\n",
+         stats.free_chunks, stats.largest_free, stats.fragmentation);
+  UNIT_TEST_ASSERT(stats.free_chunks >= NUM_SMALL_ALLOCS / 2);
+  UNIT_TEST_ASSERT(stats.largest_free < stats.available);
+  UNIT_TEST_ASSERT(stats.fragmentation <= 100);
+
+  /* Allocate the freed sizes again. */
+  for(int i = 0; i < NUM_SMALL_ALLOCS; i += 2) {
+    ptrs[i] = heapmem_alloc(1 + (i % 8) * alignment);
+    UNIT_TEST_ASSERT(ptrs[i] != NULL);
+    memset(ptrs[i], i, 1 + (i % 8) * alignment);
+  }
+#if HEAPMEM_WITH_SIZE_CLASSES
+  /* The freed chunks are reused from their size classes. */
+  heapmem_stats(&stats);
+  size_t hits = 0;
+  for(int i = 0; i < HEAPMEM_SIZE_CLASSES; i++) {
+    hits += stats.class_hits[i];
+  }
+  printf("* size class hits %zu\n", hits);
+  UNIT_TEST_ASSERT(hits >= NUM_SMALL_ALLOCS / 2);
+#endif /* HEAPMEM_WITH_SIZE_CLASSES */
+
+  for(int i = 0; i < NUM_SMALL_ALLOCS; i++) {
+    for(size_t j = 0; j < 1 + (i % 8) * alignment; j++) {
+      UNIT_TEST_ASSERT(ptrs[i][j] == (uint8_t)i);
+    }
+  }
+  for(int i = NUM_SMALL_ALLOCS - 1; i >= 0; i--) {
+    UNIT_TEST_ASSERT(heapmem_free(ptrs[i]));
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(small_then_large, "Large allocation from freed small chunks");
+UNIT_TEST(small_then_large)
+{
+#define NUM_MERGED_ALLOCS 16
+#define MERGED_ALLOC_SIZE (4 * alignment)
+#define NUM_FILLERS 8
+
+  UNIT_TEST_BEGIN();
+
+  uint8_t *ptrs[NUM_MERGED_ALLOCS];
+  size_t alignment = heapmem_alignment();
+  heapmem_stats_t stats;
+
+  for(int i = 0; i < NUM_MERGED_ALLOCS; i++) {
+    ptrs[i] = heapmem_alloc(MERGED_ALLOC_SIZE);
+    UNIT_TEST_ASSERT(ptrs[i] != NULL);
+  }
+  /* Keep the freed chunks from being released into the wilderness. */
+  void *guard = heapmem_alloc(alignment);
+  UNIT_TEST_ASSERT(guard != NULL);
+
+  /* Use up the rest of the arena and any free chunk that could hold
+     the large allocation, so that only the freed small chunks can. */
+  void *fillers[NUM_FILLERS];
+  int num_fillers = 0;
+  heapmem_stats(&stats);
+  while(stats.largest_free >= NUM_MERGED_ALLOCS * MERGED_ALLOC_SIZE) {
+    UNIT_TEST_ASSERT(num_fillers < NUM_FILLERS);
+    fillers[num_fillers] = heapmem_alloc(stats.largest_free);
+    UNIT_TEST_ASSERT(fillers[num_fillers] != NULL);
+    num_fillers++;
+    heapmem_stats(&stats);
+  }
+  UNIT_TEST_ASSERT(stats.footprint == HEAPMEM_CONF_ARENA_SIZE);
+
+  for(int i = 0; i < NUM_MERGED_ALLOCS; i++) {
+    UNIT_TEST_ASSERT(heapmem_free(ptrs[i]));
+  }
+
+  /* The freed small chunks together can hold the large allocation. */
+  void *large = heapmem_alloc(NUM_MERGED_ALLOCS * MERGED_ALLOC_SIZE);
+  UNIT_TEST_ASSERT(large != NULL);
+
+  UNIT_TEST_ASSERT(heapmem_free(large));
+  for(int i = 0; i < num_fillers; i++) {
+    UNIT_TEST_ASSERT(heapmem_free(fillers[i]));
+  }
+  UNIT_TEST_ASSERT(heapmem_free(guard));
 
   UNIT_TEST_END();
 }
@@ -334,6 +446,8 @@ PROCESS_THREAD(test_heapmem_process, ev, data)
   UNIT_TEST_RUN(reallocations);
   UNIT_TEST_RUN(zero_init_alloc);
   UNIT_TEST_RUN(stats_check);
+  UNIT_TEST_RUN(small_then_large);
+  UNIT_TEST_RUN(small_allocations);
   UNIT_TEST_RUN(zones);
 
   if(!UNIT_TEST_PASSED(do_many_allocations) ||
@@ -342,6 +456,8 @@ PROCESS_THREAD(test_heapmem_process, ev, data)
      !UNIT_TEST_PASSED(reallocations) ||
      !UNIT_TEST_PASSED(zero_init_alloc) ||
      !UNIT_TEST_PASSED(stats_check) ||
+     !UNIT_TEST_PASSED(small_then_large) ||
+     !UNIT_TEST_PASSED(small_allocations) ||
      !UNIT_TEST_PASSED(zones)) {
     printf("=check-me= FAILED\n");
     printf("---\n");
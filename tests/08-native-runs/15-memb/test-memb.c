@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a microbenchmark for the memb module. The test is
+ *      built once with the linear-scan allocator and once with
+ *      MEMB_CONF_WITH_FREE_LIST, so that the timings can be compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "lib/memb.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of free/alloc pairs per pool size in the benchmark. */
+#ifdef TEST_CONF_ITERATIONS
+#define TEST_ITERATIONS TEST_CONF_ITERATIONS
+#else
+#define TEST_ITERATIONS 200000
+#endif
+
+#define MAX_POOL_SIZE 1024
+
+struct block {
+  uint32_t data[4];
+};
+
+MEMB(pool_16, struct block, 16);
+MEMB(pool_64, struct block, 64);
+MEMB(pool_256, struct block, 256);
+MEMB(pool_1024, struct block, MAX_POOL_SIZE);
+
+static struct memb *pools[] = { &pool_16, &pool_64, &pool_256, &pool_1024 };
+
+static void *blocks[MAX_POOL_SIZE];
+/*****************************************************************************/
+PROCESS(test_memb_process, "Memb test process");
+AUTOSTART_PROCESSES(&test_memb_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(alloc_free, "Allocation and deallocation");
+UNIT_TEST(alloc_free)
+{
+  UNIT_TEST_BEGIN();
+
+  struct memb *m = &pool_16;
+  char *ptr;
+
+  memb_init(m);
+  UNIT_TEST_ASSERT(memb_numfree(m) == m->num);
+
+  for(int i = 0; i < m->num; i++) {
+    blocks[i] = memb_alloc(m);
+    UNIT_TEST_ASSERT(blocks[i] != NULL);
+    UNIT_TEST_ASSERT(memb_inmemb(m, blocks[i]));
+    UNIT_TEST_ASSERT(memb_numfree(m) == m->num - i - 1);
+    for(int j = 0; j < i; j++) {
+      UNIT_TEST_ASSERT(blocks[i] != blocks[j]);
+    }
+  }
+  UNIT_TEST_ASSERT(memb_alloc(m) == NULL);
+
+  /* Free every other block and allocate them again. */
+  for(int i = 0; i < m->num; i += 2) {
+    UNIT_TEST_ASSERT(memb_free(m, blocks[i]) == 0);
+  }
+  UNIT_TEST_ASSERT(memb_numfree(m) == m->num / 2);
+  for(int i = 0; i < m->num; i += 2) {
+    blocks[i] = memb_alloc(m);
+    UNIT_TEST_ASSERT(blocks[i] != NULL);
+  }
+  UNIT_TEST_ASSERT(memb_numfree(m) == 0);
+
+  /* Pointers that are not the start of a block must be rejected. */
+  ptr = blocks[0];
+  UNIT_TEST_ASSERT(memb_free(m, ptr + 1) == -1);
+  UNIT_TEST_ASSERT(memb_free(m, &test_memb_process) == -1);
+
+  for(int i = 0; i < m->num; i++) {
+    UNIT_TEST_ASSERT(memb_free(m, blocks[i]) == 0);
+  }
+  UNIT_TEST_ASSERT(memb_numfree(m) == m->num);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(double_free, "Double free detection");
+UNIT_TEST(double_free)
+{
+  UNIT_TEST_BEGIN();
+
+  struct memb *m = &pool_64;
+  void *ptr;
+
+  memb_init(m);
+  ptr = memb_alloc(m);
+  UNIT_TEST_ASSERT(ptr != NULL);
+  UNIT_TEST_ASSERT(memb_free(m, ptr) == 0);
+  UNIT_TEST_ASSERT(memb_free(m, ptr) == -1);
+  UNIT_TEST_ASSERT(memb_numfree(m) == m->num);
+
+  /* The pool must still hand out every block exactly once. */
+  for(int i = 0; i < m->num; i++) {
+    UNIT_TEST_ASSERT(memb_alloc(m) != NULL);
+  }
+  UNIT_TEST_ASSERT(memb_alloc(m) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Allocation benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("Free list: %s\n", MEMB_WITH_FREE_LIST ? "yes" : "no");
+
+  for(int p = 0; p < sizeof(pools) / sizeof(pools[0]); p++) {
+    struct memb *m = pools[p];
+    unsigned failures = 0;
+    uint64_t start, elapsed;
+
+    memb_init(m);
+    for(int i = 0; i < m->num; i++) {
+      blocks[i] = memb_alloc(m);
+    }
+
+    /*
+     * Keep the pool full and repeatedly release a random block and
+     * allocate a new one, which is the steady state of queuebuf and
+     * route tables on a busy router.
+     */
+    srand(m->num);
+    start = now_ns();
+    for(unsigned long i = 0; i < TEST_ITERATIONS; i++) {
+      int index = rand() % m->num;
+      if(memb_free(m, blocks[index]) != 0) {
+        failures++;
+      }
+      blocks[index] = memb_alloc(m);
+      if(blocks[index] == NULL) {
+        failures++;
+      }
+    }
+    elapsed = now_ns() - start;
+
+    printf("Pool size %4u: %6.1f ns per free+alloc pair\n",
+           m->num, (double)elapsed / TEST_ITERATIONS);
+    UNIT_TEST_ASSERT(failures == 0);
+    UNIT_TEST_ASSERT(memb_numfree(m) == 0);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_memb_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(alloc_free);
+  UNIT_TEST_RUN(double_free);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(alloc_free) ||
+     !UNIT_TEST_PASSED(double_free) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a lookup benchmark for the neighbor table. The test
+ *      is built with and without NBR_TABLE_CONF_WITH_LLADDR_INDEX, so that
+ *      the cost of nbr_table_get_from_lladdr() can be compared for 16 to
+ *      512 neighbors.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/nbr-table.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of lookups per table size in the benchmark. */
+#ifdef TEST_CONF_LOOKUPS
+#define TEST_LOOKUPS TEST_CONF_LOOKUPS
+#else
+#define TEST_LOOKUPS 200000
+#endif
+
+struct test_nbr {
+  uint16_t id;
+};
+
+NBR_TABLE(struct test_nbr, test_nbrs);
+
+static volatile unsigned sink;
+/*****************************************************************************/
+PROCESS(test_nbr_table_process, "Neighbor table test process");
+AUTOSTART_PROCESSES(&test_nbr_table_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static void
+make_lladdr(linkaddr_t *lladdr, uint16_t id)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->u8[0] = 0x02;
+  lladdr->u8[LINKADDR_SIZE - 2] = id >> 8;
+  lladdr->u8[LINKADDR_SIZE - 1] = id & 0xff;
+}
+/*****************************************************************************/
+static struct test_nbr *
+add_nbr(uint16_t id)
+{
+  linkaddr_t lladdr;
+  struct test_nbr *nbr;
+
+  make_lladdr(&lladdr, id);
+  nbr = nbr_table_add_lladdr(test_nbrs, &lladdr, NBR_TABLE_REASON_UNDEFINED,
+                             NULL);
+  if(nbr != NULL) {
+    nbr->id = id;
+  }
+  return nbr;
+}
+/*****************************************************************************/
+static struct test_nbr *
+get_nbr(uint16_t id)
+{
+  linkaddr_t lladdr;
+
+  make_lladdr(&lladdr, id);
+  return nbr_table_get_from_lladdr(test_nbrs, &lladdr);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(add_lookup, "Add and look up neighbors");
+UNIT_TEST(add_lookup)
+{
+  UNIT_TEST_BEGIN();
+
+  nbr_table_clear();
+
+  for(uint16_t id = 1; id <= NBR_TABLE_MAX_NEIGHBORS; id++) {
+    UNIT_TEST_ASSERT(add_nbr(id) != NULL);
+  }
+  UNIT_TEST_ASSERT(nbr_table_count_entries() == NBR_TABLE_MAX_NEIGHBORS);
+
+  for(uint16_t id = 1; id <= NBR_TABLE_MAX_NEIGHBORS; id++) {
+    struct test_nbr *nbr = get_nbr(id);
+    UNIT_TEST_ASSERT(nbr != NULL);
+    UNIT_TEST_ASSERT(nbr->id == id);
+  }
+  UNIT_TEST_ASSERT(get_nbr(NBR_TABLE_MAX_NEIGHBORS + 1) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(replacement, "Replace neighbors when the table is full");
+UNIT_TEST(replacement)
+{
+  UNIT_TEST_BEGIN();
+
+  uint16_t next_id = NBR_TABLE_MAX_NEIGHBORS + 1;
+
+  /* The table is full after the previous test, so every new neighbor
+     evicts an existing one and reuses its key. */
+  for(int i = 0; i < NBR_TABLE_MAX_NEIGHBORS / 2; i++) {
+    UNIT_TEST_ASSERT(add_nbr(next_id++) != NULL);
+  }
+  UNIT_TEST_ASSERT(nbr_table_count_entries() == NBR_TABLE_MAX_NEIGHBORS);
+
+  /* Every neighbor still in the table must be found, and every evicted
+     neighbor must be gone. */
+  int found = 0;
+  for(uint16_t id = 1; id < next_id; id++) {
+    struct test_nbr *nbr = get_nbr(id);
+    if(nbr != NULL) {
+      UNIT_TEST_ASSERT(nbr->id == id);
+      UNIT_TEST_ASSERT(nbr_table_get_lladdr(test_nbrs, nbr)->u8[LINKADDR_SIZE - 1]
+                       == (id & 0xff));
+      found++;
+    }
+  }
+  UNIT_TEST_ASSERT(found == NBR_TABLE_MAX_NEIGHBORS);
+
+  nbr_table_clear();
+  UNIT_TEST_ASSERT(nbr_table_count_entries() == 0);
+  for(uint16_t id = 1; id < next_id; id++) {
+    UNIT_TEST_ASSERT(get_nbr(id) == NULL);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Lookup benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("Link-layer address index: %s\n",
+         NBR_TABLE_WITH_LLADDR_INDEX ? "yes" : "no");
+
+  nbr_table_clear();
+  uint16_t count = 0;
+  for(uint16_t size = 16; size <= NBR_TABLE_MAX_NEIGHBORS; size *= 2) {
+    linkaddr_t lladdr;
+    unsigned misses = 0;
+    uint64_t start, elapsed;
+
+    while(count < size) {
+      UNIT_TEST_ASSERT(add_nbr(++count) != NULL);
+    }
+
+    srand(size);
+    start = now_ns();
+    for(unsigned long i = 0; i < TEST_LOOKUPS; i++) {
+      make_lladdr(&lladdr, 1 + rand() % size);
+      struct test_nbr *nbr = nbr_table_get_from_lladdr(test_nbrs, &lladdr);
+      if(nbr == NULL) {
+        misses++;
+      } else {
+        sink += nbr->id;
+      }
+    }
+    elapsed = now_ns() - start;
+
+    printf("%3u neighbors: %7.1f ns per lookup\n",
+           size, (double)elapsed / TEST_LOOKUPS);
+    UNIT_TEST_ASSERT(misses == 0);
+  }
+  nbr_table_clear();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_nbr_table_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  nbr_table_register(test_nbrs, NULL);
+
+  UNIT_TEST_RUN(add_lookup);
+  UNIT_TEST_RUN(replacement);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(add_lookup) ||
+     !UNIT_TEST_PASSED(replacement) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
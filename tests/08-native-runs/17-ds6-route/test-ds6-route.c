@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a forwarding lookup benchmark for the IPv6 routing
+ *      table. The test is built with the route list and with
+ *      UIP_DS6_ROUTE_CONF_WITH_TRIE, so that lookup rates can be compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of lookups per table size in the benchmark. */
+#ifdef TEST_CONF_LOOKUPS
+#define TEST_LOOKUPS TEST_CONF_LOOKUPS
+#else
+#define TEST_LOOKUPS 100000
+#endif
+
+#define NUM_NEXTHOPS 8
+
+static uip_ipaddr_t nexthops[NUM_NEXTHOPS];
+/*****************************************************************************/
+PROCESS(test_ds6_route_process, "IPv6 route test process");
+AUTOSTART_PROCESSES(&test_ds6_route_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static void
+add_nexthops(void)
+{
+  uip_lladdr_t lladdr;
+
+  for(int i = 0; i < NUM_NEXTHOPS; i++) {
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[0] = 0x02;
+    lladdr.addr[sizeof(lladdr) - 1] = i + 1;
+    uip_ip6addr(&nexthops[i], 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    uip_ds6_nbr_add(&nexthops[i], &lladdr, 1, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+}
+/*****************************************************************************/
+static void
+remove_all_routes(void)
+{
+  uip_ds6_route_t *r;
+
+  while((r = uip_ds6_route_head()) != NULL) {
+    uip_ds6_route_rm(r);
+  }
+}
+/*****************************************************************************/
+static int
+lookup_length(const uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r = uip_ds6_route_lookup(addr);
+  return r != NULL ? r->length : -1;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(longest_match, "Longest prefix match");
+UNIT_TEST(longest_match)
+{
+  UNIT_TEST_BEGIN();
+
+  uip_ipaddr_t prefix;
+  uip_ipaddr_t addr;
+
+  /*
+   * uip_ds6_route_add() replaces any route that covers the new route's
+   * address and uses another next hop, so the more specific routes are
+   * added first, and the prefix addresses of the covering routes lie
+   * outside of them.
+   */
+  uip_ip6addr(&prefix, 0xfd00, 0, 0, 0, 0x1200, 0, 0, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&prefix, 128, &nexthops[3]) != NULL);
+  uip_ip6addr(&prefix, 0xfd00, 0, 0, 0, 0x3400, 0, 0, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&prefix, 128, &nexthops[4]) != NULL);
+  uip_ip6addr(&prefix, 0xfd00, 0, 0, 0, 0x1200, 0, 0, 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&prefix, 72, &nexthops[2]) != NULL);
+  uip_ip6addr(&prefix, 0xfd00, 0, 0, 0, 0, 0, 0, 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&prefix, 64, &nexthops[1]) != NULL);
+  uip_ip6addr(&prefix, 0xfd00, 0, 0, 0xff00, 0, 0, 0, 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&prefix, 48, &nexthops[0]) != NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 5);
+
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0x1200, 0, 0, 1);
+  UNIT_TEST_ASSERT(lookup_length(&addr) == 128);
+  UNIT_TEST_ASSERT(uip_ipaddr_cmp(uip_ds6_route_nexthop(uip_ds6_route_lookup(&addr)),
+                                  &nexthops[3]));
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0x1200, 0, 0, 2);
+  UNIT_TEST_ASSERT(lookup_length(&addr) == 72);
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0x3400, 0, 0, 2);
+  UNIT_TEST_ASSERT(lookup_length(&addr) == 64);
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 1, 0, 0, 0, 1);
+  UNIT_TEST_ASSERT(lookup_length(&addr) == 48);
+  uip_ip6addr(&addr, 0xfd01, 0, 0, 0, 0, 0, 0, 1);
+  UNIT_TEST_ASSERT(lookup_length(&addr) == -1);
+
+  /* Removing a covering route falls back to the next shorter prefix. */
+  uip_ip6addr(&prefix, 0xfd00, 0, 0, 0, 0x1200, 0, 0, 0);
+  uip_ds6_route_rm(uip_ds6_route_lookup(&prefix));
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0x1200, 0, 0, 2);
+  UNIT_TEST_ASSERT(lookup_length(&addr) == 64);
+  uip_ip6addr(&addr, 0xfd00, 0, 0, 0, 0x1200, 0, 0, 1);
+  UNIT_TEST_ASSERT(lookup_length(&addr) == 128);
+
+  /* Removing all routes via a next hop. */
+  uip_ds6_route_rm_by_nexthop(&nexthops[3]);
+  UNIT_TEST_ASSERT(lookup_length(&addr) == 64);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 3);
+
+  /* Re-adding a route with another next hop replaces it. */
+  uip_ip6addr(&prefix, 0xfd00, 0, 0, 0, 0x3400, 0, 0, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&prefix, 128, &nexthops[5]) != NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 3);
+  UNIT_TEST_ASSERT(uip_ipaddr_cmp(uip_ds6_route_nexthop(uip_ds6_route_lookup(&prefix)),
+                                  &nexthops[5]));
+
+  remove_all_routes();
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&prefix) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+static void
+make_route_addr(uip_ipaddr_t *addr, int id)
+{
+  uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0x200, 0, id >> 8, id & 0xff);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(full_table, "Adding to a full table");
+UNIT_TEST(full_table)
+{
+  UNIT_TEST_BEGIN();
+
+  uip_ipaddr_t addr;
+  int id;
+
+  for(id = 0; id < UIP_DS6_ROUTE_NB; id++) {
+    make_route_addr(&addr, id);
+    UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 128,
+                                       &nexthops[id % NUM_NEXTHOPS]) != NULL);
+  }
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == UIP_DS6_ROUTE_NB);
+
+  /* Use the oldest route, so that it is no longer the least recently
+     used one */
+  make_route_addr(&addr, 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) != NULL);
+
+  make_route_addr(&addr, UIP_DS6_ROUTE_NB);
+#if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+  /* The least recently used route makes room for the new one */
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 128, &nexthops[0]) != NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == UIP_DS6_ROUTE_NB);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) != NULL);
+  make_route_addr(&addr, 0);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) != NULL);
+  make_route_addr(&addr, 1);
+  UNIT_TEST_ASSERT(uip_ds6_route_lookup(&addr) == NULL);
+#else /* UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
+  UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 128, &nexthops[0]) == NULL);
+  UNIT_TEST_ASSERT(uip_ds6_route_num_routes() == UIP_DS6_ROUTE_NB);
+#endif /* UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
+
+  remove_all_routes();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Forwarding lookup benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  uip_ipaddr_t addr;
+  int count = 0;
+
+  printf("Route trie: %s\n", UIP_DS6_ROUTE_WITH_TRIE ? "yes" : "no");
+
+  for(int size = 16; size <= UIP_DS6_ROUTE_NB; size *= 2) {
+    unsigned misses = 0;
+    uint64_t start, elapsed;
+
+    while(count < size) {
+      make_route_addr(&addr, count);
+      UNIT_TEST_ASSERT(uip_ds6_route_add(&addr, 128,
+                                         &nexthops[count % NUM_NEXTHOPS]) != NULL);
+      count++;
+    }
+
+    srand(size);
+    start = now_ns();
+    for(unsigned long i = 0; i < TEST_LOOKUPS; i++) {
+      int id = rand() % size;
+      make_route_addr(&addr, id);
+      uip_ds6_route_t *r = uip_ds6_route_lookup(&addr);
+      if(r == NULL || r->length != 128) {
+        misses++;
+      }
+    }
+    elapsed = now_ns() - start;
+
+    printf("%4d routes: %10.0f lookups/s\n",
+           size, TEST_LOOKUPS * 1e9 / elapsed);
+    UNIT_TEST_ASSERT(misses == 0);
+  }
+
+  remove_all_routes();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_ds6_route_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  add_nexthops();
+
+  UNIT_TEST_RUN(longest_match);
+  UNIT_TEST_RUN(full_table);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(longest_match) ||
+     !UNIT_TEST_PASSED(full_table) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a microbenchmark for event timers. The test is
+ *      built once with the list-based timer queue and once with
+ *      ETIMER_CONF_WITH_HEAP, so that the timings can be compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of re-armed timers per queue size in the benchmark. */
+#ifdef TEST_CONF_ITERATIONS
+#define TEST_ITERATIONS TEST_CONF_ITERATIONS
+#else
+#define TEST_ITERATIONS 100000
+#endif
+
+#define MAX_TIMERS 4096
+#define NUM_FIRED_TIMERS 1000
+#define NUM_HELPER_TIMERS 16
+#define NUM_EXPECTED_TIMERS (NUM_FIRED_TIMERS - (NUM_FIRED_TIMERS + 2) / 3)
+
+static struct etimer timers[MAX_TIMERS];
+static struct etimer helper_timers[NUM_HELPER_TIMERS];
+static const unsigned queue_sizes[] = { 16, 256, 1024, MAX_TIMERS };
+/*****************************************************************************/
+PROCESS(test_etimer_process, "Etimer test process");
+PROCESS(helper_process, "Etimer helper process");
+AUTOSTART_PROCESSES(&test_etimer_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+/* The earliest expiration time of the pending timers in the first n
+   entries of the timer array, found by brute force. */
+static clock_time_t
+earliest_expiration(unsigned n)
+{
+  clock_time_t earliest = 0;
+  int found = 0;
+
+  for(unsigned i = 0; i < n; i++) {
+    if(!etimer_expired(&timers[i])) {
+      clock_time_t t = etimer_expiration_time(&timers[i]);
+      if(!found || CLOCK_LT(t, earliest)) {
+        earliest = t;
+        found = 1;
+      }
+    }
+  }
+  return earliest;
+}
+/*****************************************************************************/
+static void
+stop_all(unsigned n)
+{
+  for(unsigned i = 0; i < n; i++) {
+    etimer_stop(&timers[i]);
+  }
+}
+/*****************************************************************************/
+PROCESS_THREAD(helper_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  for(int i = 0; i < NUM_HELPER_TIMERS; i++) {
+    etimer_set(&helper_timers[i], 1 + i);
+  }
+  PROCESS_WAIT_EVENT_UNTIL(0);
+
+  PROCESS_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(next_expiration, "Next expiration time");
+UNIT_TEST(next_expiration)
+{
+  UNIT_TEST_BEGIN();
+
+  const unsigned n = 1024;
+
+  srand(n);
+  for(unsigned i = 0; i < n; i++) {
+    etimer_set(&timers[i], CLOCK_SECOND + rand() % (10 * CLOCK_SECOND));
+  }
+  UNIT_TEST_ASSERT(etimer_pending());
+  UNIT_TEST_ASSERT(etimer_next_expiration_time() == earliest_expiration(n));
+
+  /* Re-arm, stop, and adjust random timers, and check that the next
+     expiration time follows. */
+  for(unsigned i = 0; i < 4 * n; i++) {
+    struct etimer *et = &timers[rand() % n];
+
+    switch(rand() % 4) {
+    case 0:
+      etimer_set(et, CLOCK_SECOND + rand() % (10 * CLOCK_SECOND));
+      break;
+    case 1:
+      etimer_stop(et);
+      break;
+    case 2:
+      etimer_restart(et);
+      break;
+    case 3:
+      etimer_adjust(et, (int)(rand() % CLOCK_SECOND) - CLOCK_SECOND / 2);
+      break;
+    }
+    if(etimer_next_expiration_time() != earliest_expiration(n)) {
+      break;
+    }
+  }
+  UNIT_TEST_ASSERT(etimer_next_expiration_time() == earliest_expiration(n));
+
+  /* Timers that belong to an exited process are dropped. */
+  stop_all(n);
+  etimer_set(&timers[0], 10 * CLOCK_SECOND);
+  process_start(&helper_process, NULL);
+  UNIT_TEST_ASSERT(etimer_next_expiration_time() ==
+                   etimer_expiration_time(&helper_timers[0]));
+  process_exit(&helper_process);
+  UNIT_TEST_ASSERT(etimer_next_expiration_time() ==
+                   etimer_expiration_time(&timers[0]));
+
+  stop_all(n);
+  UNIT_TEST_ASSERT(!etimer_pending());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(unset_timers, "Timers that were never set");
+UNIT_TEST(unset_timers)
+{
+  UNIT_TEST_BEGIN();
+
+  static struct etimer stray[2];
+  const unsigned n = 64;
+
+  for(unsigned i = 0; i < n; i++) {
+    etimer_set(&timers[i], CLOCK_SECOND + i);
+  }
+
+  /* Memory that was never zeroed, and a copy of a queued timer, as left
+     behind when a timer struct is moved */
+  memset(&stray[0], 0xa5, sizeof(stray[0]));
+  memcpy(&stray[1], &timers[n / 2], sizeof(stray[1]));
+
+  for(unsigned i = 0; i < 2; i++) {
+    etimer_stop(&stray[i]);
+    UNIT_TEST_ASSERT(etimer_expired(&stray[i]));
+    UNIT_TEST_ASSERT(etimer_next_expiration_time() == earliest_expiration(n));
+  }
+
+  memset(&stray[0], 0xa5, sizeof(stray[0]));
+  memcpy(&stray[1], &timers[n / 2], sizeof(stray[1]));
+
+  for(unsigned i = 0; i < 2; i++) {
+    etimer_set(&stray[i], CLOCK_SECOND / 2 + i);
+    UNIT_TEST_ASSERT(etimer_next_expiration_time() ==
+                     etimer_expiration_time(&stray[0]));
+  }
+  for(unsigned i = 0; i < 2; i++) {
+    etimer_stop(&stray[i]);
+  }
+  UNIT_TEST_ASSERT(etimer_next_expiration_time() == earliest_expiration(n));
+
+  stop_all(n);
+  UNIT_TEST_ASSERT(!etimer_pending());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Re-arm benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("Heap: %s\n", ETIMER_WITH_HEAP ? "yes" : "no");
+
+  for(int q = 0; q < sizeof(queue_sizes) / sizeof(queue_sizes[0]); q++) {
+    unsigned n = queue_sizes[q];
+    uint64_t start, elapsed;
+
+    srand(n);
+    for(unsigned i = 0; i < n; i++) {
+      etimer_set(&timers[i], CLOCK_SECOND + rand() % (10 * CLOCK_SECOND));
+    }
+
+    /*
+     * Keep n timers pending and re-arm a random one, which is what
+     * periodic protocol processes do on every activation.
+     */
+    start = now_ns();
+    for(unsigned long i = 0; i < TEST_ITERATIONS; i++) {
+      etimer_set(&timers[rand() % n],
+                 CLOCK_SECOND + rand() % (10 * CLOCK_SECOND));
+    }
+    elapsed = now_ns() - start;
+
+    printf("Pending timers %4u: %7.1f ns per re-arm\n",
+           n, (double)elapsed / TEST_ITERATIONS);
+    UNIT_TEST_ASSERT(etimer_next_expiration_time() == earliest_expiration(n));
+    stop_all(n);
+  }
+  UNIT_TEST_ASSERT(!etimer_pending());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_etimer_process, ev, data)
+{
+  static unsigned fired;
+  static unsigned out_of_order;
+  static clock_time_t last;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(next_expiration);
+  UNIT_TEST_RUN(unset_timers);
+  UNIT_TEST_RUN(benchmark);
+
+  /* Let a batch of timers expire. The heap delivers them in order of
+     expiration time, the list only guarantees that they have expired. */
+  srand(NUM_FIRED_TIMERS);
+  for(int i = 0; i < NUM_FIRED_TIMERS; i++) {
+    etimer_set(&timers[i], 1 + rand() % (CLOCK_SECOND / 4));
+  }
+  for(int i = 0; i < NUM_FIRED_TIMERS; i += 3) {
+    etimer_stop(&timers[i]);
+  }
+  fired = 0;
+  out_of_order = 0;
+  last = 0;
+  while(fired < NUM_EXPECTED_TIMERS) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    if(ETIMER_WITH_HEAP && fired > 0 &&
+       CLOCK_LT(etimer_expiration_time(data), last)) {
+      out_of_order++;
+    }
+    if(CLOCK_LT(clock_time(), etimer_expiration_time(data))) {
+      out_of_order++;
+    }
+    last = etimer_expiration_time(data);
+    fired++;
+  }
+  printf("Fired %u timers, %u out of order\n", fired, out_of_order);
+
+  if(!UNIT_TEST_PASSED(next_expiration) ||
+     !UNIT_TEST_PASSED(unset_timers) ||
+     !UNIT_TEST_PASSED(benchmark) ||
+     fired != NUM_EXPECTED_TIMERS || etimer_pending() ||
+     out_of_order != 0) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Stress test for callback timers. A large number of callback
+ *      timers is armed, re-armed, and stopped, partly from within
+ *      callbacks. The test is built once with the default timer queue
+ *      and once with ETIMER_CONF_WITH_HEAP and CTIMER_CONF_WITH_BATCHING.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#ifdef TEST_CONF_NUM_TIMERS
+#define TEST_NUM_TIMERS TEST_CONF_NUM_TIMERS
+#else
+#define TEST_NUM_TIMERS 10000
+#endif
+
+/* Longest interval of a timer. */
+#define MAX_INTERVAL (CLOCK_SECOND / 2)
+
+struct test_timer {
+  struct ctimer ctimer;
+  uint8_t fired;
+  uint8_t expected;
+  uint8_t cancelled;
+};
+
+static struct test_timer timers[TEST_NUM_TIMERS];
+static unsigned outstanding;
+static unsigned early;
+static unsigned late_fires;
+static unsigned out_of_order;
+#if CTIMER_WITH_BATCHING
+static clock_time_t last_expiration;
+#endif /* CTIMER_WITH_BATCHING */
+static struct etimer poll_timer;
+/* A timer whose memory was never zeroed */
+static struct ctimer stray;
+static unsigned stray_fired;
+/*****************************************************************************/
+PROCESS(test_ctimer_process, "Ctimer test process");
+AUTOSTART_PROCESSES(&test_ctimer_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static void
+cancel(struct test_timer *t)
+{
+  if(!ctimer_expired(&t->ctimer)) {
+    ctimer_stop(&t->ctimer);
+    t->cancelled = 1;
+    outstanding -= t->expected - t->fired;
+  }
+}
+/*****************************************************************************/
+static void
+callback(void *ptr)
+{
+  struct test_timer *t = ptr;
+  unsigned i = t - timers;
+  clock_time_t expiration = etimer_expiration_time(&t->ctimer.etimer);
+
+  if(CLOCK_LT(clock_time(), expiration)) {
+    early++;
+  }
+  if(t->cancelled || t->fired == t->expected) {
+    late_fires++;
+    return;
+  }
+#if CTIMER_WITH_BATCHING
+  /* Batched timers run in order of expiration. A re-armed timer may
+     however be due before timers that ran in the same batch. */
+  if(t->fired == 0) {
+    if(CLOCK_LT(expiration, last_expiration)) {
+      out_of_order++;
+    }
+    last_expiration = expiration;
+  }
+#endif /* CTIMER_WITH_BATCHING */
+
+  t->fired++;
+  outstanding--;
+
+  if(t->fired < t->expected) {
+    ctimer_reset(&t->ctimer);
+  }
+  /* Some callbacks stop a timer that may be due in the same batch. */
+  if(i % 13 == 2 && i + 1 < TEST_NUM_TIMERS) {
+    cancel(&timers[i + 1]);
+  }
+}
+/*****************************************************************************/
+static void
+stray_callback(void *ptr)
+{
+  stray_fired++;
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_ctimer_process, ev, data)
+{
+  static uint64_t start, elapsed;
+  static unsigned i;
+  static clock_time_t deadline;
+  static int passed;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+  printf("Batching: %s\n", CTIMER_WITH_BATCHING ? "yes" : "no");
+
+  srand(TEST_NUM_TIMERS);
+  outstanding = 0;
+  start = now_ns();
+  for(i = 0; i < TEST_NUM_TIMERS; i++) {
+    timers[i].expected = i % 10 == 1 ? 2 : 1;
+    outstanding += timers[i].expected;
+    ctimer_set(&timers[i].ctimer, 1 + rand() % MAX_INTERVAL,
+               callback, &timers[i]);
+  }
+  elapsed = now_ns() - start;
+  printf("Armed %u timers: %.1f ns per timer\n", TEST_NUM_TIMERS,
+         (double)elapsed / TEST_NUM_TIMERS);
+
+  for(i = 0; i < TEST_NUM_TIMERS; i += 7) {
+    cancel(&timers[i]);
+  }
+
+  /* Stopping or setting a timer that was never set works */
+  memset(&stray, 0xa5, sizeof(stray));
+  ctimer_stop(&stray);
+  memset(&stray, 0xa5, sizeof(stray));
+  ctimer_set(&stray, MAX_INTERVAL / 2, stray_callback, NULL);
+
+  /* Wait for all callbacks, with a generous deadline. */
+  start = now_ns();
+  deadline = clock_time() + 20 * MAX_INTERVAL * 2;
+  while((outstanding > 0 || stray_fired == 0) &&
+        CLOCK_LT(clock_time(), deadline)) {
+    etimer_set(&poll_timer, CLOCK_SECOND / 20);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&poll_timer));
+  }
+  elapsed = now_ns() - start;
+  printf("Callbacks completed in %.1f ms\n", (double)elapsed / 1000000);
+
+  passed = outstanding == 0 && early == 0 && late_fires == 0 &&
+    out_of_order == 0 && stray_fired == 1 && ctimer_expired(&stray);
+  for(i = 0; i < TEST_NUM_TIMERS; i++) {
+    if(!ctimer_expired(&timers[i].ctimer) ||
+       (!timers[i].cancelled && timers[i].fired != timers[i].expected)) {
+      passed = 0;
+    }
+  }
+  printf("Outstanding %u, early %u, late %u, out of order %u, "
+         "stray fired %u\n",
+         outstanding, early, late_fires, out_of_order, stray_fired);
+
+  if(!passed) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,4 @@
+#!/bin/sh -e
+
+# The node opens a tun interface, which requires root.
+RUN_PREFIX=sudo ./run-one.sh 20-tun6-net
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Receive throughput benchmark for the native tun driver. The node
+ *      sends bursts of UDP datagrams to its own address through a host
+ *      socket, so that they reach it through the tun device, and counts
+ *      them as they arrive. The test is built once with per-packet
+ *      reads and once with TUN6_NET_CONF_WITH_BATCHING.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "contiki.h"
+#include "net/ipv6/simple-udp.h"
+#include "tun6-net.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of datagrams in the benchmark. */
+#ifdef TEST_CONF_PACKETS
+#define TEST_PACKETS TEST_CONF_PACKETS
+#else
+#define TEST_PACKETS 20000
+#endif
+
+/* Number of datagrams sent back to back before waiting for them. */
+#define TEST_BURST 64
+#define TEST_PAYLOAD_LEN 64
+#define TEST_PORT 5678
+
+/* The address that the node configures from the default prefix. */
+#define TEST_NODE_ADDR "fd00::302:304:506:708"
+
+static struct simple_udp_connection conn;
+static unsigned long sent;
+static unsigned long received;
+static unsigned long lost_bursts;
+static uint64_t elapsed;
+/*****************************************************************************/
+PROCESS(test_tun6_net_process, "Tun6 net test process");
+AUTOSTART_PROCESSES(&test_tun6_net_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static void
+udp_rx_callback(struct simple_udp_connection *c,
+                const uip_ipaddr_t *sender_addr,
+                uint16_t sender_port,
+                const uip_ipaddr_t *receiver_addr,
+                uint16_t receiver_port,
+                const uint8_t *data,
+                uint16_t datalen)
+{
+  if(datalen == TEST_PAYLOAD_LEN) {
+    received++;
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(throughput, "Receive throughput");
+UNIT_TEST(throughput)
+{
+  const struct tun6_net_stats *stats = tun6_net_get_stats();
+
+  UNIT_TEST_BEGIN();
+
+  printf("Batching: %s\n", TUN6_NET_WITH_BATCHING ? "yes" : "no");
+  printf("Received %lu of %lu datagrams in %.1f ms: %.0f packets/s\n",
+         received, sent, elapsed / 1e6, received / (elapsed / 1e9));
+  printf("Reads: %lu packets in %lu batches, %.2f per batch, max %lu\n",
+         stats->rx_packets, stats->rx_batches,
+         stats->rx_batches ? (double)stats->rx_packets / stats->rx_batches : 0,
+         stats->rx_max_batch);
+  printf("Ring full: %lu, lost bursts: %lu\n",
+         stats->rx_ring_full, lost_bursts);
+
+  UNIT_TEST_ASSERT(sent > 0);
+  UNIT_TEST_ASSERT(received == sent);
+  UNIT_TEST_ASSERT(stats->rx_packets >= received);
+#if TUN6_NET_WITH_BATCHING
+  UNIT_TEST_ASSERT(stats->rx_max_batch > 1);
+#else /* TUN6_NET_WITH_BATCHING */
+  UNIT_TEST_ASSERT(stats->rx_max_batch == 1);
+#endif /* TUN6_NET_WITH_BATCHING */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_tun6_net_process, ev, data)
+{
+  static struct etimer et;
+  static struct sockaddr_in6 dest;
+  static uint8_t payload[TEST_PAYLOAD_LEN];
+  static uint64_t start, deadline;
+  static int fd;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  simple_udp_register(&conn, TEST_PORT, NULL, 0, udp_rx_callback);
+
+  fd = socket(AF_INET6, SOCK_DGRAM, 0);
+  /* Route through the tun device even if another host interface is on
+     the same prefix. */
+  setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, "tun0", strlen("tun0"));
+  memset(&dest, 0, sizeof(dest));
+  dest.sin6_family = AF_INET6;
+  dest.sin6_port = htons(TEST_PORT);
+  inet_pton(AF_INET6, TEST_NODE_ADDR, &dest.sin6_addr);
+  memset(payload, 0xa5, sizeof(payload));
+
+  /* Give the host time to bring up the interface. */
+  etimer_set(&et, 3 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  start = now_ns();
+  while(fd >= 0 && sent < TEST_PACKETS) {
+    for(int i = 0; i < TEST_BURST && sent < TEST_PACKETS; i++) {
+      if(sendto(fd, payload, sizeof(payload), 0,
+                (struct sockaddr *)&dest, sizeof(dest)) != sizeof(payload)) {
+        printf("sendto: %s\n", strerror(errno));
+        break;
+      }
+      sent++;
+    }
+
+    /* Let the main loop read the burst from the tun device. */
+    deadline = now_ns() + 1000000000;
+    while(received < sent && now_ns() < deadline) {
+      PROCESS_PAUSE();
+    }
+    if(received < sent) {
+      lost_bursts++;
+      break;
+    }
+  }
+  elapsed = now_ns() - start;
+
+  if(fd >= 0) {
+    close(fd);
+  }
+
+  UNIT_TEST_RUN(throughput);
+
+  if(!UNIT_TEST_PASSED(throughput)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a forwarding benchmark for the queuebuf module.
+ *      The test is built once with copied data and once with
+ *      QUEUEBUF_CONF_WITH_SHARED_DATA, so that the timings can be
+ *      compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of forwarded packets in the benchmark. */
+#ifdef TEST_CONF_ITERATIONS
+#define TEST_ITERATIONS TEST_CONF_ITERATIONS
+#else
+#define TEST_ITERATIONS 200000
+#endif
+
+#define TEST_FRAME_LEN 100
+
+static uint8_t frame[PACKETBUF_SIZE];
+static const linkaddr_t receiver = { { 1, 2, 3, 4, 5, 6, 7, 8 } };
+/*****************************************************************************/
+PROCESS(test_queuebuf_process, "Queuebuf test process");
+AUTOSTART_PROCESSES(&test_queuebuf_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static uint64_t
+now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  return 0;
+#endif
+}
+/*****************************************************************************/
+static void
+prepare_packet(uint8_t seqno)
+{
+  frame[0] = seqno;
+  packetbuf_copyfrom(frame, TEST_FRAME_LEN);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &receiver);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, seqno);
+}
+/*****************************************************************************/
+static int
+packetbuf_holds(const uint8_t *data, uint16_t len)
+{
+  return packetbuf_totlen() == len &&
+         packetbuf_hdrlen() == 0 &&
+         memcmp(packetbuf_dataptr(), data, len) == 0;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(round_trip, "Packetbuf to queuebuf and back");
+UNIT_TEST(round_trip)
+{
+  struct queuebuf *q;
+  size_t numfree = queuebuf_numfree();
+
+  UNIT_TEST_BEGIN();
+
+  prepare_packet(1);
+  q = queuebuf_new_from_packetbuf();
+  UNIT_TEST_ASSERT(q != NULL);
+  UNIT_TEST_ASSERT(queuebuf_numfree() == numfree - 1);
+  UNIT_TEST_ASSERT(queuebuf_datalen(q) == TEST_FRAME_LEN);
+  UNIT_TEST_ASSERT(queuebuf_attr(q, PACKETBUF_ATTR_MAC_SEQNO) == 1);
+  UNIT_TEST_ASSERT(linkaddr_cmp(queuebuf_addr(q, PACKETBUF_ADDR_RECEIVER),
+                                &receiver));
+
+  /* Loading the packet into the packetbuf that holds it already. */
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, 2);
+  queuebuf_to_packetbuf(q);
+  UNIT_TEST_ASSERT(packetbuf_holds(frame, TEST_FRAME_LEN));
+  UNIT_TEST_ASSERT(packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO) == 1);
+
+  /* Loading the packet after the packetbuf has been reused. */
+  packetbuf_clear();
+  queuebuf_to_packetbuf(q);
+  UNIT_TEST_ASSERT(packetbuf_holds(frame, TEST_FRAME_LEN));
+  UNIT_TEST_ASSERT(linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER),
+                                &receiver));
+
+  /* A header added in the packetbuf is queued in front of the data. */
+  UNIT_TEST_ASSERT(packetbuf_hdralloc(3));
+  memset(packetbuf_hdrptr(), 0xee, 3);
+  queuebuf_update_from_packetbuf(q);
+  UNIT_TEST_ASSERT(queuebuf_datalen(q) == TEST_FRAME_LEN + 3);
+  packetbuf_clear();
+  queuebuf_to_packetbuf(q);
+  UNIT_TEST_ASSERT(packetbuf_totlen() == TEST_FRAME_LEN + 3);
+  UNIT_TEST_ASSERT(((uint8_t *)packetbuf_dataptr())[2] == 0xee);
+  UNIT_TEST_ASSERT(memcmp((uint8_t *)packetbuf_dataptr() + 3,
+                          frame, TEST_FRAME_LEN) == 0);
+
+  queuebuf_free(q);
+  UNIT_TEST_ASSERT(queuebuf_numfree() == numfree);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(isolation, "Queued copies are independent");
+UNIT_TEST(isolation)
+{
+  struct queuebuf *q1, *q2;
+  uint8_t *data;
+  size_t numfree = queuebuf_numfree();
+
+  UNIT_TEST_BEGIN();
+
+  /* The same packet is queued twice with different attributes. */
+  prepare_packet(1);
+  q1 = queuebuf_new_from_packetbuf();
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, 2);
+  q2 = queuebuf_new_from_packetbuf();
+  UNIT_TEST_ASSERT(q1 != NULL && q2 != NULL);
+  UNIT_TEST_ASSERT(queuebuf_attr(q1, PACKETBUF_ATTR_MAC_SEQNO) == 1);
+  UNIT_TEST_ASSERT(queuebuf_attr(q2, PACKETBUF_ATTR_MAC_SEQNO) == 2);
+
+  /* Modifying one of them leaves the other and the packetbuf as is. */
+  data = queuebuf_dataptr(q1);
+  UNIT_TEST_ASSERT(data != NULL);
+  data[0] = 0xff;
+  UNIT_TEST_ASSERT(((uint8_t *)queuebuf_dataptr(q2))[0] == 1);
+  UNIT_TEST_ASSERT(packetbuf_holds(frame, TEST_FRAME_LEN));
+
+  queuebuf_to_packetbuf(q1);
+  UNIT_TEST_ASSERT(((uint8_t *)packetbuf_dataptr())[0] == 0xff);
+  queuebuf_to_packetbuf(q2);
+  UNIT_TEST_ASSERT(packetbuf_holds(frame, TEST_FRAME_LEN));
+  UNIT_TEST_ASSERT(packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO) == 2);
+
+  /* Modifying the packetbuf leaves the queued packet as is. */
+  ((uint8_t *)packetbuf_dataptr())[0] = 0xaa;
+  queuebuf_free(q1);
+  q1 = queuebuf_new_from_packetbuf();
+  UNIT_TEST_ASSERT(q1 != NULL);
+  queuebuf_to_packetbuf(q2);
+  UNIT_TEST_ASSERT(packetbuf_holds(frame, TEST_FRAME_LEN));
+  queuebuf_to_packetbuf(q1);
+  UNIT_TEST_ASSERT(((uint8_t *)packetbuf_dataptr())[0] == 0xaa);
+
+  /* The data of a freed packet is not used again. */
+  queuebuf_free(q1);
+  prepare_packet(3);
+  q1 = queuebuf_new_from_packetbuf();
+  UNIT_TEST_ASSERT(q1 != NULL);
+  UNIT_TEST_ASSERT(((uint8_t *)queuebuf_dataptr(q1))[0] == 3);
+
+  queuebuf_free(q1);
+  queuebuf_free(q2);
+  UNIT_TEST_ASSERT(queuebuf_numfree() == numfree);
+
+  /* Every queuebuf can be allocated, whether data is shared or not. */
+  prepare_packet(4);
+  for(int i = 0; i < QUEUEBUF_NUM; i++) {
+    if(i % 2 == 0) {
+      packetbuf_set_datalen(TEST_FRAME_LEN - i);
+    }
+    UNIT_TEST_ASSERT(queuebuf_new_from_packetbuf() != NULL);
+  }
+  UNIT_TEST_ASSERT(queuebuf_new_from_packetbuf() == NULL);
+  queuebuf_init();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Forwarding benchmark");
+UNIT_TEST(benchmark)
+{
+  struct queuebuf *backup, *queued;
+  unsigned failures = 0;
+  uint64_t start, cycles, elapsed;
+
+  UNIT_TEST_BEGIN();
+
+  printf("Shared data: %s\n", QUEUEBUF_WITH_SHARED_DATA ? "yes" : "no");
+
+  /*
+   * Forward fragments through 6LoWPAN and CSMA: the fragment is backed
+   * up around the MAC send call, queued by the MAC, restored from the
+   * backup, and finally loaded from the queue for transmission after
+   * the next fragment has been prepared.
+   */
+  queued = NULL;
+  start = now_ns();
+  cycles = now_cycles();
+  for(unsigned long i = 0; i < TEST_ITERATIONS; i++) {
+    prepare_packet(i);
+    backup = queuebuf_new_from_packetbuf();
+    packetbuf_set_attr(PACKETBUF_ATTR_MAC_ACK, 1);
+    if(queued != NULL) {
+      queuebuf_free(queued);
+    }
+    queued = queuebuf_new_from_packetbuf();
+    if(backup == NULL || queued == NULL) {
+      failures++;
+      break;
+    }
+    queuebuf_to_packetbuf(backup);
+    queuebuf_free(backup);
+    queuebuf_to_packetbuf(queued);
+    if(((uint8_t *)packetbuf_hdrptr())[0] != (uint8_t)i) {
+      failures++;
+    }
+  }
+  cycles = now_cycles() - cycles;
+  elapsed = now_ns() - start;
+  queuebuf_free(queued);
+
+  printf("Fragment forwarding: %6.1f ns, %6.0f cycles per packet\n",
+         (double)elapsed / TEST_ITERATIONS, (double)cycles / TEST_ITERATIONS);
+  UNIT_TEST_ASSERT(failures == 0);
+
+  /*
+   * Forward packets through a MAC queue that holds several packets,
+   * so that other packets pass through the packetbuf between queueing
+   * and transmission.
+   */
+  start = now_ns();
+  cycles = now_cycles();
+  for(unsigned long i = 0; i < TEST_ITERATIONS; i++) {
+    prepare_packet(i);
+    queued = queuebuf_new_from_packetbuf();
+    if(queued == NULL) {
+      failures++;
+      break;
+    }
+    prepare_packet(i + 1);
+    queuebuf_to_packetbuf(queued);
+    if(((uint8_t *)packetbuf_hdrptr())[0] != (uint8_t)i) {
+      failures++;
+    }
+    queuebuf_free(queued);
+  }
+  cycles = now_cycles() - cycles;
+  elapsed = now_ns() - start;
+
+  printf("Queued forwarding:   %6.1f ns, %6.0f cycles per packet\n",
+         (double)elapsed / TEST_ITERATIONS, (double)cycles / TEST_ITERATIONS);
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_queuebuf_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(int i = 0; i < sizeof(frame); i++) {
+    frame[i] = i;
+  }
+  queuebuf_init();
+
+  UNIT_TEST_RUN(round_trip);
+  UNIT_TEST_RUN(isolation);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(round_trip) ||
+     !UNIT_TEST_PASSED(isolation) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and benchmarks for the link lookups of a TSCH
+ *      schedule. The test is built once with the link lists, and with
+ *      TSCH_SCHEDULE_CONF_WITH_SORTED_LINKS and
+ *      TSCH_SCHEDULE_CONF_WITH_LINK_HASH, so that the timings can be
+ *      compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of consecutive ASNs that are checked and timed. */
+#ifdef TEST_CONF_ASNS
+#define TEST_ASNS TEST_CONF_ASNS
+#else
+#define TEST_ASNS 100000
+#endif
+
+/* Number of 6TiSCH cells on top of the Orchestra slotframes. */
+#define TEST_CELLS 256
+#define TEST_REPEATS 5
+#define TEST_NEIGHBORS 16
+
+/* The parts of TSCH that the schedule uses. */
+struct tsch_link *current_link;
+const linkaddr_t tsch_broadcast_address = { { 0xff, 0xff } };
+/*****************************************************************************/
+int
+tsch_is_locked(void)
+{
+  return 0;
+}
+/*****************************************************************************/
+int
+tsch_get_lock(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+void
+tsch_release_lock(void)
+{
+}
+/*****************************************************************************/
+struct tsch_neighbor *
+tsch_queue_add_nbr(const linkaddr_t *addr)
+{
+  return NULL;
+}
+/*****************************************************************************/
+struct tsch_neighbor *
+tsch_queue_get_nbr(const linkaddr_t *addr)
+{
+  return NULL;
+}
+/*****************************************************************************/
+PROCESS(test_tsch_schedule_process, "TSCH schedule test process");
+AUTOSTART_PROCESSES(&test_tsch_schedule_process);
+/*****************************************************************************/
+static uint64_t
+now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+/*****************************************************************************/
+/*
+ * The link selection of the original implementation: a scan of all
+ * links of all slotframes. Without queued packets, the default link
+ * comparator always keeps the first link.
+ */
+static struct tsch_link *
+reference_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
+                           struct tsch_link **backup_link)
+{
+  uint16_t time_to_curr_best = 0;
+  struct tsch_link *curr_best = NULL;
+  struct tsch_link *curr_backup = NULL;
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+
+  for(sf = tsch_schedule_slotframe_head(); sf != NULL;
+      sf = tsch_schedule_slotframe_next(sf)) {
+    uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      uint16_t time_to_timeslot =
+        l->timeslot > timeslot ?
+        l->timeslot - timeslot :
+        sf->size.val + l->timeslot - timeslot;
+      if(curr_best == NULL || time_to_timeslot < time_to_curr_best) {
+        time_to_curr_best = time_to_timeslot;
+        curr_best = l;
+        curr_backup = NULL;
+      } else if(time_to_timeslot == time_to_curr_best) {
+        struct tsch_link *new_best = NULL;
+        if((curr_best->link_options & LINK_OPTION_TX) ==
+           (l->link_options & LINK_OPTION_TX)) {
+          if(l->slotframe_handle != curr_best->slotframe_handle) {
+            if(l->slotframe_handle < curr_best->slotframe_handle) {
+              new_best = l;
+            }
+          } else {
+            new_best = curr_best;
+          }
+        } else if(l->link_options & LINK_OPTION_TX) {
+          new_best = l;
+        }
+        if(new_best != l && (l->link_options & LINK_OPTION_RX)) {
+          if(curr_backup == NULL ||
+             l->slotframe_handle < curr_backup->slotframe_handle) {
+            curr_backup = l;
+          }
+        }
+        if(new_best != curr_best &&
+           (curr_best->link_options & LINK_OPTION_RX)) {
+          if(curr_backup == NULL ||
+             curr_best->slotframe_handle < curr_backup->slotframe_handle) {
+            curr_backup = curr_best;
+          }
+        }
+        if(new_best != NULL) {
+          curr_best = new_best;
+        }
+      }
+    }
+  }
+  *time_offset = time_to_curr_best;
+  *backup_link = curr_backup;
+  return curr_best;
+}
+/*****************************************************************************/
+/* An Orchestra schedule with a large 6TiSCH slotframe on top. */
+static int
+create_schedule(void)
+{
+  struct tsch_slotframe *sf_eb, *sf_common, *sf_unicast, *sf_6tisch;
+  linkaddr_t addr;
+  int links = 0;
+
+  tsch_schedule_init();
+  sf_eb = tsch_schedule_add_slotframe(0, 397);
+  sf_common = tsch_schedule_add_slotframe(1, 31);
+  sf_unicast = tsch_schedule_add_slotframe(2, 17);
+  sf_6tisch = tsch_schedule_add_slotframe(3, 101);
+  if(sf_eb == NULL || sf_common == NULL ||
+     sf_unicast == NULL || sf_6tisch == NULL) {
+    return 0;
+  }
+
+  links += tsch_schedule_add_link(sf_eb, LINK_OPTION_TX, LINK_TYPE_ADVERTISING_ONLY,
+                                  &tsch_broadcast_address, 12, 0, 0) != NULL;
+  links += tsch_schedule_add_link(sf_eb, LINK_OPTION_RX, LINK_TYPE_ADVERTISING_ONLY,
+                                  &tsch_broadcast_address, 300, 0, 0) != NULL;
+  links += tsch_schedule_add_link(sf_common,
+                                  LINK_OPTION_TX | LINK_OPTION_RX | LINK_OPTION_SHARED,
+                                  LINK_TYPE_ADVERTISING, &tsch_broadcast_address,
+                                  0, 1, 0) != NULL;
+  /* One Rx cell for the node and a shared Tx cell for every neighbor */
+  links += tsch_schedule_add_link(sf_unicast, LINK_OPTION_RX, LINK_TYPE_NORMAL,
+                                  &tsch_broadcast_address, 5, 2, 0) != NULL;
+  for(int i = 0; i < TEST_NEIGHBORS; i++) {
+    linkaddr_copy(&addr, &linkaddr_null);
+    addr.u8[LINKADDR_SIZE - 1] = i + 1;
+    links += tsch_schedule_add_link(sf_unicast,
+                                    LINK_OPTION_TX | LINK_OPTION_SHARED,
+                                    LINK_TYPE_NORMAL, &addr, i % 17, 2, 0) != NULL;
+  }
+  /* Negotiated cells, with several cells per timeslot */
+  srand(1);
+  for(int i = 0; i < TEST_CELLS; i++) {
+    linkaddr_copy(&addr, &linkaddr_null);
+    addr.u8[LINKADDR_SIZE - 1] = 1 + rand() % TEST_NEIGHBORS;
+    links += tsch_schedule_add_link(sf_6tisch,
+                                    rand() % 2 ? LINK_OPTION_TX : LINK_OPTION_RX,
+                                    LINK_TYPE_NORMAL, &addr,
+                                    rand() % 101, 3 + i % 13, 0) != NULL;
+  }
+
+  return links == 3 + 1 + TEST_NEIGHBORS + TEST_CELLS;
+}
+/*****************************************************************************/
+/* Compares the next active links to the reference over consecutive ASNs */
+static int
+check_schedule(uint32_t first_asn)
+{
+  struct tsch_asn_t asn;
+  struct tsch_link *link, *backup;
+  struct tsch_link *ref_link, *ref_backup;
+  uint16_t offset, ref_offset;
+
+  TSCH_ASN_INIT(asn, 0, first_asn);
+  for(int i = 0; i < TEST_ASNS; i++) {
+    link = tsch_schedule_get_next_active_link(&asn, &offset, &backup);
+    ref_link = reference_next_active_link(&asn, &ref_offset, &ref_backup);
+    if(link != ref_link || backup != ref_backup || offset != ref_offset) {
+      printf("Mismatch at ASN %lu\n", (unsigned long)asn.ls4b);
+      return 0;
+    }
+    TSCH_ASN_INC(asn, 1);
+  }
+  return 1;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(next_active_link, "Next active link");
+UNIT_TEST(next_active_link)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l, *next;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(create_schedule());
+  UNIT_TEST_ASSERT(check_schedule(0));
+  UNIT_TEST_ASSERT(check_schedule(0xffffffff - TEST_ASNS / 2));
+
+  /* Remove every third cell and the shared cell, and check again */
+  sf = tsch_schedule_get_slotframe_by_handle(3);
+  for(l = list_head(sf->links_list), i = 0; l != NULL; l = next, i++) {
+    next = list_item_next(l);
+    if(i % 3 == 0) {
+      UNIT_TEST_ASSERT(tsch_schedule_remove_link(sf, l));
+    }
+  }
+  sf = tsch_schedule_get_slotframe_by_handle(1);
+  UNIT_TEST_ASSERT(tsch_schedule_remove_link_by_offsets(sf, 0, 1));
+  UNIT_TEST_ASSERT(check_schedule(12345));
+
+  /* A slotframe without links, and removed slotframes */
+  UNIT_TEST_ASSERT(tsch_schedule_remove_slotframe(sf));
+  UNIT_TEST_ASSERT(tsch_schedule_add_slotframe(4, 7) != NULL);
+  UNIT_TEST_ASSERT(tsch_schedule_remove_slotframe(tsch_schedule_get_slotframe_by_handle(0)));
+  UNIT_TEST_ASSERT(check_schedule(777));
+  sf = tsch_schedule_get_slotframe_by_handle(4);
+  UNIT_TEST_ASSERT(tsch_schedule_add_link(sf, LINK_OPTION_RX, LINK_TYPE_NORMAL,
+                                          &tsch_broadcast_address, 3, 0, 1) != NULL);
+  UNIT_TEST_ASSERT(check_schedule(778));
+
+  UNIT_TEST_ASSERT(tsch_schedule_remove_all_slotframes());
+  UNIT_TEST_ASSERT(tsch_schedule_slotframe_head() == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+/* The link lookups of the original implementation */
+static struct tsch_link *
+reference_link_by_offsets(struct tsch_slotframe *sf, uint16_t timeslot,
+                          int channel_offset)
+{
+  struct tsch_link *l;
+
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->timeslot == timeslot &&
+       (channel_offset < 0 || l->channel_offset == channel_offset)) {
+      return l;
+    }
+  }
+  return NULL;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(link_lookup, "Link lookup");
+UNIT_TEST(link_lookup)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  uint64_t start, cycles;
+  unsigned found = 0, expected = 0;
+
+  UNIT_TEST_BEGIN();
+
+  printf("Link hash: %s\n", TSCH_SCHEDULE_WITH_LINK_HASH ? "yes" : "no");
+
+  UNIT_TEST_ASSERT(create_schedule());
+
+  for(sf = tsch_schedule_slotframe_head(); sf != NULL;
+      sf = tsch_schedule_slotframe_next(sf)) {
+    for(uint16_t ts = 0; ts < sf->size.val; ts++) {
+      UNIT_TEST_ASSERT(tsch_schedule_get_link_by_timeslot(sf, ts) ==
+                       reference_link_by_offsets(sf, ts, -1));
+      for(uint16_t ch = 0; ch < 16; ch++) {
+        UNIT_TEST_ASSERT(tsch_schedule_get_link_by_offsets(sf, ts, ch) ==
+                         reference_link_by_offsets(sf, ts, ch));
+      }
+    }
+  }
+
+  /* Remove all cells of a timeslot, and a cell at a free timeslot */
+  sf = tsch_schedule_get_slotframe_by_handle(3);
+  l = list_head(sf->links_list);
+  while(tsch_schedule_get_link_by_timeslot(sf, l->timeslot) != NULL) {
+    UNIT_TEST_ASSERT(tsch_schedule_remove_link_by_offsets(sf, l->timeslot,
+      tsch_schedule_get_link_by_timeslot(sf, l->timeslot)->channel_offset));
+  }
+  UNIT_TEST_ASSERT(reference_link_by_offsets(sf, l->timeslot, -1) == NULL);
+  UNIT_TEST_ASSERT(!tsch_schedule_remove_link_by_offsets(sf, l->timeslot, 0));
+
+  /*
+   * Time the search of a 6P candidate cell list: every cell of the
+   * slotframe is checked for a conflict.
+   */
+  for(uint16_t ts = 0; ts < sf->size.val; ts++) {
+    for(uint16_t ch = 0; ch < 16; ch++) {
+      expected += reference_link_by_offsets(sf, ts, ch) != NULL;
+    }
+  }
+  start = now_cycles();
+  for(uint16_t ts = 0; ts < sf->size.val; ts++) {
+    for(uint16_t ch = 0; ch < 16; ch++) {
+      found += tsch_schedule_get_link_by_offsets(sf, ts, ch) != NULL;
+    }
+  }
+  cycles = now_cycles() - start;
+  printf("%u cells: %.0f cycles per cell lookup\n",
+         list_length(sf->links_list), (double)cycles / (sf->size.val * 16));
+  UNIT_TEST_ASSERT(found == expected);
+
+  UNIT_TEST_ASSERT(tsch_schedule_remove_all_slotframes());
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Next active link benchmark");
+UNIT_TEST(benchmark)
+{
+  struct tsch_asn_t asn;
+  struct tsch_link *backup;
+  uint16_t offset;
+  uint64_t start, cycles, total = 0, worst = 0;
+  unsigned failures = 0;
+
+  UNIT_TEST_BEGIN();
+
+  printf("Sorted links: %s\n", TSCH_SCHEDULE_WITH_SORTED_LINKS ? "yes" : "no");
+
+  UNIT_TEST_ASSERT(create_schedule());
+
+  /* The fastest of a few calls per ASN, so that the worst case is not
+     that of a call interrupted by the host */
+  TSCH_ASN_INIT(asn, 0, 0);
+  for(int i = 0; i < TEST_ASNS; i++) {
+    cycles = UINT64_MAX;
+    for(int j = 0; j < TEST_REPEATS; j++) {
+      start = now_cycles();
+      if(tsch_schedule_get_next_active_link(&asn, &offset, &backup) == NULL) {
+        failures++;
+      }
+      start = now_cycles() - start;
+      if(start < cycles) {
+        cycles = start;
+      }
+    }
+    total += cycles;
+    if(cycles > worst) {
+      worst = cycles;
+    }
+    TSCH_ASN_INC(asn, 1);
+  }
+
+  printf("%u links: %.0f cycles per call on average, %lu at worst\n",
+         3 + 1 + TEST_NEIGHBORS + TEST_CELLS,
+         (double)total / TEST_ASNS, (unsigned long)worst);
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_tsch_schedule_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(next_active_link);
+  UNIT_TEST_RUN(link_lookup);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(next_active_link) ||
+     !UNIT_TEST_PASSED(link_lookup) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a benchmark for the selection of a unicast packet
+ *      on a shared TSCH link. The test is built once with the scan of
+ *      the neighbor table and once with TSCH_QUEUE_CONF_WITH_READY_SET,
+ *      so that the timings can be compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/nbr-table.h"
+#include "net/packetbuf.h"
+#include "net/mac/tsch/tsch.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of random queue operations in the consistency test. */
+#ifdef TEST_CONF_OPERATIONS
+#define TEST_OPERATIONS TEST_CONF_OPERATIONS
+#else
+#define TEST_OPERATIONS 100000
+#endif
+
+#define TEST_NEIGHBORS (NBR_TABLE_MAX_NEIGHBORS - 2)
+#define TEST_CALLS 10000
+
+/* The parts of TSCH that the queues use. */
+int tsch_is_coordinator;
+const linkaddr_t tsch_broadcast_address = { { 0xff, 0xff } };
+const linkaddr_t tsch_eb_address = { { 0, 0 } };
+
+static struct tsch_neighbor *neighbors[TEST_NEIGHBORS];
+static struct tsch_link shared_link = {
+  .link_options = LINK_OPTION_TX | LINK_OPTION_RX | LINK_OPTION_SHARED,
+};
+/*****************************************************************************/
+int
+tsch_is_locked(void)
+{
+  return 0;
+}
+/*****************************************************************************/
+int
+tsch_get_lock(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+void
+tsch_release_lock(void)
+{
+}
+/*****************************************************************************/
+void
+tsch_set_ka_timeout(uint32_t timeout)
+{
+}
+/*****************************************************************************/
+PROCESS(test_tsch_queue_process, "TSCH queue test process");
+AUTOSTART_PROCESSES(&test_tsch_queue_process);
+/*****************************************************************************/
+static uint64_t
+now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+/*****************************************************************************/
+/* Gives a tx link to the neighbor, or takes it away */
+static void
+set_tx_link(struct tsch_neighbor *n, int has_link)
+{
+  n->tx_links_count = has_link;
+  tsch_queue_update_ready(n);
+}
+/*****************************************************************************/
+static void
+create_neighbors(void)
+{
+  linkaddr_t addr;
+
+  tsch_queue_init();
+  for(int i = 0; i < TEST_NEIGHBORS; i++) {
+    linkaddr_copy(&addr, &linkaddr_null);
+    addr.u8[LINKADDR_SIZE - 1] = i + 1;
+    neighbors[i] = tsch_queue_add_nbr(&addr);
+    if(neighbors[i] != NULL) {
+      set_tx_link(neighbors[i], 0);
+    }
+  }
+}
+/*****************************************************************************/
+static int
+add_packet(struct tsch_neighbor *n)
+{
+  packetbuf_clear();
+  packetbuf_copyfrom("payload", 7);
+  return tsch_queue_add_packet(tsch_queue_get_nbr_address(n), 4, NULL, NULL) != NULL;
+}
+/*****************************************************************************/
+/* May the neighbor send over a shared link to the broadcast address? */
+static int
+is_ready(const struct tsch_neighbor *n)
+{
+  return !n->is_broadcast && n->tx_links_count == 0 &&
+    tsch_queue_backoff_expired(n) && !tsch_queue_is_empty(n);
+}
+/*****************************************************************************/
+static int
+count_ready(void)
+{
+  int count = 0;
+
+  for(int i = 0; i < TEST_NEIGHBORS; i++) {
+    count += is_ready(neighbors[i]);
+  }
+  return count;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(selection, "Packet selection");
+UNIT_TEST(selection)
+{
+  static uint8_t served[TEST_NEIGHBORS];
+  struct tsch_neighbor *n;
+  struct tsch_packet *p;
+  int ready, index, distinct = 0;
+
+  UNIT_TEST_BEGIN();
+
+  create_neighbors();
+  for(int i = 0; i < TEST_NEIGHBORS; i++) {
+    UNIT_TEST_ASSERT(neighbors[i] != NULL);
+  }
+  UNIT_TEST_ASSERT(tsch_queue_get_unicast_packet_for_any(&n, &shared_link) == NULL);
+
+  /* Neighbors with packets, in backoff, and with a tx link */
+  srand(1);
+  for(int i = 0; i < TEST_NEIGHBORS; i++) {
+    if(rand() % 2) {
+      UNIT_TEST_ASSERT(add_packet(neighbors[i]));
+    }
+    if(rand() % 4 == 0) {
+      tsch_queue_backoff_inc(neighbors[i]);
+    }
+    if(rand() % 8 == 0) {
+      set_tx_link(neighbors[i], 1);
+    }
+  }
+  /* Broadcast packets are not picked */
+  UNIT_TEST_ASSERT(add_packet(n_broadcast));
+
+  ready = count_ready();
+  UNIT_TEST_ASSERT(ready > 0);
+  for(int i = 0; i < ready; i++) {
+    p = tsch_queue_get_unicast_packet_for_any(&n, &shared_link);
+    UNIT_TEST_ASSERT(p != NULL);
+    UNIT_TEST_ASSERT(is_ready(n));
+    for(index = 0; neighbors[index] != n; index++);
+    distinct += !served[index];
+    served[index] = 1;
+  }
+#if TSCH_QUEUE_WITH_READY_SET
+  /* Round-robin: every ready neighbor is served once per round */
+  UNIT_TEST_ASSERT(distinct == ready);
+#else /* TSCH_QUEUE_WITH_READY_SET */
+  /* The scan always serves the first ready neighbor */
+  UNIT_TEST_ASSERT(distinct == 1);
+#endif /* TSCH_QUEUE_WITH_READY_SET */
+
+  /* A non-shared link ignores the backoff */
+  tsch_queue_reset();
+  set_tx_link(neighbors[0], 0);
+  UNIT_TEST_ASSERT(add_packet(neighbors[0]));
+  tsch_queue_backoff_inc(neighbors[0]);
+  UNIT_TEST_ASSERT(tsch_queue_get_unicast_packet_for_any(&n, &shared_link) == NULL);
+  shared_link.link_options &= ~LINK_OPTION_SHARED;
+  UNIT_TEST_ASSERT(tsch_queue_get_unicast_packet_for_any(&n, &shared_link) != NULL);
+  UNIT_TEST_ASSERT(n == neighbors[0]);
+  shared_link.link_options |= LINK_OPTION_SHARED;
+
+  tsch_queue_reset();
+  UNIT_TEST_ASSERT(tsch_queue_global_packet_count() == 0);
+  UNIT_TEST_ASSERT(tsch_queue_get_unicast_packet_for_any(&n, &shared_link) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(consistency, "Consistency over random operations");
+UNIT_TEST(consistency)
+{
+  struct tsch_neighbor *n;
+  struct tsch_packet *p;
+  unsigned sent = 0;
+
+  UNIT_TEST_BEGIN();
+
+  create_neighbors();
+  srand(2);
+  for(int i = 0; i < TEST_OPERATIONS; i++) {
+    n = neighbors[rand() % TEST_NEIGHBORS];
+    switch(rand() % 4) {
+    case 0:
+      /* At most two packets per neighbor, to not run out of queuebufs */
+      if(tsch_queue_nbr_packet_count(n) < 2) {
+        UNIT_TEST_ASSERT(add_packet(n));
+      }
+      break;
+    case 1:
+      if(rand() % 16 == 0) {
+        set_tx_link(n, !n->tx_links_count);
+      }
+      break;
+    default:
+      /* A shared slot: send a packet, fail half of the times */
+      p = tsch_queue_get_unicast_packet_for_any(&n, &shared_link);
+      if(p == NULL) {
+        UNIT_TEST_ASSERT(count_ready() == 0);
+      } else {
+        UNIT_TEST_ASSERT(is_ready(n));
+        p->transmissions++;
+        if(!tsch_queue_packet_sent(n, p, &shared_link,
+                                   rand() % 2 ? MAC_TX_OK : MAC_TX_NOACK)) {
+          tsch_queue_free_packet(p);
+          sent++;
+        }
+      }
+      tsch_queue_update_all_backoff_windows(&tsch_broadcast_address);
+      break;
+    }
+  }
+  printf("Packets sent or dropped: %u\n", sent);
+  UNIT_TEST_ASSERT(sent > 0);
+
+  tsch_queue_reset();
+  UNIT_TEST_ASSERT(tsch_queue_global_packet_count() == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+/* Cycles per packet selection */
+static double
+time_selection(void)
+{
+  struct tsch_neighbor *n;
+  uint64_t start, best = UINT64_MAX;
+
+  for(int r = 0; r < 5; r++) {
+    start = now_cycles();
+    for(int i = 0; i < TEST_CALLS; i++) {
+      tsch_queue_get_unicast_packet_for_any(&n, &shared_link);
+    }
+    best = MIN(best, now_cycles() - start);
+  }
+  return (double)best / TEST_CALLS;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Selection benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("Ready set: %s\n", TSCH_QUEUE_WITH_READY_SET ? "yes" : "no");
+
+  create_neighbors();
+  for(int i = 0; i < TEST_NEIGHBORS; i++) {
+    UNIT_TEST_ASSERT(add_packet(neighbors[i]));
+  }
+  printf("%d neighbors, all ready:        %7.1f cycles per selection\n",
+         TEST_NEIGHBORS, time_selection());
+
+  /* A busy network: all neighbors but one in backoff */
+  for(int i = 0; i < TEST_NEIGHBORS - 1; i++) {
+    tsch_queue_backoff_inc(neighbors[i]);
+  }
+  UNIT_TEST_ASSERT(count_ready() == 1);
+  printf("%d neighbors, one ready:        %7.1f cycles per selection\n",
+         TEST_NEIGHBORS, time_selection());
+
+  /* Orchestra: a tx link to every neighbor but one */
+  for(int i = 0; i < TEST_NEIGHBORS - 1; i++) {
+    tsch_queue_backoff_reset(neighbors[i]);
+    set_tx_link(neighbors[i], 1);
+  }
+  UNIT_TEST_ASSERT(count_ready() == 1);
+  printf("%d neighbors, one without link: %7.1f cycles per selection\n",
+         TEST_NEIGHBORS, time_selection());
+
+  tsch_queue_reset();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_tsch_queue_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(selection);
+  UNIT_TEST_RUN(consistency);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(selection) ||
+     !UNIT_TEST_PASSED(consistency) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
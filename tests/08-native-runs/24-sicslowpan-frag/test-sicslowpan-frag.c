@@ -0,0 +1,458 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests for the fragmentation of 6LoWPAN. A node forwards a
+ *      fragmented datagram, and the frames that it sends are checked
+ *      and reassembled. The test is built once with reassembly at
+ *      every hop and once with SICSLOWPAN_CONF_FRAG_FORWARDING, so that
+ *      the latencies in frames and the buffer usages can be compared.
+ *      Last, the node becomes an RPL root, which inserts a source
+ *      routing header into the datagrams that it forwards.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/ipv6/simple-udp.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "net/ipv6/uip-sr.h"
+#include "net/routing/routing.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define TEST_PAYLOAD_LEN 1024
+#define TEST_PORT 5683
+/* An IEEE 802.15.4 frame with short addresses and a PAN ID */
+#define TEST_MAC_PAYLOAD (127 - 2 - 9)
+#define MAX_FRAMES 32
+
+struct frame {
+  linkaddr_t receiver;
+  uint16_t len;
+  uint8_t data[PACKETBUF_SIZE];
+};
+
+/* The frames sent through the MAC driver */
+static struct frame sent[MAX_FRAMES];
+static int sent_count;
+/* The frames fed to the node */
+static struct frame received[MAX_FRAMES];
+static int received_count;
+
+static const linkaddr_t prev_hop = { { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11 } };
+static const linkaddr_t next_hop = { { 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22 } };
+
+static struct simple_udp_connection conn;
+static uint16_t delivered_len;
+static int delivered_ok;
+/*****************************************************************************/
+static void
+mac_init(void)
+{
+}
+/*****************************************************************************/
+static void
+mac_send(mac_callback_t sent_callback, void *ptr)
+{
+  if(sent_count < MAX_FRAMES) {
+    struct frame *f = &sent[sent_count++];
+    linkaddr_copy(&f->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+    f->len = packetbuf_datalen();
+    memcpy(f->data, packetbuf_dataptr(), f->len);
+  }
+  mac_call_sent_callback(sent_callback, ptr, MAC_TX_OK, 1);
+}
+/*****************************************************************************/
+static void
+mac_input(void)
+{
+}
+/*****************************************************************************/
+static int
+mac_on(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_off(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_max_payload(void)
+{
+  return TEST_MAC_PAYLOAD;
+}
+/*****************************************************************************/
+const struct mac_driver test_mac_driver = {
+  "test-mac",
+  mac_init,
+  mac_send,
+  mac_input,
+  mac_on,
+  mac_off,
+  mac_max_payload,
+};
+/*****************************************************************************/
+PROCESS(test_sicslowpan_frag_process, "6LoWPAN fragmentation test process");
+AUTOSTART_PROCESSES(&test_sicslowpan_frag_process);
+/*****************************************************************************/
+static void
+udp_rx_callback(struct simple_udp_connection *c,
+                const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+                const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+                const uint8_t *data, uint16_t datalen)
+{
+  delivered_len = datalen;
+  delivered_ok = 1;
+  for(int i = 0; i < datalen; i++) {
+    if(data[i] != (uint8_t)(i * 7)) {
+      delivered_ok = 0;
+    }
+  }
+}
+/*****************************************************************************/
+static void
+set_destination(uip_ipaddr_t *addr)
+{
+  uip_ip6addr(addr, 0xfd01, 0, 0, 0, 0, 0, 0, 0x99);
+}
+/*****************************************************************************/
+/* Fragments a UDP datagram from another node through the next hop */
+static void
+create_fragments_to(const uip_ipaddr_t *destination)
+{
+  uint8_t *payload;
+
+  uipbuf_clear();
+  memset(UIP_IP_BUF, 0, UIP_IPH_LEN + UIP_UDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfd02, 0, 0, 0, 0, 0, 0, 1);
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, destination);
+  uip_len = UIP_IPH_LEN + UIP_UDPH_LEN + TEST_PAYLOAD_LEN;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+
+  UIP_UDP_BUF->srcport = UIP_HTONS(TEST_PORT);
+  UIP_UDP_BUF->destport = UIP_HTONS(TEST_PORT);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + TEST_PAYLOAD_LEN);
+  payload = (uint8_t *)UIP_UDP_BUF + UIP_UDPH_LEN;
+  for(int i = 0; i < TEST_PAYLOAD_LEN; i++) {
+    payload[i] = i * 7;
+  }
+  UIP_UDP_BUF->udpchksum = ~(uip_udpchksum());
+  if(UIP_UDP_BUF->udpchksum == 0) {
+    UIP_UDP_BUF->udpchksum = 0xffff;
+  }
+
+  sent_count = 0;
+  NETSTACK_NETWORK.output(&linkaddr_node_addr);
+  memcpy(received, sent, sizeof(sent));
+  received_count = sent_count;
+  sent_count = 0;
+}
+/*****************************************************************************/
+static void
+create_fragments(void)
+{
+  uip_ipaddr_t addr;
+
+  set_destination(&addr);
+  create_fragments_to(&addr);
+}
+/*****************************************************************************/
+/* Get the datagram tag of a fragment */
+static uint16_t
+frame_tag(const struct frame *f)
+{
+  return (f->data[2] << 8) | f->data[3];
+}
+/*****************************************************************************/
+static void
+input_frame(const struct frame *f, const linkaddr_t *sender)
+{
+  packetbuf_clear();
+  packetbuf_copyfrom(f->data, f->len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, sender);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  NETSTACK_NETWORK.input();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(forwarding, "Forwarding a fragmented datagram");
+UNIT_TEST(forwarding)
+{
+  uip_ipaddr_t nexthop_addr, addr;
+  uip_ds6_addr_t *local;
+  const struct sicslowpan_frag_stats *stats;
+  int first_sent = -1;
+  uint16_t tag;
+
+  UNIT_TEST_BEGIN();
+
+  printf("Fragment forwarding: %s\n", SICSLOWPAN_CONF_FRAG_FORWARDING ? "yes" : "no");
+
+  /* Route everything through the next hop */
+  uip_ip6addr(&nexthop_addr, 0xfe80, 0, 0, 0, 0, 0, 0, 0x22);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_add(&nexthop_addr, (const uip_lladdr_t *)&next_hop,
+                                   1, NBR_REACHABLE, NBR_TABLE_REASON_UNDEFINED,
+                                   NULL) != NULL);
+  UNIT_TEST_ASSERT(uip_ds6_defrt_add(&nexthop_addr, 0) != NULL);
+
+  create_fragments();
+  printf("Datagram of %u bytes in %d fragments\n",
+         UIP_IPH_LEN + UIP_UDPH_LEN + TEST_PAYLOAD_LEN, received_count);
+  UNIT_TEST_ASSERT(received_count > 2);
+
+  /* The node forwards the datagram */
+  for(int i = 0; i < received_count; i++) {
+    input_frame(&received[i], &prev_hop);
+    if(first_sent < 0 && sent_count > 0) {
+      first_sent = i + 1;
+    }
+  }
+  stats = sicslowpan_get_frag_stats();
+  printf("Fragments received before the first was sent: %d\n", first_sent);
+  printf("Peak fragment buffers in use: %u\n", stats->max_buffers);
+  UNIT_TEST_ASSERT(sent_count >= received_count);
+  for(int i = 0; i < sent_count; i++) {
+    UNIT_TEST_ASSERT(linkaddr_cmp(&sent[i].receiver, &next_hop));
+  }
+#if SICSLOWPAN_CONF_FRAG_FORWARDING
+  UNIT_TEST_ASSERT(first_sent == 1);
+  UNIT_TEST_ASSERT(stats->forwarded == 1);
+  UNIT_TEST_ASSERT(stats->max_buffers == 0);
+  /* All fragments have the new tag, the next ones are unchanged */
+  tag = frame_tag(&sent[0]);
+  for(int i = 1; i < sent_count; i++) {
+    UNIT_TEST_ASSERT(frame_tag(&sent[i]) == tag);
+    UNIT_TEST_ASSERT(sent[i].len == received[i].len);
+    UNIT_TEST_ASSERT(memcmp(sent[i].data + 4, received[i].data + 4,
+                            sent[i].len - 4) == 0);
+  }
+#else /* SICSLOWPAN_CONF_FRAG_FORWARDING */
+  UNIT_TEST_ASSERT(first_sent == received_count);
+  UNIT_TEST_ASSERT(stats->reassembled == 1);
+  UNIT_TEST_ASSERT(stats->max_buffers == received_count - 1);
+  (void)tag;
+#endif /* SICSLOWPAN_CONF_FRAG_FORWARDING */
+
+  /* The next hop reassembles the datagram that was sent */
+  set_destination(&addr);
+  local = uip_ds6_addr_add(&addr, 0, ADDR_MANUAL);
+  UNIT_TEST_ASSERT(local != NULL);
+  memcpy(received, sent, sizeof(sent));
+  received_count = sent_count;
+  sent_count = 0;
+  delivered_len = 0;
+  for(int i = 0; i < received_count; i++) {
+    input_frame(&received[i], &prev_hop);
+  }
+  UNIT_TEST_ASSERT(delivered_len == TEST_PAYLOAD_LEN);
+  UNIT_TEST_ASSERT(delivered_ok);
+  UNIT_TEST_ASSERT(sent_count == 0);
+  uip_ds6_addr_rm(local);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lost_fragment, "Lost fragment");
+UNIT_TEST(lost_fragment)
+{
+  uip_ipaddr_t addr;
+  uip_ds6_addr_t *local;
+
+  UNIT_TEST_BEGIN();
+
+  /* The node forwards or reassembles what it can */
+  create_fragments();
+  for(int i = 0; i < received_count; i++) {
+    if(i != 1) {
+      input_frame(&received[i], &prev_hop);
+    }
+  }
+#if SICSLOWPAN_CONF_FRAG_FORWARDING
+  UNIT_TEST_ASSERT(sent_count == received_count - 1);
+#else /* SICSLOWPAN_CONF_FRAG_FORWARDING */
+  UNIT_TEST_ASSERT(sent_count == 0);
+#endif /* SICSLOWPAN_CONF_FRAG_FORWARDING */
+
+  /* The datagram is not delivered, and the next one is */
+  set_destination(&addr);
+  local = uip_ds6_addr_add(&addr, 0, ADDR_MANUAL);
+  UNIT_TEST_ASSERT(local != NULL);
+  memcpy(received, sent, sizeof(sent));
+  received_count = sent_count;
+  delivered_len = 0;
+  for(int i = 0; i < received_count; i++) {
+    input_frame(&received[i], &prev_hop);
+  }
+  UNIT_TEST_ASSERT(delivered_len == 0);
+
+  create_fragments();
+  for(int i = 0; i < received_count; i++) {
+    input_frame(&received[i], &prev_hop);
+  }
+  UNIT_TEST_ASSERT(delivered_len == TEST_PAYLOAD_LEN);
+  UNIT_TEST_ASSERT(delivered_ok);
+  uip_ds6_addr_rm(local);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(duplicate_fragment, "Duplicate fragment");
+UNIT_TEST(duplicate_fragment)
+{
+  uip_ipaddr_t addr;
+  uip_ds6_addr_t *local;
+
+  UNIT_TEST_BEGIN();
+
+#if SICSLOWPAN_CONF_FRAG_FORWARDING
+  /* The previous hop sends the second fragment twice, and the node
+     forwards it once and still forwards the last fragment */
+  create_fragments();
+  for(int i = 0; i < received_count; i++) {
+    input_frame(&received[i], &prev_hop);
+    if(i == 1) {
+      input_frame(&received[i], &prev_hop);
+    }
+  }
+  UNIT_TEST_ASSERT(sent_count == received_count);
+
+  /* The next hop reassembles the datagram that was sent */
+  set_destination(&addr);
+  local = uip_ds6_addr_add(&addr, 0, ADDR_MANUAL);
+  UNIT_TEST_ASSERT(local != NULL);
+  memcpy(received, sent, sizeof(sent));
+  received_count = sent_count;
+  sent_count = 0;
+  delivered_len = 0;
+  for(int i = 0; i < received_count; i++) {
+    input_frame(&received[i], &prev_hop);
+  }
+  UNIT_TEST_ASSERT(delivered_len == TEST_PAYLOAD_LEN);
+  UNIT_TEST_ASSERT(delivered_ok);
+  uip_ds6_addr_rm(local);
+#else /* SICSLOWPAN_CONF_FRAG_FORWARDING */
+  (void)addr;
+  (void)local;
+#endif /* SICSLOWPAN_CONF_FRAG_FORWARDING */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(rewritten_headers, "Forwarding with rewritten headers");
+UNIT_TEST(rewritten_headers)
+{
+  uip_ipaddr_t root_addr, hop_addr, dest_addr;
+  const struct sicslowpan_frag_stats *stats;
+  uint32_t forwarded;
+  uint32_t reassembled;
+  uint16_t tag;
+  uint16_t size;
+
+  UNIT_TEST_BEGIN();
+
+  /* As the RPL root, the node inserts a source routing header into the
+     datagrams for nodes down the DODAG */
+  NETSTACK_ROUTING.root_set_prefix(NULL, NULL);
+  NETSTACK_ROUTING.root_start();
+  UNIT_TEST_ASSERT(NETSTACK_ROUTING.get_root_ipaddr(&root_addr));
+  uip_ip6addr(&hop_addr, 0, 0, 0, 0, 0, 0, 0, 0x22);
+  memcpy(&hop_addr, &root_addr, 8);
+  uip_ip6addr(&dest_addr, 0, 0, 0, 0, 0, 0, 0, 0x33);
+  memcpy(&dest_addr, &root_addr, 8);
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &hop_addr, &root_addr,
+                                      UIP_SR_INFINITE_LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &dest_addr, &hop_addr,
+                                      UIP_SR_INFINITE_LIFETIME) != NULL);
+
+  stats = sicslowpan_get_frag_stats();
+  forwarded = stats->forwarded;
+  reassembled = stats->reassembled;
+
+  create_fragments_to(&dest_addr);
+  for(int i = 0; i < received_count; i++) {
+    input_frame(&received[i], &prev_hop);
+  }
+
+  /* The headers grew, so the datagram is reassembled and sent once */
+  printf("Fragments sent: %d\n", sent_count);
+  UNIT_TEST_ASSERT(stats->forwarded == forwarded);
+  UNIT_TEST_ASSERT(stats->reassembled == reassembled + 1);
+  UNIT_TEST_ASSERT(sent_count >= received_count);
+  tag = frame_tag(&sent[0]);
+  size = ((sent[0].data[0] << 8) | sent[0].data[1]) & 0x07ff;
+  UNIT_TEST_ASSERT(size > UIP_IPH_LEN + UIP_UDPH_LEN + TEST_PAYLOAD_LEN);
+  for(int i = 0; i < sent_count; i++) {
+    UNIT_TEST_ASSERT(linkaddr_cmp(&sent[i].receiver, &next_hop));
+    UNIT_TEST_ASSERT(frame_tag(&sent[i]) == tag);
+  }
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_sicslowpan_frag_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  simple_udp_register(&conn, TEST_PORT, NULL, TEST_PORT, udp_rx_callback);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(forwarding);
+  UNIT_TEST_RUN(lost_fragment);
+  UNIT_TEST_RUN(duplicate_fragment);
+  UNIT_TEST_RUN(rewritten_headers);
+
+  if(!UNIT_TEST_PASSED(forwarding) ||
+     !UNIT_TEST_PASSED(lost_fragment) ||
+     !UNIT_TEST_PASSED(duplicate_fragment) ||
+     !UNIT_TEST_PASSED(rewritten_headers)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
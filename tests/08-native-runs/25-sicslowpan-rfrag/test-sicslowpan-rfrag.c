@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests for the selective fragment recovery of 6LoWPAN. The
+ *      node sends a fragmented datagram to a peer, and the frames that
+ *      it sends are fed back to it as if the peer had sent them, so that
+ *      it is both the sender and the receiver of the fragments. Some
+ *      frames are lost on the way.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/ipv6/simple-udp.h"
+#include "net/ipv6/uip-ds6.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define TEST_PAYLOAD_LEN 1024
+#define TEST_PORT 5683
+/* An IEEE 802.15.4 frame with short addresses and a PAN ID */
+#define TEST_MAC_PAYLOAD (127 - 2 - 9)
+#define MAX_FRAMES 32
+
+struct frame {
+  linkaddr_t receiver;
+  uint16_t len;
+  uint8_t data[PACKETBUF_SIZE];
+};
+
+/* The frames sent through the MAC driver */
+static struct frame sent[MAX_FRAMES];
+static int sent_count;
+/* The frames fed to the node */
+static struct frame received[MAX_FRAMES];
+static int received_count;
+
+static const linkaddr_t peer = { { 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22 } };
+
+static struct simple_udp_connection conn;
+static int delivered;
+static int delivered_ok;
+static struct etimer timer;
+/*****************************************************************************/
+static void
+mac_init(void)
+{
+}
+/*****************************************************************************/
+static void
+mac_send(mac_callback_t sent_callback, void *ptr)
+{
+  if(sent_count < MAX_FRAMES) {
+    struct frame *f = &sent[sent_count++];
+    linkaddr_copy(&f->receiver, packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
+    f->len = packetbuf_datalen();
+    memcpy(f->data, packetbuf_dataptr(), f->len);
+  }
+  mac_call_sent_callback(sent_callback, ptr, MAC_TX_OK, 1);
+}
+/*****************************************************************************/
+static void
+mac_input(void)
+{
+}
+/*****************************************************************************/
+static int
+mac_on(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_off(void)
+{
+  return 1;
+}
+/*****************************************************************************/
+static int
+mac_max_payload(void)
+{
+  return TEST_MAC_PAYLOAD;
+}
+/*****************************************************************************/
+const struct mac_driver test_mac_driver = {
+  "test-mac",
+  mac_init,
+  mac_send,
+  mac_input,
+  mac_on,
+  mac_off,
+  mac_max_payload,
+};
+/*****************************************************************************/
+PROCESS(test_sicslowpan_rfrag_process, "6LoWPAN fragment recovery test process");
+AUTOSTART_PROCESSES(&test_sicslowpan_rfrag_process);
+/*****************************************************************************/
+static void
+udp_rx_callback(struct simple_udp_connection *c,
+                const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+                const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+                const uint8_t *data, uint16_t datalen)
+{
+  delivered++;
+  delivered_ok = datalen == TEST_PAYLOAD_LEN;
+  for(int i = 0; i < datalen; i++) {
+    if(data[i] != (uint8_t)(i * 7)) {
+      delivered_ok = 0;
+    }
+  }
+}
+/*****************************************************************************/
+static void
+set_destination(uip_ipaddr_t *addr)
+{
+  uip_ip6addr(addr, 0xfd01, 0, 0, 0, 0, 0, 0, 0x99);
+}
+/*****************************************************************************/
+/* Moves the frames sent to the frames to feed to the node */
+static void
+take_sent_frames(void)
+{
+  memcpy(received, sent, sizeof(sent));
+  received_count = sent_count;
+  sent_count = 0;
+}
+/*****************************************************************************/
+/* Fragments a UDP datagram for this node, sent to the peer */
+static void
+create_fragments(void)
+{
+  uint8_t *payload;
+
+  uipbuf_clear();
+  memset(UIP_IP_BUF, 0, UIP_IPH_LEN + UIP_UDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfd02, 0, 0, 0, 0, 0, 0, 1);
+  set_destination(&UIP_IP_BUF->destipaddr);
+  uip_len = UIP_IPH_LEN + UIP_UDPH_LEN + TEST_PAYLOAD_LEN;
+  uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
+
+  UIP_UDP_BUF->srcport = UIP_HTONS(TEST_PORT);
+  UIP_UDP_BUF->destport = UIP_HTONS(TEST_PORT);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + TEST_PAYLOAD_LEN);
+  payload = (uint8_t *)UIP_UDP_BUF + UIP_UDPH_LEN;
+  for(int i = 0; i < TEST_PAYLOAD_LEN; i++) {
+    payload[i] = i * 7;
+  }
+  UIP_UDP_BUF->udpchksum = ~(uip_udpchksum());
+  if(UIP_UDP_BUF->udpchksum == 0) {
+    UIP_UDP_BUF->udpchksum = 0xffff;
+  }
+
+  sent_count = 0;
+  NETSTACK_NETWORK.output(&peer);
+  take_sent_frames();
+}
+/*****************************************************************************/
+static void
+input_frame(const struct frame *f)
+{
+  packetbuf_clear();
+  packetbuf_copyfrom(f->data, f->len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &peer);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  NETSTACK_NETWORK.input();
+}
+/*****************************************************************************/
+/* Feeds the frames to the node, except the lost one */
+static void
+input_frames(int lost)
+{
+  for(int i = 0; i < received_count; i++) {
+    if(i != lost) {
+      input_frame(&received[i]);
+    }
+  }
+}
+/*****************************************************************************/
+static int
+is_fragment(const struct frame *f)
+{
+  return (f->data[0] & SICSLOWPAN_DISPATCH_RFRAG_MASK) == SICSLOWPAN_DISPATCH_RFRAG;
+}
+/*****************************************************************************/
+static int
+is_ack(const struct frame *f)
+{
+  return (f->data[0] & SICSLOWPAN_DISPATCH_RFRAG_MASK) == SICSLOWPAN_DISPATCH_RFRAG_ACK;
+}
+/*****************************************************************************/
+static int
+fragment_seq(const struct frame *f)
+{
+  return (f->data[2] >> 2) & 0x1f;
+}
+/*****************************************************************************/
+static int
+fragment_ack_request(const struct frame *f)
+{
+  return (f->data[2] & 0x80) != 0;
+}
+/*****************************************************************************/
+static uint32_t
+ack_bitmap(const struct frame *f)
+{
+  return ((uint32_t)f->data[2] << 24) | ((uint32_t)f->data[3] << 16) |
+    (f->data[4] << 8) | f->data[5];
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lost_fragment, "Lost fragment");
+UNIT_TEST(lost_fragment)
+{
+  const struct sicslowpan_frag_stats *stats = sicslowpan_get_frag_stats();
+  uint32_t retransmitted = stats->retransmitted;
+  int count;
+
+  UNIT_TEST_BEGIN();
+
+  create_fragments();
+  count = received_count;
+  printf("Datagram of %u bytes in %d fragments\n",
+         UIP_IPH_LEN + UIP_UDPH_LEN + TEST_PAYLOAD_LEN, count);
+  UNIT_TEST_ASSERT(count > 3);
+  for(int i = 0; i < count; i++) {
+    UNIT_TEST_ASSERT(is_fragment(&received[i]));
+    UNIT_TEST_ASSERT(fragment_seq(&received[i]) == i);
+    UNIT_TEST_ASSERT(fragment_ack_request(&received[i]) == (i == count - 1));
+    UNIT_TEST_ASSERT(linkaddr_cmp(&received[i].receiver, &peer));
+  }
+
+  /* The receiver asks for the missing fragment */
+  delivered = 0;
+  input_frames(2);
+  UNIT_TEST_ASSERT(delivered == 0);
+  UNIT_TEST_ASSERT(sent_count == 1);
+  UNIT_TEST_ASSERT(is_ack(&sent[0]));
+  UNIT_TEST_ASSERT(linkaddr_cmp(&sent[0].receiver, &peer));
+  for(int i = 0; i < count; i++) {
+    UNIT_TEST_ASSERT(((ack_bitmap(&sent[0]) & (0x80000000UL >> i)) == 0) == (i == 2));
+  }
+
+  /* Only the missing fragment is sent again */
+  take_sent_frames();
+  input_frames(-1);
+  UNIT_TEST_ASSERT(sent_count == 1);
+  UNIT_TEST_ASSERT(is_fragment(&sent[0]));
+  UNIT_TEST_ASSERT(fragment_seq(&sent[0]) == 2);
+  UNIT_TEST_ASSERT(fragment_ack_request(&sent[0]));
+  UNIT_TEST_ASSERT(stats->retransmitted == retransmitted + 1);
+
+  /* The datagram is complete */
+  take_sent_frames();
+  input_frames(-1);
+  UNIT_TEST_ASSERT(delivered == 1);
+  UNIT_TEST_ASSERT(delivered_ok);
+  UNIT_TEST_ASSERT(sent_count == 1);
+  UNIT_TEST_ASSERT(is_ack(&sent[0]));
+  UNIT_TEST_ASSERT(ack_bitmap(&sent[0]) == 0xffffffff);
+  printf("Frames sent with one lost fragment: %d instead of %d\n",
+         count + 1, 2 * count);
+
+  /* The sender is done */
+  take_sent_frames();
+  input_frames(-1);
+  UNIT_TEST_ASSERT(sent_count == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lost_first_fragment, "Lost first fragment");
+UNIT_TEST(lost_first_fragment)
+{
+  UNIT_TEST_BEGIN();
+
+  create_fragments();
+  delivered = 0;
+  input_frames(0);
+  UNIT_TEST_ASSERT(delivered == 0);
+  UNIT_TEST_ASSERT(sent_count == 1);
+  UNIT_TEST_ASSERT(is_ack(&sent[0]));
+  UNIT_TEST_ASSERT((ack_bitmap(&sent[0]) & 0x80000000UL) == 0);
+
+  take_sent_frames();
+  input_frames(-1);
+  UNIT_TEST_ASSERT(sent_count == 1);
+  UNIT_TEST_ASSERT(fragment_seq(&sent[0]) == 0);
+  UNIT_TEST_ASSERT(fragment_ack_request(&sent[0]));
+
+  /* The first fragment completes the datagram */
+  take_sent_frames();
+  input_frames(-1);
+  UNIT_TEST_ASSERT(delivered == 1);
+  UNIT_TEST_ASSERT(delivered_ok);
+  UNIT_TEST_ASSERT(sent_count == 1);
+  UNIT_TEST_ASSERT(ack_bitmap(&sent[0]) == 0xffffffff);
+
+  take_sent_frames();
+  input_frames(-1);
+  UNIT_TEST_ASSERT(sent_count == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lost_ack, "Lost acknowledgment");
+UNIT_TEST(lost_ack)
+{
+  UNIT_TEST_BEGIN();
+
+  create_fragments();
+  delivered = 0;
+  input_frames(-1);
+  UNIT_TEST_ASSERT(delivered == 1);
+  UNIT_TEST_ASSERT(sent_count == 1);
+  UNIT_TEST_ASSERT(ack_bitmap(&sent[0]) == 0xffffffff);
+  /* The acknowledgment is lost */
+  sent_count = 0;
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(ack_timeout, "Acknowledgment timeout");
+UNIT_TEST(ack_timeout)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The sender asks for an acknowledgment again, once if the test was
+     not delayed */
+  UNIT_TEST_ASSERT(sent_count >= 1);
+  sent_count = 1;
+  UNIT_TEST_ASSERT(is_fragment(&sent[0]));
+  UNIT_TEST_ASSERT(fragment_seq(&sent[0]) == received_count - 1);
+  UNIT_TEST_ASSERT(fragment_ack_request(&sent[0]));
+
+  /* The receiver acknowledges it without delivering the datagram again */
+  take_sent_frames();
+  input_frames(-1);
+  UNIT_TEST_ASSERT(delivered == 1);
+  UNIT_TEST_ASSERT(sent_count == 1);
+  UNIT_TEST_ASSERT(is_ack(&sent[0]));
+  UNIT_TEST_ASSERT(ack_bitmap(&sent[0]) == 0xffffffff);
+
+  take_sent_frames();
+  input_frames(-1);
+  UNIT_TEST_ASSERT(sent_count == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_sicslowpan_rfrag_process, ev, data)
+{
+  static uip_ipaddr_t addr;
+  static clock_time_t waited;
+
+  PROCESS_BEGIN();
+
+  simple_udp_register(&conn, TEST_PORT, NULL, TEST_PORT, udp_rx_callback);
+  set_destination(&addr);
+  uip_ds6_addr_add(&addr, 0, ADDR_MANUAL);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(lost_fragment);
+  UNIT_TEST_RUN(lost_first_fragment);
+  UNIT_TEST_RUN(lost_ack);
+
+  /* Wait for the acknowledgment timer of the sender */
+  for(waited = 0; sent_count == 0 && waited < 4 * SICSLOWPAN_CONF_RFRAG_ACK_TIMEOUT;
+      waited += CLOCK_SECOND / 32) {
+    etimer_set(&timer, CLOCK_SECOND / 32);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+  }
+
+  UNIT_TEST_RUN(ack_timeout);
+
+  if(!UNIT_TEST_PASSED(lost_fragment) ||
+     !UNIT_TEST_PASSED(lost_first_fragment) ||
+     !UNIT_TEST_PASSED(lost_ack) ||
+     !UNIT_TEST_PASSED(ack_timeout)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
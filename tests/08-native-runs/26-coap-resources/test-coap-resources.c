@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a benchmark for the resource lookup of the CoAP
+ *      engine. The test is built once with the linear scan of the
+ *      resource list and once with COAP_CONF_WITH_RESOURCE_HASH, so
+ *      that the timings can be compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of lookups of each URI path in the benchmark. */
+#ifdef TEST_CONF_ITERATIONS
+#define TEST_ITERATIONS TEST_CONF_ITERATIONS
+#else
+#define TEST_ITERATIONS 2000
+#endif
+
+#define NUM_DEVICES 32
+#define URL_LEN 24
+
+RESOURCE(res_hello, "title=\"Hello\"", NULL, NULL, NULL, NULL);
+RESOURCE(res_led, "title=\"LED\"", NULL, NULL, NULL, NULL);
+RESOURCE(res_moved, "title=\"Moved\"", NULL, NULL, NULL, NULL);
+PARENT_RESOURCE(res_sensors, "title=\"Sensors\"", NULL, NULL, NULL, NULL);
+PARENT_RESOURCE(res_temp, "title=\"Temperature\"", NULL, NULL, NULL, NULL);
+
+/* Resources of the benchmark: a value and a config resource per device */
+static coap_resource_t device_resources[2 * NUM_DEVICES];
+static char device_urls[2 * NUM_DEVICES][URL_LEN];
+static char sub_urls[NUM_DEVICES][URL_LEN + 8];
+/*****************************************************************************/
+PROCESS(test_coap_resources_process, "CoAP resources test process");
+AUTOSTART_PROCESSES(&test_coap_resources_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static coap_resource_t *
+find(const char *url)
+{
+  return coap_find_resource(url, strlen(url));
+}
+/*****************************************************************************/
+static int
+count_resources(void)
+{
+  coap_resource_t *resource;
+  int count = 0;
+
+  for(resource = coap_get_first_resource(); resource != NULL;
+      resource = coap_get_next_resource(resource)) {
+    count++;
+  }
+  return count;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lookup, "Resource lookup");
+UNIT_TEST(lookup)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The deeper parent first, so that the first match of the list is
+     also the longest one */
+  coap_activate_resource(&res_temp, "sensors/temp");
+  coap_activate_resource(&res_sensors, "sensors");
+  coap_activate_resource(&res_led, "actuators/led");
+  coap_activate_resource(&res_hello, "hello");
+  coap_activate_resource(&res_moved, "abc");
+
+  UNIT_TEST_ASSERT(find("hello") == &res_hello);
+  UNIT_TEST_ASSERT(find("hell") == NULL);
+  UNIT_TEST_ASSERT(find("hello!") == NULL);
+  UNIT_TEST_ASSERT(find("hello/world") == NULL);
+  UNIT_TEST_ASSERT(find("actuators/led") == &res_led);
+  UNIT_TEST_ASSERT(find("actuators") == NULL);
+  UNIT_TEST_ASSERT(find("") == NULL);
+
+  /* Sub-resources */
+  UNIT_TEST_ASSERT(find("sensors") == &res_sensors);
+  UNIT_TEST_ASSERT(find("sensors/hum") == &res_sensors);
+  UNIT_TEST_ASSERT(find("sensors/temp") == &res_temp);
+  UNIT_TEST_ASSERT(find("sensors/temp/max") == &res_temp);
+  UNIT_TEST_ASSERT(find("sensors/temperature") == &res_sensors);
+  UNIT_TEST_ASSERT(find("sensorsx") == NULL);
+
+  /* The URI path of a message is not null-terminated */
+  UNIT_TEST_ASSERT(coap_find_resource("hello/world", 5) == &res_hello);
+  UNIT_TEST_ASSERT(coap_find_resource("sensors/temp", 7) == &res_sensors);
+
+  /* Activating a resource again moves it to the new path */
+  coap_activate_resource(&res_moved, "zzz");
+  UNIT_TEST_ASSERT(find("abc") == NULL);
+  UNIT_TEST_ASSERT(find("zzz") == &res_moved);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(traversal, "Resource traversal");
+UNIT_TEST(traversal)
+{
+  UNIT_TEST_BEGIN();
+
+  coap_resource_t *resource;
+  const char *prev = NULL;
+  int unsorted = 0;
+
+  for(resource = coap_get_first_resource(); resource != NULL;
+      resource = coap_get_next_resource(resource)) {
+    if(prev != NULL && strcmp(prev, resource->url) >= 0) {
+      unsorted++;
+    }
+    prev = resource->url;
+  }
+  /* The resources of the test, and .well-known/core of the engine */
+  UNIT_TEST_ASSERT(count_resources() == 5 + COAP_WELL_KNOWN_RESOURCE_ENABLED);
+  /* With the hash table, the list is sorted by URI path */
+  UNIT_TEST_ASSERT(!COAP_WITH_RESOURCE_HASH || unsorted == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Lookup benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  unsigned failures = 0;
+  uint64_t start, elapsed;
+  int i, j;
+
+  printf("Resource hash: %s\n", COAP_WITH_RESOURCE_HASH ? "yes" : "no");
+
+  for(i = 0; i < NUM_DEVICES; i++) {
+    snprintf(device_urls[2 * i], URL_LEN, "devices/%d/value", i);
+    coap_activate_resource(&device_resources[2 * i], device_urls[2 * i]);
+    snprintf(device_urls[2 * i + 1], URL_LEN, "devices/%d/config", i);
+    device_resources[2 * i + 1].flags = HAS_SUB_RESOURCES;
+    coap_activate_resource(&device_resources[2 * i + 1],
+                           device_urls[2 * i + 1]);
+    snprintf(sub_urls[i], sizeof(sub_urls[i]), "%s/rate",
+             device_urls[2 * i + 1]);
+  }
+
+  /* Look up every resource, and a sub-resource of each config resource */
+  start = now_ns();
+  for(j = 0; j < TEST_ITERATIONS; j++) {
+    for(i = 0; i < 2 * NUM_DEVICES; i++) {
+      if(find(device_urls[i]) != &device_resources[i]) {
+        failures++;
+      }
+    }
+  }
+  elapsed = now_ns() - start;
+  printf("%d resources: %6.1f ns per lookup\n", count_resources(),
+         (double)elapsed / (TEST_ITERATIONS * 2 * NUM_DEVICES));
+
+  start = now_ns();
+  for(j = 0; j < TEST_ITERATIONS; j++) {
+    for(i = 0; i < NUM_DEVICES; i++) {
+      if(find(sub_urls[i]) != &device_resources[2 * i + 1]) {
+        failures++;
+      }
+    }
+  }
+  elapsed = now_ns() - start;
+  printf("%d resources: %6.1f ns per sub-resource lookup\n",
+         count_resources(),
+         (double)elapsed / (TEST_ITERATIONS * NUM_DEVICES));
+
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_coap_resources_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(lookup);
+  UNIT_TEST_RUN(traversal);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(lookup) ||
+     !UNIT_TEST_PASSED(traversal) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
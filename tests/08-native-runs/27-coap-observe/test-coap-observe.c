@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a benchmark for the notifications of CoAP
+ *      observe. Observers register with GET requests fed to the
+ *      engine, and the notifications that the engine sends are checked
+ *      for each observer. The test is built once with a handler call
+ *      and a transaction per observer and once with
+ *      COAP_CONF_WITH_OBSERVE_FANOUT, so that the timings can be compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uipbuf.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define NUM_OBSERVERS COAP_MAX_OBSERVERS
+/* Enough rounds for the Observe values to need two bytes */
+#define NUM_ROUNDS 300
+#define MAX_PACKETS (2 * NUM_OBSERVERS)
+#define OBSERVE_URL "test/obs"
+
+struct packet {
+  uip_ipaddr_t dest;
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+};
+
+/* The CoAP messages sent through the network driver */
+static struct packet sent[MAX_PACKETS];
+static int sent_count;
+
+static coap_endpoint_t endpoints[NUM_OBSERVERS];
+static uint8_t tokens[NUM_OBSERVERS][COAP_TOKEN_LEN];
+static uint32_t next_observe[NUM_OBSERVERS];
+
+static unsigned value;
+static unsigned handler_calls;
+/*****************************************************************************/
+static void
+network_init(void)
+{
+}
+/*****************************************************************************/
+static void
+network_input(void)
+{
+}
+/*****************************************************************************/
+static uint8_t
+network_output(const linkaddr_t *localdest)
+{
+  if(sent_count < MAX_PACKETS && uip_len > UIP_IPUDPH_LEN) {
+    struct packet *p = &sent[sent_count++];
+    uip_ipaddr_copy(&p->dest, &UIP_IP_BUF->destipaddr);
+    p->len = uip_len - UIP_IPUDPH_LEN;
+    memcpy(p->data, &uip_buf[UIP_IPUDPH_LEN], p->len);
+  }
+  uipbuf_clear();
+  return 1;
+}
+/*****************************************************************************/
+const struct network_driver test_network_driver = {
+  "test-network",
+  network_init,
+  network_input,
+  network_output
+};
+/*****************************************************************************/
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  handler_calls++;
+  coap_set_header_content_format(response, TEXT_PLAIN);
+  coap_set_payload(response, buffer,
+                   snprintf((char *)buffer, preferred_size, "value %u",
+                            value));
+}
+EVENT_RESOURCE(res_obs, "obs", res_get_handler, NULL, NULL, NULL, NULL);
+/*****************************************************************************/
+PROCESS(test_coap_observe_process, "CoAP observe test process");
+AUTOSTART_PROCESSES(&test_coap_observe_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static int
+observer_index(const uip_ipaddr_t *addr)
+{
+  for(int i = 0; i < NUM_OBSERVERS; i++) {
+    if(uip_ipaddr_cmp(addr, &endpoints[i].ipaddr)) {
+      return i;
+    }
+  }
+  return -1;
+}
+/*****************************************************************************/
+/* Checks that every observer got one notification with its token and
+   next Observe value, and acknowledges the confirmable ones */
+static int
+check_notifications(coap_status_t code)
+{
+  static coap_message_t message[1];
+  uint8_t seen[NUM_OBSERVERS];
+  uint16_t mids[MAX_PACKETS];
+  char payload[16];
+  int payload_len;
+  int i;
+
+  if(sent_count != NUM_OBSERVERS) {
+    return 0;
+  }
+
+  memset(seen, 0, sizeof(seen));
+  payload_len = snprintf(payload, sizeof(payload), "value %u", value);
+  for(int p = 0; p < sent_count; p++) {
+    i = observer_index(&sent[p].dest);
+    if(i < 0 || seen[i]
+       || coap_parse_message(message, sent[p].data, sent[p].len) != NO_ERROR
+       || message->code != code
+       || message->token_len != i % (COAP_TOKEN_LEN + 1)
+       || memcmp(message->token, tokens[i], message->token_len) != 0) {
+      return 0;
+    }
+    seen[i] = 1;
+
+    for(int q = 0; q < p; q++) {
+      if(mids[q] == message->mid) {
+        return 0;
+      }
+    }
+    mids[p] = message->mid;
+
+    if((message->type == COAP_TYPE_CON)
+       != (next_observe[i] % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
+      return 0;
+    }
+    if(message->type == COAP_TYPE_CON) {
+      /* Acknowledge */
+      coap_clear_transaction(coap_get_transaction_by_mid(message->mid));
+    }
+
+    if(code < BAD_REQUEST_4_00) {
+      if(!coap_is_option(message, COAP_OPTION_OBSERVE)
+         || message->observe != next_observe[i]
+         || message->payload_len != payload_len
+         || memcmp(message->payload, payload, payload_len) != 0) {
+        return 0;
+      }
+      next_observe[i]++;
+    } else if(coap_is_option(message, COAP_OPTION_OBSERVE)) {
+      return 0;
+    }
+  }
+  sent_count = 0;
+  return 1;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(registration, "Observer registration");
+UNIT_TEST(registration)
+{
+  UNIT_TEST_BEGIN();
+
+  static coap_message_t request[1];
+  static uint8_t buffer[COAP_MAX_PACKET_SIZE];
+  int len;
+
+  coap_activate_resource(&res_obs, OBSERVE_URL);
+
+  sent_count = 0;
+  for(int i = 0; i < NUM_OBSERVERS; i++) {
+    uip_ip6addr(&endpoints[i].ipaddr, 0xfe80, 0, 0, 0, 0xaaaa, 0, 0, i + 1);
+    endpoints[i].port = UIP_HTONS(COAP_DEFAULT_PORT);
+    /* Tokens of all lengths */
+    for(int j = 0; j < COAP_TOKEN_LEN; j++) {
+      tokens[i][j] = i * 16 + j;
+    }
+
+    coap_init_message(request, COAP_TYPE_CON, COAP_GET, i + 1);
+    coap_set_header_uri_path(request, OBSERVE_URL);
+    coap_set_header_observe(request, 0);
+    coap_set_token(request, tokens[i], i % (COAP_TOKEN_LEN + 1));
+    len = coap_serialize_message(request, buffer);
+    UNIT_TEST_ASSERT(len > 0);
+    UNIT_TEST_ASSERT(coap_receive(&endpoints[i], buffer, len) == NO_ERROR);
+    next_observe[i] = 1;
+  }
+  /* One response per request */
+  UNIT_TEST_ASSERT(sent_count == NUM_OBSERVERS);
+  UNIT_TEST_ASSERT(coap_has_observers(OBSERVE_URL));
+
+  sent_count = 0;
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(notification, "Notifications");
+UNIT_TEST(notification)
+{
+  UNIT_TEST_BEGIN();
+
+  int failures = 0;
+
+  handler_calls = 0;
+  for(value = 0; value < NUM_ROUNDS; value++) {
+    coap_notify_observers(&res_obs);
+    if(!check_notifications(CONTENT_2_05)) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+  UNIT_TEST_ASSERT(next_observe[0] > 0xff);
+  UNIT_TEST_ASSERT(handler_calls ==
+                   NUM_ROUNDS * (COAP_WITH_OBSERVE_FANOUT ? 1 : NUM_OBSERVERS));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(notification_by_url, "Notifications by URL");
+UNIT_TEST(notification_by_url)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Without a resource, there is no handler for the notification */
+  coap_notify_observers_sub(NULL, OBSERVE_URL);
+  UNIT_TEST_ASSERT(check_notifications(BAD_REQUEST_4_00));
+
+  coap_notify_observers_sub(NULL, "test/other");
+  UNIT_TEST_ASSERT(sent_count == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Notification benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  uint64_t start, elapsed = 0;
+  int failures = 0;
+
+  printf("Observe fan-out: %s\n", COAP_WITH_OBSERVE_FANOUT ? "yes" : "no");
+
+  handler_calls = 0;
+  for(value = 0; value < NUM_ROUNDS; value++) {
+    start = now_ns();
+    coap_notify_observers(&res_obs);
+    elapsed += now_ns() - start;
+    if(!check_notifications(CONTENT_2_05)) {
+      failures++;
+    }
+  }
+  printf("%d observers: %6.1f us and %u handler calls per notification\n",
+         NUM_OBSERVERS, (double)elapsed / NUM_ROUNDS / 1000,
+         handler_calls / NUM_ROUNDS);
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(deregistration, "Observer deregistration");
+UNIT_TEST(deregistration)
+{
+  UNIT_TEST_BEGIN();
+
+  static coap_message_t message[1];
+  int failures = 0;
+  int i;
+
+  /* Every other observer goes away */
+  for(i = 0; i < NUM_OBSERVERS; i += 2) {
+    UNIT_TEST_ASSERT(coap_remove_observer_by_client(&endpoints[i]) == 1);
+  }
+
+  coap_notify_observers(&res_obs);
+  UNIT_TEST_ASSERT(sent_count == NUM_OBSERVERS / 2);
+  for(int p = 0; p < sent_count; p++) {
+    i = observer_index(&sent[p].dest);
+    if(i < 0 || i % 2 == 0
+       || coap_parse_message(message, sent[p].data, sent[p].len) != NO_ERROR) {
+      failures++;
+    } else if(message->type == COAP_TYPE_CON) {
+      coap_clear_transaction(coap_get_transaction_by_mid(message->mid));
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+  sent_count = 0;
+
+  for(i = 1; i < NUM_OBSERVERS; i += 2) {
+    UNIT_TEST_ASSERT(coap_remove_observer_by_client(&endpoints[i]) == 1);
+  }
+  coap_notify_observers(&res_obs);
+  UNIT_TEST_ASSERT(sent_count == 0);
+  UNIT_TEST_ASSERT(!coap_has_observers(OBSERVE_URL));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_coap_observe_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(registration);
+  UNIT_TEST_RUN(notification);
+  UNIT_TEST_RUN(notification_by_url);
+  UNIT_TEST_RUN(benchmark);
+  UNIT_TEST_RUN(deregistration);
+
+  if(!UNIT_TEST_PASSED(registration) ||
+     !UNIT_TEST_PASSED(notification) ||
+     !UNIT_TEST_PASSED(notification_by_url) ||
+     !UNIT_TEST_PASSED(benchmark) ||
+     !UNIT_TEST_PASSED(deregistration)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
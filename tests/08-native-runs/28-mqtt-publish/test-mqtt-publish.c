@@ -0,0 +1,454 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *      Unit tests and a benchmark for MQTT publishes. A stand-in for a
+ *      broker listens on a TCP socket of the node itself, so that the
+ *      client reaches it through the loopback of uIP. The test is built
+ *      once with the default publish path and once with
+ *      MQTT_CONF_WITH_STREAMING, where large payloads are published
+ *      from fragments, so that the rates can be compared.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "mqtt.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uiplib.h"
+#include "net/ipv6/uipbuf.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define BROKER_PORT 1883
+#define MAX_SEGMENT_SIZE 1024
+#define TOPIC "test/publish"
+
+#define SMALL_PAYLOAD_SIZE 32
+#define SMALL_COUNT 2000
+#define ACKED_COUNT 50
+#define LARGE_PAYLOAD_SIZE 4000
+#define LARGE_COUNT 200
+#define RUN_TIMEOUT (10 * CLOCK_SECOND)
+
+#define WAIT_UNTIL(cond)                                         \
+  while(!(cond) && !clock_expired(deadline)) {                   \
+    PROCESS_PAUSE();                                             \
+  }
+
+/* The stand-in for the broker parses the MQTT packets of the stream */
+enum {
+  BROKER_FIXED_HEADER,
+  BROKER_REMAINING_LENGTH,
+  BROKER_BODY,
+};
+
+static struct tcp_socket broker_socket;
+static uint8_t broker_inbuf[128];
+static uint8_t broker_outbuf[128];
+static uint8_t broker_state;
+static uint8_t packet_type;
+static uint32_t remaining_length;
+static uint32_t length_multiplier;
+static uint32_t body_pos;
+static uint32_t payload_pos;
+/* The start of a PUBLISH body: topic and message ID */
+static uint8_t body_head[2 + sizeof(TOPIC) + 2];
+
+static unsigned connects;
+static unsigned publishes;
+static unsigned bad_publishes;
+static unsigned pubacks;
+
+static struct mqtt_connection conn;
+static char broker_host[UIPLIB_IPV6_MAX_STR_LEN];
+static uint8_t payload[LARGE_PAYLOAD_SIZE];
+static unsigned expected_payload_size;
+static mqtt_qos_level_t expected_qos;
+
+static int connected;
+static uint64_t small_ns;
+static uint64_t large_ns;
+static unsigned small_publishes;
+static unsigned acked_publishes;
+static unsigned large_publishes;
+/*****************************************************************************/
+static void
+network_init(void)
+{
+}
+/*****************************************************************************/
+static void
+network_input(void)
+{
+}
+/*****************************************************************************/
+static uint8_t
+network_output(const linkaddr_t *localdest)
+{
+  uipbuf_clear();
+  return 1;
+}
+/*****************************************************************************/
+const struct network_driver test_network_driver = {
+  "test-network",
+  network_init,
+  network_input,
+  network_output
+};
+/*****************************************************************************/
+PROCESS(test_mqtt_publish_process, "MQTT publish test process");
+AUTOSTART_PROCESSES(&test_mqtt_publish_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static int
+clock_expired(clock_time_t deadline)
+{
+  return (clock_time_t)(clock_time() - deadline) < (CLOCK_SECOND * 3600);
+}
+/*****************************************************************************/
+static uint8_t
+payload_byte(uint32_t pos)
+{
+  return (uint8_t)(pos * 13 + 1);
+}
+/*****************************************************************************/
+static void
+broker_send(uint8_t type, uint8_t b1, uint8_t b2)
+{
+  uint8_t packet[4] = { type, 2, b1, b2 };
+
+  tcp_socket_send(&broker_socket, packet, sizeof(packet));
+}
+/*****************************************************************************/
+static void
+broker_packet(void)
+{
+  uint32_t payload_offset;
+
+  switch(packet_type & 0xf0) {
+  case MQTT_FHDR_MSG_TYPE_CONNECT:
+    connects++;
+    broker_send(MQTT_FHDR_MSG_TYPE_CONNACK, 0, 0);
+    break;
+  case MQTT_FHDR_MSG_TYPE_PUBLISH:
+    payload_offset = 2 + strlen(TOPIC) + (expected_qos > 0 ? 2 : 0);
+    if(body_head[0] != 0 || body_head[1] != strlen(TOPIC)
+       || memcmp(&body_head[2], TOPIC, strlen(TOPIC)) != 0
+       || ((packet_type >> 1) & 0x03) != expected_qos
+       || remaining_length != payload_offset + expected_payload_size
+       || payload_pos != expected_payload_size) {
+      bad_publishes++;
+    }
+    publishes++;
+    if(expected_qos > 0) {
+      broker_send(MQTT_FHDR_MSG_TYPE_PUBACK,
+                  body_head[payload_offset - 2], body_head[payload_offset - 1]);
+    }
+    break;
+  case MQTT_FHDR_MSG_TYPE_PINGREQ:
+    broker_send(MQTT_FHDR_MSG_TYPE_PINGRESP, 0, 0);
+    break;
+  }
+}
+/*****************************************************************************/
+static void
+broker_body_byte(uint8_t byte)
+{
+  uint32_t payload_offset = 2 + strlen(TOPIC) + (expected_qos > 0 ? 2 : 0);
+
+  if(body_pos < sizeof(body_head)) {
+    body_head[body_pos] = byte;
+  }
+  if((packet_type & 0xf0) == MQTT_FHDR_MSG_TYPE_PUBLISH
+     && body_pos >= payload_offset) {
+    if(byte != payload_byte(payload_pos)) {
+      bad_publishes++;
+    }
+    payload_pos++;
+  }
+  body_pos++;
+}
+/*****************************************************************************/
+static int
+broker_input(struct tcp_socket *s, void *ptr,
+             const uint8_t *input_data_ptr, int input_data_len)
+{
+  for(int i = 0; i < input_data_len; i++) {
+    uint8_t byte = input_data_ptr[i];
+
+    switch(broker_state) {
+    case BROKER_FIXED_HEADER:
+      packet_type = byte;
+      remaining_length = 0;
+      length_multiplier = 1;
+      broker_state = BROKER_REMAINING_LENGTH;
+      break;
+    case BROKER_REMAINING_LENGTH:
+      remaining_length += (byte & 0x7f) * length_multiplier;
+      length_multiplier <<= 7;
+      if(byte & 0x80) {
+        break;
+      }
+      body_pos = 0;
+      payload_pos = 0;
+      if(remaining_length > 0) {
+        broker_state = BROKER_BODY;
+        break;
+      }
+      broker_packet();
+      broker_state = BROKER_FIXED_HEADER;
+      break;
+    case BROKER_BODY:
+      broker_body_byte(byte);
+      if(body_pos == remaining_length) {
+        broker_packet();
+        broker_state = BROKER_FIXED_HEADER;
+      }
+      break;
+    }
+  }
+  return 0;
+}
+/*****************************************************************************/
+static void
+broker_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CONNECTED) {
+    broker_state = BROKER_FIXED_HEADER;
+  }
+}
+/*****************************************************************************/
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+  switch(event) {
+  case MQTT_EVENT_CONNECTED:
+    connected = 1;
+    break;
+  case MQTT_EVENT_PUBACK:
+    pubacks++;
+    break;
+  default:
+    break;
+  }
+}
+/*****************************************************************************/
+static mqtt_status_t
+publish(uint32_t payload_size, mqtt_qos_level_t qos)
+{
+  return mqtt_publish(&conn, NULL, TOPIC, payload, payload_size, qos,
+#if MQTT_5
+                      MQTT_RETAIN_OFF, 0, MQTT_TOPIC_ALIAS_OFF, NULL);
+#else
+                      MQTT_RETAIN_OFF);
+#endif
+}
+/*****************************************************************************/
+static mqtt_status_t
+publish_large(void)
+{
+#if MQTT_WITH_STREAMING
+  /* Fragments of uneven sizes, each larger than the output buffer */
+  static const struct tcp_socket_frag frags[] = {
+    { &payload[0], 700 },
+    { &payload[700], 1500 },
+    { &payload[2200], LARGE_PAYLOAD_SIZE - 2200 },
+  };
+
+  return mqtt_publish_frags(&conn, NULL, TOPIC, frags,
+                            sizeof(frags) / sizeof(frags[0]),
+                            MQTT_QOS_LEVEL_0,
+#if MQTT_5
+                            MQTT_RETAIN_OFF, 0, MQTT_TOPIC_ALIAS_OFF, NULL);
+#else
+                            MQTT_RETAIN_OFF);
+#endif
+#else /* MQTT_WITH_STREAMING */
+  return publish(LARGE_PAYLOAD_SIZE, MQTT_QOS_LEVEL_0);
+#endif /* MQTT_WITH_STREAMING */
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(connection, "Connection to the broker");
+UNIT_TEST(connection)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(connected);
+  UNIT_TEST_ASSERT(connects == 1);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(publish_small, "QoS 0 publishes of small payloads");
+UNIT_TEST(publish_small)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("Streaming: %s\n", MQTT_WITH_STREAMING ? "yes" : "no");
+  printf("%u publishes of %u bytes: %8.0f messages/s\n",
+         SMALL_COUNT, SMALL_PAYLOAD_SIZE,
+         SMALL_COUNT * 1e9 / small_ns);
+  UNIT_TEST_ASSERT(small_publishes == SMALL_COUNT);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(publish_acked, "QoS 1 publishes");
+UNIT_TEST(publish_acked)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(acked_publishes == ACKED_COUNT);
+  UNIT_TEST_ASSERT(pubacks == ACKED_COUNT);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(publish_large, "QoS 0 publishes of large payloads");
+UNIT_TEST(publish_large)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("%u publishes of %u bytes: %8.0f messages/s\n",
+         LARGE_COUNT, LARGE_PAYLOAD_SIZE,
+         LARGE_COUNT * 1e9 / large_ns);
+  UNIT_TEST_ASSERT(large_publishes == LARGE_COUNT);
+  UNIT_TEST_ASSERT(bad_publishes == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_mqtt_publish_process, ev, data)
+{
+  static clock_time_t deadline;
+  static uint64_t start;
+  static unsigned first, i;
+
+  PROCESS_BEGIN();
+
+  for(i = 0; i < LARGE_PAYLOAD_SIZE; i++) {
+    payload[i] = payload_byte(i);
+  }
+
+  tcp_socket_register(&broker_socket, NULL,
+                      broker_inbuf, sizeof(broker_inbuf),
+                      broker_outbuf, sizeof(broker_outbuf),
+                      broker_input, broker_event);
+  tcp_socket_listen(&broker_socket, BROKER_PORT);
+
+  uiplib_ipaddr_snprint(broker_host, sizeof(broker_host),
+                        &uip_ds6_get_link_local(-1)->ipaddr);
+  mqtt_register(&conn, PROCESS_CURRENT(), "test-client", mqtt_event,
+                MAX_SEGMENT_SIZE);
+  deadline = clock_time() + RUN_TIMEOUT;
+  mqtt_connect(&conn, broker_host, BROKER_PORT, 60,
+#if MQTT_5
+               1, NULL);
+#else
+               1);
+#endif
+  WAIT_UNTIL(connected && mqtt_ready(&conn));
+
+  /* QoS 0 publishes of small payloads */
+  expected_qos = MQTT_QOS_LEVEL_0;
+  expected_payload_size = SMALL_PAYLOAD_SIZE;
+  deadline = clock_time() + RUN_TIMEOUT;
+  first = publishes;
+  start = now_ns();
+  for(i = 0; i < SMALL_COUNT; i++) {
+    WAIT_UNTIL(mqtt_ready(&conn));
+    publish(SMALL_PAYLOAD_SIZE, MQTT_QOS_LEVEL_0);
+  }
+  WAIT_UNTIL(publishes - first == SMALL_COUNT);
+  small_ns = now_ns() - start;
+  small_publishes = publishes - first;
+
+  /* QoS 1 publishes, each waiting for its PUBACK */
+  WAIT_UNTIL(mqtt_ready(&conn) && conn.out_buffer_sent);
+  expected_qos = MQTT_QOS_LEVEL_1;
+  deadline = clock_time() + RUN_TIMEOUT;
+  first = publishes;
+  for(i = 0; i < ACKED_COUNT; i++) {
+    WAIT_UNTIL(mqtt_ready(&conn));
+    publish(SMALL_PAYLOAD_SIZE, MQTT_QOS_LEVEL_1);
+  }
+  WAIT_UNTIL(mqtt_ready(&conn));
+  acked_publishes = publishes - first;
+
+  /* QoS 0 publishes of payloads larger than the output buffer */
+  WAIT_UNTIL(conn.out_buffer_sent);
+  expected_qos = MQTT_QOS_LEVEL_0;
+  expected_payload_size = LARGE_PAYLOAD_SIZE;
+  deadline = clock_time() + RUN_TIMEOUT;
+  first = publishes;
+  start = now_ns();
+  for(i = 0; i < LARGE_COUNT; i++) {
+    WAIT_UNTIL(mqtt_ready(&conn));
+    publish_large();
+  }
+  WAIT_UNTIL(publishes - first == LARGE_COUNT);
+  large_ns = now_ns() - start;
+  large_publishes = publishes - first;
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(connection);
+  UNIT_TEST_RUN(publish_small);
+  UNIT_TEST_RUN(publish_acked);
+  UNIT_TEST_RUN(publish_large);
+
+  if(!UNIT_TEST_PASSED(connection) ||
+     !UNIT_TEST_PASSED(publish_small) ||
+     !UNIT_TEST_PASSED(publish_acked) ||
+     !UNIT_TEST_PASSED(publish_large)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
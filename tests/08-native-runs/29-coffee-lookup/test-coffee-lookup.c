@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *      Unit tests and a benchmark for file lookups in Coffee. The test
+ *      is built without and with COFFEE_DIR_CACHE_SIZE, so that the
+ *      rates of opens can be compared for different numbers of files.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Files of a single page, so that many files fit */
+#define FILE_SIZE 64
+#define MAX_FILES 1024
+#define BENCHMARK_OPENS 5000
+/*****************************************************************************/
+PROCESS(test_coffee_lookup_process, "Coffee lookup test process");
+AUTOSTART_PROCESSES(&test_coffee_lookup_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static const char *
+file_name(unsigned i)
+{
+  static char name[8];
+
+  snprintf(name, sizeof(name), "f%u", i);
+  return name;
+}
+/*****************************************************************************/
+static int
+create_files(unsigned count)
+{
+  for(unsigned i = 0; i < count; i++) {
+    if(cfs_coffee_reserve(file_name(i), FILE_SIZE) < 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*****************************************************************************/
+/* The content of a file is its name, since Coffee finds the end of a
+   file at its last non-zero byte */
+static int
+write_file(unsigned i, const char *prefix)
+{
+  char content[16];
+  int fd, len;
+
+  fd = cfs_open(file_name(i), CFS_WRITE);
+  if(fd < 0) {
+    return 0;
+  }
+  len = snprintf(content, sizeof(content), "%s%s", prefix, file_name(i));
+  len = cfs_write(fd, content, len) == len;
+  cfs_close(fd);
+  return len;
+}
+/*****************************************************************************/
+static int
+check_file(unsigned i, const char *prefix)
+{
+  char expected[16], content[16];
+  int fd, len;
+
+  fd = cfs_open(file_name(i), CFS_READ);
+  if(fd < 0) {
+    return 0;
+  }
+  len = snprintf(expected, sizeof(expected), "%s%s", prefix, file_name(i));
+  len = cfs_read(fd, content, sizeof(content)) == len
+    && memcmp(content, expected, len) == 0;
+  cfs_close(fd);
+  return len;
+}
+/*****************************************************************************/
+static int
+file_exists(unsigned i)
+{
+  int fd;
+
+  fd = cfs_open(file_name(i), CFS_READ);
+  if(fd < 0) {
+    return 0;
+  }
+  cfs_close(fd);
+  return 1;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(lookup, "File lookup");
+UNIT_TEST(lookup)
+{
+  UNIT_TEST_BEGIN();
+
+  unsigned i, failures = 0;
+
+  UNIT_TEST_ASSERT(cfs_coffee_format() == 0);
+  UNIT_TEST_ASSERT(create_files(MAX_FILES));
+  for(i = 0; i < MAX_FILES; i++) {
+    if(!write_file(i, "")) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  /* Existing files cannot be reserved again */
+  UNIT_TEST_ASSERT(cfs_coffee_reserve(file_name(0), FILE_SIZE) < 0);
+  UNIT_TEST_ASSERT(cfs_coffee_reserve(file_name(MAX_FILES - 1),
+                                      FILE_SIZE) < 0);
+  UNIT_TEST_ASSERT(!file_exists(MAX_FILES));
+
+  for(i = 0; i < MAX_FILES; i++) {
+    if(!check_file(i, "")) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(removal, "File removal");
+UNIT_TEST(removal)
+{
+  UNIT_TEST_BEGIN();
+
+  unsigned i, failures = 0;
+
+  /* Remove every other file */
+  for(i = 0; i < MAX_FILES; i += 2) {
+    if(cfs_remove(file_name(i)) < 0) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+  UNIT_TEST_ASSERT(cfs_remove(file_name(0)) < 0);
+
+  for(i = 0; i < MAX_FILES; i++) {
+    if(i % 2 == 0 ? file_exists(i) : !check_file(i, "")) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  /* Create the removed files again, with new contents */
+  for(i = 0; i < MAX_FILES; i += 2) {
+    if(cfs_coffee_reserve(file_name(i), FILE_SIZE) < 0
+       || !write_file(i, "new ")) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  for(i = 0; i < MAX_FILES; i++) {
+    if(!check_file(i, i % 2 == 0 ? "new " : "")) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Lookup benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  static const unsigned file_counts[] = { 16, 64, 256, MAX_FILES };
+  uint64_t start, elapsed;
+  unsigned count, i, j, failures = 0;
+  int fd;
+
+  printf("Directory cache size: %u\n", COFFEE_DIR_CACHE_SIZE);
+
+  for(i = 0; i < sizeof(file_counts) / sizeof(file_counts[0]); i++) {
+    count = file_counts[i];
+    UNIT_TEST_ASSERT(cfs_coffee_format() == 0);
+    UNIT_TEST_ASSERT(create_files(count));
+
+    start = now_ns();
+    for(j = 0; j < BENCHMARK_OPENS; j++) {
+      /* Spread the opens over all files */
+      fd = cfs_open(file_name((j * 7919) % count), CFS_READ);
+      if(fd < 0) {
+        failures++;
+      }
+      cfs_close(fd);
+    }
+    elapsed = now_ns() - start;
+
+    printf("%4u files: %9.0f opens/s\n", count,
+           BENCHMARK_OPENS * 1e9 / elapsed);
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_coffee_lookup_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(lookup);
+  UNIT_TEST_RUN(removal);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(lookup) ||
+     !UNIT_TEST_PASSED(removal) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Send throughput benchmark for uIP TCP. A host socket in the
+ *      same process connects through the tun device to a listening
+ *      TCP socket on the node, which then sends a stream of data that
+ *      is received by the Linux TCP stack. The test is built once with
+ *      a stop-and-wait window and once with UIP_CONF_TCP_SEND_WINDOW.
+ *      The host also sends a few bytes meanwhile, and the segments of
+ *      the node are captured on the tun device to check that its pure
+ *      ACKs follow the data that it has sent.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <net/ethernet.h>
+#include <netpacket/packet.h>
+
+#include "contiki.h"
+#include "net/ipv6/tcp-socket.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Number of bytes in the benchmark. */
+#ifdef TEST_CONF_BYTES
+#define TEST_BYTES TEST_CONF_BYTES
+#else
+#define TEST_BYTES (256UL * 1024)
+#endif
+
+#define TEST_PORT 5679
+
+/* The addresses of the host and the node at the ends of the tun device. */
+#define TEST_HOST_ADDR "fd00::1"
+#define TEST_NODE_ADDR "fd00::302:304:506:708"
+
+static struct tcp_socket sock;
+static uint8_t inbuf[64];
+static uint8_t outbuf[2 * UIP_TCP_MSS];
+static unsigned long queued;
+static unsigned long received;
+static unsigned long corrupt;
+static uint64_t start;
+static uint64_t elapsed;
+
+/* The segments sent by the node, as captured on the tun device. */
+static uint32_t last_end;
+static int have_last_end;
+static unsigned long pure_acks;
+static unsigned long stale_acks;
+/*****************************************************************************/
+PROCESS(test_tcp_throughput_process, "TCP throughput test process");
+AUTOSTART_PROCESSES(&test_tcp_throughput_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+/* The byte at each offset of the stream is derived from the offset. */
+static uint8_t
+stream_byte(unsigned long offset)
+{
+  return (uint8_t)(offset * 7 + (offset >> 8));
+}
+/*****************************************************************************/
+static uint32_t
+get32(const uint8_t *p)
+{
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | p[2] << 8 | p[3];
+}
+/*****************************************************************************/
+/* Check that the sequence number of every pure ACK of the node is not
+   behind the end of the last segment that carried data. */
+static void
+check_segments(int cap)
+{
+  uint8_t pkt[1500];
+  const uint8_t *tcp;
+  uint32_t seq, end;
+  uint8_t flags;
+  int len, hdr_len, data_len;
+
+  while((len = recv(cap, pkt, sizeof(pkt), 0)) > 0) {
+    if(len < 40 + 20 || (pkt[0] >> 4) != 6 || pkt[6] != IPPROTO_TCP) {
+      continue;
+    }
+    tcp = pkt + 40;
+    if(((tcp[0] << 8) | tcp[1]) != TEST_PORT) {
+      /* Sent by the host. */
+      continue;
+    }
+    seq = get32(tcp + 4);
+    flags = tcp[13];
+    hdr_len = (tcp[12] >> 4) * 4;
+    data_len = ((pkt[4] << 8) | pkt[5]) - hdr_len;
+
+    if(data_len == 0 && flags == 0x10) {
+      pure_acks++;
+      if(have_last_end && (int32_t)(seq - last_end) < 0) {
+        stale_acks++;
+      }
+    }
+    end = seq + data_len + ((flags & 0x03) ? 1 : 0);
+    if(end != seq) {
+      last_end = end;
+      have_last_end = 1;
+    }
+  }
+}
+/*****************************************************************************/
+static void
+fill(struct tcp_socket *s)
+{
+  static uint8_t chunk[128];
+  int len, i;
+
+  while(queued < TEST_BYTES) {
+    len = MIN(sizeof(chunk), TEST_BYTES - queued);
+    len = MIN(len, tcp_socket_max_sendlen(s));
+    if(len <= 0) {
+      break;
+    }
+    for(i = 0; i < len; i++) {
+      chunk[i] = stream_byte(queued + i);
+    }
+    queued += tcp_socket_send(s, chunk, len);
+  }
+}
+/*****************************************************************************/
+static int
+input(struct tcp_socket *s, void *ptr, const uint8_t *data, int len)
+{
+  return 0;
+}
+/*****************************************************************************/
+static void
+event(struct tcp_socket *s, void *ptr, tcp_socket_event_t ev)
+{
+  if(ev == TCP_SOCKET_CONNECTED) {
+    /* Start the clock when the node has accepted the connection. */
+    start = now_ns();
+  }
+  if(ev == TCP_SOCKET_CONNECTED || ev == TCP_SOCKET_DATA_SENT) {
+    fill(s);
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(throughput, "Send throughput");
+UNIT_TEST(throughput)
+{
+  UNIT_TEST_BEGIN();
+
+  printf("Send window: %u segments of %u bytes\n",
+         UIP_TCP_SEND_WINDOW, UIP_TCP_MSS);
+  printf("Received %lu of %lu bytes in %.1f ms: %.0f bytes/s\n",
+         received, (unsigned long)TEST_BYTES, elapsed / 1e6,
+         received / (elapsed / 1e9));
+
+  printf("Pure ACKs from the node: %lu, behind the data sent: %lu\n",
+         pure_acks, stale_acks);
+
+  UNIT_TEST_ASSERT(received == TEST_BYTES);
+  UNIT_TEST_ASSERT(corrupt == 0);
+  UNIT_TEST_ASSERT(stale_acks == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_tcp_throughput_process, ev, data)
+{
+  static struct etimer et;
+  static struct sockaddr_in6 addr;
+  static struct sockaddr_ll sll;
+  static uint8_t buf[4096];
+  static uint64_t deadline;
+  static unsigned long next_write;
+  static int fd;
+  static int cap;
+  int i, r;
+
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  tcp_socket_register(&sock, NULL, inbuf, sizeof(inbuf),
+                      outbuf, sizeof(outbuf), input, event);
+  tcp_socket_listen(&sock, TEST_PORT);
+
+  fd = socket(AF_INET6, SOCK_STREAM, 0);
+  /* Route through the tun device even if another host interface is on
+     the same prefix. */
+  setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, "tun0", strlen("tun0"));
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin6_family = AF_INET6;
+  inet_pton(AF_INET6, TEST_HOST_ADDR, &addr.sin6_addr);
+  /* The host address on the tun device may still be tentative. */
+  i = 1;
+  setsockopt(fd, SOL_IPV6, IPV6_FREEBIND, &i, sizeof(i));
+  if(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    printf("bind: %s\n", strerror(errno));
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sin6_family = AF_INET6;
+  addr.sin6_port = htons(TEST_PORT);
+  inet_pton(AF_INET6, TEST_NODE_ADDR, &addr.sin6_addr);
+
+  /* Capture the packets on the tun device. */
+  cap = socket(AF_PACKET, SOCK_DGRAM | SOCK_NONBLOCK, htons(ETH_P_IPV6));
+  memset(&sll, 0, sizeof(sll));
+  sll.sll_family = AF_PACKET;
+  sll.sll_protocol = htons(ETH_P_IPV6);
+  sll.sll_ifindex = if_nametoindex("tun0");
+  if(bind(cap, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+    printf("capture: %s\n", strerror(errno));
+  }
+
+  /* Give the host time to bring up the interface. */
+  etimer_set(&et, 3 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  if(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 &&
+     errno != EINPROGRESS) {
+    printf("connect: %s\n", strerror(errno));
+  }
+
+  start = now_ns();
+  deadline = start + 60ULL * 1000000000;
+  while(received < TEST_BYTES && now_ns() < deadline) {
+    while((r = read(fd, buf, sizeof(buf))) > 0) {
+      for(i = 0; i < r; i++) {
+        if(buf[i] != stream_byte(received + i)) {
+          corrupt++;
+        }
+      }
+      received += r;
+    }
+    /* Make the node acknowledge data while its segments are in flight. */
+    if(received >= next_write) {
+      if(write(fd, "x", 1) == 1) {
+        next_write = received + 4096;
+      }
+    }
+    check_segments(cap);
+    /* Let the main loop run the stack. */
+    PROCESS_PAUSE();
+  }
+  elapsed = now_ns() - start;
+  check_segments(cap);
+
+  tcp_socket_close(&sock);
+  close(fd);
+  close(cap);
+
+  UNIT_TEST_RUN(throughput);
+
+  if(!UNIT_TEST_PASSED(throughput)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a benchmark for the Internet checksum routines.
+ *      The test is built with both word sizes, and the results are
+ *      compared with a reference that sums the data a byte pair at a
+ *      time, as uIP used to.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip-chksum.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define MAX_LEN 300
+#define MAX_OFFSET 8
+#define BENCHMARK_LEN 1280
+#define BENCHMARK_ROUNDS 20000
+/*****************************************************************************/
+PROCESS(test_chksum_process, "Checksum test process");
+AUTOSTART_PROCESSES(&test_chksum_process);
+/*****************************************************************************/
+static uint8_t src[MAX_LEN + MAX_OFFSET];
+static uint8_t dst[MAX_LEN + MAX_OFFSET];
+static uint8_t bench_src[BENCHMARK_LEN];
+static uint8_t bench_dst[BENCHMARK_LEN];
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static uint64_t
+now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  return 0;
+#endif
+}
+/*****************************************************************************/
+static void
+fill_random(uint8_t *data, uint16_t len)
+{
+  for(uint16_t i = 0; i < len; i++) {
+    data[i] = rand();
+  }
+}
+/*****************************************************************************/
+/* The checksum that uip6.c computed before the word-at-a-time routine */
+static uint16_t
+reference_chksum(uint16_t sum, const uint8_t *data, uint16_t len)
+{
+  uint16_t t;
+  const uint8_t *dataptr;
+  const uint8_t *last_byte;
+
+  dataptr = data;
+  last_byte = data + len - 1;
+
+  while(dataptr < last_byte) {
+    t = (dataptr[0] << 8) + dataptr[1];
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+    dataptr += 2;
+  }
+
+  if(dataptr == last_byte) {
+    t = (dataptr[0] << 8) + 0;
+    sum += t;
+    if(sum < t) {
+      sum++;
+    }
+  }
+
+  return sum;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(add, "Checksum of data");
+UNIT_TEST(add)
+{
+  UNIT_TEST_BEGIN();
+
+  unsigned offset, len, failures = 0;
+  uint16_t initial;
+
+  fill_random(src, sizeof(src));
+
+  for(offset = 0; offset < MAX_OFFSET; offset++) {
+    for(len = 0; len <= MAX_LEN; len++) {
+      initial = rand();
+      if(uip_chksum_add(initial, &src[offset], len)
+         != reference_chksum(initial, &src[offset], len)) {
+        failures++;
+      }
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  /* A sum can be continued at any even offset */
+  len = uip_chksum_add(0, src, 14);
+  UNIT_TEST_ASSERT(uip_chksum_add(len, &src[14], 99)
+                   == reference_chksum(0, src, 14 + 99));
+
+  /* Sums that carry many times */
+  memset(src, 0xff, sizeof(src));
+  UNIT_TEST_ASSERT(uip_chksum_add(0xffff, src, MAX_LEN)
+                   == reference_chksum(0xffff, src, MAX_LEN));
+  src[0] = 0xfe;
+  UNIT_TEST_ASSERT(uip_chksum_add(1, src, MAX_LEN - 1)
+                   == reference_chksum(1, src, MAX_LEN - 1));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(copy, "Copy and checksum");
+UNIT_TEST(copy)
+{
+  UNIT_TEST_BEGIN();
+
+  unsigned offset, len, failures = 0;
+  uint16_t initial;
+
+  fill_random(src, sizeof(src));
+
+  for(offset = 0; offset < MAX_OFFSET; offset++) {
+    for(len = 0; len <= MAX_LEN; len++) {
+      initial = rand();
+      memset(dst, 0, sizeof(dst));
+      /* Copy between differently aligned buffers */
+      if(uip_chksum_copy(initial, &dst[MAX_OFFSET - 1 - offset],
+                         &src[offset], len)
+         != reference_chksum(initial, &src[offset], len)
+         || memcmp(&dst[MAX_OFFSET - 1 - offset], &src[offset], len) != 0) {
+        failures++;
+      }
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(update, "Incremental update");
+UNIT_TEST(update)
+{
+  UNIT_TEST_BEGIN();
+
+  unsigned i, failures = 0;
+  uint16_t len, field, chksum, old_sum, new_sum, result;
+  uint8_t *p;
+
+  for(i = 0; i < 10000; i++) {
+    len = 2 * (16 + rand() % (MAX_LEN / 2 - 16));
+    fill_random(src, len);
+    /* Some fields at the extremes of the range of values */
+    if(i % 4 == 0) {
+      memset(src, 0xff, len);
+    } else if(i % 4 == 1) {
+      memset(src, 0, len);
+    }
+
+    /* The checksum field at offset 0, as stored in a packet */
+    src[0] = src[1] = 0;
+    chksum = ~reference_chksum(0, src, len);
+    src[0] = chksum >> 8;
+    src[1] = chksum & 0xff;
+
+    /* Change a field of up to 16 bytes at an even offset */
+    field = 2 * (1 + rand() % (len / 2 - 9));
+    p = &src[field];
+    old_sum = uip_chksum_add(0, p, 16);
+    if(i % 8 == 2) {
+      memset(p, 0, 16);
+    } else {
+      fill_random(p, 16);
+    }
+    new_sum = uip_chksum_add(0, p, 16);
+
+    memcpy(&result, src, 2);
+    result = uip_chksum_update(result, old_sum, new_sum);
+    memcpy(src, &result, 2);
+
+    /* The packet with the updated field must verify */
+    if(reference_chksum(0, src, len) != 0xffff) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+static void
+report(const char *name, uint64_t ns, uint64_t cycles, uint16_t sum)
+{
+  double bytes = (double)BENCHMARK_LEN * BENCHMARK_ROUNDS;
+
+  printf("%-16s %6.2f bytes/ns", name, bytes / ns);
+  if(cycles > 0) {
+    printf(" %6.2f bytes/cycle", bytes / cycles);
+  }
+  printf(" (sum %04x)\n", sum);
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Checksum benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  uint64_t start_ns, start_cycles;
+  uint16_t sum, expected;
+  unsigned i;
+
+  printf("Word size: %u, %u bytes\n", UIP_CHKSUM_WORD_SIZE, BENCHMARK_LEN);
+  fill_random(bench_src, sizeof(bench_src));
+  expected = reference_chksum(0, bench_src, BENCHMARK_LEN);
+
+  /* The sums are chained, so that no round can be left out */
+  sum = 0;
+  start_ns = now_ns();
+  start_cycles = now_cycles();
+  for(i = 0; i < BENCHMARK_ROUNDS; i++) {
+    sum = reference_chksum(sum, bench_src, BENCHMARK_LEN);
+  }
+  report("reference", now_ns() - start_ns, now_cycles() - start_cycles, sum);
+
+  sum = 0;
+  start_ns = now_ns();
+  start_cycles = now_cycles();
+  for(i = 0; i < BENCHMARK_ROUNDS; i++) {
+    sum = uip_chksum_add(sum, bench_src, BENCHMARK_LEN);
+  }
+  report("add", now_ns() - start_ns, now_cycles() - start_cycles, sum);
+  UNIT_TEST_ASSERT(uip_chksum_add(0, bench_src, BENCHMARK_LEN) == expected);
+
+  sum = 0;
+  start_ns = now_ns();
+  start_cycles = now_cycles();
+  for(i = 0; i < BENCHMARK_ROUNDS; i++) {
+    memcpy(bench_dst, bench_src, BENCHMARK_LEN);
+    sum = uip_chksum_add(sum, bench_dst, BENCHMARK_LEN);
+  }
+  report("memcpy and add", now_ns() - start_ns,
+         now_cycles() - start_cycles, sum);
+
+  sum = 0;
+  start_ns = now_ns();
+  start_cycles = now_cycles();
+  for(i = 0; i < BENCHMARK_ROUNDS; i++) {
+    sum = uip_chksum_copy(sum, bench_dst, bench_src, BENCHMARK_LEN);
+  }
+  report("copy", now_ns() - start_ns, now_cycles() - start_cycles, sum);
+  UNIT_TEST_ASSERT(uip_chksum_copy(0, bench_dst, bench_src, BENCHMARK_LEN)
+                   == expected);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_chksum_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(add);
+  UNIT_TEST_RUN(copy);
+  UNIT_TEST_RUN(update);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(add) ||
+     !UNIT_TEST_PASSED(copy) ||
+     !UNIT_TEST_PASSED(update) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
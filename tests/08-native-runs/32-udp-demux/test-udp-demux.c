@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a benchmark for the demultiplexing of received
+ *      UDP datagrams. The test is built without and with
+ *      UIP_UDP_WITH_PORT_HASH, so that the rates can be compared.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uipbuf.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define BASE_PORT 5000
+#define REMOTE_PORT 7000
+#define BENCHMARK_DATAGRAMS 200000
+#define BENCHMARK_NEW 20000
+/*****************************************************************************/
+PROCESS(test_udp_demux_process, "UDP demultiplexing test process");
+PROCESS(owner_process, "UDP connection owner");
+AUTOSTART_PROCESSES(&test_udp_demux_process);
+/*****************************************************************************/
+static uip_ipaddr_t peer;
+static uip_ipaddr_t other_peer;
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+/* A connection that does not post events to any process */
+static struct uip_udp_conn *
+new_conn(const uip_ipaddr_t *ripaddr, uint16_t rport, uint16_t lport)
+{
+  struct uip_udp_conn *conn;
+
+  conn = uip_udp_new(ripaddr, UIP_HTONS(rport));
+  if(conn != NULL) {
+    conn->appstate.p = NULL;
+    conn->appstate.state = NULL;
+    if(lport != 0) {
+      uip_udp_bind(conn, UIP_HTONS(lport));
+    }
+  }
+  return conn;
+}
+/*****************************************************************************/
+static void
+remove_all(void)
+{
+  for(int i = 0; i < UIP_UDP_CONNS; i++) {
+    if(uip_udp_conns[i].lport != 0) {
+      uip_udp_remove(&uip_udp_conns[i]);
+    }
+  }
+}
+/*****************************************************************************/
+/* Passes a datagram to uIP as if it was received to the link-local
+   all-nodes address, and returns the connection that it was delivered
+   to, or NULL */
+static struct uip_udp_conn *
+deliver(const uip_ipaddr_t *src, uint16_t srcport, uint16_t destport)
+{
+  uip_stats_t received;
+
+  memset(uip_buf, 0, UIP_IPUDPH_LEN + 4);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, src);
+  uip_create_linklocal_allnodes_mcast(&UIP_IP_BUF->destipaddr);
+  uipbuf_set_len_field(UIP_IP_BUF, UIP_UDPH_LEN + 4);
+  UIP_UDP_BUF->srcport = UIP_HTONS(srcport);
+  UIP_UDP_BUF->destport = UIP_HTONS(destport);
+  UIP_UDP_BUF->udplen = UIP_HTONS(UIP_UDPH_LEN + 4);
+  /* uIP accepts a zero checksum */
+  UIP_UDP_BUF->udpchksum = 0;
+  uip_len = UIP_IPUDPH_LEN + 4;
+
+  received = uip_stat.udp.recv;
+  uip_input();
+  uipbuf_clear();
+
+  return uip_stat.udp.recv != received ? uip_udp_conn : NULL;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(demux, "Demultiplexing");
+UNIT_TEST(demux)
+{
+  UNIT_TEST_BEGIN();
+
+  struct uip_udp_conn *conns[48];
+  struct uip_udp_conn *connected, *rport_bound, *raddr_bound, *wildcard;
+  unsigned i, failures = 0;
+
+  remove_all();
+
+  /* The connections that are bound to a remote port or address are
+     created before the wildcard, so that they also take precedence
+     with a scan of the connections */
+  connected = new_conn(&peer, REMOTE_PORT, BASE_PORT);
+  rport_bound = new_conn(NULL, REMOTE_PORT + 1, BASE_PORT);
+  raddr_bound = new_conn(&peer, 0, BASE_PORT);
+  wildcard = new_conn(NULL, 0, BASE_PORT);
+  UNIT_TEST_ASSERT(connected != NULL && rport_bound != NULL &&
+                   raddr_bound != NULL && wildcard != NULL);
+
+  for(i = 0; i < sizeof(conns) / sizeof(conns[0]); i++) {
+    conns[i] = new_conn(NULL, 0, BASE_PORT + 1 + i);
+    UNIT_TEST_ASSERT(conns[i] != NULL);
+  }
+
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT) == connected);
+  UNIT_TEST_ASSERT(deliver(&other_peer, REMOTE_PORT + 1, BASE_PORT)
+                   == rport_bound);
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT + 2, BASE_PORT)
+                   == raddr_bound);
+  UNIT_TEST_ASSERT(deliver(&other_peer, REMOTE_PORT, BASE_PORT)
+                   == wildcard);
+
+#if UIP_UDP_WITH_PORT_HASH
+  /* The most specific connection is found also when it was created
+     after the wildcard */
+  uip_udp_remove(connected);
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT) == raddr_bound);
+  connected = new_conn(&peer, REMOTE_PORT, BASE_PORT);
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT) == connected);
+#endif /* UIP_UDP_WITH_PORT_HASH */
+
+  for(i = 0; i < sizeof(conns) / sizeof(conns[0]); i++) {
+    if(deliver(&peer, REMOTE_PORT, BASE_PORT + 1 + i) != conns[i]) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  /* No connection for the port */
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT + 100) == NULL);
+
+  /* A removed connection gets no more datagrams */
+  uip_udp_remove(conns[3]);
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT + 4) == NULL);
+  uip_udp_remove(conns[3]);
+
+  /* A removed connection that is bound again gets them again */
+  uip_udp_bind(conns[3], UIP_HTONS(BASE_PORT + 100));
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT + 100) == conns[3]);
+
+  /* A connection that is bound to another port moves there */
+  uip_udp_bind(conns[5], UIP_HTONS(BASE_PORT + 101));
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT + 6) == NULL);
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT + 101) == conns[5]);
+
+  remove_all();
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(ephemeral, "Ephemeral ports");
+UNIT_TEST(ephemeral)
+{
+  UNIT_TEST_BEGIN();
+
+  struct uip_udp_conn *conn;
+  unsigned i, j, failures = 0;
+
+  remove_all();
+
+  /* All connections can be allocated, with different ports */
+  for(i = 0; i < UIP_UDP_CONNS; i++) {
+    conn = new_conn(NULL, 0, 0);
+    if(conn == NULL || uip_ntohs(conn->lport) < 1024) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+  UNIT_TEST_ASSERT(new_conn(NULL, 0, 0) == NULL);
+
+  for(i = 0; i < UIP_UDP_CONNS; i++) {
+    for(j = i + 1; j < UIP_UDP_CONNS; j++) {
+      if(uip_udp_conns[i].lport == uip_udp_conns[j].lport) {
+        failures++;
+      }
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  /* A removed connection can be allocated again */
+  uip_udp_remove(&uip_udp_conns[UIP_UDP_CONNS / 2]);
+  UNIT_TEST_ASSERT(new_conn(NULL, 0, 0) == &uip_udp_conns[UIP_UDP_CONNS / 2]);
+
+  /* Allocation skips ports that are bound explicitly, also across the
+     wrap-around of the ephemeral port range */
+  remove_all();
+  for(i = 0; i < UIP_UDP_CONNS - 1; i++) {
+    new_conn(NULL, 0, 31990 + i);
+  }
+  for(i = 0; i < 40000; i++) {
+    conn = new_conn(NULL, 0, 0);
+    if(conn == NULL || (uip_ntohs(conn->lport) >= 31990 &&
+                        uip_ntohs(conn->lport) < 31990 + UIP_UDP_CONNS - 1)) {
+      failures++;
+      break;
+    }
+    uip_udp_remove(conn);
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  remove_all();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+/* Allocates a connection that belongs to the process and waits until
+   the process is exited */
+PROCESS_THREAD(owner_process, ev, data)
+{
+  static struct uip_udp_conn *conn;
+
+  PROCESS_BEGIN();
+
+  conn = udp_new(NULL, 0, NULL);
+  if(conn != NULL) {
+    udp_bind(conn, UIP_HTONS(BASE_PORT));
+  }
+  PROCESS_WAIT_EVENT_UNTIL(0);
+
+  PROCESS_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(exited, "Connections of exited processes");
+UNIT_TEST(exited)
+{
+  UNIT_TEST_BEGIN();
+
+  struct uip_udp_conn *conn;
+  unsigned i, failures = 0;
+
+  remove_all();
+
+  /* The connection of an exited process is removed, and can be
+     allocated and bound to the same port again */
+  for(i = 0; i < UIP_UDP_CONNS + 1; i++) {
+    process_start(&owner_process, NULL);
+    if(deliver(&peer, REMOTE_PORT, BASE_PORT) == NULL) {
+      failures++;
+    }
+    process_exit(&owner_process);
+    if(deliver(&peer, REMOTE_PORT, BASE_PORT) != NULL) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  conn = new_conn(NULL, 0, BASE_PORT);
+  UNIT_TEST_ASSERT(conn != NULL);
+  UNIT_TEST_ASSERT(deliver(&peer, REMOTE_PORT, BASE_PORT) == conn);
+
+  /* No connection is lost */
+  for(i = 1; i < UIP_UDP_CONNS; i++) {
+    if(new_conn(NULL, 0, 0) == NULL) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  remove_all();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Demultiplexing benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  static const unsigned conn_counts[] = { 1, 16, UIP_UDP_CONNS };
+  struct uip_udp_conn *conn;
+  uint64_t start, elapsed;
+  unsigned count, i, j, failures = 0;
+
+  printf("Port hash: %u, %u connections\n", UIP_UDP_WITH_PORT_HASH,
+         UIP_UDP_CONNS);
+
+  for(i = 0; i < sizeof(conn_counts) / sizeof(conn_counts[0]); i++) {
+    count = conn_counts[i];
+    remove_all();
+    for(j = 0; j < count; j++) {
+      new_conn(NULL, 0, BASE_PORT + j);
+    }
+
+    start = now_ns();
+    for(j = 0; j < BENCHMARK_DATAGRAMS; j++) {
+      /* Spread the datagrams over all connections */
+      if(deliver(&peer, REMOTE_PORT, BASE_PORT + (j * 7919) % count)
+         == NULL) {
+        failures++;
+      }
+    }
+    elapsed = now_ns() - start;
+    printf("%4u connections: %9.0f datagrams/s", count,
+           BENCHMARK_DATAGRAMS * 1e9 / elapsed);
+
+    /* Allocate and remove a connection with an ephemeral port while
+       the others are in use */
+    start = now_ns();
+    for(j = 0; j < BENCHMARK_NEW && count < UIP_UDP_CONNS; j++) {
+      conn = new_conn(NULL, 0, 0);
+      if(conn == NULL) {
+        failures++;
+        break;
+      }
+      uip_udp_remove(conn);
+    }
+    elapsed = now_ns() - start;
+    if(count < UIP_UDP_CONNS) {
+      printf(", %9.0f allocations/s", BENCHMARK_NEW * 1e9 / elapsed);
+    }
+    printf("\n");
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  remove_all();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_udp_demux_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  uip_ip6addr(&peer, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  uip_ip6addr(&other_peer, 0xfe80, 0, 0, 0, 0, 0, 0, 2);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(demux);
+  UNIT_TEST_RUN(ephemeral);
+  UNIT_TEST_RUN(exited);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(demux) ||
+     !UNIT_TEST_PASSED(ephemeral) ||
+     !UNIT_TEST_PASSED(exited) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
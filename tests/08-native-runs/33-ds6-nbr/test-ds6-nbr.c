@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a lookup benchmark for the IPv6 neighbor cache. The
+ *      test is built without and with UIP_DS6_NBR_CONF_WITH_IPADDR_INDEX,
+ *      and with UIP_DS6_NBR_CONF_MULTI_IPV6_ADDRS, so that the cost of
+ *      uip_ds6_nbr_lookup() can be compared for 16 to 256 neighbors.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define TEST_LOOKUPS 200000
+
+#if UIP_DS6_NBR_MULTI_IPV6_ADDRS
+/* A link-local and a global address per neighbor */
+#define ADDRS_PER_NBR 2
+#else
+#define ADDRS_PER_NBR 1
+#endif
+
+static volatile uintptr_t sink;
+/*****************************************************************************/
+PROCESS(test_ds6_nbr_process, "IPv6 neighbor cache test process");
+AUTOSTART_PROCESSES(&test_ds6_nbr_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static void
+make_lladdr(uip_lladdr_t *lladdr, uint16_t id)
+{
+  memset(lladdr, 0, sizeof(*lladdr));
+  lladdr->addr[0] = 0x02;
+  lladdr->addr[sizeof(lladdr->addr) - 2] = id >> 8;
+  lladdr->addr[sizeof(lladdr->addr) - 1] = id & 0xff;
+}
+/*****************************************************************************/
+/* The addresses of a neighbor share its interface identifier */
+static void
+make_ipaddr(uip_ipaddr_t *ipaddr, uint16_t id, int global)
+{
+  if(global) {
+    uip_ip6addr(ipaddr, 0xfd00, 0, 0, 0, 0x0200, 0, 0, id);
+  } else {
+    uip_ip6addr(ipaddr, 0xfe80, 0, 0, 0, 0x0200, 0, 0, id);
+  }
+}
+/*****************************************************************************/
+static uip_ds6_nbr_t *
+add_nbr(uint16_t id, int global)
+{
+  uip_ipaddr_t ipaddr;
+  uip_lladdr_t lladdr;
+
+  make_ipaddr(&ipaddr, id, global);
+  make_lladdr(&lladdr, id);
+  return uip_ds6_nbr_add(&ipaddr, &lladdr, 0, NBR_REACHABLE,
+                         NBR_TABLE_REASON_UNDEFINED, NULL);
+}
+/*****************************************************************************/
+static uip_ds6_nbr_t *
+get_nbr(uint16_t id, int global)
+{
+  uip_ipaddr_t ipaddr;
+
+  make_ipaddr(&ipaddr, id, global);
+  return uip_ds6_nbr_lookup(&ipaddr);
+}
+/*****************************************************************************/
+/* A lookup by walking all entries, to check the index against */
+static uip_ds6_nbr_t *
+scan_nbr(uint16_t id, int global)
+{
+  uip_ipaddr_t ipaddr;
+  uip_ds6_nbr_t *nbr;
+
+  make_ipaddr(&ipaddr, id, global);
+  for(nbr = uip_ds6_nbr_head(); nbr != NULL; nbr = uip_ds6_nbr_next(nbr)) {
+    if(uip_ipaddr_cmp(&nbr->ipaddr, &ipaddr)) {
+      return nbr;
+    }
+  }
+  return NULL;
+}
+/*****************************************************************************/
+static void
+remove_all(void)
+{
+  while(uip_ds6_nbr_head() != NULL) {
+    uip_ds6_nbr_rm(uip_ds6_nbr_head());
+  }
+}
+/*****************************************************************************/
+/* Checks all addresses of neighbors 1 to count + 1 against a scan */
+static unsigned
+count_mismatches(uint16_t count)
+{
+  unsigned failures = 0;
+
+  for(uint16_t id = 1; id <= count + 1; id++) {
+    for(int global = 0; global < ADDRS_PER_NBR; global++) {
+      if(get_nbr(id, global) != scan_nbr(id, global)) {
+        failures++;
+      }
+    }
+  }
+  return failures;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(add_lookup, "Add and look up neighbors");
+UNIT_TEST(add_lookup)
+{
+  UNIT_TEST_BEGIN();
+
+  uip_ds6_nbr_t *nbr;
+  unsigned failures = 0;
+
+  remove_all();
+
+  for(uint16_t id = 1; id <= NBR_TABLE_MAX_NEIGHBORS; id++) {
+    for(int global = 0; global < ADDRS_PER_NBR; global++) {
+      nbr = add_nbr(id, global);
+      if(nbr == NULL || get_nbr(id, global) != nbr) {
+        failures++;
+      }
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_num() ==
+                   NBR_TABLE_MAX_NEIGHBORS * ADDRS_PER_NBR);
+  UNIT_TEST_ASSERT(count_mismatches(NBR_TABLE_MAX_NEIGHBORS) == 0);
+
+  /* Addresses that differ from those of a neighbor in the prefix only */
+  UNIT_TEST_ASSERT(get_nbr(NBR_TABLE_MAX_NEIGHBORS + 1, 0) == NULL);
+#if !UIP_DS6_NBR_MULTI_IPV6_ADDRS
+  UNIT_TEST_ASSERT(get_nbr(1, 1) == NULL);
+#endif /* !UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(remove_update, "Remove and update neighbors");
+UNIT_TEST(remove_update)
+{
+  UNIT_TEST_BEGIN();
+
+  uip_ds6_nbr_t *nbr;
+  uip_lladdr_t lladdr;
+  unsigned failures = 0;
+
+  /* Remove every third neighbor */
+  for(uint16_t id = 1; id <= NBR_TABLE_MAX_NEIGHBORS; id += 3) {
+    for(int global = 0; global < ADDRS_PER_NBR; global++) {
+      if(uip_ds6_nbr_rm(get_nbr(id, global)) == 0) {
+        failures++;
+      }
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+  UNIT_TEST_ASSERT(get_nbr(1, 0) == NULL);
+  UNIT_TEST_ASSERT(count_mismatches(NBR_TABLE_MAX_NEIGHBORS) == 0);
+
+  /* A neighbor keeps its IPv6 address when its link-layer address
+     changes to one that is not in use */
+  nbr = get_nbr(2, 0);
+  make_lladdr(&lladdr, 1);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_update_ll(&nbr, &lladdr) == 0);
+  UNIT_TEST_ASSERT(get_nbr(2, 0) == nbr);
+  UNIT_TEST_ASSERT(uip_ds6_nbr_ll_lookup(&lladdr) == nbr);
+  UNIT_TEST_ASSERT(count_mismatches(NBR_TABLE_MAX_NEIGHBORS) == 0);
+
+#if !UIP_DS6_NBR_MULTI_IPV6_ADDRS
+  /* An address added for a link-layer address in use replaces the
+     address of that neighbor */
+  nbr = add_nbr(3, 1);
+  UNIT_TEST_ASSERT(nbr != NULL);
+  UNIT_TEST_ASSERT(get_nbr(3, 1) == nbr);
+  UNIT_TEST_ASSERT(get_nbr(3, 0) == NULL);
+  UNIT_TEST_ASSERT(count_mismatches(NBR_TABLE_MAX_NEIGHBORS) == 0);
+#endif /* !UIP_DS6_NBR_MULTI_IPV6_ADDRS */
+
+  /* Add the removed neighbors again */
+  for(uint16_t id = 4; id <= NBR_TABLE_MAX_NEIGHBORS; id += 3) {
+    for(int global = 0; global < ADDRS_PER_NBR; global++) {
+      if(add_nbr(id, global) == NULL) {
+        failures++;
+      }
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+  UNIT_TEST_ASSERT(count_mismatches(NBR_TABLE_MAX_NEIGHBORS) == 0);
+
+  remove_all();
+  UNIT_TEST_ASSERT(count_mismatches(NBR_TABLE_MAX_NEIGHBORS) == 0);
+  UNIT_TEST_ASSERT(get_nbr(2, 0) == NULL);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Lookup benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  static const uint16_t nbr_counts[] = { 16, 64, NBR_TABLE_MAX_NEIGHBORS };
+  uint64_t start, elapsed;
+  uint16_t count;
+  unsigned i, j, failures = 0;
+
+  printf("IPv6 address index: %u, addresses per neighbor: %u\n",
+         UIP_DS6_NBR_WITH_IPADDR_INDEX, ADDRS_PER_NBR);
+
+  for(i = 0; i < sizeof(nbr_counts) / sizeof(nbr_counts[0]); i++) {
+    count = nbr_counts[i];
+    remove_all();
+    for(uint16_t id = 1; id <= count; id++) {
+      for(int global = 0; global < ADDRS_PER_NBR; global++) {
+        if(add_nbr(id, global) == NULL) {
+          failures++;
+        }
+      }
+    }
+
+    start = now_ns();
+    for(j = 0; j < TEST_LOOKUPS; j++) {
+      /* Spread the lookups over all neighbors, and mostly look up
+         the global address, which comes last without the index */
+      sink += (uintptr_t)get_nbr(1 + (j * 7919) % count,
+                                 ADDRS_PER_NBR - 1);
+    }
+    elapsed = now_ns() - start;
+
+    printf("%4u neighbors: %6.1f ns/lookup\n", count,
+           (double)elapsed / TEST_LOOKUPS);
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+
+  remove_all();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_ds6_nbr_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(add_lookup);
+  UNIT_TEST_RUN(remove_update);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(add_lookup) ||
+     !UNIT_TEST_PASSED(remove_update) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a jitter benchmark for the rtimer module. The test
+ *      is built without and with RTIMER_CONF_WITH_QUEUE. Several periodic
+ *      clients, one of them with RTIMER_PRIORITY_HIGH as TSCH uses,
+ *      share the rtimer and report how late their callbacks run.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+#define CLIENTS         4
+#define RUN_TIME        (2 * RTIMER_SECOND)
+/* Lateness beyond which a callback counts as a miss: more than one
+   1 ms tick of the native rtimer */
+#define MAX_LATENESS_NS 2000000
+
+struct client {
+  struct rtimer rt;
+  rtimer_clock_t period;
+  uint8_t priority;
+  rtimer_clock_t end;
+  volatile unsigned runs;
+  volatile unsigned rejected;
+  volatile unsigned misses;
+  volatile uint64_t lateness_sum;
+  volatile uint64_t lateness_max;
+};
+
+/* Periods in ms on native; client 0 stands for TSCH */
+static struct client clients[CLIENTS] = {
+  { .period = 10, .priority = RTIMER_PRIORITY_HIGH },
+  { .period = 7, .priority = RTIMER_PRIORITY_NORMAL },
+  { .period = 11, .priority = RTIMER_PRIORITY_NORMAL },
+  { .period = 13, .priority = RTIMER_PRIORITY_NORMAL },
+};
+
+static volatile unsigned fired;
+static volatile int order[8];
+/*****************************************************************************/
+PROCESS(test_rtimer_queue_process, "rtimer queue test process");
+AUTOSTART_PROCESSES(&test_rtimer_queue_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+/* Waits, with the rtimer signal delivered, until the given number of
+   callbacks ran or the timeout passed */
+static void
+wait_fired(unsigned count, rtimer_clock_t timeout)
+{
+  rtimer_clock_t end = RTIMER_NOW() + timeout;
+  struct timespec ts = { 0, 100000 };
+
+  while(fired < count && RTIMER_CLOCK_LT(RTIMER_NOW(), end)) {
+    nanosleep(&ts, NULL);
+  }
+}
+/*****************************************************************************/
+static void
+record(struct rtimer *t, void *ptr)
+{
+  if(fired < sizeof(order) / sizeof(order[0])) {
+    order[fired] = (int)(intptr_t)ptr;
+  }
+  fired++;
+}
+/*****************************************************************************/
+static void
+client_run(struct rtimer *t, void *ptr)
+{
+  struct client *c = ptr;
+  uint64_t now = now_ns();
+  uint64_t lateness;
+
+  /* RTIMER_NOW() is clock_time(), in ms of CLOCK_MONOTONIC on native */
+  lateness = now - (uint64_t)RTIMER_TIME(t) * (1000000000 / RTIMER_SECOND);
+  c->runs++;
+  c->lateness_sum += lateness;
+  if(lateness > c->lateness_max) {
+    c->lateness_max = lateness;
+  }
+  if(lateness > MAX_LATENESS_NS) {
+    c->misses++;
+  }
+
+  if(RTIMER_CLOCK_LT(RTIMER_TIME(t) + c->period, c->end)) {
+    if(rtimer_set_with_priority(t, RTIMER_TIME(t) + c->period, c->priority,
+                                client_run, c) != RTIMER_OK) {
+      c->rejected++;
+    }
+  } else {
+    fired++;
+  }
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(order, "Run order of pending tasks");
+UNIT_TEST(order)
+{
+  UNIT_TEST_BEGIN();
+
+  static struct rtimer rt[4];
+  rtimer_clock_t now;
+
+  fired = 0;
+  now = RTIMER_NOW();
+  UNIT_TEST_ASSERT(rtimer_set(&rt[0], now + 30, 0, record,
+                              (void *)0) == RTIMER_OK);
+#if RTIMER_WITH_QUEUE
+  UNIT_TEST_ASSERT(rtimer_set(&rt[1], now + 20, 0, record,
+                              (void *)1) == RTIMER_OK);
+  UNIT_TEST_ASSERT(rtimer_set(&rt[2], now + 40, 0, record,
+                              (void *)2) == RTIMER_OK);
+  UNIT_TEST_ASSERT(rtimer_set(&rt[3], now + 20, 0, record,
+                              (void *)3) == RTIMER_OK);
+  /* A task can only be pending once */
+  UNIT_TEST_ASSERT(rtimer_set(&rt[0], now + 10, 0, record,
+                              (void *)0) == RTIMER_ERR_ALREADY_SCHEDULED);
+
+  wait_fired(4, RTIMER_SECOND);
+  UNIT_TEST_ASSERT(fired == 4);
+  /* By deadline, then in the order posted */
+  UNIT_TEST_ASSERT(order[0] == 1);
+  UNIT_TEST_ASSERT(order[1] == 3);
+  UNIT_TEST_ASSERT(order[2] == 0);
+  UNIT_TEST_ASSERT(order[3] == 2);
+#else /* RTIMER_WITH_QUEUE */
+  /* Only one task can be pending */
+  UNIT_TEST_ASSERT(rtimer_set(&rt[1], now + 20, 0, record,
+                              (void *)1) == RTIMER_ERR_ALREADY_SCHEDULED);
+
+  wait_fired(1, RTIMER_SECOND);
+  UNIT_TEST_ASSERT(fired == 1);
+  UNIT_TEST_ASSERT(order[0] == 0);
+#endif /* RTIMER_WITH_QUEUE */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(priority, "Priority on conflicting deadlines");
+UNIT_TEST(priority)
+{
+  UNIT_TEST_BEGIN();
+
+#if RTIMER_WITH_QUEUE
+  static struct rtimer rt[4];
+  rtimer_clock_t now;
+
+  fired = 0;
+  now = RTIMER_NOW();
+  /* Same deadline: the high-priority task runs first */
+  rtimer_set(&rt[0], now + 20, 0, record, (void *)0);
+  rtimer_set_with_priority(&rt[1], now + 20, RTIMER_PRIORITY_HIGH,
+                           record, (void *)1);
+  /* A task due within RTIMER_PRIORITY_WINDOW before a high-priority
+     task is held back until that one ran */
+  rtimer_set(&rt[2], now + 40, 0, record, (void *)2);
+  rtimer_set_with_priority(&rt[3], now + 40 + RTIMER_PRIORITY_WINDOW - 2,
+                           RTIMER_PRIORITY_HIGH, record, (void *)3);
+
+  wait_fired(4, RTIMER_SECOND);
+  UNIT_TEST_ASSERT(fired == 4);
+  UNIT_TEST_ASSERT(order[0] == 1);
+  UNIT_TEST_ASSERT(order[1] == 0);
+  UNIT_TEST_ASSERT(order[2] == 3);
+  UNIT_TEST_ASSERT(order[3] == 2);
+#endif /* RTIMER_WITH_QUEUE */
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(jitter, "Jitter with concurrent clients");
+UNIT_TEST(jitter)
+{
+  UNIT_TEST_BEGIN();
+
+  struct client *c;
+  rtimer_clock_t start;
+  unsigned i, expected;
+
+  printf("rtimer queue: %u, clients: %u\n", RTIMER_WITH_QUEUE, CLIENTS);
+
+  fired = 0;
+  start = RTIMER_NOW() + 10;
+  for(i = 0; i < CLIENTS; i++) {
+    c = &clients[i];
+    c->end = start + RUN_TIME;
+    if(rtimer_set_with_priority(&c->rt, start + c->period, c->priority,
+                                client_run, c) != RTIMER_OK) {
+      c->rejected++;
+      fired++;
+    }
+  }
+
+  wait_fired(CLIENTS, 2 * RUN_TIME);
+
+  for(i = 0; i < CLIENTS; i++) {
+    c = &clients[i];
+    expected = (RUN_TIME - 1) / c->period;
+    printf("client %u: period %2u ms, priority %u: %3u/%3u runs, "
+           "%u rejected, lateness mean %6.1f us, max %6.1f us, %u misses\n",
+           i, (unsigned)c->period, c->priority, c->runs, expected,
+           c->rejected, c->runs ? c->lateness_sum / 1000.0 / c->runs : 0.0,
+           c->lateness_max / 1000.0, c->misses);
+#if RTIMER_WITH_QUEUE
+    UNIT_TEST_ASSERT(c->runs == expected);
+    UNIT_TEST_ASSERT(c->rejected == 0);
+#endif /* RTIMER_WITH_QUEUE */
+  }
+  /* The high-priority client always gets the rtimer, and is on time
+     but for the scheduling noise of the host */
+  c = &clients[0];
+  UNIT_TEST_ASSERT(c->runs == (RUN_TIME - 1) / c->period);
+  UNIT_TEST_ASSERT(c->lateness_sum / c->runs <= MAX_LATENESS_NS);
+  UNIT_TEST_ASSERT(c->misses <= c->runs / 10);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_rtimer_queue_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(order);
+  UNIT_TEST_RUN(priority);
+  UNIT_TEST_RUN(jitter);
+
+  if(!UNIT_TEST_PASSED(order) ||
+     !UNIT_TEST_PASSED(priority) ||
+     !UNIT_TEST_PASSED(jitter)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*****************************************************************************/
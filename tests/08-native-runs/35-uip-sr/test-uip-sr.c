@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2026, Contiki-NG contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *      Unit tests and a benchmark for the source routing table of a
+ *      non-storing root. The test is built without and with
+ *      UIP_SR_CONF_WITH_NODE_INDEX, and checks the node lookups and
+ *      reachability of uip-sr against a walk of the parent links.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "contiki.h"
+#include "net/ipv6/uip-sr.h"
+#include "net/routing/routing.h"
+#include "unit-test/unit-test.h"
+/*****************************************************************************/
+/* Nodes besides the root, leaving room for the ones added later */
+#define TREE_NODES   (UIP_SR_LINK_NUM - 8)
+#define TEST_CHECKS  20
+#define LIFETIME     3600
+
+static uip_ipaddr_t root_ipaddr;
+static uint32_t seed = 1;
+/*****************************************************************************/
+PROCESS(test_uip_sr_process, "uip-sr test process");
+AUTOSTART_PROCESSES(&test_uip_sr_process);
+/*****************************************************************************/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+/*****************************************************************************/
+static uint32_t
+next_random(void)
+{
+  seed = seed * 1103515245 + 12345;
+  return seed >> 16;
+}
+/*****************************************************************************/
+/* Node 0 is the root; the others share its prefix */
+static void
+make_ipaddr(uip_ipaddr_t *ipaddr, uint16_t id)
+{
+  if(id == 0) {
+    uip_ipaddr_copy(ipaddr, &root_ipaddr);
+  } else {
+    uip_ip6addr(ipaddr, 0, 0, 0, 0, 0x0200, 0, 0, id);
+    memcpy(ipaddr, &root_ipaddr, 8);
+  }
+}
+/*****************************************************************************/
+static uip_sr_node_t *
+update(uint16_t child, uint16_t parent, uint32_t lifetime)
+{
+  uip_ipaddr_t child_ipaddr, parent_ipaddr;
+
+  make_ipaddr(&child_ipaddr, child);
+  make_ipaddr(&parent_ipaddr, parent);
+  return uip_sr_update_node(NULL, &child_ipaddr, &parent_ipaddr, lifetime);
+}
+/*****************************************************************************/
+static uip_sr_node_t *
+get_node(uint16_t id)
+{
+  uip_ipaddr_t ipaddr;
+
+  make_ipaddr(&ipaddr, id);
+  return uip_sr_get_node(NULL, &ipaddr);
+}
+/*****************************************************************************/
+static int
+is_reachable(uint16_t id)
+{
+  uip_ipaddr_t ipaddr;
+
+  make_ipaddr(&ipaddr, id);
+  return uip_sr_is_addr_reachable(NULL, &ipaddr);
+}
+/*****************************************************************************/
+/* Reachability by walking the parent links, to check uip-sr against */
+static int
+walk_reachable(const uip_sr_node_t *node)
+{
+  const uip_sr_node_t *root_node = get_node(0);
+  int steps;
+
+  for(steps = 0; node != NULL && node != root_node &&
+        steps < UIP_SR_LINK_NUM; steps++) {
+    node = node->parent;
+  }
+  return node != NULL && node == root_node;
+}
+/*****************************************************************************/
+/* Checks the lookup and reachability of every node against a walk */
+static unsigned
+count_mismatches(void)
+{
+  uip_sr_node_t *node;
+  uip_ipaddr_t ipaddr;
+  unsigned failures = 0;
+
+  for(node = uip_sr_node_head(); node != NULL;
+      node = uip_sr_node_next(node)) {
+    NETSTACK_ROUTING.get_sr_node_ipaddr(&ipaddr, node);
+    if(uip_sr_get_node(NULL, &ipaddr) != node ||
+       uip_sr_is_addr_reachable(NULL, &ipaddr) != walk_reachable(node)) {
+      failures++;
+    }
+  }
+  return failures;
+}
+/*****************************************************************************/
+/* Builds a deep tree: each node hangs below one of the four nodes
+   added just before it */
+static unsigned
+build_tree(void)
+{
+  unsigned failures = 0;
+  uint16_t id;
+
+  uip_sr_free_all();
+  for(id = 1; id <= TREE_NODES; id++) {
+    if(update(id, id <= 4 ? 0 : id - 1 - next_random() % 4,
+              LIFETIME) == NULL) {
+      failures++;
+    }
+  }
+  return failures;
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(tree, "Lookup and reachability in a tree");
+UNIT_TEST(tree)
+{
+  UNIT_TEST_BEGIN();
+
+  unsigned failures = 0;
+  uint16_t id;
+
+  UNIT_TEST_ASSERT(build_tree() == 0);
+  UNIT_TEST_ASSERT(uip_sr_num_nodes() == TREE_NODES + 1);
+
+  for(id = 1; id <= TREE_NODES; id++) {
+    if(get_node(id) == NULL || !is_reachable(id)) {
+      failures++;
+    }
+  }
+  UNIT_TEST_ASSERT(failures == 0);
+  UNIT_TEST_ASSERT(count_mismatches() == 0);
+  UNIT_TEST_ASSERT(get_node(TREE_NODES + 1) == NULL);
+  UNIT_TEST_ASSERT(!is_reachable(TREE_NODES + 1));
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(changes, "Reachability across topology changes");
+UNIT_TEST(changes)
+{
+  UNIT_TEST_BEGIN();
+
+  const uint16_t orphan = TREE_NODES + 1;
+  const uint16_t orphan_parent = TREE_NODES + 2;
+  uip_ipaddr_t ipaddr, parent_ipaddr;
+  uip_sr_node_t *node;
+
+  UNIT_TEST_ASSERT(build_tree() == 0);
+  /* Fill the caches */
+  UNIT_TEST_ASSERT(count_mismatches() == 0);
+
+  /* A node whose parent is not known yet is unreachable */
+  UNIT_TEST_ASSERT(update(orphan, orphan_parent, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(!is_reachable(orphan));
+  UNIT_TEST_ASSERT(!is_reachable(orphan_parent));
+  UNIT_TEST_ASSERT(count_mismatches() == 0);
+
+  /* Both become reachable once the parent joins the tree */
+  UNIT_TEST_ASSERT(update(orphan_parent, TREE_NODES, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(is_reachable(orphan));
+  UNIT_TEST_ASSERT(count_mismatches() == 0);
+
+  /* An update that would create a loop is not taken: hang the child of
+     the root the orphan descends from below the orphan */
+  for(node = get_node(orphan); node->parent != get_node(0);
+      node = node->parent);
+  NETSTACK_ROUTING.get_sr_node_ipaddr(&ipaddr, node);
+  make_ipaddr(&parent_ipaddr, orphan);
+  UNIT_TEST_ASSERT(uip_sr_update_node(NULL, &ipaddr, &parent_ipaddr,
+                                      LIFETIME) == node);
+  UNIT_TEST_ASSERT(node->parent == get_node(0));
+  UNIT_TEST_ASSERT(is_reachable(orphan));
+  UNIT_TEST_ASSERT(count_mismatches() == 0);
+
+  /* Move a subtree */
+  UNIT_TEST_ASSERT(update(TREE_NODES / 2, 3, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(get_node(TREE_NODES / 2)->parent == get_node(3));
+  UNIT_TEST_ASSERT(count_mismatches() == 0);
+
+  /* An expired leaf is removed */
+  UNIT_TEST_ASSERT(update(orphan, orphan_parent, 0) != NULL);
+  uip_sr_periodic(1);
+  UNIT_TEST_ASSERT(get_node(orphan) == NULL);
+  UNIT_TEST_ASSERT(!is_reachable(orphan));
+  UNIT_TEST_ASSERT(is_reachable(orphan_parent));
+  UNIT_TEST_ASSERT(count_mismatches() == 0);
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+UNIT_TEST_REGISTER(benchmark, "Reachability benchmark");
+UNIT_TEST(benchmark)
+{
+  UNIT_TEST_BEGIN();
+
+  uint64_t start, elapsed;
+  unsigned i, reachable = 0;
+  uint16_t id;
+
+  printf("Node index: %u, nodes: %u\n", UIP_SR_WITH_NODE_INDEX,
+         TREE_NODES + 1);
+
+  UNIT_TEST_ASSERT(build_tree() == 0);
+
+  start = now_ns();
+  for(i = 0; i < TEST_CHECKS; i++) {
+    for(id = 1; id <= TREE_NODES; id++) {
+      reachable += is_reachable(id);
+    }
+  }
+  elapsed = now_ns() - start;
+
+  printf("uip_sr_is_addr_reachable: %8.1f ns/check\n",
+         (double)elapsed / (TEST_CHECKS * TREE_NODES));
+  UNIT_TEST_ASSERT(reachable == TEST_CHECKS * TREE_NODES);
+
+  uip_sr_free_all();
+
+  UNIT_TEST_END();
+}
+/*****************************************************************************/
+PROCESS_THREAD(test_uip_sr_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  /* Become the root, whose prefix the nodes share */
+  NETSTACK_ROUTING.root_set_prefix(NULL, NULL);
+  NETSTACK_ROUTING.root_start();
+  NETSTACK_ROUTING.get_root_ipaddr(&root_ipaddr);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(tree);
+  UNIT_TEST_RUN(changes);
+  UNIT_TEST_RUN(benchmark);
+
+  if(!UNIT_TEST_PASSED(tree) ||
+     !UNIT_TEST_PASSED(changes) ||
+     !UNIT_TEST_PASSED(benchmark)) {
+    printf("=check-me= FAILED\n");
+    printf("---\n");
+  }
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*****************************************************************************/